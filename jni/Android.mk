@@ -1,47 +1,74 @@
-# Copyright (c) <2012>, Intel Corporation
-#
-# Redistribution and use in source and binary forms, with or without 
-# modification, are permitted provided that the following conditions are met:
-#
-# - Redistributions of source code must retain the above copyright notice, 
-#   this list of conditions and the following disclaimer.
-# - Redistributions in binary form must reproduce the above copyright notice, 
-#   this list of conditions and the following disclaimer in the documentation 
-#   and/or other materials provided with the distribution.
-# - Neither the name of Intel Corporation nor the names of its contributors 
-#   may be used to endorse or promote products derived from this software 
-#   without specific prior written permission.
-#
-# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-# POSSIBILITY OF SUCH DAMAGE.
-#
-
-LOCAL_PATH:= $(call my-dir)
-
-include $(CLEAR_VARS)
-
-LOCAL_CPP_EXTENSION := .cpp .cxx
-LOCAL_MODULE        := libtextureloader
-LOCAL_CFLAGS        := -Werror -DKTX_OPENGL_ES3=1 -DSUPPORT_SOFTWARE_ETC_UNPACK=0
-LOCAL_C_INCLUDES    := $(LOCAL_PATH)/stb $(LOCAL_PATH)/libktx
-LOCAL_SRC_FILES     := jni_main.c                  \
-				       file.c                      \
-				       texture.c                   \
-				       stb/stb_image.c             \
-				       libktx/checkheader.c        \
-				       libktx/hashtable.c          \
-				       libktx/loader.c             \
-				       libktx/swap.c               \
-				       libktx/writer.c
-LOCAL_LDLIBS        := -llog -landroid -lGLESv3
-
-include $(BUILD_SHARED_LIBRARY)
+# Copyright (c) <2012>, Intel Corporation
+#
+# Redistribution and use in source and binary forms, with or without 
+# modification, are permitted provided that the following conditions are met:
+#
+# - Redistributions of source code must retain the above copyright notice, 
+#   this list of conditions and the following disclaimer.
+# - Redistributions in binary form must reproduce the above copyright notice, 
+#   this list of conditions and the following disclaimer in the documentation 
+#   and/or other materials provided with the distribution.
+# - Neither the name of Intel Corporation nor the names of its contributors 
+#   may be used to endorse or promote products derived from this software 
+#   without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+# POSSIBILITY OF SUCH DAMAGE.
+#
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_CPP_EXTENSION := .cpp .cxx
+LOCAL_MODULE        := libtextureloader
+LOCAL_CFLAGS        := -Werror -DKTX_OPENGL_ES3=1 -DSUPPORT_SOFTWARE_ETC_UNPACK=0 -DSTBI_SIMD
+LOCAL_C_INCLUDES    := $(LOCAL_PATH)/stb $(LOCAL_PATH)/libktx
+LOCAL_SRC_FILES     := jni_main.c                  \
+				       block_codec.c               \
+				       cpu.c                       \
+				       dispatch.c                  \
+				       file.c                      \
+				       gl_caps.c                   \
+				       gl_state.c                  \
+				       hdr.c                       \
+				       jobs.c                      \
+				       jpeg_simd.c                 \
+				       loader_thread.c             \
+				       mipmap.c                    \
+				       pixel_convert.c             \
+				       pixel_transform.c           \
+				       staging.c                   \
+				       texture.c                   \
+				       texture_cache.c             \
+				       texture_memory.c            \
+				       texture_residency.c         \
+				       upload.c                    \
+				       upload_scheduler.c          \
+				       stb/stb_image.c             \
+				       libktx/checkheader.c        \
+				       libktx/hashtable.c          \
+				       libktx/loader.c             \
+				       libktx/swap.c               \
+				       libktx/writer.c
+LOCAL_LDLIBS        := -llog -landroid -lEGL -lGLESv3
+LOCAL_STATIC_LIBRARIES := cpufeatures
+
+# NEON kernels are built for armeabi-v7a only and selected at runtime
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+    LOCAL_CFLAGS    += -DHAVE_NEON=1
+    LOCAL_SRC_FILES += convert_neon.c.neon hdr_neon.c.neon jpeg_neon.c.neon mipmap_neon.c.neon pixel_neon.c.neon
+endif
+
+include $(BUILD_SHARED_LIBRARY)
+
+$(call import-module,android/cpufeatures)
@@ -0,0 +1,1046 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "block_codec.h"
+#include "jobs.h"
+#include "mipmap.h"
+#include "staging.h"
+
+// ETC intensity modifiers, by table codeword and then by pixel index (+a, +b, -a, -b)
+static const int gEtcModifiers[8][4] =
+{
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 },
+};
+
+// ETC2 T and H mode distances
+static const int gEtcDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+// EAC alpha modifiers, by table index and then by pixel index
+static const int gEacModifiers[16][8] =
+{
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+// One level being decoded from or encoded to blocks, a row of blocks per ParallelFor index
+typedef struct
+{
+    int mBlockFormat;
+    unsigned char* pBlocks;
+    unsigned char* pPixels;     // RGBA, 'mWidth * 4' bytes per row
+    int mWidth;
+    int mHeight;
+} BlockJob;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Bit helpers
+static inline int Clamp255( int value )
+{
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+// Returns 'count' bits of a 64-bit ETC block, the highest of them being bit 'msb'
+static inline int EtcBits( unsigned long long bits, int msb, int count )
+{
+    return (int)( bits >> ( msb - count + 1 ) ) & ( ( 1 << count ) - 1 );
+}
+
+static inline unsigned long long ReadBigEndian64( const unsigned char* p )
+{
+    unsigned long long value = 0;
+    int i;
+    for( i = 0; i < 8; ++i )
+    {
+        value = ( value << 8 ) | p[i];
+    }
+    return value;
+}
+
+static inline void WriteBigEndian64( unsigned char* p, unsigned long long value )
+{
+    int i;
+    for( i = 7; i >= 0; --i, value >>= 8 )
+    {
+        p[i] = (unsigned char)value;
+    }
+}
+
+static inline unsigned long long ReadLittleEndian( const unsigned char* p, int bytes )
+{
+    unsigned long long value = 0;
+    int i;
+    for( i = bytes - 1; i >= 0; --i )
+    {
+        value = ( value << 8 ) | p[i];
+    }
+    return value;
+}
+
+static inline void WriteLittleEndian( unsigned char* p, unsigned long long value, int bytes )
+{
+    int i;
+    for( i = 0; i < bytes; ++i, value >>= 8 )
+    {
+        p[i] = (unsigned char)value;
+    }
+}
+
+static inline int Expand4( int value ) { return ( value << 4 ) | value; }
+static inline int Expand5( int value ) { return ( value << 3 ) | ( value >> 2 ); }
+static inline int Expand6( int value ) { return ( value << 2 ) | ( value >> 4 ); }
+static inline int Expand7( int value ) { return ( value << 1 ) | ( value >> 6 ); }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetBlockBytes / GetBlockLevelSize
+int GetBlockBytes( int blockFormat )
+{
+    switch( blockFormat )
+    {
+        case BLOCK_FORMAT_DXT1:
+        case BLOCK_FORMAT_ETC1:
+        case BLOCK_FORMAT_ETC2_RGB:
+        {
+            return 8;
+        }
+        case BLOCK_FORMAT_DXT3:
+        case BLOCK_FORMAT_DXT5:
+        case BLOCK_FORMAT_ETC2_RGBA:
+        {
+            return 16;
+        }
+        default:
+        {
+            return 0;
+        }
+    }
+}
+
+unsigned int GetBlockLevelSize( int blockFormat, int width, int height )
+{
+    return (unsigned int)( ( ( width + 3 ) >> 2 ) * ( ( height + 3 ) >> 2 ) * GetBlockBytes( blockFormat ) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes the RGB of an ETC1/ETC2 color block
+//
+// ETC2 hides its T, H and planar modes in differential blocks whose red, green or blue second
+// color would overflow, which ETC1 never writes. Pixel indices are stored column by column.
+static void DecodeEtcColor( const unsigned char* pBlock, unsigned char* pPixels )
+{
+    unsigned long long bits = ReadBigEndian64( pBlock );
+    unsigned int high = (unsigned int)( bits >> 32 );
+    unsigned int low = (unsigned int)bits;
+    int base[2][3];
+    int paint[4][3];
+    int x, y, c;
+
+    if( high & 2 )
+    {
+        int overflow = -1;
+        for( c = 0; c < 3 && overflow < 0; ++c )
+        {
+            int color = ( high >> ( 27 - 8 * c ) ) & 31;
+            int delta = ( high >> ( 24 - 8 * c ) ) & 7;
+            int second = color + ( delta >= 4 ? delta - 8 : delta );
+            if( second < 0 || second > 31 )
+            {
+                overflow = c;
+            }
+            base[0][c] = Expand5( color );
+            base[1][c] = Expand5( second & 31 );
+        }
+
+        if( overflow == 0 || overflow == 1 )
+        {
+            // T mode (red overflow) or H mode (green overflow): four paint colors from two base colors
+            int c0[3], c1[3], distance;
+            if( overflow == 0 )
+            {
+                c0[0] = ( EtcBits( bits, 60, 2 ) << 2 ) | EtcBits( bits, 57, 2 );
+                c0[1] = EtcBits( bits, 55, 4 );
+                c0[2] = EtcBits( bits, 51, 4 );
+                c1[0] = EtcBits( bits, 47, 4 );
+                c1[1] = EtcBits( bits, 43, 4 );
+                c1[2] = EtcBits( bits, 39, 4 );
+                distance = gEtcDistances[( EtcBits( bits, 35, 2 ) << 1 ) | EtcBits( bits, 32, 1 )];
+            }
+            else
+            {
+                c0[0] = EtcBits( bits, 62, 4 );
+                c0[1] = ( EtcBits( bits, 58, 3 ) << 1 ) | EtcBits( bits, 52, 1 );
+                c0[2] = ( EtcBits( bits, 51, 1 ) << 3 ) | EtcBits( bits, 49, 3 );
+                c1[0] = EtcBits( bits, 46, 4 );
+                c1[1] = EtcBits( bits, 42, 4 );
+                c1[2] = EtcBits( bits, 38, 4 );
+                distance = gEtcDistances[( EtcBits( bits, 34, 1 ) << 2 ) | ( EtcBits( bits, 32, 1 ) << 1 ) |
+                                         ( ( ( c0[0] << 8 ) | ( c0[1] << 4 ) | c0[2] ) >= ( ( c1[0] << 8 ) | ( c1[1] << 4 ) | c1[2] ) )];
+            }
+            for( c = 0; c < 3; ++c )
+            {
+                int color0 = Expand4( c0[c] );
+                int color1 = Expand4( c1[c] );
+                if( overflow == 0 )
+                {
+                    paint[0][c] = color0;
+                    paint[1][c] = Clamp255( color1 + distance );
+                    paint[2][c] = color1;
+                    paint[3][c] = Clamp255( color1 - distance );
+                }
+                else
+                {
+                    paint[0][c] = Clamp255( color0 + distance );
+                    paint[1][c] = Clamp255( color0 - distance );
+                    paint[2][c] = Clamp255( color1 + distance );
+                    paint[3][c] = Clamp255( color1 - distance );
+                }
+            }
+            for( x = 0; x < 4; ++x )
+            {
+                for( y = 0; y < 4; ++y )
+                {
+                    int i = x * 4 + y;
+                    int index = ( ( ( low >> ( 16 + i ) ) & 1 ) << 1 ) | ( ( low >> i ) & 1 );
+                    for( c = 0; c < 3; ++c )
+                    {
+                        pPixels[( y * 4 + x ) * 4 + c] = (unsigned char)paint[index][c];
+                    }
+                }
+            }
+            return;
+        }
+
+        if( overflow == 2 )
+        {
+            // Planar mode (blue overflow): a gradient through the origin, horizontal and vertical colors
+            int origin[3], horizontal[3], vertical[3];
+            origin[0] = Expand6( EtcBits( bits, 62, 6 ) );
+            origin[1] = Expand7( ( EtcBits( bits, 56, 1 ) << 6 ) | EtcBits( bits, 54, 6 ) );
+            origin[2] = Expand6( ( EtcBits( bits, 48, 1 ) << 5 ) | ( EtcBits( bits, 44, 2 ) << 3 ) | EtcBits( bits, 41, 3 ) );
+            horizontal[0] = Expand6( ( EtcBits( bits, 38, 5 ) << 1 ) | EtcBits( bits, 32, 1 ) );
+            horizontal[1] = Expand7( EtcBits( bits, 31, 7 ) );
+            horizontal[2] = Expand6( EtcBits( bits, 24, 6 ) );
+            vertical[0] = Expand6( EtcBits( bits, 18, 6 ) );
+            vertical[1] = Expand7( EtcBits( bits, 12, 7 ) );
+            vertical[2] = Expand6( EtcBits( bits, 5, 6 ) );
+            for( y = 0; y < 4; ++y )
+            {
+                for( x = 0; x < 4; ++x )
+                {
+                    for( c = 0; c < 3; ++c )
+                    {
+                        int value = ( x * ( horizontal[c] - origin[c] ) + y * ( vertical[c] - origin[c] ) + 4 * origin[c] + 2 ) >> 2;
+                        pPixels[( y * 4 + x ) * 4 + c] = (unsigned char)Clamp255( value );
+                    }
+                }
+            }
+            return;
+        }
+    }
+    else
+    {
+        for( c = 0; c < 3; ++c )
+        {
+            base[0][c] = Expand4( ( high >> ( 28 - 8 * c ) ) & 15 );
+            base[1][c] = Expand4( ( high >> ( 24 - 8 * c ) ) & 15 );
+        }
+    }
+
+    // Individual and differential modes: two sub-blocks, each a base color and a modifier table
+    for( x = 0; x < 4; ++x )
+    {
+        for( y = 0; y < 4; ++y )
+        {
+            int i = x * 4 + y;
+            int index = ( ( ( low >> ( 16 + i ) ) & 1 ) << 1 ) | ( ( low >> i ) & 1 );
+            int subBlock = ( high & 1 ) ? y >= 2 : x >= 2;
+            int modifier = gEtcModifiers[( high >> ( subBlock ? 2 : 5 ) ) & 7][index];
+            for( c = 0; c < 3; ++c )
+            {
+                pPixels[( y * 4 + x ) * 4 + c] = (unsigned char)Clamp255( base[subBlock][c] + modifier );
+            }
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes the alpha of an EAC block
+static void DecodeEacAlpha( const unsigned char* pBlock, unsigned char* pPixels )
+{
+    unsigned long long bits = ReadBigEndian64( pBlock );
+    int base = pBlock[0];
+    int multiplier = pBlock[1] >> 4;
+    const int* pModifiers = gEacModifiers[pBlock[1] & 15];
+    int x, y;
+
+    for( x = 0; x < 4; ++x )
+    {
+        for( y = 0; y < 4; ++y )
+        {
+            int index = (int)( bits >> ( 45 - 3 * ( x * 4 + y ) ) ) & 7;
+            pPixels[( y * 4 + x ) * 4 + 3] = (unsigned char)Clamp255( base + pModifiers[index] * multiplier );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the palette of an S3TC color block. Colors 2 and 3 are interpolated, unless the block
+// allows 1-bit alpha and its endpoints are in the 3 color order.
+static void GetDxtPalette( int color0, int color1, int punchThrough, int palette[4][4] )
+{
+    int c;
+
+    palette[0][0] = Expand5( color0 >> 11 );
+    palette[0][1] = Expand6( ( color0 >> 5 ) & 63 );
+    palette[0][2] = Expand5( color0 & 31 );
+    palette[1][0] = Expand5( color1 >> 11 );
+    palette[1][1] = Expand6( ( color1 >> 5 ) & 63 );
+    palette[1][2] = Expand5( color1 & 31 );
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    for( c = 0; c < 3; ++c )
+    {
+        if( color0 > color1 || !punchThrough )
+        {
+            palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+            palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+        }
+        else
+        {
+            palette[2][c] = ( palette[0][c] + palette[1][c] ) / 2;
+            palette[3][c] = 0;
+            palette[3][3] = 0;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes an S3TC color block, pixel indices are stored row by row
+static void DecodeDxtColor( const unsigned char* pBlock, unsigned char* pPixels, int punchThrough )
+{
+    unsigned int indices = (unsigned int)ReadLittleEndian( pBlock + 4, 4 );
+    int palette[4][4];
+    int i, c;
+
+    GetDxtPalette( (int)ReadLittleEndian( pBlock, 2 ), (int)ReadLittleEndian( pBlock + 2, 2 ), punchThrough, palette );
+    for( i = 0; i < 16; ++i )
+    {
+        const int* pColor = palette[( indices >> ( 2 * i ) ) & 3];
+        for( c = 0; c < ( punchThrough ? 4 : 3 ); ++c )
+        {
+            pPixels[i * 4 + c] = (unsigned char)pColor[c];
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the palette of a DXT5 alpha block
+static void GetDxt5AlphaPalette( int alpha0, int alpha1, int palette[8] )
+{
+    int i;
+
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+    if( alpha0 > alpha1 )
+    {
+        for( i = 2; i < 8; ++i )
+        {
+            palette[i] = ( ( 8 - i ) * alpha0 + ( i - 1 ) * alpha1 ) / 7;
+        }
+    }
+    else
+    {
+        for( i = 2; i < 6; ++i )
+        {
+            palette[i] = ( ( 6 - i ) * alpha0 + ( i - 1 ) * alpha1 ) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DecodeBlock
+void DecodeBlock( int blockFormat, const unsigned char* pBlock, unsigned char* pPixels )
+{
+    int i;
+
+    memset( pPixels, 255, 64 );
+
+    switch( blockFormat )
+    {
+        case BLOCK_FORMAT_DXT1:
+        {
+            DecodeDxtColor( pBlock, pPixels, 1 );
+            break;
+        }
+        case BLOCK_FORMAT_DXT3:
+        {
+            for( i = 0; i < 16; ++i )
+            {
+                pPixels[i * 4 + 3] = (unsigned char)( ( ( pBlock[i >> 1] >> ( 4 * ( i & 1 ) ) ) & 15 ) * 17 );
+            }
+            DecodeDxtColor( pBlock + 8, pPixels, 0 );
+            break;
+        }
+        case BLOCK_FORMAT_DXT5:
+        {
+            unsigned long long indices = ReadLittleEndian( pBlock + 2, 6 );
+            int palette[8];
+            GetDxt5AlphaPalette( pBlock[0], pBlock[1], palette );
+            for( i = 0; i < 16; ++i )
+            {
+                pPixels[i * 4 + 3] = (unsigned char)palette[( indices >> ( 3 * i ) ) & 7];
+            }
+            DecodeDxtColor( pBlock + 8, pPixels, 0 );
+            break;
+        }
+        case BLOCK_FORMAT_ETC1:
+        case BLOCK_FORMAT_ETC2_RGB:
+        {
+            DecodeEtcColor( pBlock, pPixels );
+            break;
+        }
+        case BLOCK_FORMAT_ETC2_RGBA:
+        {
+            DecodeEacAlpha( pBlock, pPixels );
+            DecodeEtcColor( pBlock + 8, pPixels );
+            break;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the squared RGB distance between two colors
+static inline int ColorError( const unsigned char* pPixel, const int* pColor )
+{
+    int r = pPixel[0] - pColor[0];
+    int g = pPixel[1] - pColor[1];
+    int b = pPixel[2] - pColor[2];
+    return r * r + g * g + b * b;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Picks the endpoints of an S3TC color block from the pixels in 'mask'
+//
+// The pixels are projected on their principal axis (from a few power iterations on the
+// covariance) and the two extremes, pulled in by 1/16 of the range, become the endpoints.
+static void FindDxtEndpoints( const unsigned char* pPixels, unsigned int mask, int* pColor0, int* pColor1 )
+{
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    float low = 1e9f, high = -1e9f;
+    int lowest = 0, highest = 0, count = 0;
+    int ends[2][3];
+    int i, c, iteration;
+
+    for( i = 0; i < 16; ++i )
+    {
+        if( mask & ( 1 << i ) )
+        {
+            for( c = 0; c < 3; ++c )
+            {
+                mean[c] += pPixels[i * 4 + c];
+            }
+            ++count;
+        }
+    }
+    for( c = 0; c < 3; ++c )
+    {
+        mean[c] /= count;
+    }
+    for( i = 0; i < 16; ++i )
+    {
+        if( mask & ( 1 << i ) )
+        {
+            float r = pPixels[i * 4] - mean[0];
+            float g = pPixels[i * 4 + 1] - mean[1];
+            float b = pPixels[i * 4 + 2] - mean[2];
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+    }
+    for( iteration = 0; iteration < 4; ++iteration )
+    {
+        float r = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+        float g = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+        float b = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+        float largest = r > g ? r : g;
+        largest = b > largest ? b : largest;
+        largest = -r > largest ? -r : largest;
+        largest = -g > largest ? -g : largest;
+        largest = -b > largest ? -b : largest;
+        if( largest < 1e-4f )
+        {
+            break;
+        }
+        axis[0] = r / largest;
+        axis[1] = g / largest;
+        axis[2] = b / largest;
+    }
+
+    for( i = 0; i < 16; ++i )
+    {
+        if( mask & ( 1 << i ) )
+        {
+            float projection = pPixels[i * 4] * axis[0] + pPixels[i * 4 + 1] * axis[1] + pPixels[i * 4 + 2] * axis[2];
+            if( projection < low )
+            {
+                low = projection;
+                lowest = i;
+            }
+            if( projection > high )
+            {
+                high = projection;
+                highest = i;
+            }
+        }
+    }
+
+    for( c = 0; c < 3; ++c )
+    {
+        int inset = ( pPixels[highest * 4 + c] - pPixels[lowest * 4 + c] ) / 16;
+        ends[0][c] = pPixels[highest * 4 + c] - inset;
+        ends[1][c] = pPixels[lowest * 4 + c] + inset;
+    }
+    for( i = 0; i < 2; ++i )
+    {
+        int color = ( ( ends[i][0] * 31 + 127 ) / 255 ) << 11 | ( ( ends[i][1] * 63 + 127 ) / 255 ) << 5 | ( ends[i][2] * 31 + 127 ) / 255;
+        *( i ? pColor1 : pColor0 ) = color;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Encodes an S3TC color block; with punchThrough, pixels with alpha below 128 become transparent
+static void EncodeDxtColor( const unsigned char* pPixels, unsigned char* pBlock, int punchThrough )
+{
+    unsigned int opaque = 0;
+    unsigned int indices = 0;
+    int color0, color1;
+    int palette[4][4];
+    int i, index;
+
+    for( i = 0; i < 16; ++i )
+    {
+        if( !punchThrough || pPixels[i * 4 + 3] >= 128 )
+        {
+            opaque |= 1 << i;
+        }
+    }
+    if( opaque == 0 )
+    {
+        WriteLittleEndian( pBlock, 0, 4 );
+        WriteLittleEndian( pBlock + 4, 0xFFFFFFFF, 4 );
+        return;
+    }
+
+    FindDxtEndpoints( pPixels, opaque, &color0, &color1 );
+
+    // 4 colors need color0 > color1, 3 colors plus transparent need the opposite
+    if( ( opaque != 0xFFFF ) == ( color0 > color1 ) )
+    {
+        int swap = color0;
+        color0 = color1;
+        color1 = swap;
+    }
+    GetDxtPalette( color0, color1, punchThrough, palette );
+
+    for( i = 0; i < 16; ++i )
+    {
+        if( !( opaque & ( 1 << i ) ) )
+        {
+            index = 3;
+        }
+        else
+        {
+            int colors = ( color0 > color1 || !punchThrough ) ? 4 : 3;
+            int best = 0x7FFFFFFF, candidate;
+            for( candidate = index = 0; candidate < colors; ++candidate )
+            {
+                int error = ColorError( pPixels + i * 4, palette[candidate] );
+                if( error < best )
+                {
+                    best = error;
+                    index = candidate;
+                }
+            }
+        }
+        indices |= (unsigned int)index << ( 2 * i );
+    }
+
+    WriteLittleEndian( pBlock, color0, 2 );
+    WriteLittleEndian( pBlock + 2, color1, 2 );
+    WriteLittleEndian( pBlock + 4, indices, 4 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Encodes a DXT5 alpha block between the lowest and highest alpha
+static void EncodeDxt5Alpha( const unsigned char* pPixels, unsigned char* pBlock )
+{
+    unsigned long long indices = 0;
+    int low = 255, high = 0;
+    int palette[8];
+    int i, candidate;
+
+    for( i = 0; i < 16; ++i )
+    {
+        int alpha = pPixels[i * 4 + 3];
+        low = alpha < low ? alpha : low;
+        high = alpha > high ? alpha : high;
+    }
+
+    GetDxt5AlphaPalette( high, low, palette );
+    for( i = 0; i < 16 && high > low; ++i )
+    {
+        int best = 256, index = 0;
+        for( candidate = 0; candidate < 8; ++candidate )
+        {
+            int error = abs( pPixels[i * 4 + 3] - palette[candidate] );
+            if( error < best )
+            {
+                best = error;
+                index = candidate;
+            }
+        }
+        indices |= (unsigned long long)index << ( 3 * i );
+    }
+
+    pBlock[0] = (unsigned char)high;
+    pBlock[1] = (unsigned char)low;
+    WriteLittleEndian( pBlock + 2, indices, 6 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Picks the best ETC modifier table for one sub-block around 'base'. Returns the error and fills
+// the table and each pixel's modifier index.
+static int FitEtcSubBlock( const unsigned char* pPixels, const int* pPixelIndices, const int* pBase, int* pTable, int* pModifiers )
+{
+    int bestError = 0x7FFFFFFF;
+    int table, i, m;
+
+    for( table = 0; table < 8; ++table )
+    {
+        int colors[4][3];
+        int modifiers[8];
+        int error = 0;
+        for( m = 0; m < 4; ++m )
+        {
+            colors[m][0] = Clamp255( pBase[0] + gEtcModifiers[table][m] );
+            colors[m][1] = Clamp255( pBase[1] + gEtcModifiers[table][m] );
+            colors[m][2] = Clamp255( pBase[2] + gEtcModifiers[table][m] );
+        }
+        for( i = 0; i < 8 && error < bestError; ++i )
+        {
+            const unsigned char* pPixel = pPixels + pPixelIndices[i] * 4;
+            int best = 0x7FFFFFFF;
+            for( m = 0; m < 4; ++m )
+            {
+                int pixelError = ColorError( pPixel, colors[m] );
+                if( pixelError < best )
+                {
+                    best = pixelError;
+                    modifiers[i] = m;
+                }
+            }
+            error += best;
+        }
+        if( error < bestError )
+        {
+            bestError = error;
+            *pTable = table;
+            memcpy( pModifiers, modifiers, sizeof(modifiers) );
+        }
+    }
+    return bestError;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Encodes an ETC1 block
+//
+// Both sub-block orientations are tried, keeping the one with the lowest error. Each sub-block
+// is centered on its average color, with the modifier table that fits its pixels best.
+static void EncodeEtc1Block( const unsigned char* pPixels, unsigned char* pBlock )
+{
+    unsigned long long bestBits = 0;
+    int bestError = 0x7FFFFFFF;
+    int flip, differential, s, c, i, x, y;
+
+    for( flip = 0; flip < 2; ++flip )
+    {
+        int pixelIndices[2][8];
+        int average[2][3];
+        int counts[2] = { 0, 0 };
+        int quantized[2][3], base[2][3], tables[2], modifiers[2][8];
+        unsigned long long bits;
+        int error;
+
+        for( y = 0; y < 4; ++y )
+        {
+            for( x = 0; x < 4; ++x )
+            {
+                s = flip ? y >= 2 : x >= 2;
+                pixelIndices[s][counts[s]++] = y * 4 + x;
+            }
+        }
+        for( s = 0; s < 2; ++s )
+        {
+            for( c = 0; c < 3; ++c )
+            {
+                int sum = 4;
+                for( i = 0; i < 8; ++i )
+                {
+                    sum += pPixels[pixelIndices[s][i] * 4 + c];
+                }
+                average[s][c] = sum / 8;
+            }
+        }
+
+        // Differential mode has the finer 5-bit colors, individual mode is the fallback for
+        // sub-blocks too far apart for its 3-bit deltas
+        differential = 1;
+        for( c = 0; c < 3; ++c )
+        {
+            int delta = ( average[1][c] * 31 + 127 ) / 255 - ( average[0][c] * 31 + 127 ) / 255;
+            differential &= delta >= -4 && delta <= 3;
+        }
+        for( s = 0; s < 2; ++s )
+        {
+            for( c = 0; c < 3; ++c )
+            {
+                quantized[s][c] = differential ? ( average[s][c] * 31 + 127 ) / 255 : ( average[s][c] * 15 + 127 ) / 255;
+                base[s][c] = differential ? Expand5( quantized[s][c] ) : Expand4( quantized[s][c] );
+            }
+        }
+
+        for( s = 0, error = 0; s < 2; ++s )
+        {
+            error += FitEtcSubBlock( pPixels, pixelIndices[s], base[s], &tables[s], modifiers[s] );
+        }
+        if( error >= bestError )
+        {
+            continue;
+        }
+
+        bits = ( (unsigned long long)tables[0] << 37 ) | ( (unsigned long long)tables[1] << 34 ) |
+               ( (unsigned long long)differential << 33 ) | ( (unsigned long long)flip << 32 );
+        for( c = 0; c < 3; ++c )
+        {
+            if( differential )
+            {
+                bits |= (unsigned long long)quantized[0][c] << ( 59 - 8 * c );
+                bits |= (unsigned long long)( ( quantized[1][c] - quantized[0][c] ) & 7 ) << ( 56 - 8 * c );
+            }
+            else
+            {
+                bits |= (unsigned long long)quantized[0][c] << ( 60 - 8 * c );
+                bits |= (unsigned long long)quantized[1][c] << ( 56 - 8 * c );
+            }
+        }
+        for( s = 0; s < 2; ++s )
+        {
+            for( i = 0; i < 8; ++i )
+            {
+                int pixel = pixelIndices[s][i];
+                int column = ( pixel & 3 ) * 4 + ( pixel >> 2 );
+                bits |= (unsigned long long)( modifiers[s][i] >> 1 ) << ( 16 + column );
+                bits |= (unsigned long long)( modifiers[s][i] & 1 ) << column;
+            }
+        }
+        bestError = error;
+        bestBits = bits;
+    }
+
+    WriteBigEndian64( pBlock, bestBits );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Encodes an EAC alpha block, trying every modifier table with the multiplier that spans the
+// block's alpha range
+static void EncodeEacAlpha( const unsigned char* pPixels, unsigned char* pBlock )
+{
+    unsigned long long bestBits = 0;
+    int bestError = 0x7FFFFFFF;
+    int low = 255, high = 0;
+    int table, i, m;
+
+    for( i = 0; i < 16; ++i )
+    {
+        int alpha = pPixels[i * 4 + 3];
+        low = alpha < low ? alpha : low;
+        high = alpha > high ? alpha : high;
+    }
+
+    for( table = 0; table < 16 && bestError > 0; ++table )
+    {
+        const int* pModifiers = gEacModifiers[table];
+        int span = pModifiers[7] - pModifiers[3];
+        int multiplier = ( high - low + span / 2 ) / span;
+        int base, error = 0;
+        unsigned long long bits;
+
+        multiplier = multiplier < 1 ? 1 : multiplier > 15 ? 15 : multiplier;
+        base = Clamp255( ( low + high - ( pModifiers[3] + pModifiers[7] ) * multiplier + 1 ) / 2 );
+        bits = ( (unsigned long long)base << 56 ) | ( (unsigned long long)multiplier << 52 ) | ( (unsigned long long)table << 48 );
+
+        for( i = 0; i < 16; ++i )
+        {
+            int alpha = pPixels[( ( i & 3 ) * 4 + ( i >> 2 ) ) * 4 + 3];
+            int best = 0x7FFFFFFF, index = 0;
+            for( m = 0; m < 8; ++m )
+            {
+                int pixelError = abs( Clamp255( base + pModifiers[m] * multiplier ) - alpha );
+                if( pixelError < best )
+                {
+                    best = pixelError;
+                    index = m;
+                }
+            }
+            error += best * best;
+            bits |= (unsigned long long)index << ( 45 - 3 * i );
+        }
+        if( error < bestError )
+        {
+            bestError = error;
+            bestBits = bits;
+        }
+    }
+
+    WriteBigEndian64( pBlock, bestBits );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EncodeBlock
+void EncodeBlock( int blockFormat, const unsigned char* pPixels, unsigned char* pBlock )
+{
+    int i;
+
+    switch( blockFormat )
+    {
+        case BLOCK_FORMAT_DXT1:
+        {
+            EncodeDxtColor( pPixels, pBlock, 1 );
+            break;
+        }
+        case BLOCK_FORMAT_DXT3:
+        {
+            memset( pBlock, 0, 8 );
+            for( i = 0; i < 16; ++i )
+            {
+                pBlock[i >> 1] |= (unsigned char)( ( ( pPixels[i * 4 + 3] + 8 ) / 17 ) << ( 4 * ( i & 1 ) ) );
+            }
+            EncodeDxtColor( pPixels, pBlock + 8, 0 );
+            break;
+        }
+        case BLOCK_FORMAT_DXT5:
+        {
+            EncodeDxt5Alpha( pPixels, pBlock );
+            EncodeDxtColor( pPixels, pBlock + 8, 0 );
+            break;
+        }
+        case BLOCK_FORMAT_ETC1:
+        case BLOCK_FORMAT_ETC2_RGB:
+        {
+            EncodeEtc1Block( pPixels, pBlock );
+            break;
+        }
+        case BLOCK_FORMAT_ETC2_RGBA:
+        {
+            EncodeEacAlpha( pPixels, pBlock );
+            EncodeEtc1Block( pPixels, pBlock + 8 );
+            break;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ParallelFor tasks converting one row of blocks. Partial blocks at the right and bottom edges
+// decode only the pixels inside the level and encode with the edge pixels repeated.
+static void DecodeBlockRow( void* pUser, int row )
+{
+    BlockJob* pJob = (BlockJob*)pUser;
+    int blocksWide = ( pJob->mWidth + 3 ) >> 2;
+    int bytes = GetBlockBytes( pJob->mBlockFormat );
+    unsigned char pixels[64];
+    int block, x, y;
+
+    for( block = 0; block < blocksWide; ++block )
+    {
+        DecodeBlock( pJob->mBlockFormat, pJob->pBlocks + ( row * blocksWide + block ) * bytes, pixels );
+        for( y = 0; y < 4 && row * 4 + y < pJob->mHeight; ++y )
+        {
+            for( x = 0; x < 4 && block * 4 + x < pJob->mWidth; ++x )
+            {
+                memcpy( pJob->pPixels + ( ( row * 4 + y ) * pJob->mWidth + block * 4 + x ) * 4, pixels + ( y * 4 + x ) * 4, 4 );
+            }
+        }
+    }
+}
+
+static void EncodeBlockRow( void* pUser, int row )
+{
+    BlockJob* pJob = (BlockJob*)pUser;
+    int blocksWide = ( pJob->mWidth + 3 ) >> 2;
+    int bytes = GetBlockBytes( pJob->mBlockFormat );
+    unsigned char pixels[64];
+    int block, x, y;
+
+    for( block = 0; block < blocksWide; ++block )
+    {
+        for( y = 0; y < 4; ++y )
+        {
+            int sourceY = row * 4 + y < pJob->mHeight ? row * 4 + y : pJob->mHeight - 1;
+            for( x = 0; x < 4; ++x )
+            {
+                int sourceX = block * 4 + x < pJob->mWidth ? block * 4 + x : pJob->mWidth - 1;
+                memcpy( pixels + ( y * 4 + x ) * 4, pJob->pPixels + ( sourceY * pJob->mWidth + sourceX ) * 4, 4 );
+            }
+        }
+        EncodeBlock( pJob->mBlockFormat, pixels, pJob->pBlocks + ( row * blocksWide + block ) * bytes );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BuildBlockMipChain - decode, filter and re-encode
+unsigned char* BuildBlockMipChain( int blockFormat, const unsigned char* pLevel0, int width, int height, int filter,
+                                   unsigned int flags, int alphaReference, int* pLevelCount )
+{
+    MipLevel levels[MAX_MIP_LEVELS];
+    unsigned char* pPixels;
+    unsigned char* pBlocks;
+    unsigned char* pNext;
+    unsigned int pixelBytes = 0, blockBytes = 0;
+    int levelCount = GetMipLevelCount( width, height );
+    int level;
+    BlockJob job;
+
+    if( GetBlockBytes( blockFormat ) == 0 || levelCount > MAX_MIP_LEVELS )
+    {
+        return NULL;
+    }
+
+    for( level = 0; level < levelCount; ++level )
+    {
+        levels[level].mWidth = width;
+        levels[level].mHeight = height;
+        levels[level].mStride = width * 4;
+        pixelBytes += width * height * 4;
+        if( level > 0 )
+        {
+            blockBytes += GetBlockLevelSize( blockFormat, width, height );
+        }
+        width = width > 1 ? width >> 1 : 1;
+        height = height > 1 ? height >> 1 : 1;
+    }
+
+    pPixels = (unsigned char*)AcquireStagingBuffer( pixelBytes );
+    pBlocks = (unsigned char*)AcquireStagingBuffer( blockBytes );
+    if( pPixels == NULL || pBlocks == NULL )
+    {
+        ReleaseStagingBuffer( pPixels );
+        ReleaseStagingBuffer( pBlocks );
+        return NULL;
+    }
+    for( level = 0, pNext = pPixels; level < levelCount; ++level )
+    {
+        levels[level].pPixels = pNext;
+        pNext += levels[level].mStride * levels[level].mHeight;
+    }
+
+    job.mBlockFormat = blockFormat;
+    job.pBlocks = (unsigned char*)pLevel0;
+    job.pPixels = levels[0].pPixels;
+    job.mWidth = levels[0].mWidth;
+    job.mHeight = levels[0].mHeight;
+    ParallelFor( ( job.mHeight + 3 ) >> 2, DecodeBlockRow, &job );
+
+    if( !GenerateMipChain( levels, levelCount, 4, filter, flags, alphaReference ) )
+    {
+        ReleaseStagingBuffer( pPixels );
+        ReleaseStagingBuffer( pBlocks );
+        return NULL;
+    }
+
+    for( level = 1, pNext = pBlocks; level < levelCount; ++level )
+    {
+        job.pBlocks = pNext;
+        job.pPixels = levels[level].pPixels;
+        job.mWidth = levels[level].mWidth;
+        job.mHeight = levels[level].mHeight;
+        ParallelFor( ( job.mHeight + 3 ) >> 2, EncodeBlockRow, &job );
+        pNext += GetBlockLevelSize( blockFormat, job.mWidth, job.mHeight );
+    }
+
+    ReleaseStagingBuffer( pPixels );
+    *pLevelCount = levelCount;
+    return pBlocks;
+}
@@ -0,0 +1,58 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+// Block compressed formats the CPU can decode and re-encode, for building mip chains of files
+// that only ship level 0
+#define BLOCK_FORMAT_NONE           0
+#define BLOCK_FORMAT_DXT1           1   // S3TC color with 1-bit alpha, 8 bytes per block
+#define BLOCK_FORMAT_DXT3           2   // S3TC color with explicit 4-bit alpha, 16 bytes per block
+#define BLOCK_FORMAT_DXT5           3   // S3TC color with interpolated alpha, 16 bytes per block
+#define BLOCK_FORMAT_ETC1           4   // ETC1 RGB, 8 bytes per block
+#define BLOCK_FORMAT_ETC2_RGB       5   // ETC2 RGB (adds the T, H and planar modes), 8 bytes per block
+#define BLOCK_FORMAT_ETC2_RGBA      6   // ETC2 RGB with EAC alpha, 16 bytes per block
+
+// Returns the bytes in one 4x4 block
+int GetBlockBytes( int blockFormat );
+
+// Returns the bytes of a width x height level, partial blocks included
+unsigned int GetBlockLevelSize( int blockFormat, int width, int height );
+
+// Converts between one block and its 4x4 RGBA pixels (row-major, 16 bytes per row). The encoders
+// are fast single pass ones, meant for load time rather than for offline quality. ETC2 levels are
+// encoded with ETC1 blocks, which are valid ETC2.
+void DecodeBlock( int blockFormat, const unsigned char* pBlock, unsigned char* pPixels );
+void EncodeBlock( int blockFormat, const unsigned char* pPixels, unsigned char* pBlock );
+
+// Builds levels 1 and down of a block compressed texture from its level 0: decodes it, filters
+// the chain with GenerateMipChain (see mipmap.h) and encodes every new level back to blockFormat,
+// all on the worker pool. Returns the levels one after the other in a staging buffer (see
+// staging.h) and the total level count (level 0 included), or NULL on failure.
+unsigned char* BuildBlockMipChain( int blockFormat, const unsigned char* pLevel0, int width, int height, int filter,
+                                   unsigned int flags, int alphaReference, int* pLevelCount );
@@ -0,0 +1,230 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// NEON pixel layout conversion kernels - built for armeabi-v7a only, see jpeg_neon.c
+
+#include <arm_neon.h>
+
+#include "pixel_convert.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Expanding and dropping channels - 16 pixels per iteration
+//
+// The structured loads and stores (vld2/3/4, vst2/3/4) do all the interleaving, so each kernel
+// is just a load and a store.
+void ConvertPixels1To2NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x2_t pixels;
+        pixels.val[0] = vld1q_u8( pIn + i );
+        pixels.val[1] = vdupq_n_u8( 255 );
+        vst2q_u8( pOut + i * 2, pixels );
+    }
+
+    ConvertPixelsScalar( 1, 2, pOut + i * 2, pIn + i, count - i );
+}
+
+void ConvertPixels1To3NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x3_t pixels;
+        pixels.val[0] = pixels.val[1] = pixels.val[2] = vld1q_u8( pIn + i );
+        vst3q_u8( pOut + i * 3, pixels );
+    }
+
+    ConvertPixelsScalar( 1, 3, pOut + i * 3, pIn + i, count - i );
+}
+
+void ConvertPixels1To4NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x4_t pixels;
+        pixels.val[0] = pixels.val[1] = pixels.val[2] = vld1q_u8( pIn + i );
+        pixels.val[3] = vdupq_n_u8( 255 );
+        vst4q_u8( pOut + i * 4, pixels );
+    }
+
+    ConvertPixelsScalar( 1, 4, pOut + i * 4, pIn + i, count - i );
+}
+
+void ConvertPixels2To1NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        vst1q_u8( pOut + i, vld2q_u8( pIn + i * 2 ).val[0] );
+    }
+
+    ConvertPixelsScalar( 2, 1, pOut + i, pIn + i * 2, count - i );
+}
+
+void ConvertPixels2To3NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x3_t pixels;
+        pixels.val[0] = pixels.val[1] = pixels.val[2] = vld2q_u8( pIn + i * 2 ).val[0];
+        vst3q_u8( pOut + i * 3, pixels );
+    }
+
+    ConvertPixelsScalar( 2, 3, pOut + i * 3, pIn + i * 2, count - i );
+}
+
+void ConvertPixels2To4NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x2_t grayAlpha = vld2q_u8( pIn + i * 2 );
+        uint8x16x4_t pixels;
+        pixels.val[0] = pixels.val[1] = pixels.val[2] = grayAlpha.val[0];
+        pixels.val[3] = grayAlpha.val[1];
+        vst4q_u8( pOut + i * 4, pixels );
+    }
+
+    ConvertPixelsScalar( 2, 4, pOut + i * 4, pIn + i * 2, count - i );
+}
+
+void ConvertPixels3To4NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x3_t rgb = vld3q_u8( pIn + i * 3 );
+        uint8x16x4_t pixels;
+        pixels.val[0] = rgb.val[0];
+        pixels.val[1] = rgb.val[1];
+        pixels.val[2] = rgb.val[2];
+        pixels.val[3] = vdupq_n_u8( 255 );
+        vst4q_u8( pOut + i * 4, pixels );
+    }
+
+    ConvertPixelsScalar( 3, 4, pOut + i * 4, pIn + i * 3, count - i );
+}
+
+void ConvertPixels4To3NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        uint8x16x4_t rgba = vld4q_u8( pIn + i * 4 );
+        uint8x16x3_t pixels;
+        pixels.val[0] = rgba.val[0];
+        pixels.val[1] = rgba.val[1];
+        pixels.val[2] = rgba.val[2];
+        vst3q_u8( pOut + i * 3, pixels );
+    }
+
+    ConvertPixelsScalar( 4, 3, pOut + i * 3, pIn + i * 4, count - i );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Color to gray - 8 pixels per iteration
+//
+// The weights sum to 256, so the weighted sum fits 16 bits and its high byte is the luma.
+static inline uint8x8_t LumaNEON( uint8x8_t red, uint8x8_t green, uint8x8_t blue )
+{
+    uint16x8_t sum = vmull_u8( red, vdup_n_u8( 77 ) );
+    sum = vmlal_u8( sum, green, vdup_n_u8( 150 ) );
+    sum = vmlal_u8( sum, blue, vdup_n_u8( 29 ) );
+    return vshrn_n_u16( sum, 8 );
+}
+
+void ConvertPixels3To1NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        uint8x8x3_t rgb = vld3_u8( pIn + i * 3 );
+        vst1_u8( pOut + i, LumaNEON( rgb.val[0], rgb.val[1], rgb.val[2] ) );
+    }
+
+    ConvertPixelsScalar( 3, 1, pOut + i, pIn + i * 3, count - i );
+}
+
+void ConvertPixels3To2NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        uint8x8x3_t rgb = vld3_u8( pIn + i * 3 );
+        uint8x8x2_t pixels;
+        pixels.val[0] = LumaNEON( rgb.val[0], rgb.val[1], rgb.val[2] );
+        pixels.val[1] = vdup_n_u8( 255 );
+        vst2_u8( pOut + i * 2, pixels );
+    }
+
+    ConvertPixelsScalar( 3, 2, pOut + i * 2, pIn + i * 3, count - i );
+}
+
+void ConvertPixels4To1NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        uint8x8x4_t rgba = vld4_u8( pIn + i * 4 );
+        vst1_u8( pOut + i, LumaNEON( rgba.val[0], rgba.val[1], rgba.val[2] ) );
+    }
+
+    ConvertPixelsScalar( 4, 1, pOut + i, pIn + i * 4, count - i );
+}
+
+void ConvertPixels4To2NEON( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        uint8x8x4_t rgba = vld4_u8( pIn + i * 4 );
+        uint8x8x2_t pixels;
+        pixels.val[0] = LumaNEON( rgba.val[0], rgba.val[1], rgba.val[2] );
+        pixels.val[1] = rgba.val[3];
+        vst2_u8( pOut + i * 2, pixels );
+    }
+
+    ConvertPixelsScalar( 4, 2, pOut + i * 2, pIn + i * 4, count - i );
+}
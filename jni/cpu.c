@@ -0,0 +1,109 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#elif defined(__ANDROID__)
+#include <cpu-features.h>
+#elif defined(__linux__) && defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#include "cpu.h"
+
+static pthread_once_t gCpuFeaturesOnce = PTHREAD_ONCE_INIT;
+static unsigned int gCpuFeatures = 0;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Probes the CPU
+//
+// x86 uses cpuid directly, on Android as well: cpufeatures only learned about AVX2 in later NDKs.
+// AVX2 also needs the OS to save the YMM registers on context switches, which xgetbv reports.
+// On ARM Android this uses the NDK cpufeatures library, which is the only reliable way to tell
+// armeabi-v7a devices with NEON from the ones without (e.g. Tegra 2); other ARM Linux systems
+// report NEON in the auxiliary vector.
+static void DetectCpuFeatures()
+{
+    unsigned int features = 0;
+
+#if defined(__i386__) || defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+
+    if( __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+    {
+        int osSavesYmm = 0;
+
+        if( edx & bit_SSE2 )
+        {
+            features |= CPU_FEATURE_SSE2;
+        }
+        if( ecx & bit_SSSE3 )
+        {
+            features |= CPU_FEATURE_SSSE3;
+        }
+        if( ( ecx & bit_OSXSAVE ) && ( ecx & bit_AVX ) )
+        {
+            unsigned int xcr0Low, xcr0High;
+            __asm__ __volatile__( "xgetbv" : "=a"( xcr0Low ), "=d"( xcr0High ) : "c"( 0 ) );
+            osSavesYmm = ( xcr0Low & 6 ) == 6;
+        }
+        if( osSavesYmm && __get_cpuid_max( 0, NULL ) >= 7 )
+        {
+            __cpuid_count( 7, 0, eax, ebx, ecx, edx );
+            if( ebx & bit_AVX2 )
+            {
+                features |= CPU_FEATURE_AVX2;
+            }
+        }
+    }
+#elif defined(__ANDROID__)
+    if( android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM && ( android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON ) )
+    {
+        features |= CPU_FEATURE_NEON;
+    }
+#elif defined(__linux__) && defined(__arm__)
+    if( getauxval( AT_HWCAP ) & HWCAP_NEON )
+    {
+        features |= CPU_FEATURE_NEON;
+    }
+#endif
+
+    gCpuFeatures = features;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the SIMD features available on the CPU we are running on
+unsigned int GetCpuFeatures()
+{
+    pthread_once( &gCpuFeaturesOnce, DetectCpuFeatures );
+    return gCpuFeatures;
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "hdr.h"
+#include "jpeg_simd.h"
+#include "mipmap.h"
+#include "pixel_convert.h"
+#include "pixel_transform.h"
+
+static pthread_once_t gDispatchOnce = PTHREAD_ONCE_INIT;
+static unsigned int gDispatchedFeatures = 0;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Every module with SIMD variants has a Select*Kernels( features ) that points its function
+// tables at the variants 'features' allows, falling back to the scalar code for the rest
+static void BindKernels( unsigned int features )
+{
+    SelectJpegKernels( features );
+    SelectPixelConverters( features );
+    SelectPixelKernels( features );
+    SelectMipKernels( features );
+    SelectHdrKernels( features );
+
+    gDispatchedFeatures = features;
+}
+
+static void BindDetectedKernels()
+{
+    BindKernels( GetCpuFeatures() );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// InitKernelDispatch
+void InitKernelDispatch()
+{
+    pthread_once( &gDispatchOnce, BindDetectedKernels );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ForceCpuFeatures
+unsigned int ForceCpuFeatures( unsigned int features )
+{
+    InitKernelDispatch();
+
+    features &= GetCpuFeatures();
+    BindKernels( features );
+    return features;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetDispatchedCpuFeatures
+unsigned int GetDispatchedCpuFeatures()
+{
+    InitKernelDispatch();
+    return gDispatchedFeatures;
+}
@@ -1,78 +1,120 @@
-/* Copyright (c) <2012>, Intel Corporation
-*
-* Redistribution and use in source and binary forms, with or without 
-* modification, are permitted provided that the following conditions are met:
-*
-* - Redistributions of source code must retain the above copyright notice, 
-*   this list of conditions and the following disclaimer.
-* - Redistributions in binary form must reproduce the above copyright notice, 
-*   this list of conditions and the following disclaimer in the documentation 
-*   and/or other materials provided with the distribution.
-* - Neither the name of Intel Corporation nor the names of its contributors 
-*   may be used to endorse or promote products derived from this software 
-*   without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-* POSSIBILITY OF SUCH DAMAGE.
-*
-*/
-
-#include <assert.h>
-#include <memory.h>
-#include <stdio.h>
-#include <stdlib.h>
-
-// for native asset manager
-#include <sys/types.h>
-#include <android/asset_manager.h>
-#include <android/asset_manager_jni.h>
-
-#include "file.h"
-
-AAssetManager* g_pManager = NULL;
-
-void SetAssetManager( AAssetManager* pManager )
-{
-    g_pManager = pManager;
-}
-
-// Read the contents of the give file return the content and the file size.
-// The calling function is responsible for free the memory allocated for Content.
-void ReadFile( const char* pFileName, char** ppContent, unsigned int* pSize )
-{  
-    assert( g_pManager );
-    
-    // Open files
-    AAsset* pFile = AAssetManager_open( g_pManager, pFileName, AASSET_MODE_UNKNOWN );
-
-    if( pFile != NULL )
-    {
-        // Determine file size
-        off_t fileSize = AAsset_getLength( pFile );
-        
-        // Read data
-        char* pData = (char*)malloc( fileSize );
-        AAsset_read( pFile, pData, fileSize );
-    
-        // Allocate space for the file content
-        *ppContent = (char*)malloc( fileSize );
-    
-        // Copy the content
-        memcpy( *ppContent, pData, fileSize );
-        *pSize = fileSize;
-
-        free( pData );
-        
-        // Close the file
-        AAsset_close( pFile );
-    }
-}
\ No newline at end of file
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <assert.h>
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// for native asset manager
+#include <sys/types.h>
+#include <android/asset_manager.h>
+#include <android/asset_manager_jni.h>
+
+#include "file.h"
+#include "staging.h"
+
+AAssetManager* g_pManager = NULL;
+
+void SetAssetManager( AAssetManager* pManager )
+{
+    g_pManager = pManager;
+}
+
+// Read the contents of the give file return the content and the file size.
+// The content is a staging buffer, the calling function is responsible for releasing it with
+// ReleaseStagingBuffer. It is read straight into that buffer, which is reused across loads.
+void ReadFile( const char* pFileName, char** ppContent, unsigned int* pSize )
+{  
+    assert( g_pManager );
+    
+    // Open files
+    AAsset* pFile = AAssetManager_open( g_pManager, pFileName, AASSET_MODE_UNKNOWN );
+
+    if( pFile != NULL )
+    {
+        // Determine file size
+        off_t fileSize = AAsset_getLength( pFile );
+        
+        // Read data
+        *ppContent = (char*)AcquireStagingBuffer( fileSize );
+        if( *ppContent != NULL )
+        {
+            *pSize = AAsset_read( pFile, *ppContent, fileSize ) == fileSize ? fileSize : 0;
+        }
+        
+        // Close the file
+        AAsset_close( pFile );
+    }
+}
+
+
+// Opens a file for sequential reading and returns its size
+AAsset* OpenFile( const char* pFileName, unsigned int* pSize )
+{
+    assert( g_pManager );
+
+    AAsset* pFile = AAssetManager_open( g_pManager, pFileName, AASSET_MODE_RANDOM );
+
+    if( pFile != NULL )
+    {
+        *pSize = AAsset_getLength( pFile );
+    }
+    return pFile;
+}
+
+
+// Reads the next size bytes of the file
+int ReadFilePart( AAsset* pFile, void* pDest, unsigned int size )
+{
+    return AAsset_read( pFile, pDest, size ) == (int)size;
+}
+
+
+// Moves size bytes forward in the file without reading them
+int SkipFilePart( AAsset* pFile, unsigned int size )
+{
+    off_t position = AAsset_seek( pFile, 0, SEEK_CUR );
+
+    return position >= 0 && position + (off_t)size <= AAsset_getLength( pFile ) &&
+           AAsset_seek( pFile, size, SEEK_CUR ) == position + (off_t)size;
+}
+
+
+// Moves to offset bytes from the start of the file
+int SeekFile( AAsset* pFile, unsigned int offset )
+{
+    return (off_t)offset <= AAsset_getLength( pFile ) && AAsset_seek( pFile, offset, SEEK_SET ) == (off_t)offset;
+}
+
+
+// Closes a file opened by OpenFile
+void CloseFile( AAsset* pFile )
+{
+    AAsset_close( pFile );
+}
@@ -1,40 +1,52 @@
-/* Copyright (c) <2012>, Intel Corporation
-*
-* Redistribution and use in source and binary forms, with or without 
-* modification, are permitted provided that the following conditions are met:
-*
-* - Redistributions of source code must retain the above copyright notice, 
-*   this list of conditions and the following disclaimer.
-* - Redistributions in binary form must reproduce the above copyright notice, 
-*   this list of conditions and the following disclaimer in the documentation 
-*   and/or other materials provided with the distribution.
-* - Neither the name of Intel Corporation nor the names of its contributors 
-*   may be used to endorse or promote products derived from this software 
-*   without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-* POSSIBILITY OF SUCH DAMAGE.
-*
-*/
-
-#pragma once
-
-// For native asset manager
-#include <sys/types.h>
-#include <android/asset_manager.h>
-#include <android/asset_manager_jni.h>
-
-// Set the global asset manager
-void SetAssetManager( AAssetManager* pManager );
-
-// Read the contents of the give file return the content and the file size
-void ReadFile( const char* FileName, char** Content, unsigned int* Size );
\ No newline at end of file
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+// For native asset manager
+#include <sys/types.h>
+#include <android/asset_manager.h>
+#include <android/asset_manager_jni.h>
+
+// Set the global asset manager
+void SetAssetManager( AAssetManager* pManager );
+
+// Read the contents of the give file return the content and the file size. The content is a
+// staging buffer (see staging.h), released with ReleaseStagingBuffer.
+void ReadFile( const char* FileName, char** Content, unsigned int* Size );
+
+// Sequential access to a file, for loaders that only want part of it. OpenFile returns NULL if the
+// file can't be opened. ReadFilePart and SkipFilePart return zero if fewer than size bytes were left.
+// Skipping seeks, so it only avoids the I/O for files stored uncompressed in the APK. SeekFile moves
+// to an offset from the start, returning zero past the end; moving back in a compressed file
+// inflates it again from the start.
+AAsset* OpenFile( const char* pFileName, unsigned int* pSize );
+int ReadFilePart( AAsset* pFile, void* pDest, unsigned int size );
+int SkipFilePart( AAsset* pFile, unsigned int size );
+int SeekFile( AAsset* pFile, unsigned int offset );
+void CloseFile( AAsset* pFile );
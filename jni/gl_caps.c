@@ -0,0 +1,321 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <EGL/egl.h>
+#include <android/log.h>
+
+#include "gl_caps.h"
+
+#define  LogInfo(...)  __android_log_print( ANDROID_LOG_INFO, "TextureLoader", __VA_ARGS__ )
+
+// Extensions tracked, in the order of their GL_CAPS_EXT_* bits
+static const char* const gExtensionNames[] =
+{
+    "GL_OES_compressed_ETC1_RGB8_texture",
+    "GL_IMG_texture_compression_pvrtc",
+    "GL_EXT_texture_compression_s3tc",
+    "GL_EXT_texture_compression_dxt1",
+    "GL_EXT_texture_compression_s3tc_srgb",
+    "GL_KHR_texture_compression_astc_ldr",
+    "GL_EXT_texture_storage",
+    "GL_NV_pixel_buffer_object",
+    "GL_OES_required_internalformat",
+    "GL_EXT_texture_sRGB",
+    "GL_ARB_texture_rg",
+};
+
+#define GL_CAPS_EXTENSION_COUNT         ( sizeof(gExtensionNames) / sizeof(gExtensionNames[0]) )
+
+// Runs of consecutive compressed format enums, and the bit of GlCaps::mCompressedFormats the first
+// one of each takes
+typedef struct
+{
+    GLenum       mFirst;
+    GLenum       mLast;
+    unsigned int mBit;
+} FormatRange;
+
+static const FormatRange gFormatRanges[] =
+{
+    { 0x83F0, 0x83F3,  0 },         // S3TC DXT1 RGB and RGBA, DXT3, DXT5
+    { 0x8C4C, 0x8C4F,  4 },         // S3TC sRGB
+    { 0x8C00, 0x8C03,  8 },         // PVRTC 4 and 2 bpp, RGB and RGBA
+    { 0x8D64, 0x8D64, 12 },         // ETC1
+    { 0x9270, 0x9279, 13 },         // EAC R11 and RG11, ETC2 RGB, RGB with punchthrough alpha and RGBA, all with sRGB
+    { 0x93B0, 0x93BD, 23 },         // ASTC 4x4 to 12x12
+    { 0x93D0, 0x93DD, 37 },         // ASTC sRGB 4x4 to 12x12
+};
+
+#define GL_CAPS_FORMAT_RANGE_COUNT      ( sizeof(gFormatRanges) / sizeof(gFormatRanges[0]) )
+
+// Bits of whole ranges, for the formats an extension or the version brings in
+#define GL_CAPS_FORMATS_S3TC            0x000000000000000FULL
+#define GL_CAPS_FORMATS_DXT1            0x0000000000000003ULL
+#define GL_CAPS_FORMATS_S3TC_SRGB       0x00000000000000F0ULL
+#define GL_CAPS_FORMATS_PVRTC           0x0000000000000F00ULL
+#define GL_CAPS_FORMATS_ETC1            0x0000000000001000ULL
+#define GL_CAPS_FORMATS_ETC2_EAC        0x00000000007FE000ULL
+#define GL_CAPS_FORMATS_ASTC            0x0007FFFFFF800000ULL
+
+// The capabilities of the context last current on this thread when they were asked for
+static __thread EGLContext gCapsContext = EGL_NO_CONTEXT;
+static __thread GlCaps gCaps;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the bit of a compressed format in GlCaps::mCompressedFormats, or -1 if it isn't known
+static int GetFormatBit( GLenum internalFormat )
+{
+    unsigned int range;
+
+    for( range = 0; range < GL_CAPS_FORMAT_RANGE_COUNT; ++range )
+    {
+        if( internalFormat >= gFormatRanges[range].mFirst && internalFormat <= gFormatRanges[range].mLast )
+        {
+            return (int)( gFormatRanges[range].mBit + internalFormat - gFormatRanges[range].mFirst );
+        }
+    }
+    return -1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the GL_CAPS_EXT_* bit of an extension name 'length' characters long, or 0
+static unsigned int GetExtensionBit( const char* pName, size_t length )
+{
+    unsigned int extension;
+
+    for( extension = 0; extension < GL_CAPS_EXTENSION_COUNT; ++extension )
+    {
+        if( strlen( gExtensionNames[extension] ) == length && memcmp( gExtensionNames[extension], pName, length ) == 0 )
+        {
+            return 1u << extension;
+        }
+    }
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Finds the tracked extensions among the context's, one name at a time through glGetStringi from
+// OpenGL ES 3.0 on, or in the single space separated string before it
+static unsigned int QueryExtensions( int majorVersion )
+{
+    unsigned int extensions = 0;
+
+    if( majorVersion >= 3 )
+    {
+        GLint count = 0;
+        GLint index;
+
+        glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+        for( index = 0; index < count; ++index )
+        {
+            const char* pName = (const char*)glGetStringi( GL_EXTENSIONS, index );
+
+            if( pName != NULL )
+            {
+                extensions |= GetExtensionBit( pName, strlen( pName ) );
+            }
+        }
+    }
+    else
+    {
+        const char* pNames = (const char*)glGetString( GL_EXTENSIONS );
+
+        while( pNames != NULL && *pNames != '\0' )
+        {
+            size_t length = strcspn( pNames, " " );
+
+            extensions |= GetExtensionBit( pNames, length );
+            pNames += length;
+            pNames += strspn( pNames, " " );
+        }
+    }
+    return extensions;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Marks the compressed formats the context lists as supported, and those its extensions and
+// version make part of it: drivers leave some out of GL_COMPRESSED_TEXTURE_FORMATS (e.g. the sRGB
+// ones), and others list none at all.
+static unsigned long long QueryCompressedFormats( int majorVersion, unsigned int extensions )
+{
+    unsigned long long formats = 0;
+    GLint count = 0;
+
+    glGetIntegerv( GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count );
+    if( count > 0 )
+    {
+        GLint* pFormats = (GLint*)malloc( count * sizeof(GLint) );
+
+        if( pFormats != NULL )
+        {
+            GLint index;
+
+            glGetIntegerv( GL_COMPRESSED_TEXTURE_FORMATS, pFormats );
+            for( index = 0; index < count; ++index )
+            {
+                int bit = GetFormatBit( (GLenum)pFormats[index] );
+
+                if( bit >= 0 )
+                {
+                    formats |= 1ULL << bit;
+                }
+            }
+            free( pFormats );
+        }
+    }
+
+    if( extensions & GL_CAPS_EXT_ETC1 )
+    {
+        formats |= GL_CAPS_FORMATS_ETC1;
+    }
+    if( extensions & GL_CAPS_EXT_PVRTC )
+    {
+        formats |= GL_CAPS_FORMATS_PVRTC;
+    }
+    if( extensions & GL_CAPS_EXT_S3TC )
+    {
+        formats |= GL_CAPS_FORMATS_S3TC;
+    }
+    if( extensions & GL_CAPS_EXT_DXT1 )
+    {
+        formats |= GL_CAPS_FORMATS_DXT1;
+    }
+    if( extensions & GL_CAPS_EXT_S3TC_SRGB )
+    {
+        formats |= GL_CAPS_FORMATS_S3TC_SRGB;
+    }
+    if( extensions & GL_CAPS_EXT_ASTC_LDR )
+    {
+        formats |= GL_CAPS_FORMATS_ASTC;
+    }
+    if( majorVersion >= 3 )
+    {
+        formats |= GL_CAPS_FORMATS_ETC2_EAC;
+    }
+    return formats;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Queries the capabilities of the current context
+static void QueryGlCaps( GlCaps* pCaps )
+{
+    const char* pVersion = (const char*)glGetString( GL_VERSION );
+    GLint majorVersion = 0;
+    GLint minorVersion = 0;
+
+    memset( pCaps, 0, sizeof(*pCaps) );
+    pCaps->mIsES = pVersion != NULL && strstr( pVersion, "OpenGL ES" ) != NULL;
+
+    while( glGetError() != GL_NO_ERROR )
+    {
+        // Drop errors left behind by earlier calls
+    }
+
+    // GL_MAJOR_VERSION and GL_MINOR_VERSION only came with OpenGL ES 3.0 and OpenGL 3.0
+    glGetIntegerv( GL_MAJOR_VERSION, &majorVersion );
+    glGetIntegerv( GL_MINOR_VERSION, &minorVersion );
+    if( glGetError() != GL_NO_ERROR && pVersion != NULL )
+    {
+        sscanf( pVersion, pCaps->mIsES ? "OpenGL ES %d.%d" : "%d.%d", &majorVersion, &minorVersion );
+    }
+    pCaps->mMajorVersion = majorVersion;
+    pCaps->mMinorVersion = minorVersion;
+
+    glGetIntegerv( GL_MAX_TEXTURE_SIZE, &pCaps->mMaxTextureSize );
+    glGetIntegerv( GL_MAX_CUBE_MAP_TEXTURE_SIZE, &pCaps->mMaxCubeMapTextureSize );
+    if( majorVersion >= 3 )
+    {
+        glGetIntegerv( GL_MAX_3D_TEXTURE_SIZE, &pCaps->mMax3DTextureSize );
+        glGetIntegerv( GL_MAX_ARRAY_TEXTURE_LAYERS, &pCaps->mMaxArrayTextureLayers );
+    }
+
+    pCaps->mExtensions = QueryExtensions( majorVersion );
+    pCaps->mCompressedFormats = QueryCompressedFormats( majorVersion, pCaps->mExtensions );
+    pCaps->mTextureStorage = majorVersion >= 3 || ( pCaps->mExtensions & GL_CAPS_EXT_TEXTURE_STORAGE ) != 0;
+    pCaps->mPixelBufferObjects = majorVersion >= 3 || ( pCaps->mExtensions & GL_CAPS_EXT_PIXEL_BUFFER_OBJECT ) != 0;
+
+    LogInfo( "OpenGL%s %d.%d, max texture size %d, extensions 0x%x, compressed formats 0x%llx\n", pCaps->mIsES ? " ES" : "",
+             majorVersion, minorVersion, pCaps->mMaxTextureSize, pCaps->mExtensions, pCaps->mCompressedFormats );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the capabilities of the context current on this thread, querying them the first time
+const GlCaps* GetGlCaps()
+{
+    EGLContext context = eglGetCurrentContext();
+
+    if( context != gCapsContext )
+    {
+        gCapsContext = context;
+        if( context != EGL_NO_CONTEXT )
+        {
+            QueryGlCaps( &gCaps );
+        }
+        else
+        {
+            memset( &gCaps, 0, sizeof(gCaps) );
+        }
+    }
+    return &gCaps;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether the current context accepts a compressed internal format
+int IsCompressedFormatSupported( GLenum internalFormat )
+{
+    int bit = GetFormatBit( internalFormat );
+
+    return bit >= 0 && ( GetGlCaps()->mCompressedFormats >> bit ) & 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether the current context has one of the GL_CAPS_EXT_* extensions
+int HasGlExtension( unsigned int extension )
+{
+    return ( GetGlCaps()->mExtensions & extension ) != 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether the current context has a tracked extension by name
+int HasGlExtensionNamed( const char* pName )
+{
+    unsigned int extension = GetExtensionBit( pName, strlen( pName ) );
+
+    return extension != 0 && HasGlExtension( extension );
+}
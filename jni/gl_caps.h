@@ -0,0 +1,82 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <GLES3/gl3.h>
+
+// What the context current on the calling thread can do, queried once per context and answered
+// from memory afterwards: its version, the limits the loaders check textures against, the
+// extensions the loaders care about, and a bit per compressed format it accepts. The format bits
+// come from GL_COMPRESSED_TEXTURE_FORMATS, the extensions and what the version makes core (ETC2 and
+// EAC in OpenGL ES 3.0).
+//
+// Each thread keeps the capabilities of the last context it asked about, and queries again when
+// another context is current. Without a current context everything reads as unsupported.
+
+// Extensions tracked in GlCaps::mExtensions
+#define GL_CAPS_EXT_ETC1                    0x0001  // GL_OES_compressed_ETC1_RGB8_texture
+#define GL_CAPS_EXT_PVRTC                   0x0002  // GL_IMG_texture_compression_pvrtc
+#define GL_CAPS_EXT_S3TC                    0x0004  // GL_EXT_texture_compression_s3tc
+#define GL_CAPS_EXT_DXT1                    0x0008  // GL_EXT_texture_compression_dxt1
+#define GL_CAPS_EXT_S3TC_SRGB               0x0010  // GL_EXT_texture_compression_s3tc_srgb
+#define GL_CAPS_EXT_ASTC_LDR                0x0020  // GL_KHR_texture_compression_astc_ldr
+#define GL_CAPS_EXT_TEXTURE_STORAGE         0x0040  // GL_EXT_texture_storage
+#define GL_CAPS_EXT_PIXEL_BUFFER_OBJECT     0x0080  // GL_NV_pixel_buffer_object
+#define GL_CAPS_EXT_REQUIRED_INTERNALFORMAT 0x0100  // GL_OES_required_internalformat
+#define GL_CAPS_EXT_TEXTURE_SRGB            0x0200  // GL_EXT_texture_sRGB
+#define GL_CAPS_EXT_TEXTURE_RG              0x0400  // GL_ARB_texture_rg
+
+typedef struct
+{
+    int                mIsES;                   // OpenGL ES rather than desktop OpenGL
+    int                mMajorVersion;
+    int                mMinorVersion;
+    int                mMaxTextureSize;
+    int                mMaxCubeMapTextureSize;
+    int                mMax3DTextureSize;
+    int                mMaxArrayTextureLayers;
+    int                mTextureStorage;         // glTexStorage2D, core in ES 3.0 or GL_EXT_texture_storage
+    int                mPixelBufferObjects;     // GL_PIXEL_UNPACK_BUFFER, core in ES 3.0 or GL_NV_pixel_buffer_object
+    unsigned int       mExtensions;             // GL_CAPS_EXT_* bits
+    unsigned long long mCompressedFormats;      // Bit per known compressed format, see IsCompressedFormatSupported
+} GlCaps;
+
+// Returns the capabilities of the context current on this thread, querying them the first time
+const GlCaps* GetGlCaps();
+
+// Returns whether the current context accepts a compressed internal format. Formats outside the
+// S3TC, PVRTC, ETC1, ETC2/EAC and ASTC families are never reported as supported.
+int IsCompressedFormatSupported( GLenum internalFormat );
+
+// Returns whether the current context has one of the GL_CAPS_EXT_* extensions
+int HasGlExtension( unsigned int extension );
+
+// Returns whether the current context has an extension by name. Only the extensions tracked by
+// GL_CAPS_EXT_* are known, the others read as missing.
+int HasGlExtensionNamed( const char* pName );
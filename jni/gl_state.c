@@ -0,0 +1,567 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <string.h>
+
+#include "gl_state.h"
+
+// Targets whose bindings are shadowed: GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D and
+// GL_TEXTURE_2D_ARRAY
+#define GL_STATE_TEXTURE_TARGETS        4
+
+// GL_ARRAY_BUFFER, GL_PIXEL_UNPACK_BUFFER and GL_PIXEL_PACK_BUFFER. The element array buffer
+// binding belongs to the vertex array object, and is left alone.
+#define GL_STATE_BUFFER_TARGETS         3
+
+// GL_UNPACK_ALIGNMENT, GL_UNPACK_ROW_LENGTH, GL_UNPACK_IMAGE_HEIGHT, GL_UNPACK_SKIP_PIXELS,
+// GL_UNPACK_SKIP_ROWS, GL_UNPACK_SKIP_IMAGES and GL_PACK_ALIGNMENT
+#define GL_STATE_PIXEL_STORE_PARAMETERS 7
+
+// Filters, wraps, level range, swizzles and compare mode
+#define GL_STATE_TEXTURE_PARAMETERS     12
+
+// The parameters known of a texture
+typedef struct
+{
+    GLuint       mTexture;          // Name + 1, 0 if the entry is free
+    unsigned int mKnown;            // Bit per parameter
+    GLint        mValues[GL_STATE_TEXTURE_PARAMETERS];
+} TextureParameters;
+
+// What is known of the state of the context current on a thread. Names are stored plus one, so
+// zero, as a new thread starts with, means unknown.
+typedef struct
+{
+    GLuint            mActiveUnit;  // Unit index + 1
+    GLuint            mTextures[GL_STATE_TEXTURE_UNITS][GL_STATE_TEXTURE_TARGETS];
+    GLuint            mBuffers[GL_STATE_BUFFER_TARGETS];
+    GLuint            mProgram;
+    unsigned int      mAttribsKnown;    // Bit per vertex attribute array, of the default vertex array object
+    unsigned int      mAttribsEnabled;
+    unsigned int      mPixelStoreKnown;
+    GLint             mPixelStore[GL_STATE_PIXEL_STORE_PARAMETERS];
+    TextureParameters mParameters[GL_STATE_TEXTURE_ENTRIES];
+} GlState;
+
+static __thread GlState gGlState;
+
+// Updated atomically, every thread counts its calls in them
+static GlStateStats gGlStateStats = { 0, 0 };
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Counts a call that reached GL, or one that was left out
+static void CountIssued()
+{
+    __sync_fetch_and_add( &gGlStateStats.mIssued, 1 );
+}
+
+
+static void CountSkipped()
+{
+    __sync_fetch_and_add( &gGlStateStats.mSkipped, 1 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Index of the shadowed state for a GL enum, -1 if it isn't shadowed
+static int GetTextureTargetIndex( GLenum target )
+{
+    switch( target )
+    {
+    case GL_TEXTURE_2D:         return 0;
+    case GL_TEXTURE_CUBE_MAP:   return 1;
+    case GL_TEXTURE_3D:         return 2;
+    case GL_TEXTURE_2D_ARRAY:   return 3;
+    default:                    return -1;
+    }
+}
+
+
+static int GetBufferTargetIndex( GLenum target )
+{
+    switch( target )
+    {
+    case GL_ARRAY_BUFFER:           return 0;
+    case GL_PIXEL_UNPACK_BUFFER:    return 1;
+    case GL_PIXEL_PACK_BUFFER:      return 2;
+    default:                        return -1;
+    }
+}
+
+
+static int GetPixelStoreIndex( GLenum name )
+{
+    switch( name )
+    {
+    case GL_UNPACK_ALIGNMENT:       return 0;
+    case GL_UNPACK_ROW_LENGTH:      return 1;
+    case GL_UNPACK_IMAGE_HEIGHT:    return 2;
+    case GL_UNPACK_SKIP_PIXELS:     return 3;
+    case GL_UNPACK_SKIP_ROWS:       return 4;
+    case GL_UNPACK_SKIP_IMAGES:     return 5;
+    case GL_PACK_ALIGNMENT:         return 6;
+    default:                        return -1;
+    }
+}
+
+
+static int GetTextureParameterIndex( GLenum name )
+{
+    switch( name )
+    {
+    case GL_TEXTURE_MIN_FILTER:     return 0;
+    case GL_TEXTURE_MAG_FILTER:     return 1;
+    case GL_TEXTURE_WRAP_S:         return 2;
+    case GL_TEXTURE_WRAP_T:         return 3;
+    case GL_TEXTURE_WRAP_R:         return 4;
+    case GL_TEXTURE_BASE_LEVEL:     return 5;
+    case GL_TEXTURE_MAX_LEVEL:      return 6;
+    case GL_TEXTURE_SWIZZLE_R:      return 7;
+    case GL_TEXTURE_SWIZZLE_G:      return 8;
+    case GL_TEXTURE_SWIZZLE_B:      return 9;
+    case GL_TEXTURE_SWIZZLE_A:      return 10;
+    case GL_TEXTURE_COMPARE_MODE:   return 11;
+    default:                        return -1;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Selects the texture unit the texture calls apply to
+void CachedActiveTexture( GLenum unit )
+{
+    if( gGlState.mActiveUnit == unit - GL_TEXTURE0 + 1 )
+    {
+        CountSkipped();
+        return;
+    }
+    glActiveTexture( unit );
+    gGlState.mActiveUnit = unit - GL_TEXTURE0 + 1;
+    CountIssued();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the shadowed binding of a target on the active unit, NULL if it isn't shadowed
+static GLuint* GetTextureBinding( GLenum target )
+{
+    int index = GetTextureTargetIndex( target );
+
+    if( index < 0 || gGlState.mActiveUnit == 0 || gGlState.mActiveUnit > GL_STATE_TEXTURE_UNITS )
+    {
+        return NULL;
+    }
+    return &gGlState.mTextures[gGlState.mActiveUnit - 1][index];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Binds a texture to the active unit
+void CachedBindTexture( GLenum target, GLuint texture )
+{
+    GLuint* pBinding = GetTextureBinding( target );
+
+    if( pBinding != NULL && *pBinding == texture + 1 )
+    {
+        CountSkipped();
+        return;
+    }
+    glBindTexture( target, texture );
+    if( pBinding != NULL )
+    {
+        *pBinding = texture + 1;
+    }
+    CountIssued();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sets a parameter of the texture bound to a target of the active unit
+void CachedTexParameteri( GLenum target, GLenum name, GLint value )
+{
+    GLuint* pBinding = GetTextureBinding( target );
+    int index = GetTextureParameterIndex( name );
+    TextureParameters* pEntry;
+
+    if( pBinding == NULL || *pBinding <= 1 || index < 0 )
+    {
+        // Not known which texture it applies to, or not shadowed
+        glTexParameteri( target, name, value );
+        CountIssued();
+        return;
+    }
+
+    pEntry = &gGlState.mParameters[( *pBinding - 1 ) & ( GL_STATE_TEXTURE_ENTRIES - 1 )];
+    if( pEntry->mTexture != *pBinding )
+    {
+        pEntry->mTexture = *pBinding;
+        pEntry->mKnown = 0;
+    }
+    else if( ( pEntry->mKnown & ( 1u << index ) ) && pEntry->mValues[index] == value )
+    {
+        CountSkipped();
+        return;
+    }
+
+    glTexParameteri( target, name, value );
+    pEntry->mKnown |= 1u << index;
+    pEntry->mValues[index] = value;
+    CountIssued();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Forgets what is known of a texture name: its parameters, and the texture it is bound as on
+// every unit, which may have been deleted by another context since. The units it was bound on are
+// left with the given binding (plus one, as stored).
+static void ForgetTexture( GLuint texture, GLuint binding )
+{
+    TextureParameters* pEntry = &gGlState.mParameters[texture & ( GL_STATE_TEXTURE_ENTRIES - 1 )];
+    int unit;
+    int target;
+
+    if( pEntry->mTexture == texture + 1 )
+    {
+        pEntry->mTexture = 0;
+        pEntry->mKnown = 0;
+    }
+    for( unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit )
+    {
+        for( target = 0; target < GL_STATE_TEXTURE_TARGETS; ++target )
+        {
+            if( gGlState.mTextures[unit][target] == texture + 1 )
+            {
+                gGlState.mTextures[unit][target] = binding;
+            }
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Creates texture names, none of what was known of the names before applies to them
+void CachedGenTextures( GLsizei count, GLuint* pTextures )
+{
+    GLsizei index;
+
+    glGenTextures( count, pTextures );
+    for( index = 0; index < count; ++index )
+    {
+        ForgetTexture( pTextures[index], 0 );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletes textures, which unbinds them from this context
+void CachedDeleteTextures( GLsizei count, const GLuint* pTextures )
+{
+    GLsizei index;
+
+    glDeleteTextures( count, pTextures );
+    for( index = 0; index < count; ++index )
+    {
+        if( pTextures[index] != 0 )
+        {
+            ForgetTexture( pTextures[index], 1 );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Binds a buffer
+void CachedBindBuffer( GLenum target, GLuint buffer )
+{
+    int index = GetBufferTargetIndex( target );
+
+    if( index >= 0 && gGlState.mBuffers[index] == buffer + 1 )
+    {
+        CountSkipped();
+        return;
+    }
+    glBindBuffer( target, buffer );
+    if( index >= 0 )
+    {
+        gGlState.mBuffers[index] = buffer + 1;
+    }
+    CountIssued();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletes buffers, which unbinds them from this context
+void CachedDeleteBuffers( GLsizei count, const GLuint* pBuffers )
+{
+    GLsizei index;
+    int target;
+
+    glDeleteBuffers( count, pBuffers );
+    for( index = 0; index < count; ++index )
+    {
+        for( target = 0; target < GL_STATE_BUFFER_TARGETS; ++target )
+        {
+            if( pBuffers[index] != 0 && gGlState.mBuffers[target] == pBuffers[index] + 1 )
+            {
+                gGlState.mBuffers[target] = 1;
+            }
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Makes a program current
+void CachedUseProgram( GLuint program )
+{
+    if( gGlState.mProgram == program + 1 )
+    {
+        CountSkipped();
+        return;
+    }
+    glUseProgram( program );
+    gGlState.mProgram = program + 1;
+    CountIssued();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Enables or disables a vertex attribute array
+static void SetVertexAttribArray( GLuint index, int enable )
+{
+    unsigned int bit = index < GL_STATE_VERTEX_ATTRIBS ? 1u << index : 0;
+
+    if( ( gGlState.mAttribsKnown & bit ) && ( ( gGlState.mAttribsEnabled & bit ) != 0 ) == enable )
+    {
+        CountSkipped();
+        return;
+    }
+    if( enable )
+    {
+        glEnableVertexAttribArray( index );
+        gGlState.mAttribsEnabled |= bit;
+    }
+    else
+    {
+        glDisableVertexAttribArray( index );
+        gGlState.mAttribsEnabled &= ~bit;
+    }
+    gGlState.mAttribsKnown |= bit;
+    CountIssued();
+}
+
+
+void CachedEnableVertexAttribArray( GLuint index )
+{
+    SetVertexAttribArray( index, 1 );
+}
+
+
+void CachedDisableVertexAttribArray( GLuint index )
+{
+    SetVertexAttribArray( index, 0 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sets a pixel store parameter
+void CachedPixelStorei( GLenum name, GLint value )
+{
+    int index = GetPixelStoreIndex( name );
+
+    if( index >= 0 && ( gGlState.mPixelStoreKnown & ( 1u << index ) ) && gGlState.mPixelStore[index] == value )
+    {
+        CountSkipped();
+        return;
+    }
+    glPixelStorei( name, value );
+    if( index >= 0 )
+    {
+        gGlState.mPixelStoreKnown |= 1u << index;
+        gGlState.mPixelStore[index] = value;
+    }
+    CountIssued();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns a pixel store parameter from the shadow, or from GL the first time
+GLint GetCachedPixelStore( GLenum name )
+{
+    int index = GetPixelStoreIndex( name );
+    GLint value = 0;
+
+    if( index >= 0 && ( gGlState.mPixelStoreKnown & ( 1u << index ) ) )
+    {
+        CountSkipped();
+        return gGlState.mPixelStore[index];
+    }
+    glGetIntegerv( name, &value );
+    if( index >= 0 )
+    {
+        gGlState.mPixelStoreKnown |= 1u << index;
+        gGlState.mPixelStore[index] = value;
+    }
+    CountIssued();
+    return value;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Forgets everything known of the current context
+void ResetGlStateCache()
+{
+    memset( &gGlState, 0, sizeof(gGlState) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Compares what is known of the current context with what GL reports
+int CountGlStateMismatches()
+{
+    static const GLenum textureTargets[GL_STATE_TEXTURE_TARGETS] =
+        { GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D, GL_TEXTURE_2D_ARRAY };
+    static const GLenum textureBindings[GL_STATE_TEXTURE_TARGETS] =
+        { GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_CUBE_MAP, GL_TEXTURE_BINDING_3D, GL_TEXTURE_BINDING_2D_ARRAY };
+    static const GLenum bufferBindings[GL_STATE_BUFFER_TARGETS] =
+        { GL_ARRAY_BUFFER_BINDING, GL_PIXEL_UNPACK_BUFFER_BINDING, GL_PIXEL_PACK_BUFFER_BINDING };
+    static const GLenum pixelStoreNames[GL_STATE_PIXEL_STORE_PARAMETERS] =
+        { GL_UNPACK_ALIGNMENT, GL_UNPACK_ROW_LENGTH, GL_UNPACK_IMAGE_HEIGHT, GL_UNPACK_SKIP_PIXELS,
+          GL_UNPACK_SKIP_ROWS, GL_UNPACK_SKIP_IMAGES, GL_PACK_ALIGNMENT };
+    static const GLenum textureParameterNames[GL_STATE_TEXTURE_PARAMETERS] =
+        { GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R,
+          GL_TEXTURE_BASE_LEVEL, GL_TEXTURE_MAX_LEVEL, GL_TEXTURE_SWIZZLE_R, GL_TEXTURE_SWIZZLE_G,
+          GL_TEXTURE_SWIZZLE_B, GL_TEXTURE_SWIZZLE_A, GL_TEXTURE_COMPARE_MODE };
+    GLint activeUnit = GL_TEXTURE0;
+    GLint value;
+    int mismatches = 0;
+    int unit;
+    int index;
+    int entry;
+
+    // Errors raised before would be taken for the ones binding a texture to another target raises
+    while( glGetError() != GL_NO_ERROR )
+    {
+    }
+
+    glGetIntegerv( GL_ACTIVE_TEXTURE, &activeUnit );
+    if( gGlState.mActiveUnit != 0 && (GLuint)activeUnit != GL_TEXTURE0 + gGlState.mActiveUnit - 1 )
+    {
+        ++mismatches;
+    }
+    for( unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit )
+    {
+        glActiveTexture( GL_TEXTURE0 + unit );
+        for( index = 0; index < GL_STATE_TEXTURE_TARGETS; ++index )
+        {
+            glGetIntegerv( textureBindings[index], &value );
+            if( gGlState.mTextures[unit][index] != 0 && (GLuint)value != gGlState.mTextures[unit][index] - 1 )
+            {
+                ++mismatches;
+            }
+        }
+    }
+    glActiveTexture( activeUnit );
+
+    for( index = 0; index < GL_STATE_BUFFER_TARGETS; ++index )
+    {
+        glGetIntegerv( bufferBindings[index], &value );
+        if( gGlState.mBuffers[index] != 0 && (GLuint)value != gGlState.mBuffers[index] - 1 )
+        {
+            ++mismatches;
+        }
+    }
+
+    glGetIntegerv( GL_CURRENT_PROGRAM, &value );
+    if( gGlState.mProgram != 0 && (GLuint)value != gGlState.mProgram - 1 )
+    {
+        ++mismatches;
+    }
+
+    for( index = 0; index < GL_STATE_VERTEX_ATTRIBS; ++index )
+    {
+        glGetVertexAttribiv( index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &value );
+        if( ( gGlState.mAttribsKnown & ( 1u << index ) ) && ( value != 0 ) != ( ( gGlState.mAttribsEnabled >> index ) & 1 ) )
+        {
+            ++mismatches;
+        }
+    }
+
+    for( index = 0; index < GL_STATE_PIXEL_STORE_PARAMETERS; ++index )
+    {
+        glGetIntegerv( pixelStoreNames[index], &value );
+        if( ( gGlState.mPixelStoreKnown & ( 1u << index ) ) && value != gGlState.mPixelStore[index] )
+        {
+            ++mismatches;
+        }
+    }
+
+    // A texture's parameters can only be read bound, to whichever target it was created for
+    for( entry = 0; entry < GL_STATE_TEXTURE_ENTRIES; ++entry )
+    {
+        const TextureParameters* pEntry = &gGlState.mParameters[entry];
+
+        if( pEntry->mTexture == 0 || pEntry->mKnown == 0 || !glIsTexture( pEntry->mTexture - 1 ) )
+        {
+            continue;
+        }
+        for( index = 0; index < GL_STATE_TEXTURE_TARGETS; ++index )
+        {
+            GLint binding = 0;
+            int parameter;
+
+            glGetIntegerv( textureBindings[index], &binding );
+            glBindTexture( textureTargets[index], pEntry->mTexture - 1 );
+            if( glGetError() != GL_NO_ERROR )
+            {
+                continue;
+            }
+            for( parameter = 0; parameter < GL_STATE_TEXTURE_PARAMETERS; ++parameter )
+            {
+                glGetTexParameteriv( textureTargets[index], textureParameterNames[parameter], &value );
+                if( ( pEntry->mKnown & ( 1u << parameter ) ) && value != pEntry->mValues[parameter] )
+                {
+                    ++mismatches;
+                }
+            }
+            glBindTexture( textureTargets[index], binding );
+            break;
+        }
+    }
+
+    return mismatches;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the call counters
+void GetGlStateStats( GlStateStats* pStats )
+{
+    pStats->mIssued = __sync_fetch_and_add( &gGlStateStats.mIssued, 0 );
+    pStats->mSkipped = __sync_fetch_and_add( &gGlStateStats.mSkipped, 0 );
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <GLES3/gl3.h>
+
+// Shadows the GL state the loaders and the renderer set over and over, and skips the calls that
+// wouldn't change it: texture bindings of the first GL_STATE_TEXTURE_UNITS units, the active unit,
+// buffer bindings, the current program, vertex attribute arrays, the unpack pixel store and the
+// usual texture parameters. Reading the unpack pixel store back from the shadow also saves the
+// glGetIntegerv round trip, which stalls on some drivers.
+//
+// Each thread shadows the context current on it, starting from nothing known: the first call
+// setting a piece of state always reaches GL. ResetGlStateCache forgets what is known, and must be
+// called after another context is made current on the thread, or after code outside the cache
+// changed the state.
+//
+// Texture names are reused once deleted, and textures are shared with other contexts, so textures
+// must be created and deleted through CachedGenTextures and CachedDeleteTextures: a new name
+// starts with no known parameters and isn't taken for the texture the name may still be bound to.
+// Parameters are shadowed per texture in a small table indexed by name, a texture whose entry was
+// taken by another one is only set again. A texture's parameters must be set on one thread at a
+// time (e.g. by the loader thread until it is published, and by the render thread from then on).
+
+// Texture units whose bindings are shadowed
+#define GL_STATE_TEXTURE_UNITS          8
+
+// Vertex attribute arrays whose enables are shadowed
+#define GL_STATE_VERTEX_ATTRIBS         16
+
+// Entries of the texture parameter table, a power of 2
+#define GL_STATE_TEXTURE_ENTRIES        256
+
+typedef struct
+{
+    unsigned int mIssued;           // Calls that reached GL
+    unsigned int mSkipped;          // Calls left out as the state was already set, or queries answered
+} GlStateStats;
+
+void CachedActiveTexture( GLenum unit );
+void CachedBindTexture( GLenum target, GLuint texture );
+void CachedTexParameteri( GLenum target, GLenum name, GLint value );
+void CachedGenTextures( GLsizei count, GLuint* pTextures );
+void CachedDeleteTextures( GLsizei count, const GLuint* pTextures );
+
+void CachedBindBuffer( GLenum target, GLuint buffer );
+void CachedDeleteBuffers( GLsizei count, const GLuint* pBuffers );
+
+void CachedUseProgram( GLuint program );
+void CachedEnableVertexAttribArray( GLuint index );
+void CachedDisableVertexAttribArray( GLuint index );
+
+void CachedPixelStorei( GLenum name, GLint value );
+
+// Returns a pixel store parameter, querying GL only if it isn't known
+GLint GetCachedPixelStore( GLenum name );
+
+// Forgets the state of the context current on this thread
+void ResetGlStateCache();
+
+// Counts every thread's calls
+void GetGlStateStats( GlStateStats* pStats );
+
+// Returns how many pieces of the state known on this thread differ from what the current context
+// reports, for debugging and tests: it queries GL for all of it, which the cache is there to avoid
+int CountGlStateMismatches();
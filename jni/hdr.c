@@ -0,0 +1,503 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "hdr.h"
+
+#define RGB9E5_MAX          65408.0f        // 511 / 512 * 2^16
+#define R11F_MAX            65024.0f        // 63 / 64 + 1, times 2^15
+#define B10F_MAX            64512.0f        // 31 / 32 + 1, times 2^15
+#define SMALL_FLOAT_MIN     ( 1.0f / 16384 ) // Smallest normal value of the 10 and 11-bit floats
+
+static void (*gpPackHdrPixels)( int packFormat, unsigned int* pOut, const float* pIn, int count ) = NULL;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Float <-> bit pattern helpers
+static inline unsigned int FloatBits( float value )
+{
+    union { float f; unsigned int u; } bits;
+    bits.f = value;
+    return bits.u;
+}
+
+static inline float BitsToFloat( unsigned int value )
+{
+    union { float f; unsigned int u; } bits;
+    bits.u = value;
+    return bits.f;
+}
+
+static inline float ClampHdr( float value, float maxValue )
+{
+    // Written so NaN fails the first test
+    return value > 0.0f ? ( value < maxValue ? value : maxValue ) : 0.0f;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Float RGB to RGB9E5, as described in the OpenGL ES 3.0 specification (section 3.8.3.2)
+//
+// The shared exponent comes from the largest channel, floored at 2^-16. Dividing by a power of two
+// is a multiply by an exact reciprocal built from its bit pattern, and when the largest channel
+// rounds up to 512 the exponent moves up one. The SIMD versions do the same steps.
+static inline unsigned int FloatToRGB9E5( const float* pIn )
+{
+    float r = ClampHdr( pIn[0], RGB9E5_MAX );
+    float g = ClampHdr( pIn[1], RGB9E5_MAX );
+    float b = ClampHdr( pIn[2], RGB9E5_MAX );
+    float largest = r > g ? r : g;
+    unsigned int exponent;
+    float scale;
+
+    largest = largest > b ? largest : b;
+    largest = largest > 1.0f / 65536 ? largest : 1.0f / 65536;
+
+    exponent = ( FloatBits( largest ) >> 23 ) - 111;
+    scale = BitsToFloat( ( 151 - exponent ) << 23 );
+    if( (int)( largest * scale + 0.5f ) >= 512 )
+    {
+        scale *= 0.5f;
+        ++exponent;
+    }
+
+    return (unsigned int)( r * scale + 0.5f ) | ( (unsigned int)( g * scale + 0.5f ) << 9 ) |
+           ( (unsigned int)( b * scale + 0.5f ) << 18 ) | ( exponent << 27 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Float to an unsigned 5-bit exponent float with 'mantissaBits' bits of mantissa
+//
+// Normal values keep the top of the float's mantissa, rounded, with the exponent rebiased from 127
+// to 15; a carry out of the mantissa correctly bumps the exponent. Values below the smallest normal
+// are denormals, a plain fixed point count of 2^-(14 + mantissaBits).
+static inline unsigned int FloatToSmallFloat( float value, float maxValue, int mantissaBits )
+{
+    value = ClampHdr( value, maxValue );
+    if( value < SMALL_FLOAT_MIN )
+    {
+        return (unsigned int)( value * (float)( 1 << ( 14 + mantissaBits ) ) + 0.5f );
+    }
+    return ( ( FloatBits( value ) + ( 1 << ( 22 - mantissaBits ) ) ) >> ( 23 - mantissaBits ) ) - ( 112 << mantissaBits );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackHdrPixelsScalar
+void PackHdrPixelsScalar( int packFormat, unsigned int* pOut, const float* pIn, int i0, int i1 )
+{
+    int i;
+
+    if( packFormat == HDR_PACK_RGB9E5 )
+    {
+        for( i = i0; i < i1; ++i )
+        {
+            pOut[i] = FloatToRGB9E5( pIn + i * 3 );
+        }
+    }
+    else
+    {
+        for( i = i0; i < i1; ++i )
+        {
+            const float* pPixel = pIn + i * 3;
+            pOut[i] = FloatToSmallFloat( pPixel[0], R11F_MAX, 6 ) | ( FloatToSmallFloat( pPixel[1], R11F_MAX, 6 ) << 11 ) |
+                      ( FloatToSmallFloat( pPixel[2], B10F_MAX, 5 ) << 22 );
+        }
+    }
+}
+
+
+#if defined(__SSE2__)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackHdrPixelsSSE2 - 4 pixels per iteration
+//
+// Three loads of 4 floats hold 4 RGB pixels, shuffled into one register per channel.
+static inline __m128i FloatToSmallFloatSSE2( __m128 value, __m128 maxValue, int mantissaBits )
+{
+    const __m128 denormalScale = _mm_set1_ps( (float)( 1 << ( 14 + mantissaBits ) ) );
+    __m128 isDenormal;
+    __m128i normal, denormal;
+
+    value = _mm_min_ps( _mm_max_ps( value, _mm_setzero_ps() ), maxValue );
+    isDenormal = _mm_cmplt_ps( value, _mm_set1_ps( SMALL_FLOAT_MIN ) );
+
+    normal = _mm_add_epi32( _mm_castps_si128( value ), _mm_set1_epi32( 1 << ( 22 - mantissaBits ) ) );
+    normal = _mm_sub_epi32( _mm_srli_epi32( normal, 23 - mantissaBits ), _mm_set1_epi32( 112 << mantissaBits ) );
+    denormal = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( value, denormalScale ), _mm_set1_ps( 0.5f ) ) );
+
+    return _mm_or_si128( _mm_and_si128( _mm_castps_si128( isDenormal ), denormal ),
+                         _mm_andnot_si128( _mm_castps_si128( isDenormal ), normal ) );
+}
+
+void PackHdrPixelsSSE2( int packFormat, unsigned int* pOut, const float* pIn, int count )
+{
+    const __m128 half = _mm_set1_ps( 0.5f );
+    int i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128 a = _mm_loadu_ps( pIn + i * 3 );        // r0 g0 b0 r1
+        __m128 b = _mm_loadu_ps( pIn + i * 3 + 4 );    // g1 b1 r2 g2
+        __m128 c = _mm_loadu_ps( pIn + i * 3 + 8 );    // b2 r3 g3 b3
+        __m128 red   = _mm_shuffle_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+        __m128 green = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+        __m128 blue  = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+        __m128i packed;
+
+        if( packFormat == HDR_PACK_RGB9E5 )
+        {
+            const __m128 maxValue = _mm_set1_ps( RGB9E5_MAX );
+            __m128 largest, scale;
+            __m128i exponent, overflow;
+
+            red   = _mm_min_ps( _mm_max_ps( red,   _mm_setzero_ps() ), maxValue );
+            green = _mm_min_ps( _mm_max_ps( green, _mm_setzero_ps() ), maxValue );
+            blue  = _mm_min_ps( _mm_max_ps( blue,  _mm_setzero_ps() ), maxValue );
+            largest = _mm_max_ps( _mm_max_ps( _mm_max_ps( red, green ), blue ), _mm_set1_ps( 1.0f / 65536 ) );
+
+            exponent = _mm_sub_epi32( _mm_srli_epi32( _mm_castps_si128( largest ), 23 ), _mm_set1_epi32( 111 ) );
+            scale = _mm_castsi128_ps( _mm_slli_epi32( _mm_sub_epi32( _mm_set1_epi32( 151 ), exponent ), 23 ) );
+
+            // All ones where the largest channel rounds up to 512, halving the scale in the exponent field
+            overflow = _mm_cmpgt_epi32( _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( largest, scale ), half ) ), _mm_set1_epi32( 511 ) );
+            scale = _mm_castsi128_ps( _mm_sub_epi32( _mm_castps_si128( scale ), _mm_and_si128( overflow, _mm_set1_epi32( 1 << 23 ) ) ) );
+            exponent = _mm_sub_epi32( exponent, overflow );
+
+            packed = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( red, scale ), half ) );
+            packed = _mm_or_si128( packed, _mm_slli_epi32( _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( green, scale ), half ) ), 9 ) );
+            packed = _mm_or_si128( packed, _mm_slli_epi32( _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( blue, scale ), half ) ), 18 ) );
+            packed = _mm_or_si128( packed, _mm_slli_epi32( exponent, 27 ) );
+        }
+        else
+        {
+            packed = FloatToSmallFloatSSE2( red, _mm_set1_ps( R11F_MAX ), 6 );
+            packed = _mm_or_si128( packed, _mm_slli_epi32( FloatToSmallFloatSSE2( green, _mm_set1_ps( R11F_MAX ), 6 ), 11 ) );
+            packed = _mm_or_si128( packed, _mm_slli_epi32( FloatToSmallFloatSSE2( blue, _mm_set1_ps( B10F_MAX ), 5 ), 22 ) );
+        }
+
+        _mm_storeu_si128( (__m128i*)( pOut + i ), packed );
+    }
+
+    PackHdrPixelsScalar( packFormat, pOut, pIn, i, count );
+}
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SelectHdrKernels
+void SelectHdrKernels( unsigned int features )
+{
+    gpPackHdrPixels = NULL;
+
+#if defined(__SSE2__)
+    if( features & CPU_FEATURE_SSE2 )
+    {
+        gpPackHdrPixels = PackHdrPixelsSSE2;
+    }
+#endif
+
+#if defined(HAVE_NEON)
+    if( features & CPU_FEATURE_NEON )
+    {
+        gpPackHdrPixels = PackHdrPixelsNEON;
+    }
+#endif
+
+    (void)features;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackHdrPixels - runs the fastest packing kernel
+void PackHdrPixels( int packFormat, unsigned int* pOut, const float* pIn, int count )
+{
+    InitKernelDispatch();
+
+    if( gpPackHdrPixels != NULL )
+    {
+        gpPackHdrPixels( packFormat, pOut, pIn, count );
+    }
+    else
+    {
+        PackHdrPixelsScalar( packFormat, pOut, pIn, 0, count );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RGBE to packed pixels
+//
+// An RGBE pixel is m * 2^(e - 136) per channel (e == 0 is black). RGB9E5 represents that with a
+// shift of the 8-bit mantissas; only values past its range are clamped, or rounded away.
+
+// m * 2^shift, rounded to nearest and clamped to 9 bits
+static inline unsigned int ShiftMantissa( unsigned int m, int shift )
+{
+    if( shift >= 0 )
+    {
+        m = shift < 9 ? m << shift : ( m != 0 ) * 511;
+        return m < 511 ? m : 511;
+    }
+    return -shift < 10 ? ( m + ( 1 << ( -shift - 1 ) ) ) >> -shift : 0;
+}
+
+static inline unsigned int RgbeToRGB9E5( const unsigned char* pPixel )
+{
+    // RGB9E5 is m9 * 2^(E - 24), so m9 = m << 1 with E = e - 113
+    int exponent = pPixel[3] - 113;
+    int shift = 1;
+
+    if( pPixel[3] == 0 )
+    {
+        return 0;
+    }
+    if( exponent > 31 )
+    {
+        shift += exponent - 31;
+        exponent = 31;
+    }
+    else if( exponent < 0 )
+    {
+        shift += exponent;
+        exponent = 0;
+    }
+    return ShiftMantissa( pPixel[0], shift ) | ( ShiftMantissa( pPixel[1], shift ) << 9 ) |
+           ( ShiftMantissa( pPixel[2], shift ) << 18 ) | ( (unsigned int)exponent << 27 );
+}
+
+// m * 2^(e - 136) is exact in a float, and FloatToSmallFloat does the rest. Exponents below 10
+// would need a float denormal, and are far under the smallest 10/11-bit float anyway.
+static inline unsigned int RgbeToR11G11B10F( const unsigned char* pPixel )
+{
+    float scale;
+
+    if( pPixel[3] < 10 )
+    {
+        return 0;
+    }
+    scale = BitsToFloat( (unsigned int)( pPixel[3] - 9 ) << 23 );
+    return FloatToSmallFloat( pPixel[0] * scale, R11F_MAX, 6 ) | ( FloatToSmallFloat( pPixel[1] * scale, R11F_MAX, 6 ) << 11 ) |
+           ( FloatToSmallFloat( pPixel[2] * scale, B10F_MAX, 5 ) << 22 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the length of the line at pData[*pPosition] and moves past its newline, or -1 if there
+// is no newline before the end
+static int ReadHeaderLine( const unsigned char* pData, unsigned int size, unsigned int* pPosition )
+{
+    unsigned int start = *pPosition;
+    unsigned int end = start;
+
+    while( end < size && pData[end] != '\n' )
+    {
+        ++end;
+    }
+    if( end == size )
+    {
+        return -1;
+    }
+    *pPosition = end + 1;
+    return (int)( end - start );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ParseRadianceHeader
+//
+// Accepts the "-Y height +X width" (top to bottom, left to right) orientation only, which is what
+// every common writer produces, like stb_image does.
+unsigned int ParseRadianceHeader( const unsigned char* pData, unsigned int size, int* pWidth, int* pHeight )
+{
+    unsigned int position = 0;
+    char resolution[64];
+    int length;
+
+    length = ReadHeaderLine( pData, size, &position );
+    if( !( length == 10 && memcmp( pData, "#?RADIANCE", 10 ) == 0 ) && !( length == 6 && memcmp( pData, "#?RGBE", 6 ) == 0 ) )
+    {
+        return 0;
+    }
+
+    // Variables up to an empty line, only the pixel format matters
+    for( ;; )
+    {
+        const unsigned char* pLine = pData + position;
+
+        length = ReadHeaderLine( pData, size, &position );
+        if( length <= 0 )
+        {
+            break;
+        }
+        if( length >= 7 && memcmp( pLine, "FORMAT=", 7 ) == 0 &&
+            !( length == 22 && memcmp( pLine, "FORMAT=32-bit_rle_rgbe", 22 ) == 0 ) )
+        {
+            return 0;
+        }
+    }
+    if( length < 0 )
+    {
+        return 0;
+    }
+
+    length = ReadHeaderLine( pData, size, &position );
+    if( length <= 0 || length >= (int)sizeof(resolution) )
+    {
+        return 0;
+    }
+    memcpy( resolution, pData + position - length - 1, length );
+    resolution[length] = '\0';
+
+    if( sscanf( resolution, "-Y %d +X %d", pHeight, pWidth ) != 2 ||
+        *pWidth <= 0 || *pHeight <= 0 || *pWidth > 16384 || *pHeight > 16384 )
+    {
+        return 0;
+    }
+    return position;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads one scanline of RGBE pixels into pRow, returns the position after it or 0 if corrupt
+//
+// Run length encoded scanlines start with 2, 2 and the width, then store each channel in turn as
+// runs (count > 128, one value repeated count - 128 times) and literal spans. Anything else is a
+// flat scanline; the old per pixel run length scheme is not supported, as in stb_image.
+static unsigned int ReadScanline( const unsigned char* pData, unsigned int size, unsigned int position,
+                                  unsigned char* pRow, int width )
+{
+    const unsigned char* p = pData + position;
+    int c, x;
+
+    if( width < 8 || width > 0x7FFF || size - position < 4 || p[0] != 2 || p[1] != 2 || ( p[2] & 0x80 ) )
+    {
+        if( size - position < (unsigned int)width * 4 )
+        {
+            return 0;
+        }
+        memcpy( pRow, p, width * 4 );
+        return position + width * 4;
+    }
+
+    if( ( ( p[2] << 8 ) | p[3] ) != width )
+    {
+        return 0;
+    }
+    position += 4;
+
+    for( c = 0; c < 4; ++c )
+    {
+        for( x = 0; x < width; )
+        {
+            int count;
+
+            if( position >= size )
+            {
+                return 0;
+            }
+            count = pData[position++];
+            if( count > 128 )
+            {
+                unsigned char value;
+
+                count -= 128;
+                if( x + count > width || position >= size )
+                {
+                    return 0;
+                }
+                value = pData[position++];
+                for( ; count > 0; --count, ++x )
+                {
+                    pRow[x * 4 + c] = value;
+                }
+            }
+            else
+            {
+                if( count == 0 || x + count > width || size - position < (unsigned int)count )
+                {
+                    return 0;
+                }
+                for( ; count > 0; --count, ++x )
+                {
+                    pRow[x * 4 + c] = pData[position++];
+                }
+            }
+        }
+    }
+    return position;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DecodeRadiance
+//
+// RGBE and the packed formats are both 4 bytes a pixel, so each scanline is decoded into its own
+// output row and converted over itself.
+int DecodeRadiance( const unsigned char* pData, unsigned int size, unsigned int offset, int packFormat,
+                    unsigned int* pFirstRow, int width, int height, int rowStride )
+{
+    unsigned int position = offset;
+    int x, y;
+
+    for( y = 0; y < height; ++y )
+    {
+        unsigned int* pRow = pFirstRow + y * rowStride;
+        unsigned char* pRgbe = (unsigned char*)pRow;
+
+        position = ReadScanline( pData, size, position, pRgbe, width );
+        if( position == 0 )
+        {
+            return 0;
+        }
+
+        if( packFormat == HDR_PACK_RGB9E5 )
+        {
+            for( x = 0; x < width; ++x )
+            {
+                pRow[x] = RgbeToRGB9E5( pRgbe + x * 4 );
+            }
+        }
+        else
+        {
+            for( x = 0; x < width; ++x )
+            {
+                pRow[x] = RgbeToR11G11B10F( pRgbe + x * 4 );
+            }
+        }
+    }
+    return 1;
+}
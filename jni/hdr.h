@@ -0,0 +1,58 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+// 32-bit HDR texel formats, both core in OpenGL ES 3.0 and a third the size of GL_RGB32F
+#define HDR_PACK_RGB9E5             0   // GL_RGB9_E5, 9-bit mantissas with a shared 5-bit exponent
+#define HDR_PACK_R11G11B10F         1   // GL_R11F_G11F_B10F, unsigned 11/11/10-bit floats
+
+// Packs 'count' float RGB pixels into 32-bit pixels. Negative and NaN channels become 0, values
+// past the format's range are clamped to its largest finite value.
+void PackHdrPixels( int packFormat, unsigned int* pOut, const float* pIn, int count );
+
+// Points the packing kernel at the variant 'features' (CPU_FEATURE_*) allows. Called by the kernel
+// dispatch (dispatch.h).
+void SelectHdrKernels( unsigned int features );
+
+// Scalar packing of pixels [i0, i1), also used for the tail of a row by the SIMD versions
+void PackHdrPixelsScalar( int packFormat, unsigned int* pOut, const float* pIn, int i0, int i1 );
+
+void PackHdrPixelsSSE2( int packFormat, unsigned int* pOut, const float* pIn, int count );
+void PackHdrPixelsNEON( int packFormat, unsigned int* pOut, const float* pIn, int count );
+
+// Parses the header of a Radiance (.hdr) RGBE file. Returns the offset of the pixel data, or 0 if
+// this is not an RGBE file this decoder supports.
+unsigned int ParseRadianceHeader( const unsigned char* pData, unsigned int size, int* pWidth, int* pHeight );
+
+// Decodes the RGBE pixels that start at 'offset' straight into 'height' rows of 'width' packed
+// pixels, with a signed step of 'rowStride' pixels between rows. Each scanline is run length
+// decoded in place and converted with integer arithmetic while it is in cache. Returns 0 if the
+// data is truncated or corrupt.
+int DecodeRadiance( const unsigned char* pData, unsigned int size, unsigned int offset, int packFormat,
+                    unsigned int* pFirstRow, int width, int height, int rowStride );
@@ -0,0 +1,104 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// NEON HDR packing kernels - built for armeabi-v7a only, see jpeg_neon.c
+
+#include <arm_neon.h>
+
+#include "hdr.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackHdrPixelsNEON - 4 pixels per iteration, same arithmetic as the scalar version
+//
+// vld3 deinterleaves the channels. NEON min/max propagate NaN, so NaN lanes are zeroed first
+// through a self compare.
+static inline float32x4_t ClampHdrNEON( float32x4_t value, float32x4_t maxValue )
+{
+    value = vreinterpretq_f32_u32( vandq_u32( vceqq_f32( value, value ), vreinterpretq_u32_f32( value ) ) );
+    return vminq_f32( vmaxq_f32( value, vdupq_n_f32( 0.0f ) ), maxValue );
+}
+
+static inline uint32x4_t FloatToSmallFloatNEON( float32x4_t value, float maxValue, int mantissaBits )
+{
+    uint32x4_t isDenormal, normal, denormal;
+
+    value = ClampHdrNEON( value, vdupq_n_f32( maxValue ) );
+    isDenormal = vcltq_f32( value, vdupq_n_f32( 1.0f / 16384 ) );
+
+    normal = vaddq_u32( vreinterpretq_u32_f32( value ), vdupq_n_u32( 1 << ( 22 - mantissaBits ) ) );
+    normal = vsubq_u32( vshlq_u32( normal, vdupq_n_s32( mantissaBits - 23 ) ), vdupq_n_u32( 112 << mantissaBits ) );
+    denormal = vcvtq_u32_f32( vmlaq_n_f32( vdupq_n_f32( 0.5f ), value, (float)( 1 << ( 14 + mantissaBits ) ) ) );
+
+    return vbslq_u32( isDenormal, denormal, normal );
+}
+
+void PackHdrPixelsNEON( int packFormat, unsigned int* pOut, const float* pIn, int count )
+{
+    const float32x4_t half = vdupq_n_f32( 0.5f );
+    int i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        float32x4x3_t pixels = vld3q_f32( pIn + i * 3 );
+        uint32x4_t packed;
+
+        if( packFormat == HDR_PACK_RGB9E5 )
+        {
+            const float32x4_t maxValue = vdupq_n_f32( 65408.0f );
+            float32x4_t red   = ClampHdrNEON( pixels.val[0], maxValue );
+            float32x4_t green = ClampHdrNEON( pixels.val[1], maxValue );
+            float32x4_t blue  = ClampHdrNEON( pixels.val[2], maxValue );
+            float32x4_t largest = vmaxq_f32( vmaxq_f32( vmaxq_f32( red, green ), blue ), vdupq_n_f32( 1.0f / 65536 ) );
+            uint32x4_t exponent, scaleBits, overflow;
+            float32x4_t scale;
+
+            exponent = vsubq_u32( vshrq_n_u32( vreinterpretq_u32_f32( largest ), 23 ), vdupq_n_u32( 111 ) );
+            scaleBits = vshlq_n_u32( vsubq_u32( vdupq_n_u32( 151 ), exponent ), 23 );
+
+            // All ones where the largest channel rounds up to 512, halving the scale in the exponent field
+            overflow = vcgtq_u32( vcvtq_u32_f32( vmlaq_f32( half, largest, vreinterpretq_f32_u32( scaleBits ) ) ), vdupq_n_u32( 511 ) );
+            scale = vreinterpretq_f32_u32( vsubq_u32( scaleBits, vandq_u32( overflow, vdupq_n_u32( 1 << 23 ) ) ) );
+            exponent = vsubq_u32( exponent, overflow );
+
+            packed = vcvtq_u32_f32( vmlaq_f32( half, red, scale ) );
+            packed = vorrq_u32( packed, vshlq_n_u32( vcvtq_u32_f32( vmlaq_f32( half, green, scale ) ), 9 ) );
+            packed = vorrq_u32( packed, vshlq_n_u32( vcvtq_u32_f32( vmlaq_f32( half, blue, scale ) ), 18 ) );
+            packed = vorrq_u32( packed, vshlq_n_u32( exponent, 27 ) );
+        }
+        else
+        {
+            packed = FloatToSmallFloatNEON( pixels.val[0], 65024.0f, 6 );
+            packed = vorrq_u32( packed, vshlq_n_u32( FloatToSmallFloatNEON( pixels.val[1], 65024.0f, 6 ), 11 ) );
+            packed = vorrq_u32( packed, vshlq_n_u32( FloatToSmallFloatNEON( pixels.val[2], 64512.0f, 5 ), 22 ) );
+        }
+
+        vst1q_u32( pOut + i, packed );
+    }
+
+    PackHdrPixelsScalar( packFormat, pOut, pIn, i, count );
+}
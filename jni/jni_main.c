@@ -1,415 +1,599 @@
-/* Copyright (c) <2012>, Intel Corporation
-*
-* Redistribution and use in source and binary forms, with or without 
-* modification, are permitted provided that the following conditions are met:
-*
-* - Redistributions of source code must retain the above copyright notice, 
-*   this list of conditions and the following disclaimer.
-* - Redistributions in binary form must reproduce the above copyright notice, 
-*   this list of conditions and the following disclaimer in the documentation 
-*   and/or other materials provided with the distribution.
-* - Neither the name of Intel Corporation nor the names of its contributors 
-*   may be used to endorse or promote products derived from this software 
-*   without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-* POSSIBILITY OF SUCH DAMAGE.
-*
-*/
-
-#include <assert.h>
-#include <jni.h>
-#include <sys/types.h>
-#include <android/asset_manager.h>
-#include <android/asset_manager_jni.h>
-#include <android/log.h>
-
-#include <GLES3/gl3.h>
-#include <GLES3/gl3ext.h>
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-
-#include "file.h"
-#include "texture.h"
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Debugging helper functions
-#define  Log(...)  __android_log_print( ANDROID_LOG_INFO, "TextureLoader", __VA_ARGS__ )
-#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
-
-static void CheckGlError( const char* pFunctionName ) 
-{
-    GLint error = glGetError();
-    if( error != GL_NO_ERROR ) 
-    {
-        LogError( "%s returned glError 0x%x\n", pFunctionName, error );
-    }
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Simple geometry data to render textured quads
-typedef struct
-{
-    float x;
-    float y;
-    float u;
-    float v;
-    
-} TriangleVertex;
-
-TriangleVertex gTriangleVerticesPNG[] =     { { -0.6f,  1.0f, 0.2f, 0.0f  },
-                                            {   -1.0f, -1.0f, 0.0f,  1.0f  },
-                                            {   -0.6f, -1.0f, 0.2f, 1.0f  },
-                                            {   -1.0f,  1.0f, 0.0f,  0.0f  },
-                                            {   -1.0f, -1.0f, 0.0f,  1.0f  },
-                                            {   -0.6f,  1.0f, 0.2f, 0.0f  } }; 
-                                           
-TriangleVertex gTriangleVerticesETC[] =     { { -0.2f,  1.0f, 0.4f,  0.0f  },
-                                            {   -0.6f, -1.0f, 0.2f, 1.0f  },
-                                            {   -0.2f, -1.0f, 0.4f,  1.0f  },
-                                            {   -0.6f,  1.0f, 0.2f, 0.0f  },
-                                            {   -0.6f, -1.0f, 0.2f, 1.0f  },
-                                            {   -0.2f,  1.0f, 0.4f,  0.0f  } };
-
-TriangleVertex gTriangleVerticesETC2[] =     { { 0.2f,  1.0f, 0.6f,  0.0f  },
-                                            {   -0.2f, -1.0f, 0.4f, 1.0f  },
-                                            {    0.2f, -1.0f, 0.6f,  1.0f  },
-                                            {   -0.2f,  1.0f, 0.4f, 0.0f  },
-                                            {   -0.2f, -1.0f, 0.4f, 1.0f  },
-                                            {    0.2f,  1.0f, 0.6f,  0.0f  } };
-
-TriangleVertex gTriangleVerticesPVRTC[] =   { {  0.6f,  1.0f, 0.8f, 0.0f  },
-                                            {    0.2f, -1.0f, 0.6f,  1.0f  },
-                                            {    0.6f, -1.0f, 0.8f, 1.0f  },
-                                            {    0.2f,  1.0f, 0.6f,  0.0f  },
-                                            {    0.2f, -1.0f, 0.6f,  1.0f  },
-                                            {    0.6f,  1.0f, 0.8f, 0.0f  } }; 
-                                           
-TriangleVertex gTriangleVerticesS3TC[] =    { {  1.0f,  1.0f, 1.0f,  0.0f  },
-                                            {    0.6f, -1.0f, 0.8f, 1.0f  },
-                                            {    1.0f, -1.0f, 1.0f,  1.0f  },
-                                            {    0.6f,  1.0f, 0.8f, 0.0f  },
-                                            {    0.6f, -1.0f, 0.8f, 1.0f  },
-                                            {    1.0f,  1.0f, 1.0f,  0.0f  } }; 
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Simple vertex shader
-static const char gVertexShader[] = 
-    "attribute vec4 aPosition;  \n"
-    "attribute vec2 aTexCoord;  \n"
-    "varying vec2 vTexCoord;    \n"
-    "void main()                \n"
-    "{                          \n"
-    "  vTexCoord = aTexCoord;   \n"
-    "  gl_Position = aPosition; \n"
-    "}                          \n";
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Simple pixel (aka Fragment) shader
-static const char gPixelShader[] = 
-    "precision mediump float;                          \n"
-    "varying vec2 vTexCoord;                           \n"
-    "uniform sampler2D sTexture;                       \n"
-    "void main()                                       \n"
-    "{                                                 \n"
-    "  gl_FragColor = texture2D(sTexture, vTexCoord);  \n"
-    "}                                                 \n";
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// CompileShader - Compiles the passed in string for the given shaderType
-GLuint CompileShader( GLenum shaderType, const char* pSource ) 
-{
-    // Create a shader handle
-    GLuint shaderHandle = glCreateShader( shaderType );
-
-    if( shaderHandle ) 
-    {
-        // Set the shader source
-        glShaderSource( shaderHandle, 1, &pSource, NULL );
-
-        // Compile the shader
-        glCompileShader( shaderHandle );
-
-        // Check the compile status
-        GLint compileStatus = 0;
-        glGetShaderiv( shaderHandle, GL_COMPILE_STATUS, &compileStatus );
-
-        if( !compileStatus ) 
-        {
-            // There was an error, print it out
-            GLint infoLogLength = 0;
-            glGetShaderiv( shaderHandle, GL_INFO_LOG_LENGTH, &infoLogLength );
-
-            if( infoLogLength > 1 ) 
-            {
-                char* pShaderInfoLog = (char*)malloc( infoLogLength );
-                if( pShaderInfoLog ) 
-                {
-                    glGetShaderInfoLog( shaderHandle, infoLogLength, NULL, pShaderInfoLog );
-                    LogError( "Error compiling shader: \n%s", pShaderInfoLog );
-                    free( pShaderInfoLog );
-                }
-
-                // Free the handle
-                glDeleteShader( shaderHandle );
-                shaderHandle = 0;
-            }
-        }
-    }
-
-    return shaderHandle;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// createProgram - Creates a new program with the given vertex and pixel shader
-GLuint createProgram( const char* pVertexSource, const char* pPixelSource ) 
-{
-    // Compile the vertex shader
-    GLuint vertexShaderHandle = CompileShader( GL_VERTEX_SHADER, pVertexSource );
-    GLuint pixelShaderHandle  = CompileShader( GL_FRAGMENT_SHADER, pPixelSource );
-
-    if( !vertexShaderHandle || !pixelShaderHandle )
-    {
-        return 0;
-    }
-
-    // Create a new handle for this program
-    GLuint programHandle = glCreateProgram();
-
-    // Link and finish the program
-    if( programHandle ) 
-    {
-        // Set the vertex shader for this program
-        glAttachShader( programHandle, vertexShaderHandle );
-        CheckGlError( "glAttachShader" );
-
-        // Set the pixel shader for this program
-        glAttachShader( programHandle, pixelShaderHandle );
-        CheckGlError( "glAttachShader" );
-
-        // Link the program
-        glLinkProgram( programHandle );
-
-        // Check the link status
-        GLint linkStatus = 0;
-        glGetProgramiv( programHandle, GL_LINK_STATUS, &linkStatus );
-
-        if( !linkStatus ) 
-        {
-            // There was an error, print it out
-            GLint infoLogLength = 0;
-            glGetProgramiv( programHandle, GL_INFO_LOG_LENGTH, &infoLogLength );
-
-            if( infoLogLength ) 
-            {
-                char* pInfoLog = (char*)malloc( infoLogLength );
-                if( pInfoLog ) 
-                {
-                    glGetProgramInfoLog( programHandle, infoLogLength, NULL, pInfoLog );
-                    LogError( "Error linking the program: \n%s", pInfoLog );
-                    free( pInfoLog );
-                }
-            }
-
-            // Free the handle
-            glDeleteProgram( programHandle );
-            programHandle = 0;
-        }
-    }
-
-    return programHandle;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Init - Called from Java-side to setup the graphics on the native-side 
-GLuint gProgramHandle;
-GLuint gaPositionHandle;
-GLuint gaTexCoordHandle;
-GLuint gaTexSamplerHandle;
-
-GLuint gTextureHandlePNG;
-GLuint gTextureHandleUnsupported;
-GLuint gTextureHandleETC;
-GLuint gTextureHandleETC2;
-GLuint gTextureHandlePVRTC;
-GLuint gTextureHandleS3TC;
-
-void Init( int width, int height ) 
-{
-    // Init the shaders
-    gProgramHandle = createProgram( gVertexShader, gPixelShader );
-    if( !gProgramHandle ) 
-    {
-        LogError( "Could not create program." );
-        assert(0);
-    }
-    
-    // Read attribute locations from the program
-    gaPositionHandle = glGetAttribLocation( gProgramHandle, "aPosition" );
-    CheckGlError( "glGetAttribLocation" );
-
-    gaTexCoordHandle = glGetAttribLocation( gProgramHandle, "aTexCoord" );
-    CheckGlError( "glGetAttribLocation" );
-    
-    gaTexSamplerHandle = glGetUniformLocation( gProgramHandle, "sTexture" );
-    CheckGlError( "glGetUnitformLocation" );
-
-    // Set up viewport
-    glViewport( 0, 0, width, height ) ;
-    CheckGlError( "glViewport" );
-
-    // Load textures
-    gTextureHandlePNG = LoadTexturePNG("tex_png.png");
-    gTextureHandleUnsupported = LoadTexturePNG("tex_bw.png");
-    gTextureHandleETC = ( IsETCSupported() ) ? LoadTextureETC_KTX("tex_etc1.ktx") : gTextureHandleUnsupported;
-    gTextureHandleETC2 = ( IsETC2Supported() ) ? LoadTextureETC_KTX("tex_etc2.ktx") : gTextureHandleUnsupported;
-    gTextureHandlePVRTC = ( IsPVRTCSupported() ) ? LoadTexturePVRTC("tex_pvr.pvr") : gTextureHandleUnsupported;
-    gTextureHandleS3TC = ( IsS3TCSupported() ) ? LoadTextureS3TC("tex_s3tc.dds") : gTextureHandleUnsupported;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Render - Called from Java-side to render a frame
-void Render() 
-{
-    // Set the clear color
-    glClearColor( 0.8f, 0.7f, 0.6f, 1.0f);
-    CheckGlError( "glClearColor" );
-
-    // Clear the color and depth buffer 
-    glClear( GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-    CheckGlError( "glClear" );
-    
-    // Select vertex/pixel shader
-    glUseProgram( gProgramHandle );
-    CheckGlError( "glUseProgram" );
-    
-    // Enable vertex
-    glEnableVertexAttribArray( gaPositionHandle );
-    CheckGlError( "glEnableVertexAttribArray" );
-    
-    // Enable tex coords
-    glEnableVertexAttribArray( gaTexCoordHandle );
-    CheckGlError( "glEnableVertexAttribArray" );
- 
-    // Set texture sampler
-    glActiveTexture( GL_TEXTURE0 );
-    
-    // Enable texture sampler 
-    glUniform1i( gaTexSamplerHandle, 0 );
-    
-    // PNG //////////////////////////////////////////////////////////////////////////////////////////////////////
-            
-    // Set vertex position
-    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesPNG );
-    CheckGlError( "glVertexAttribPointer" );
-    
-    // Set vertex texture coordinates
-    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesPNG + sizeof(float)*2 );
-    CheckGlError( "glVertexAttribPointer" );
-    
-    // Set active texture
-    glBindTexture( GL_TEXTURE_2D, gTextureHandlePNG );
-    
-    glDrawArrays( GL_TRIANGLES, 0, 6 );
-
-    // ETC //////////////////////////////////////////////////////////////////////////////////////////////////////
-    
-    // Set vertex position
-    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesETC );
-    CheckGlError( "glVertexAttribPointer");
-    
-    // Set vertex texture coordinates
-    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesETC + sizeof(float)*2 );
-    CheckGlError( "glVertexAttribPointer");
-    
-    // Set active texture
-    glBindTexture( GL_TEXTURE_2D, gTextureHandleETC );
-
-    glDrawArrays( GL_TRIANGLES, 0, 6 );
-
-    // ETC2 //////////////////////////////////////////////////////////////////////////////////////////////////////
-    
-    // Set vertex position
-    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesETC2 );
-    CheckGlError( "glVertexAttribPointer");
-    
-    // Set vertex texture coordinates
-    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesETC2 + sizeof(float)*2 );
-    CheckGlError( "glVertexAttribPointer");
-    
-    // Set active texture
-    glBindTexture( GL_TEXTURE_2D, gTextureHandleETC2 );
-
-    glDrawArrays( GL_TRIANGLES, 0, 6 );
-
-    // PVRTC //////////////////////////////////////////////////////////////////////////////////////////////////////
-    
-    // Set vertex position
-    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesPVRTC );
-    CheckGlError( "glVertexAttribPointer" );
-    
-    // Set vertex texture coordinates
-    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesPVRTC + sizeof(float)*2 );
-    CheckGlError( "glVertexAttribPointer" );
-    
-    // Set active texture
-    glBindTexture( GL_TEXTURE_2D, gTextureHandlePVRTC );
-    
-    glDrawArrays( GL_TRIANGLES, 0, 6) ;
-
-    // S3TC //////////////////////////////////////////////////////////////////////////////////////////////////////
-    
-    // Set vertex position
-    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesS3TC );
-    CheckGlError( "glVertexAttribPointer" );
-    
-    // Set vertex texture coordinates
-    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesS3TC + sizeof(float)*2 );
-    CheckGlError( "glVertexAttribPointer" );
-    
-    // Set active texture
-    glBindTexture( GL_TEXTURE_2D, gTextureHandleS3TC );
-
-    glDrawArrays( GL_TRIANGLES, 0, 6 );
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// JNI helper functions
-JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_initGraphics( JNIEnv * env, jobject obj,  jint width, jint height )
-{
-    Init( width, height );
-}
-
-JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_drawFrame( JNIEnv * env, jobject obj )
-{
-    Render();
-}
-
-JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_createAssetManager(JNIEnv* env, jobject obj, jobject assetManager)
-{
-    AAssetManager* mgr = AAssetManager_fromJava( env, assetManager );
-    
-    // Store the assest manager for future use.
-    SetAssetManager( mgr );   
-}
-
-
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <assert.h>
+#include <jni.h>
+#include <sys/types.h>
+#include <android/asset_manager.h>
+#include <android/asset_manager_jni.h>
+#include <android/log.h>
+
+#include <GLES3/gl3.h>
+#include <GLES3/gl3ext.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "dispatch.h"
+#include "file.h"
+#include "gl_state.h"
+#include "loader_thread.h"
+#include "texture.h"
+#include "texture_cache.h"
+#include "texture_memory.h"
+#include "texture_residency.h"
+#include "upload.h"
+#include "upload_scheduler.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Debugging helper functions
+#define  Log(...)  __android_log_print( ANDROID_LOG_INFO, "TextureLoader", __VA_ARGS__ )
+#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
+
+static void CheckGlError( const char* pFunctionName ) 
+{
+    GLint error = glGetError();
+    if( error != GL_NO_ERROR ) 
+    {
+        LogError( "%s returned glError 0x%x\n", pFunctionName, error );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Simple geometry data to render textured quads
+typedef struct
+{
+    float x;
+    float y;
+    float u;
+    float v;
+    
+} TriangleVertex;
+
+TriangleVertex gTriangleVerticesPNG[] =     { { -0.6f,  1.0f, 0.2f, 0.0f  },
+                                            {   -1.0f, -1.0f, 0.0f,  1.0f  },
+                                            {   -0.6f, -1.0f, 0.2f, 1.0f  },
+                                            {   -1.0f,  1.0f, 0.0f,  0.0f  },
+                                            {   -1.0f, -1.0f, 0.0f,  1.0f  },
+                                            {   -0.6f,  1.0f, 0.2f, 0.0f  } }; 
+                                           
+TriangleVertex gTriangleVerticesETC[] =     { { -0.2f,  1.0f, 0.4f,  0.0f  },
+                                            {   -0.6f, -1.0f, 0.2f, 1.0f  },
+                                            {   -0.2f, -1.0f, 0.4f,  1.0f  },
+                                            {   -0.6f,  1.0f, 0.2f, 0.0f  },
+                                            {   -0.6f, -1.0f, 0.2f, 1.0f  },
+                                            {   -0.2f,  1.0f, 0.4f,  0.0f  } };
+
+TriangleVertex gTriangleVerticesETC2[] =     { { 0.2f,  1.0f, 0.6f,  0.0f  },
+                                            {   -0.2f, -1.0f, 0.4f, 1.0f  },
+                                            {    0.2f, -1.0f, 0.6f,  1.0f  },
+                                            {   -0.2f,  1.0f, 0.4f, 0.0f  },
+                                            {   -0.2f, -1.0f, 0.4f, 1.0f  },
+                                            {    0.2f,  1.0f, 0.6f,  0.0f  } };
+
+TriangleVertex gTriangleVerticesPVRTC[] =   { {  0.6f,  1.0f, 0.8f, 0.0f  },
+                                            {    0.2f, -1.0f, 0.6f,  1.0f  },
+                                            {    0.6f, -1.0f, 0.8f, 1.0f  },
+                                            {    0.2f,  1.0f, 0.6f,  0.0f  },
+                                            {    0.2f, -1.0f, 0.6f,  1.0f  },
+                                            {    0.6f,  1.0f, 0.8f, 0.0f  } }; 
+                                           
+TriangleVertex gTriangleVerticesS3TC[] =    { {  1.0f,  1.0f, 1.0f,  0.0f  },
+                                            {    0.6f, -1.0f, 0.8f, 1.0f  },
+                                            {    1.0f, -1.0f, 1.0f,  1.0f  },
+                                            {    0.6f,  1.0f, 0.8f, 0.0f  },
+                                            {    0.6f, -1.0f, 0.8f, 1.0f  },
+                                            {    1.0f,  1.0f, 1.0f,  0.0f  } }; 
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Simple vertex shader
+static const char gVertexShader[] = 
+    "attribute vec4 aPosition;  \n"
+    "attribute vec2 aTexCoord;  \n"
+    "varying vec2 vTexCoord;    \n"
+    "void main()                \n"
+    "{                          \n"
+    "  vTexCoord = aTexCoord;   \n"
+    "  gl_Position = aPosition; \n"
+    "}                          \n";
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Simple pixel (aka Fragment) shader
+static const char gPixelShader[] = 
+    "precision mediump float;                          \n"
+    "varying vec2 vTexCoord;                           \n"
+    "uniform sampler2D sTexture;                       \n"
+    "void main()                                       \n"
+    "{                                                 \n"
+    "  gl_FragColor = texture2D(sTexture, vTexCoord);  \n"
+    "}                                                 \n";
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CompileShader - Compiles the passed in string for the given shaderType
+GLuint CompileShader( GLenum shaderType, const char* pSource ) 
+{
+    // Create a shader handle
+    GLuint shaderHandle = glCreateShader( shaderType );
+
+    if( shaderHandle ) 
+    {
+        // Set the shader source
+        glShaderSource( shaderHandle, 1, &pSource, NULL );
+
+        // Compile the shader
+        glCompileShader( shaderHandle );
+
+        // Check the compile status
+        GLint compileStatus = 0;
+        glGetShaderiv( shaderHandle, GL_COMPILE_STATUS, &compileStatus );
+
+        if( !compileStatus ) 
+        {
+            // There was an error, print it out
+            GLint infoLogLength = 0;
+            glGetShaderiv( shaderHandle, GL_INFO_LOG_LENGTH, &infoLogLength );
+
+            if( infoLogLength > 1 ) 
+            {
+                char* pShaderInfoLog = (char*)malloc( infoLogLength );
+                if( pShaderInfoLog ) 
+                {
+                    glGetShaderInfoLog( shaderHandle, infoLogLength, NULL, pShaderInfoLog );
+                    LogError( "Error compiling shader: \n%s", pShaderInfoLog );
+                    free( pShaderInfoLog );
+                }
+
+                // Free the handle
+                glDeleteShader( shaderHandle );
+                shaderHandle = 0;
+            }
+        }
+    }
+
+    return shaderHandle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// createProgram - Creates a new program with the given vertex and pixel shader
+GLuint createProgram( const char* pVertexSource, const char* pPixelSource ) 
+{
+    // Compile the vertex shader
+    GLuint vertexShaderHandle = CompileShader( GL_VERTEX_SHADER, pVertexSource );
+    GLuint pixelShaderHandle  = CompileShader( GL_FRAGMENT_SHADER, pPixelSource );
+
+    if( !vertexShaderHandle || !pixelShaderHandle )
+    {
+        return 0;
+    }
+
+    // Create a new handle for this program
+    GLuint programHandle = glCreateProgram();
+
+    // Link and finish the program
+    if( programHandle ) 
+    {
+        // Set the vertex shader for this program
+        glAttachShader( programHandle, vertexShaderHandle );
+        CheckGlError( "glAttachShader" );
+
+        // Set the pixel shader for this program
+        glAttachShader( programHandle, pixelShaderHandle );
+        CheckGlError( "glAttachShader" );
+
+        // Link the program
+        glLinkProgram( programHandle );
+
+        // Check the link status
+        GLint linkStatus = 0;
+        glGetProgramiv( programHandle, GL_LINK_STATUS, &linkStatus );
+
+        if( !linkStatus ) 
+        {
+            // There was an error, print it out
+            GLint infoLogLength = 0;
+            glGetProgramiv( programHandle, GL_INFO_LOG_LENGTH, &infoLogLength );
+
+            if( infoLogLength ) 
+            {
+                char* pInfoLog = (char*)malloc( infoLogLength );
+                if( pInfoLog ) 
+                {
+                    glGetProgramInfoLog( programHandle, infoLogLength, NULL, pInfoLog );
+                    LogError( "Error linking the program: \n%s", pInfoLog );
+                    free( pInfoLog );
+                }
+            }
+
+            // Free the handle
+            glDeleteProgram( programHandle );
+            programHandle = 0;
+        }
+    }
+
+    return programHandle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Init - Called from Java-side to setup the graphics on the native-side 
+GLuint gProgramHandle;
+GLuint gaPositionHandle;
+GLuint gaTexCoordHandle;
+GLuint gaTexSamplerHandle;
+
+GLuint gTextureHandlePNG;
+GLuint gTextureHandleUnsupported;
+GLuint gTextureHandleETC;
+GLuint gTextureHandleETC2;
+GLuint gTextureHandlePVRTC;
+GLuint gTextureHandleS3TC;
+
+// Time Render gives the upload scheduler each frame
+unsigned int gUploadBudgetMicroseconds = 2000;
+
+void Init( int width, int height ) 
+{
+    // A new context, nothing the GL state cache knew of the old one holds
+    ResetGlStateCache();
+
+    // Init the shaders
+    gProgramHandle = createProgram( gVertexShader, gPixelShader );
+    if( !gProgramHandle ) 
+    {
+        LogError( "Could not create program." );
+        assert(0);
+    }
+    
+    // Read attribute locations from the program
+    gaPositionHandle = glGetAttribLocation( gProgramHandle, "aPosition" );
+    CheckGlError( "glGetAttribLocation" );
+
+    gaTexCoordHandle = glGetAttribLocation( gProgramHandle, "aTexCoord" );
+    CheckGlError( "glGetAttribLocation" );
+    
+    gaTexSamplerHandle = glGetUniformLocation( gProgramHandle, "sTexture" );
+    CheckGlError( "glGetUnitformLocation" );
+
+    // The sampler reads texture unit 0, which the program remembers
+    CachedUseProgram( gProgramHandle );
+    glUniform1i( gaTexSamplerHandle, 0 );
+    CheckGlError( "glUniform1i" );
+
+    // Set up viewport
+    glViewport( 0, 0, width, height ) ;
+    CheckGlError( "glViewport" );
+
+    // Init runs again for a new context after the old one is lost, and so does the thread sharing
+    // with it. The old context took its textures with it: the thread is stopped before it registers
+    // any more, then everything kept of them is forgotten.
+    StopLoaderThread();
+    ResetUploadScheduler();
+    ResetTextureMemory();
+    ResetTextureResidency();
+    ResetTextureCache();
+
+    // Load the small placeholder now, every other texture shows it until the loader thread has
+    // loaded it, so the first frame doesn't wait for them. They all share the one texture.
+    gTextureHandleUnsupported = AcquireTexture( "tex_bw.png", LoadTexturePNGEx, NULL );
+    gTextureHandlePNG = AcquireTexture( "tex_bw.png", LoadTexturePNGEx, NULL );
+    gTextureHandleETC = AcquireTexture( "tex_bw.png", LoadTexturePNGEx, NULL );
+    gTextureHandleETC2 = AcquireTexture( "tex_bw.png", LoadTexturePNGEx, NULL );
+    gTextureHandlePVRTC = AcquireTexture( "tex_bw.png", LoadTexturePNGEx, NULL );
+    gTextureHandleS3TC = AcquireTexture( "tex_bw.png", LoadTexturePNGEx, NULL );
+
+    SetResidencyViewport( width, height );
+    if( !StartLoaderThread() )
+    {
+        LogError( "No loader thread, textures are loaded on the render thread" );
+    }
+
+    // Load textures, each keeping the mip levels its quad needs on screen. Their larger levels are
+    // uploaded a little every frame, and those in KTX, PVR and DDS files read from them as they go,
+    // smallest first
+    TextureOptions options;
+    memset( &options, 0, sizeof(options) );
+    options.mDeferUpload = 1;
+    options.mStreamLevels = 1;
+    ManageTextureResidency( "tex_png.png", LoadTexturePNGEx, &options, &gTextureHandlePNG );
+    if( IsETCSupported() )
+    {
+        ManageTextureResidency( "tex_etc1.ktx", LoadTextureETC_KTXEx, &options, &gTextureHandleETC );
+    }
+    if( IsETC2Supported() )
+    {
+        ManageTextureResidency( "tex_etc2.ktx", LoadTextureETC_KTXEx, &options, &gTextureHandleETC2 );
+    }
+    if( IsPVRTCSupported() )
+    {
+        ManageTextureResidency( "tex_pvr.pvr", LoadTexturePVRTCEx, &options, &gTextureHandlePVRTC );
+    }
+    if( IsS3TCSupported() )
+    {
+        ManageTextureResidency( "tex_s3tc.dds", LoadTextureS3TCEx, &options, &gTextureHandleS3TC );
+    }
+
+    // The render thread's upload ring isn't needed again until the next time, the loader thread
+    // has a ring of its own
+    ShutdownUploadRing();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Render - Called from Java-side to render a frame
+void Render() 
+{
+    // Swap in the textures the loader thread has finished, fit them to what the last frame drew
+    // them at, and upload some more of their levels
+    PublishLoadedTextures();
+    UpdateTextureResidency();
+    RunScheduledUploads( gUploadBudgetMicroseconds );
+
+    // Set the clear color
+    glClearColor( 0.8f, 0.7f, 0.6f, 1.0f);
+    CheckGlError( "glClearColor" );
+
+    // Clear the color and depth buffer 
+    glClear( GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    CheckGlError( "glClear" );
+    
+    // Select vertex/pixel shader, these only reach GL when they change (see gl_state.h)
+    CachedUseProgram( gProgramHandle );
+    CheckGlError( "glUseProgram" );
+    
+    // Enable vertex
+    CachedEnableVertexAttribArray( gaPositionHandle );
+    CheckGlError( "glEnableVertexAttribArray" );
+    
+    // Enable tex coords
+    CachedEnableVertexAttribArray( gaTexCoordHandle );
+    CheckGlError( "glEnableVertexAttribArray" );
+ 
+    // Set texture sampler
+    CachedActiveTexture( GL_TEXTURE0 );
+    
+    // PNG //////////////////////////////////////////////////////////////////////////////////////////////////////
+            
+    // Set vertex position
+    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesPNG );
+    CheckGlError( "glVertexAttribPointer" );
+    
+    // Set vertex texture coordinates
+    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesPNG + sizeof(float)*2 );
+    CheckGlError( "glVertexAttribPointer" );
+    
+    // Set active texture
+    BindResidentTexture( &gTextureHandlePNG );
+    ReportTextureFootprint( &gTextureHandlePNG, &gTriangleVerticesPNG[0].x, &gTriangleVerticesPNG[0].u, sizeof(TriangleVertex), 6 );
+    
+    glDrawArrays( GL_TRIANGLES, 0, 6 );
+
+    // ETC //////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    // Set vertex position
+    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesETC );
+    CheckGlError( "glVertexAttribPointer");
+    
+    // Set vertex texture coordinates
+    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesETC + sizeof(float)*2 );
+    CheckGlError( "glVertexAttribPointer");
+    
+    // Set active texture
+    BindResidentTexture( &gTextureHandleETC );
+    ReportTextureFootprint( &gTextureHandleETC, &gTriangleVerticesETC[0].x, &gTriangleVerticesETC[0].u, sizeof(TriangleVertex), 6 );
+
+    glDrawArrays( GL_TRIANGLES, 0, 6 );
+
+    // ETC2 //////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    // Set vertex position
+    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesETC2 );
+    CheckGlError( "glVertexAttribPointer");
+    
+    // Set vertex texture coordinates
+    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesETC2 + sizeof(float)*2 );
+    CheckGlError( "glVertexAttribPointer");
+    
+    // Set active texture
+    BindResidentTexture( &gTextureHandleETC2 );
+    ReportTextureFootprint( &gTextureHandleETC2, &gTriangleVerticesETC2[0].x, &gTriangleVerticesETC2[0].u, sizeof(TriangleVertex), 6 );
+
+    glDrawArrays( GL_TRIANGLES, 0, 6 );
+
+    // PVRTC //////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    // Set vertex position
+    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesPVRTC );
+    CheckGlError( "glVertexAttribPointer" );
+    
+    // Set vertex texture coordinates
+    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesPVRTC + sizeof(float)*2 );
+    CheckGlError( "glVertexAttribPointer" );
+    
+    // Set active texture
+    BindResidentTexture( &gTextureHandlePVRTC );
+    ReportTextureFootprint( &gTextureHandlePVRTC, &gTriangleVerticesPVRTC[0].x, &gTriangleVerticesPVRTC[0].u, sizeof(TriangleVertex), 6 );
+    
+    glDrawArrays( GL_TRIANGLES, 0, 6) ;
+
+    // S3TC //////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    // Set vertex position
+    glVertexAttribPointer( gaPositionHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), gTriangleVerticesS3TC );
+    CheckGlError( "glVertexAttribPointer" );
+    
+    // Set vertex texture coordinates
+    glVertexAttribPointer( gaTexCoordHandle, 2, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), (char*)gTriangleVerticesS3TC + sizeof(float)*2 );
+    CheckGlError( "glVertexAttribPointer" );
+    
+    // Set active texture
+    BindResidentTexture( &gTextureHandleS3TC );
+    ReportTextureFootprint( &gTextureHandleS3TC, &gTriangleVerticesS3TC[0].x, &gTriangleVerticesS3TC[0].u, sizeof(TriangleVertex), 6 );
+
+    glDrawArrays( GL_TRIANGLES, 0, 6 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JNI helper functions
+JNIEXPORT jint JNICALL JNI_OnLoad( JavaVM* vm, void* reserved )
+{
+    // Detect the CPU and bind the SIMD kernels once, before any texture is loaded
+    InitKernelDispatch();
+    return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_initGraphics( JNIEnv * env, jobject obj,  jint width, jint height )
+{
+    Init( width, height );
+}
+
+JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_drawFrame( JNIEnv * env, jobject obj )
+{
+    Render();
+}
+
+JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_createAssetManager(JNIEnv* env, jobject obj, jobject assetManager)
+{
+    AAssetManager* mgr = AAssetManager_fromJava( env, assetManager );
+    
+    // Store the assest manager for future use.
+    SetAssetManager( mgr );   
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_intel_textureloader_TextureLoaderLib_getTextureMemoryTotals( JNIEnv* env, jobject obj )
+{
+    TextureMemoryTotals totals;
+    jlong values[6];
+    jlongArray result;
+
+    // Laid out as the MEMORY_* indices of TextureLoaderLib
+    GetTextureMemoryTotals( &totals );
+    values[0] = totals.mTextureCount;
+    values[1] = totals.mGpuBytes;
+    values[2] = totals.mPeakGpuBytes;
+    values[3] = totals.mCpuPeakBytes;
+    values[4] = totals.mSourceBytes;
+    values[5] = totals.mGpuBudget;
+
+    result = (*env)->NewLongArray( env, 6 );
+    if( result != NULL )
+    {
+        (*env)->SetLongArrayRegion( env, result, 0, 6, values );
+    }
+    return result;
+}
+
+JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_setTextureMemoryBudget( JNIEnv* env, jobject obj, jlong bytes )
+{
+    SetTextureMemoryBudget( bytes > 0 ? (size_t)bytes : 0 );
+}
+
+JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_setTextureResolutionCap( JNIEnv* env, jobject obj, jint maxDimension,
+                                                                                             jint skipMipLevels )
+{
+    SetTextureResolutionCap( maxDimension > 0 ? maxDimension : 0, skipMipLevels > 0 ? skipMipLevels : 0 );
+}
+
+JNIEXPORT void JNICALL Java_com_intel_textureloader_TextureLoaderLib_setUploadBudget( JNIEnv* env, jobject obj, jint microseconds )
+{
+    gUploadBudgetMicroseconds = microseconds > 0 ? (unsigned int)microseconds : 0;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_intel_textureloader_TextureLoaderLib_getUploadStats( JNIEnv* env, jobject obj )
+{
+    UploadRingStats stats;
+    jlong values[7];
+    jlongArray result;
+
+    // Laid out as the UPLOAD_* indices of TextureLoaderLib
+    GetUploadRingStats( &stats );
+    values[0] = stats.mBytes;
+    values[1] = stats.mIssueNanoseconds > 0 ? (jlong)( stats.mBytes * 1000000000.0 / stats.mIssueNanoseconds ) : 0;
+    values[2] = stats.mUploads;
+    values[3] = stats.mStalls;
+    values[4] = stats.mStallNanoseconds;
+    values[5] = stats.mFallbacks;
+    values[6] = stats.mBufferBytes;
+
+    result = (*env)->NewLongArray( env, 7 );
+    if( result != NULL )
+    {
+        (*env)->SetLongArrayRegion( env, result, 0, 7, values );
+    }
+    return result;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_intel_textureloader_TextureLoaderLib_getResidencyStats( JNIEnv* env, jobject obj )
+{
+    ResidencyStats stats;
+    jlong values[7];
+    jlongArray result;
+
+    // Laid out as the RESIDENCY_* indices of TextureLoaderLib
+    GetResidencyStats( &stats );
+    values[0] = stats.mFrame;
+    values[1] = stats.mManagedCount;
+    values[2] = stats.mResidentCount;
+    values[3] = stats.mResidentBytes;
+    values[4] = stats.mEvictions;
+    values[5] = stats.mLevelDrops;
+    values[6] = stats.mReloads;
+
+    result = (*env)->NewLongArray( env, 7 );
+    if( result != NULL )
+    {
+        (*env)->SetLongArrayRegion( env, result, 0, 7, values );
+    }
+    return result;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_intel_textureloader_TextureLoaderLib_getGlStateStats( JNIEnv* env, jobject obj )
+{
+    GlStateStats stats;
+    jlong values[2];
+    jlongArray result;
+
+    // Laid out as the GL_STATE_* indices of TextureLoaderLib
+    GetGlStateStats( &stats );
+    values[0] = stats.mIssued;
+    values[1] = stats.mSkipped;
+
+    result = (*env)->NewLongArray( env, 2 );
+    if( result != NULL )
+    {
+        (*env)->SetLongArrayRegion( env, result, 0, 2, values );
+    }
+    return result;
+}
@@ -0,0 +1,195 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <unistd.h>
+#include <android/log.h>
+
+#include "jobs.h"
+
+// Upper bound on the pool size, the loaders don't scale past this
+#define MAX_WORKERS 8
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Debugging helper functions
+#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
+
+// One ParallelFor call. It lives on the caller's stack, so workers only touch it while holding
+// gJobMutex and never after they have reported their last index as done.
+typedef struct ParallelJob
+{
+    ParallelTask        pTask;
+    void*               pUser;
+    int                 mCount;
+    int                 mNext;      // next index to hand out
+    int                 mDone;      // indices that have completed
+    struct ParallelJob* pNext;      // next job in gpJobQueue
+} ParallelJob;
+
+static pthread_once_t   gWorkersOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t  gJobMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   gJobAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t   gJobFinished = PTHREAD_COND_INITIALIZER;
+static ParallelJob*     gpJobQueue = NULL;  // jobs that still have indices to hand out
+static int              gWorkerCount = 1;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ClaimIndex - hands out the next index of pJob, dequeueing it once the last one is taken.
+// gJobMutex must be held.
+static int ClaimIndex( ParallelJob* pJob )
+{
+    int index = pJob->mNext++;
+
+    if( pJob->mNext == pJob->mCount )
+    {
+        ParallelJob** ppJob = &gpJobQueue;
+        while( *ppJob != pJob )
+        {
+            ppJob = &( *ppJob )->pNext;
+        }
+        *ppJob = pJob->pNext;
+    }
+    return index;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RunIndex - runs one index of pJob with gJobMutex released, then reports it as done
+static void RunIndex( ParallelJob* pJob, int index )
+{
+    pthread_mutex_unlock( &gJobMutex );
+    pJob->pTask( pJob->pUser, index );
+    pthread_mutex_lock( &gJobMutex );
+
+    if( ++pJob->mDone == pJob->mCount )
+    {
+        pthread_cond_broadcast( &gJobFinished );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WorkerThread - pulls indices off the oldest queued job forever
+static void* WorkerThread( void* pArg )
+{
+    (void)pArg;
+
+    pthread_mutex_lock( &gJobMutex );
+    for( ;; )
+    {
+        ParallelJob* pJob;
+        while( gpJobQueue == NULL )
+        {
+            pthread_cond_wait( &gJobAvailable, &gJobMutex );
+        }
+        pJob = gpJobQueue;
+        RunIndex( pJob, ClaimIndex( pJob ) );
+    }
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// StartWorkers - creates one worker per additional core
+static void StartWorkers()
+{
+    long cores = sysconf( _SC_NPROCESSORS_CONF );
+    int i;
+
+    if( cores > MAX_WORKERS )
+    {
+        cores = MAX_WORKERS;
+    }
+    for( i = 1; i < cores; ++i )
+    {
+        pthread_t thread;
+        if( pthread_create( &thread, NULL, WorkerThread, NULL ) != 0 )
+        {
+            LogError( "Failed to start worker thread %d", i );
+            break;
+        }
+        pthread_detach( thread );
+        ++gWorkerCount;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ParallelFor - runs pTask for every index in [0, count) and waits for completion
+//
+// The caller works on its own job instead of blocking, which keeps nested calls from a task
+// deadlock free: every index it waits on has been claimed by a thread that is running it.
+void ParallelFor( int count, ParallelTask pTask, void* pUser )
+{
+    ParallelJob job;
+    ParallelJob** ppTail;
+
+    pthread_once( &gWorkersOnce, StartWorkers );
+
+    if( count <= 1 || gWorkerCount == 1 )
+    {
+        int i;
+        for( i = 0; i < count; ++i )
+        {
+            pTask( pUser, i );
+        }
+        return;
+    }
+
+    job.pTask = pTask;
+    job.pUser = pUser;
+    job.mCount = count;
+    job.mNext = 0;
+    job.mDone = 0;
+    job.pNext = NULL;
+
+    pthread_mutex_lock( &gJobMutex );
+
+    ppTail = &gpJobQueue;
+    while( *ppTail != NULL )
+    {
+        ppTail = &( *ppTail )->pNext;
+    }
+    *ppTail = &job;
+    pthread_cond_broadcast( &gJobAvailable );
+
+    while( job.mNext < job.mCount )
+    {
+        RunIndex( &job, ClaimIndex( &job ) );
+    }
+    while( job.mDone < job.mCount )
+    {
+        pthread_cond_wait( &gJobFinished, &gJobMutex );
+    }
+
+    pthread_mutex_unlock( &gJobMutex );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetWorkerCount - number of threads ParallelFor uses, including the caller
+int GetWorkerCount()
+{
+    pthread_once( &gWorkersOnce, StartWorkers );
+    return gWorkerCount;
+}
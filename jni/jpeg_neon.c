@@ -0,0 +1,364 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// NEON kernels - only built for armeabi-v7a (compiled with -mfpu=neon through the .neon suffix
+// in Android.mk) and only called when the CPU reports NEON support at runtime
+
+#include <arm_neon.h>
+
+#include "jpeg_simd.h"
+
+#define F2F(x)          ( (int)( ( (x) * 4096 + 0.5 ) ) )
+#define FLOAT2FIXED(x)  ( (int)( ( (x) * 65536 + 0.5 ) ) )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IdctBlockNEON - dequantize + 8x8 integer IDCT
+//
+// Same arithmetic as stb_image's idct_block. The +512 rounding of the column pass is done by
+// vrshrn, and the +128 level shift is folded into the DC coefficient. vrshrn only shifts up to 16,
+// so the row pass shifts by 16 and then does a rounding, saturating shift by 1 on the way to 8
+// bits, which is exactly ( x + 65536 ) >> 17.
+#define IDCT_LONG_MUL(out, inq, coeff) \
+    int32x4_t out##Lo = vmull_s16( vget_low_s16( inq ), coeff ); \
+    int32x4_t out##Hi = vmull_s16( vget_high_s16( inq ), coeff )
+
+#define IDCT_LONG_MAC(out, acc, inq, coeff) \
+    int32x4_t out##Lo = vmlal_s16( acc##Lo, vget_low_s16( inq ), coeff ); \
+    int32x4_t out##Hi = vmlal_s16( acc##Hi, vget_high_s16( inq ), coeff )
+
+#define IDCT_WIDEN(out, inq) \
+    int32x4_t out##Lo = vshll_n_s16( vget_low_s16( inq ), 12 ); \
+    int32x4_t out##Hi = vshll_n_s16( vget_high_s16( inq ), 12 )
+
+#define IDCT_WADD(out, a, b) \
+    int32x4_t out##Lo = vaddq_s32( a##Lo, b##Lo ); \
+    int32x4_t out##Hi = vaddq_s32( a##Hi, b##Hi )
+
+#define IDCT_WSUB(out, a, b) \
+    int32x4_t out##Lo = vsubq_s32( a##Lo, b##Lo ); \
+    int32x4_t out##Hi = vsubq_s32( a##Hi, b##Hi )
+
+#define IDCT_BFLY(out0, out1, a, b, shiftop, s) \
+    { \
+        IDCT_WADD( sum, a, b ); \
+        IDCT_WSUB( dif, a, b ); \
+        out0 = vcombine_s16( shiftop( sumLo, s ), shiftop( sumHi, s ) ); \
+        out1 = vcombine_s16( shiftop( difLo, s ), shiftop( difHi, s ) ); \
+    }
+
+#define IDCT_PASS(shiftop, shift) \
+    { \
+        /* even part */ \
+        int16x8_t sum26 = vaddq_s16( row2, row6 ); \
+        IDCT_LONG_MUL( p1e, sum26, rot0_0 ); \
+        IDCT_LONG_MAC( t2e, p1e, row6, rot0_1 ); \
+        IDCT_LONG_MAC( t3e, p1e, row2, rot0_2 ); \
+        int16x8_t sum04 = vaddq_s16( row0, row4 ); \
+        int16x8_t dif04 = vsubq_s16( row0, row4 ); \
+        IDCT_WIDEN( t0e, sum04 ); \
+        IDCT_WIDEN( t1e, dif04 ); \
+        IDCT_WADD( x0, t0e, t3e ); \
+        IDCT_WSUB( x3, t0e, t3e ); \
+        IDCT_WADD( x1, t1e, t2e ); \
+        IDCT_WSUB( x2, t1e, t2e ); \
+        /* odd part */ \
+        int16x8_t sum15 = vaddq_s16( row1, row5 ); \
+        int16x8_t sum17 = vaddq_s16( row1, row7 ); \
+        int16x8_t sum35 = vaddq_s16( row3, row5 ); \
+        int16x8_t sum37 = vaddq_s16( row3, row7 ); \
+        int16x8_t sumOdd = vaddq_s16( sum17, sum35 ); \
+        IDCT_LONG_MUL( p5o, sumOdd, rot1_0 ); \
+        IDCT_LONG_MAC( p1o, p5o, sum17, rot1_1 ); \
+        IDCT_LONG_MAC( p2o, p5o, sum35, rot1_2 ); \
+        IDCT_LONG_MUL( p3o, sum37, rot2_0 ); \
+        IDCT_LONG_MUL( p4o, sum15, rot2_1 ); \
+        IDCT_WADD( sump13o, p1o, p3o ); \
+        IDCT_WADD( sump14o, p1o, p4o ); \
+        IDCT_WADD( sump23o, p2o, p3o ); \
+        IDCT_WADD( sump24o, p2o, p4o ); \
+        IDCT_LONG_MAC( x4, sump13o, row7, rot3_0 ); \
+        IDCT_LONG_MAC( x5, sump24o, row5, rot3_1 ); \
+        IDCT_LONG_MAC( x6, sump23o, row3, rot3_2 ); \
+        IDCT_LONG_MAC( x7, sump14o, row1, rot3_3 ); \
+        IDCT_BFLY( row0, row7, x0, x7, shiftop, shift ); \
+        IDCT_BFLY( row1, row6, x1, x6, shiftop, shift ); \
+        IDCT_BFLY( row2, row5, x2, x5, shiftop, shift ); \
+        IDCT_BFLY( row3, row4, x3, x4, shiftop, shift ); \
+    }
+
+#define TRN16(x, y)  { int16x8x2_t t = vtrnq_s16( x, y ); x = t.val[0]; y = t.val[1]; }
+#define TRN32(x, y)  { int32x4x2_t t = vtrnq_s32( vreinterpretq_s32_s16( x ), vreinterpretq_s32_s16( y ) ); \
+                       x = vreinterpretq_s16_s32( t.val[0] ); y = vreinterpretq_s16_s32( t.val[1] ); }
+#define TRN64(x, y)  { int16x8_t x0 = x; int16x8_t y0 = y; \
+                       x = vcombine_s16( vget_low_s16( x0 ), vget_low_s16( y0 ) ); \
+                       y = vcombine_s16( vget_high_s16( x0 ), vget_high_s16( y0 ) ); }
+
+#define TRN8_8(x, y)   { uint8x8x2_t t = vtrn_u8( x, y ); x = t.val[0]; y = t.val[1]; }
+#define TRN8_16(x, y)  { uint16x4x2_t t = vtrn_u16( vreinterpret_u16_u8( x ), vreinterpret_u16_u8( y ) ); \
+                         x = vreinterpret_u8_u16( t.val[0] ); y = vreinterpret_u8_u16( t.val[1] ); }
+#define TRN8_32(x, y)  { uint32x2x2_t t = vtrn_u32( vreinterpret_u32_u8( x ), vreinterpret_u32_u8( y ) ); \
+                         x = vreinterpret_u8_u32( t.val[0] ); y = vreinterpret_u8_u32( t.val[1] ); }
+
+void IdctBlockNEON( stbi_uc* pOut, int outStride, short pData[64], unsigned short* pDequantize )
+{
+    int16x8_t row0, row1, row2, row3, row4, row5, row6, row7;
+
+    const int16x4_t rot0_0 = vdup_n_s16( F2F( 0.5411961f ) );
+    const int16x4_t rot0_1 = vdup_n_s16( F2F( -1.847759065f ) );
+    const int16x4_t rot0_2 = vdup_n_s16( F2F( 0.765366865f ) );
+    const int16x4_t rot1_0 = vdup_n_s16( F2F( 1.175875602f ) );
+    const int16x4_t rot1_1 = vdup_n_s16( F2F( -0.899976223f ) );
+    const int16x4_t rot1_2 = vdup_n_s16( F2F( -2.562915447f ) );
+    const int16x4_t rot2_0 = vdup_n_s16( F2F( -1.961570560f ) );
+    const int16x4_t rot2_1 = vdup_n_s16( F2F( -0.390180644f ) );
+    const int16x4_t rot3_0 = vdup_n_s16( F2F( 0.298631336f ) );
+    const int16x4_t rot3_1 = vdup_n_s16( F2F( 2.053119869f ) );
+    const int16x4_t rot3_2 = vdup_n_s16( F2F( 3.072711026f ) );
+    const int16x4_t rot3_3 = vdup_n_s16( F2F( 1.501321110f ) );
+
+    // Load and dequantize
+    row0 = vmulq_s16( vld1q_s16( pData + 0 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 0 * 8 ) ) );
+    row1 = vmulq_s16( vld1q_s16( pData + 1 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 1 * 8 ) ) );
+    row2 = vmulq_s16( vld1q_s16( pData + 2 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 2 * 8 ) ) );
+    row3 = vmulq_s16( vld1q_s16( pData + 3 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 3 * 8 ) ) );
+    row4 = vmulq_s16( vld1q_s16( pData + 4 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 4 * 8 ) ) );
+    row5 = vmulq_s16( vld1q_s16( pData + 5 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 5 * 8 ) ) );
+    row6 = vmulq_s16( vld1q_s16( pData + 6 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 6 * 8 ) ) );
+    row7 = vmulq_s16( vld1q_s16( pData + 7 * 8 ), vreinterpretq_s16_u16( vld1q_u16( pDequantize + 7 * 8 ) ) );
+
+    // +128 level shift: 1024 on the DC term ends up as 128 << 17 before the final shift
+    row0 = vaddq_s16( row0, vsetq_lane_s16( 1024, vdupq_n_s16( 0 ), 0 ) );
+
+    // Column pass
+    IDCT_PASS( vrshrn_n_s32, 10 );
+
+    // 16-bit 8x8 transpose
+    TRN16( row0, row1 );
+    TRN16( row2, row3 );
+    TRN16( row4, row5 );
+    TRN16( row6, row7 );
+
+    TRN32( row0, row2 );
+    TRN32( row1, row3 );
+    TRN32( row4, row6 );
+    TRN32( row5, row7 );
+
+    TRN64( row0, row4 );
+    TRN64( row1, row5 );
+    TRN64( row2, row6 );
+    TRN64( row3, row7 );
+
+    // Row pass
+    IDCT_PASS( vshrn_n_s32, 16 );
+
+    {
+        // Round, clamp to 0..255 and narrow
+        uint8x8_t p0 = vqrshrun_n_s16( row0, 1 );
+        uint8x8_t p1 = vqrshrun_n_s16( row1, 1 );
+        uint8x8_t p2 = vqrshrun_n_s16( row2, 1 );
+        uint8x8_t p3 = vqrshrun_n_s16( row3, 1 );
+        uint8x8_t p4 = vqrshrun_n_s16( row4, 1 );
+        uint8x8_t p5 = vqrshrun_n_s16( row5, 1 );
+        uint8x8_t p6 = vqrshrun_n_s16( row6, 1 );
+        uint8x8_t p7 = vqrshrun_n_s16( row7, 1 );
+
+        // 8-bit 8x8 transpose
+        TRN8_8( p0, p1 );
+        TRN8_8( p2, p3 );
+        TRN8_8( p4, p5 );
+        TRN8_8( p6, p7 );
+
+        TRN8_16( p0, p2 );
+        TRN8_16( p1, p3 );
+        TRN8_16( p4, p6 );
+        TRN8_16( p5, p7 );
+
+        TRN8_32( p0, p4 );
+        TRN8_32( p1, p5 );
+        TRN8_32( p2, p6 );
+        TRN8_32( p3, p7 );
+
+        // Store
+        vst1_u8( pOut, p0 ); pOut += outStride;
+        vst1_u8( pOut, p1 ); pOut += outStride;
+        vst1_u8( pOut, p2 ); pOut += outStride;
+        vst1_u8( pOut, p3 ); pOut += outStride;
+        vst1_u8( pOut, p4 ); pOut += outStride;
+        vst1_u8( pOut, p5 ); pOut += outStride;
+        vst1_u8( pOut, p6 ); pOut += outStride;
+        vst1_u8( pOut, p7 );
+    }
+}
+
+#undef IDCT_LONG_MUL
+#undef IDCT_LONG_MAC
+#undef IDCT_WIDEN
+#undef IDCT_WADD
+#undef IDCT_WSUB
+#undef IDCT_BFLY
+#undef IDCT_PASS
+#undef TRN16
+#undef TRN32
+#undef TRN64
+#undef TRN8_8
+#undef TRN8_16
+#undef TRN8_32
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertStoreNEON - YCbCr->RGB(A) conversion of 8 pixels
+//
+// Splits the 16.16 constants into integer and fractional parts like the SSE2 version so the
+// result is bit-exact with the scalar code; the interleaved stores handle both 3 and 4 byte pixels.
+// cb and cr come in with the 128 bias already removed.
+static inline void ConvertStoreNEON( stbi_uc* pOut, int16x8_t y, int16x8_t cb, int16x8_t cr, int step )
+{
+    const int32x4_t round = vdupq_n_s32( 32768 );
+
+    // Fractional parts in 32 bits
+    int32x4_t rLo = vmlal_n_s16( round, vget_low_s16( cr ),  FLOAT2FIXED( 1.40200f ) - 65536 );
+    int32x4_t rHi = vmlal_n_s16( round, vget_high_s16( cr ), FLOAT2FIXED( 1.40200f ) - 65536 );
+    int32x4_t gLo = vmlal_n_s16( vmlal_n_s16( round, vget_low_s16( cr ),  65536 - FLOAT2FIXED( 0.71414f ) ), vget_low_s16( cb ),  -FLOAT2FIXED( 0.34414f ) );
+    int32x4_t gHi = vmlal_n_s16( vmlal_n_s16( round, vget_high_s16( cr ), 65536 - FLOAT2FIXED( 0.71414f ) ), vget_high_s16( cb ), -FLOAT2FIXED( 0.34414f ) );
+    int32x4_t bLo = vmlal_n_s16( round, vget_low_s16( cb ),  FLOAT2FIXED( 1.77200f ) - 131072 );
+    int32x4_t bHi = vmlal_n_s16( round, vget_high_s16( cb ), FLOAT2FIXED( 1.77200f ) - 131072 );
+
+    // Integer parts in 16 bits
+    int16x8_t r = vaddq_s16( vaddq_s16( y, cr ), vcombine_s16( vshrn_n_s32( rLo, 16 ), vshrn_n_s32( rHi, 16 ) ) );
+    int16x8_t g = vaddq_s16( vsubq_s16( y, cr ), vcombine_s16( vshrn_n_s32( gLo, 16 ), vshrn_n_s32( gHi, 16 ) ) );
+    int16x8_t b = vaddq_s16( vaddq_s16( y, vaddq_s16( cb, cb ) ), vcombine_s16( vshrn_n_s32( bLo, 16 ), vshrn_n_s32( bHi, 16 ) ) );
+
+    // Clamp to 0..255 and store interleaved
+    if( step == 4 )
+    {
+        uint8x8x4_t rgba;
+        rgba.val[0] = vqmovun_s16( r );
+        rgba.val[1] = vqmovun_s16( g );
+        rgba.val[2] = vqmovun_s16( b );
+        rgba.val[3] = vdup_n_u8( 255 );
+        vst4_u8( pOut, rgba );
+    }
+    else
+    {
+        uint8x8x3_t rgb;
+        rgb.val[0] = vqmovun_s16( r );
+        rgb.val[1] = vqmovun_s16( g );
+        rgb.val[2] = vqmovun_s16( b );
+        vst3_u8( pOut, rgb );
+    }
+}
+
+#define LOAD8_S16(p)    vreinterpretq_s16_u16( vmovl_u8( vld1_u8( p ) ) )
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// YCbCrToRGBRowNEON - YCbCr->RGB(A) conversion, 8 pixels per iteration
+void YCbCrToRGBRowNEON( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCb, const stbi_uc* pCr, int count, int step )
+{
+    const int16x8_t bias = vdupq_n_s16( 128 );
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        ConvertStoreNEON( pOut, LOAD8_S16( pY + i ), vsubq_s16( LOAD8_S16( pCb + i ), bias ), vsubq_s16( LOAD8_S16( pCr + i ), bias ), step );
+        pOut += 8 * step;
+    }
+
+    YCbCrToRGBRowScalar( pOut, pY + i, pCb + i, pCr + i, count - i, step );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UpsampleYCbCrToRGBRowNEON - chroma upsampling fused with YCbCr->RGB(A), 16 pixels per iteration
+//
+// Same split as the SSE2 version: T = 3*near + far (or 4*near), interior samples are
+// ( 3*T[i] + T[i-1 or i+1] + 8 ) >> 4 and the row ends go through the scalar path.
+static inline int16x8_t ChromaTNEON( const stbi_uc* pNear, const stbi_uc* pFar, int i )
+{
+    uint8x8_t nearRow = vld1_u8( pNear + i );
+    if( pFar == NULL )
+    {
+        return vreinterpretq_s16_u16( vshll_n_u8( nearRow, 2 ) );
+    }
+    return vreinterpretq_s16_u16( vmlal_u8( vmovl_u8( vld1_u8( pFar + i ) ), nearRow, vdup_n_u8( 3 ) ) );
+}
+
+static inline void UpsampleH2NEON( const stbi_uc* pNear, const stbi_uc* pFar, int i, int16x8_t* pLo, int16x8_t* pHi )
+{
+    const int16x8_t bias = vdupq_n_s16( 128 );
+    int16x8_t t3   = vmlaq_n_s16( vdupq_n_s16( 8 ), ChromaTNEON( pNear, pFar, i ), 3 );
+    int16x8_t even = vshrq_n_s16( vaddq_s16( t3, ChromaTNEON( pNear, pFar, i - 1 ) ), 4 );
+    int16x8_t odd  = vshrq_n_s16( vaddq_s16( t3, ChromaTNEON( pNear, pFar, i + 1 ) ), 4 );
+    int16x8x2_t zipped = vzipq_s16( even, odd );
+
+    *pLo = vsubq_s16( zipped.val[0], bias );
+    *pHi = vsubq_s16( zipped.val[1], bias );
+}
+
+void UpsampleYCbCrToRGBRowNEON( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCbNear, const stbi_uc* pCbFar,
+                                const stbi_uc* pCrNear, const stbi_uc* pCrFar, int wLores, int hs, int count, int step )
+{
+    int x = 0;
+
+    if( hs == 2 )
+    {
+        // Vectors cover lores samples [i, i+8) and read one sample on either side; the first and
+        // the last two samples have edge weights
+        int i = 1;
+        int head = count < 2 ? count : 2;
+
+        UpsampleYCbCrToRGBRowScalar( pOut, pY, pCbNear, pCbFar, pCrNear, pCrFar, wLores, hs, 0, head, step );
+
+        for( ; i + 8 <= wLores - 1; i += 8 )
+        {
+            int16x8_t cbLo, cbHi, crLo, crHi;
+            UpsampleH2NEON( pCbNear, pCbFar, i, &cbLo, &cbHi );
+            UpsampleH2NEON( pCrNear, pCrFar, i, &crLo, &crHi );
+
+            ConvertStoreNEON( pOut + 2 * i * step, LOAD8_S16( pY + 2 * i ), cbLo, crLo, step );
+            ConvertStoreNEON( pOut + ( 2 * i + 8 ) * step, LOAD8_S16( pY + 2 * i + 8 ), cbHi, crHi, step );
+        }
+        x = 2 * i > head ? 2 * i : head;
+    }
+    else
+    {
+        // Vertical only: ( 3*near + far + 2 ) >> 2
+        const int16x8_t bias = vdupq_n_s16( 128 );
+
+        for( ; x + 8 <= count; x += 8 )
+        {
+            int16x8_t cb = vsubq_s16( vrshrq_n_s16( ChromaTNEON( pCbNear, pCbFar, x ), 2 ), bias );
+            int16x8_t cr = vsubq_s16( vrshrq_n_s16( ChromaTNEON( pCrNear, pCrFar, x ), 2 ), bias );
+            ConvertStoreNEON( pOut + x * step, LOAD8_S16( pY + x ), cb, cr, step );
+        }
+    }
+
+    UpsampleYCbCrToRGBRowScalar( pOut + x * step, pY + x, pCbNear, pCbFar, pCrNear, pCrFar, wLores, hs, x, count, step );
+}
+
+#undef LOAD8_S16
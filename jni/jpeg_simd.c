@@ -0,0 +1,490 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cpu.h"
+#include "jobs.h"
+#include "jpeg_simd.h"
+
+// Fixed point helpers, identical to the ones stb_image uses so the results are bit-exact
+#define F2F(x)          ( (int)( ( (x) * 4096 + 0.5 ) ) )
+#define FLOAT2FIXED(x)  ( (int)( ( (x) * 65536 + 0.5 ) ) )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar YCbCr->RGB conversion, used for the tail of a row by the SIMD versions
+void YCbCrToRGBRowScalar( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCb, const stbi_uc* pCr, int count, int step )
+{
+    int i;
+    for( i = 0; i < count; ++i )
+    {
+        int yFixed = ( pY[i] << 16 ) + 32768;
+        int cr = pCr[i] - 128;
+        int cb = pCb[i] - 128;
+        int r = ( yFixed + cr * FLOAT2FIXED( 1.40200f ) ) >> 16;
+        int g = ( yFixed - cr * FLOAT2FIXED( 0.71414f ) - cb * FLOAT2FIXED( 0.34414f ) ) >> 16;
+        int b = ( yFixed + cb * FLOAT2FIXED( 1.77200f ) ) >> 16;
+
+        pOut[0] = (stbi_uc)( r < 0 ? 0 : ( r > 255 ? 255 : r ) );
+        pOut[1] = (stbi_uc)( g < 0 ? 0 : ( g > 255 ? 255 : g ) );
+        pOut[2] = (stbi_uc)( b < 0 ? 0 : ( b > 255 ? 255 : b ) );
+        if( step == 4 )
+        {
+            pOut[3] = 255;
+        }
+        pOut += step;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UpsampleChroma - one chroma sample of an upsampled row, exactly as stb_image's resample_row_h_2
+// (hs 2, no far row), resample_row_v_2 (hs 1) and resample_row_hv_2 (hs 2) compute it
+static int UpsampleChroma( const stbi_uc* pNear, const stbi_uc* pFar, int wLores, int hs, int x )
+{
+#define T(i)    ( pFar ? 3 * pNear[i] + pFar[i] : 4 * pNear[i] )
+    int i = x >> 1;
+    int value;
+
+    if( hs == 1 )
+    {
+        value = ( T( x ) + 2 ) >> 2;
+    }
+    else if( wLores == 1 || x == 0 || x == 2 * wLores - 1 )
+    {
+        value = ( T( i ) + 2 ) >> 2;
+    }
+    else if( pFar == NULL && x == 2 * wLores - 2 )
+    {
+        // resample_row_h_2 weights the last even sample towards its left neighbour
+        value = ( 3 * pNear[wLores - 2] + pNear[wLores - 1] + 2 ) >> 2;
+    }
+    else
+    {
+        value = ( 3 * T( i ) + T( ( x & 1 ) ? i + 1 : i - 1 ) + 8 ) >> 4;
+    }
+    return value;
+#undef T
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar fused upsampling + YCbCr->RGB conversion of output pixels [x0, x1), used for the row
+// ends by the SIMD versions. pOut and pY point at pixel x0.
+void UpsampleYCbCrToRGBRowScalar( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCbNear, const stbi_uc* pCbFar,
+                                  const stbi_uc* pCrNear, const stbi_uc* pCrFar, int wLores, int hs, int x0, int x1, int step )
+{
+    stbi_uc cb[32], cr[32];
+
+    while( x0 < x1 )
+    {
+        int count = x1 - x0 < 32 ? x1 - x0 : 32;
+        int i;
+        for( i = 0; i < count; ++i )
+        {
+            cb[i] = (stbi_uc)UpsampleChroma( pCbNear, pCbFar, wLores, hs, x0 + i );
+            cr[i] = (stbi_uc)UpsampleChroma( pCrNear, pCrFar, wLores, hs, x0 + i );
+        }
+        YCbCrToRGBRowScalar( pOut, pY, cb, cr, count, step );
+        pOut += count * step;
+        pY += count;
+        x0 += count;
+    }
+}
+
+
+#if defined(__SSE2__)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IdctBlockSSE2 - dequantize + 8x8 integer IDCT
+//
+// Same arithmetic as stb_image's idct_block (jidctint "islow"), evaluated eight columns at a time
+// with 16-bit inputs and 32-bit accumulators, so the output is identical to the scalar version.
+// Each rotation is a pair of pmaddwd with the summed constants, e.g. t2 = s2*c0 + s6*(c0+c1).
+#define IDCT_CONST(x, y)    _mm_setr_epi16( (x), (y), (x), (y), (x), (y), (x), (y) )
+
+#define IDCT_ROT(out0, out1, x, y, c0, c1) \
+    __m128i out0##Lo, out0##Hi, out1##Lo, out1##Hi; \
+    { \
+        __m128i lo = _mm_unpacklo_epi16( (x), (y) ); \
+        __m128i hi = _mm_unpackhi_epi16( (x), (y) ); \
+        out0##Lo = _mm_madd_epi16( lo, c0 ); \
+        out0##Hi = _mm_madd_epi16( hi, c0 ); \
+        out1##Lo = _mm_madd_epi16( lo, c1 ); \
+        out1##Hi = _mm_madd_epi16( hi, c1 ); \
+    }
+
+// out = in << 12 (16-bit in, 32-bit out)
+#define IDCT_WIDEN(out, in) \
+    __m128i out##Lo = _mm_srai_epi32( _mm_unpacklo_epi16( _mm_setzero_si128(), (in) ), 4 ); \
+    __m128i out##Hi = _mm_srai_epi32( _mm_unpackhi_epi16( _mm_setzero_si128(), (in) ), 4 )
+
+#define IDCT_WADD(out, a, b) \
+    __m128i out##Lo = _mm_add_epi32( a##Lo, b##Lo ); \
+    __m128i out##Hi = _mm_add_epi32( a##Hi, b##Hi )
+
+#define IDCT_WSUB(out, a, b) \
+    __m128i out##Lo = _mm_sub_epi32( a##Lo, b##Lo ); \
+    __m128i out##Hi = _mm_sub_epi32( a##Hi, b##Hi )
+
+// butterfly a/b, add bias, shift by s and pack back to 16 bits
+#define IDCT_BFLY(out0, out1, a, b, bias, s) \
+    { \
+        __m128i biasedLo = _mm_add_epi32( a##Lo, bias ); \
+        __m128i biasedHi = _mm_add_epi32( a##Hi, bias ); \
+        IDCT_WADD( sum, biased, b ); \
+        IDCT_WSUB( dif, biased, b ); \
+        out0 = _mm_packs_epi32( _mm_srai_epi32( sumLo, s ), _mm_srai_epi32( sumHi, s ) ); \
+        out1 = _mm_packs_epi32( _mm_srai_epi32( difLo, s ), _mm_srai_epi32( difHi, s ) ); \
+    }
+
+#define IDCT_PASS(bias, shift) \
+    { \
+        /* even part */ \
+        IDCT_ROT( t2e, t3e, row2, row6, rot0_0, rot0_1 ); \
+        __m128i sum04 = _mm_add_epi16( row0, row4 ); \
+        __m128i dif04 = _mm_sub_epi16( row0, row4 ); \
+        IDCT_WIDEN( t0e, sum04 ); \
+        IDCT_WIDEN( t1e, dif04 ); \
+        IDCT_WADD( x0, t0e, t3e ); \
+        IDCT_WSUB( x3, t0e, t3e ); \
+        IDCT_WADD( x1, t1e, t2e ); \
+        IDCT_WSUB( x2, t1e, t2e ); \
+        /* odd part */ \
+        IDCT_ROT( y0o, y2o, row7, row3, rot2_0, rot2_1 ); \
+        IDCT_ROT( y1o, y3o, row5, row1, rot3_0, rot3_1 ); \
+        __m128i sum17 = _mm_add_epi16( row1, row7 ); \
+        __m128i sum35 = _mm_add_epi16( row3, row5 ); \
+        IDCT_ROT( y4o, y5o, sum17, sum35, rot1_0, rot1_1 ); \
+        IDCT_WADD( x4, y0o, y4o ); \
+        IDCT_WADD( x5, y1o, y5o ); \
+        IDCT_WADD( x6, y2o, y5o ); \
+        IDCT_WADD( x7, y3o, y4o ); \
+        IDCT_BFLY( row0, row7, x0, x7, bias, shift ); \
+        IDCT_BFLY( row1, row6, x1, x6, bias, shift ); \
+        IDCT_BFLY( row2, row5, x2, x5, bias, shift ); \
+        IDCT_BFLY( row3, row4, x3, x4, bias, shift ); \
+    }
+
+#define INTERLEAVE16(a, b)  tmp = a; a = _mm_unpacklo_epi16( a, b ); b = _mm_unpackhi_epi16( tmp, b )
+#define INTERLEAVE8(a, b)   tmp = a; a = _mm_unpacklo_epi8( a, b );  b = _mm_unpackhi_epi8( tmp, b )
+
+void IdctBlockSSE2( stbi_uc* pOut, int outStride, short pData[64], unsigned short* pDequantize )
+{
+    __m128i row0, row1, row2, row3, row4, row5, row6, row7;
+    __m128i tmp;
+
+    const __m128i rot0_0 = IDCT_CONST( F2F( 0.5411961f ), F2F( 0.5411961f ) + F2F( -1.847759065f ) );
+    const __m128i rot0_1 = IDCT_CONST( F2F( 0.5411961f ) + F2F( 0.765366865f ), F2F( 0.5411961f ) );
+    const __m128i rot1_0 = IDCT_CONST( F2F( 1.175875602f ) + F2F( -0.899976223f ), F2F( 1.175875602f ) );
+    const __m128i rot1_1 = IDCT_CONST( F2F( 1.175875602f ), F2F( 1.175875602f ) + F2F( -2.562915447f ) );
+    const __m128i rot2_0 = IDCT_CONST( F2F( -1.961570560f ) + F2F( 0.298631336f ), F2F( -1.961570560f ) );
+    const __m128i rot2_1 = IDCT_CONST( F2F( -1.961570560f ), F2F( -1.961570560f ) + F2F( 3.072711026f ) );
+    const __m128i rot3_0 = IDCT_CONST( F2F( -0.390180644f ) + F2F( 2.053119869f ), F2F( -0.390180644f ) );
+    const __m128i rot3_1 = IDCT_CONST( F2F( -0.390180644f ), F2F( -0.390180644f ) + F2F( 1.501321110f ) );
+
+    // Rounding biases of the column and row pass (see idct_block in stb_image.c); the row pass
+    // bias also includes the +128 level shift
+    const __m128i bias0 = _mm_set1_epi32( 512 );
+    const __m128i bias1 = _mm_set1_epi32( 65536 + ( 128 << 17 ) );
+
+    // Load and dequantize
+    const __m128i* pCoeffs = (const __m128i*)pData;
+    const __m128i* pQuant  = (const __m128i*)pDequantize;
+    row0 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 0 ), _mm_loadu_si128( pQuant + 0 ) );
+    row1 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 1 ), _mm_loadu_si128( pQuant + 1 ) );
+    row2 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 2 ), _mm_loadu_si128( pQuant + 2 ) );
+    row3 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 3 ), _mm_loadu_si128( pQuant + 3 ) );
+    row4 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 4 ), _mm_loadu_si128( pQuant + 4 ) );
+    row5 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 5 ), _mm_loadu_si128( pQuant + 5 ) );
+    row6 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 6 ), _mm_loadu_si128( pQuant + 6 ) );
+    row7 = _mm_mullo_epi16( _mm_loadu_si128( pCoeffs + 7 ), _mm_loadu_si128( pQuant + 7 ) );
+
+    // Column pass
+    IDCT_PASS( bias0, 10 );
+
+    // 16-bit 8x8 transpose
+    INTERLEAVE16( row0, row4 );
+    INTERLEAVE16( row1, row5 );
+    INTERLEAVE16( row2, row6 );
+    INTERLEAVE16( row3, row7 );
+
+    INTERLEAVE16( row0, row2 );
+    INTERLEAVE16( row1, row3 );
+    INTERLEAVE16( row4, row6 );
+    INTERLEAVE16( row5, row7 );
+
+    INTERLEAVE16( row0, row1 );
+    INTERLEAVE16( row2, row3 );
+    INTERLEAVE16( row4, row5 );
+    INTERLEAVE16( row6, row7 );
+
+    // Row pass
+    IDCT_PASS( bias1, 17 );
+
+    {
+        // Pack with unsigned saturation (the clamp to 0..255)
+        __m128i p0 = _mm_packus_epi16( row0, row1 );
+        __m128i p1 = _mm_packus_epi16( row2, row3 );
+        __m128i p2 = _mm_packus_epi16( row4, row5 );
+        __m128i p3 = _mm_packus_epi16( row6, row7 );
+
+        // 8-bit 8x8 transpose
+        INTERLEAVE8( p0, p2 );
+        INTERLEAVE8( p1, p3 );
+
+        INTERLEAVE8( p0, p1 );
+        INTERLEAVE8( p2, p3 );
+
+        INTERLEAVE8( p0, p2 );
+        INTERLEAVE8( p1, p3 );
+
+        // Store
+        _mm_storel_epi64( (__m128i*)pOut, p0 );                             pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, _mm_shuffle_epi32( p0, 0x4e ) );  pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, p2 );                             pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, _mm_shuffle_epi32( p2, 0x4e ) );  pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, p1 );                             pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, _mm_shuffle_epi32( p1, 0x4e ) );  pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, p3 );                             pOut += outStride;
+        _mm_storel_epi64( (__m128i*)pOut, _mm_shuffle_epi32( p3, 0x4e ) );
+    }
+}
+
+#undef IDCT_CONST
+#undef IDCT_ROT
+#undef IDCT_WIDEN
+#undef IDCT_WADD
+#undef IDCT_WSUB
+#undef IDCT_BFLY
+#undef IDCT_PASS
+#undef INTERLEAVE16
+#undef INTERLEAVE8
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertStoreSSE2 - YCbCr->RGB(A) conversion of 8 pixels
+//
+// stb_image's 16.16 constants don't fit in 16 bits, so they are split into an integer part that
+// is added directly and a 16-bit fraction that goes through pmaddwd, e.g.
+//      r = ( (y << 16) + 32768 + cr*91881 ) >> 16  ==  y + cr + ( (cr*26345 + 32768) >> 16 )
+// The rounding constant rides along in the second 16-bit lane (2 * 16384), which keeps the
+// result bit-exact with the scalar code. cb and cr come in with the 128 bias already removed.
+static inline void ConvertStoreSSE2( stbi_uc* pOut, __m128i y, __m128i cb, __m128i cr, int step )
+{
+    const __m128i two     = _mm_set1_epi16( 2 );
+    const __m128i round   = _mm_set1_epi32( 32768 );
+    const __m128i alpha   = _mm_set1_epi8( (char)255 );
+    const __m128i crToR   = _mm_setr_epi16( FLOAT2FIXED( 1.40200f ) - 65536, 16384, FLOAT2FIXED( 1.40200f ) - 65536, 16384,
+                                            FLOAT2FIXED( 1.40200f ) - 65536, 16384, FLOAT2FIXED( 1.40200f ) - 65536, 16384 );
+    const __m128i cbCrToG = _mm_setr_epi16( 65536 - FLOAT2FIXED( 0.71414f ), -FLOAT2FIXED( 0.34414f ), 65536 - FLOAT2FIXED( 0.71414f ), -FLOAT2FIXED( 0.34414f ),
+                                            65536 - FLOAT2FIXED( 0.71414f ), -FLOAT2FIXED( 0.34414f ), 65536 - FLOAT2FIXED( 0.71414f ), -FLOAT2FIXED( 0.34414f ) );
+    const __m128i cbToB   = _mm_setr_epi16( FLOAT2FIXED( 1.77200f ) - 131072, 16384, FLOAT2FIXED( 1.77200f ) - 131072, 16384,
+                                            FLOAT2FIXED( 1.77200f ) - 131072, 16384, FLOAT2FIXED( 1.77200f ) - 131072, 16384 );
+
+    // Fractional parts in 32 bits
+    __m128i rLo = _mm_srai_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( cr, two ), crToR ), 16 );
+    __m128i rHi = _mm_srai_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( cr, two ), crToR ), 16 );
+    __m128i gLo = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( cr, cb ), cbCrToG ), round ), 16 );
+    __m128i gHi = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( cr, cb ), cbCrToG ), round ), 16 );
+    __m128i bLo = _mm_srai_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( cb, two ), cbToB ), 16 );
+    __m128i bHi = _mm_srai_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( cb, two ), cbToB ), 16 );
+
+    // Integer parts in 16 bits
+    __m128i r = _mm_add_epi16( _mm_add_epi16( y, cr ), _mm_packs_epi32( rLo, rHi ) );
+    __m128i g = _mm_add_epi16( _mm_sub_epi16( y, cr ), _mm_packs_epi32( gLo, gHi ) );
+    __m128i b = _mm_add_epi16( _mm_add_epi16( y, _mm_add_epi16( cb, cb ) ), _mm_packs_epi32( bLo, bHi ) );
+
+    // Clamp to 0..255 and interleave to RGBA
+    __m128i rg = _mm_unpacklo_epi8( _mm_packus_epi16( r, r ), _mm_packus_epi16( g, g ) );
+    __m128i ba = _mm_unpacklo_epi8( _mm_packus_epi16( b, b ), alpha );
+    __m128i rgba0 = _mm_unpacklo_epi16( rg, ba );
+    __m128i rgba1 = _mm_unpackhi_epi16( rg, ba );
+
+    if( step == 4 )
+    {
+        _mm_storeu_si128( (__m128i*)( pOut + 0 ), rgba0 );
+        _mm_storeu_si128( (__m128i*)( pOut + 16 ), rgba1 );
+    }
+    else
+    {
+        // Every pixel is written with a 4 byte store, so the caller must leave room for one more
+        // pixel. Pixels are stored in order, each store's 4th byte is fixed up by the next one.
+        int p;
+        for( p = 0; p < 4; ++p )
+        {
+            int pixel = _mm_cvtsi128_si32( rgba0 );
+            memcpy( pOut + p * 3, &pixel, 4 );
+            rgba0 = _mm_srli_si128( rgba0, 4 );
+        }
+        for( p = 4; p < 8; ++p )
+        {
+            int pixel = _mm_cvtsi128_si32( rgba1 );
+            memcpy( pOut + p * 3, &pixel, 4 );
+            rgba1 = _mm_srli_si128( rgba1, 4 );
+        }
+    }
+}
+
+#define LOAD8_EPI16(p)  _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)( p ) ), _mm_setzero_si128() )
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// YCbCrToRGBRowSSE2 - YCbCr->RGB(A) conversion, 8 pixels per iteration
+void YCbCrToRGBRowSSE2( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCb, const stbi_uc* pCr, int count, int step )
+{
+    const __m128i bias = _mm_set1_epi16( 128 );
+    int i = 0;
+
+    // With 3 bytes per pixel always leave at least one pixel for the scalar tail
+    int vectorCount = ( step == 4 ) ? count : count - 1;
+
+    for( ; i + 8 <= vectorCount; i += 8 )
+    {
+        ConvertStoreSSE2( pOut, LOAD8_EPI16( pY + i ),
+                          _mm_sub_epi16( LOAD8_EPI16( pCb + i ), bias ),
+                          _mm_sub_epi16( LOAD8_EPI16( pCr + i ), bias ), step );
+        pOut += 8 * step;
+    }
+
+    YCbCrToRGBRowScalar( pOut, pY + i, pCb + i, pCr + i, count - i, step );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UpsampleYCbCrToRGBRowSSE2 - chroma upsampling fused with YCbCr->RGB(A), 16 pixels per iteration
+//
+// With T = 3*near + far (or 4*near without vertical filtering), the interior of the 2x horizontal
+// triangle filter is ( 3*T[i] + T[i-1 or i+1] + 8 ) >> 4, which fits in 16 bits. The row ends,
+// where stb_image uses different weights, go through the scalar path.
+static inline __m128i ChromaTSSE2( const stbi_uc* pNear, const stbi_uc* pFar, int i )
+{
+    __m128i nearRow = LOAD8_EPI16( pNear + i );
+    if( pFar == NULL )
+    {
+        return _mm_slli_epi16( nearRow, 2 );
+    }
+    return _mm_add_epi16( _mm_add_epi16( nearRow, _mm_add_epi16( nearRow, nearRow ) ), LOAD8_EPI16( pFar + i ) );
+}
+
+static inline void UpsampleH2SSE2( const stbi_uc* pNear, const stbi_uc* pFar, int i, __m128i* pLo, __m128i* pHi )
+{
+    const __m128i eight = _mm_set1_epi16( 8 );
+    const __m128i bias  = _mm_set1_epi16( 128 );
+    __m128i t    = ChromaTSSE2( pNear, pFar, i );
+    __m128i t3   = _mm_add_epi16( _mm_add_epi16( t, _mm_add_epi16( t, t ) ), eight );
+    __m128i even = _mm_srli_epi16( _mm_add_epi16( t3, ChromaTSSE2( pNear, pFar, i - 1 ) ), 4 );
+    __m128i odd  = _mm_srli_epi16( _mm_add_epi16( t3, ChromaTSSE2( pNear, pFar, i + 1 ) ), 4 );
+
+    *pLo = _mm_sub_epi16( _mm_unpacklo_epi16( even, odd ), bias );
+    *pHi = _mm_sub_epi16( _mm_unpackhi_epi16( even, odd ), bias );
+}
+
+void UpsampleYCbCrToRGBRowSSE2( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCbNear, const stbi_uc* pCbFar,
+                                const stbi_uc* pCrNear, const stbi_uc* pCrFar, int wLores, int hs, int count, int step )
+{
+    int x = 0;
+
+    if( hs == 2 )
+    {
+        // Vectors cover lores samples [i, i+8) and read one sample on either side; the first and
+        // the last two samples have edge weights
+        int i = 1;
+        int head = count < 2 ? count : 2;
+
+        UpsampleYCbCrToRGBRowScalar( pOut, pY, pCbNear, pCbFar, pCrNear, pCrFar, wLores, hs, 0, head, step );
+
+        for( ; i + 8 <= wLores - 1; i += 8 )
+        {
+            __m128i cbLo, cbHi, crLo, crHi;
+            UpsampleH2SSE2( pCbNear, pCbFar, i, &cbLo, &cbHi );
+            UpsampleH2SSE2( pCrNear, pCrFar, i, &crLo, &crHi );
+
+            // 2*i + 16 <= count - 1, so 3 byte pixels have room for the trailing store
+            ConvertStoreSSE2( pOut + 2 * i * step, LOAD8_EPI16( pY + 2 * i ), cbLo, crLo, step );
+            ConvertStoreSSE2( pOut + ( 2 * i + 8 ) * step, LOAD8_EPI16( pY + 2 * i + 8 ), cbHi, crHi, step );
+        }
+        x = 2 * i > head ? 2 * i : head;
+    }
+    else
+    {
+        // Vertical only: ( 3*near + far + 2 ) >> 2
+        const __m128i two  = _mm_set1_epi16( 2 );
+        const __m128i bias = _mm_set1_epi16( 128 );
+
+        for( ; x + 8 <= count - 1; x += 8 )
+        {
+            __m128i cb = _mm_sub_epi16( _mm_srli_epi16( _mm_add_epi16( ChromaTSSE2( pCbNear, pCbFar, x ), two ), 2 ), bias );
+            __m128i cr = _mm_sub_epi16( _mm_srli_epi16( _mm_add_epi16( ChromaTSSE2( pCrNear, pCrFar, x ), two ), 2 ), bias );
+            ConvertStoreSSE2( pOut + x * step, LOAD8_EPI16( pY + x ), cb, cr, step );
+        }
+    }
+
+    UpsampleYCbCrToRGBRowScalar( pOut + x * step, pY + x, pCbNear, pCbFar, pCrNear, pCrFar, wLores, hs, x, count, step );
+}
+
+#undef LOAD8_EPI16
+
+#endif // __SSE2__
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernel selection, NULL puts stb_image's own code back
+void SelectJpegKernels( unsigned int features )
+{
+    stbi_install_idct( NULL );
+    stbi_install_YCbCr_to_RGB( NULL );
+    stbi_install_upsample_YCbCr_to_RGB( NULL );
+
+#if defined(__SSE2__)
+    if( features & CPU_FEATURE_SSE2 )
+    {
+        stbi_install_idct( IdctBlockSSE2 );
+        stbi_install_YCbCr_to_RGB( YCbCrToRGBRowSSE2 );
+        stbi_install_upsample_YCbCr_to_RGB( UpsampleYCbCrToRGBRowSSE2 );
+    }
+#endif
+
+#if defined(HAVE_NEON)
+    if( features & CPU_FEATURE_NEON )
+    {
+        stbi_install_idct( IdctBlockNEON );
+        stbi_install_YCbCr_to_RGB( YCbCrToRGBRowNEON );
+        stbi_install_upsample_YCbCr_to_RGB( UpsampleYCbCrToRGBRowNEON );
+    }
+#endif
+
+    (void)features;
+
+    // Restart intervals and upsampling bands are spread across the worker pool
+    stbi_install_parallel_for( ParallelFor );
+}
@@ -0,0 +1,54 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include "stb_image.h"
+
+// Installs the IDCT and YCbCr->RGB kernels 'features' (CPU_FEATURE_*) allows into stb_image, and
+// lets it decode on the worker pool. Called by the kernel dispatch (see dispatch.h).
+void SelectJpegKernels( unsigned int features );
+
+// Scalar YCbCr->RGB conversion, used for the tail of a row by the SIMD versions
+void YCbCrToRGBRowScalar( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCb, const stbi_uc* pCr, int count, int step );
+
+// Scalar fused chroma upsampling + YCbCr->RGB of output pixels [x0, x1), pOut and pY point at x0
+void UpsampleYCbCrToRGBRowScalar( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCbNear, const stbi_uc* pCbFar,
+                                  const stbi_uc* pCrNear, const stbi_uc* pCrFar, int wLores, int hs, int x0, int x1, int step );
+
+// Kernels matching stb_image's stbi_idct_8x8, stbi_YCbCr_to_RGB_run and stbi_upsample_YCbCr_to_RGB_run
+// signatures
+void IdctBlockSSE2( stbi_uc* pOut, int outStride, short pData[64], unsigned short* pDequantize );
+void YCbCrToRGBRowSSE2( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCb, const stbi_uc* pCr, int count, int step );
+void UpsampleYCbCrToRGBRowSSE2( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCbNear, const stbi_uc* pCbFar,
+                                const stbi_uc* pCrNear, const stbi_uc* pCrFar, int wLores, int hs, int count, int step );
+
+void IdctBlockNEON( stbi_uc* pOut, int outStride, short pData[64], unsigned short* pDequantize );
+void YCbCrToRGBRowNEON( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCb, const stbi_uc* pCr, int count, int step );
+void UpsampleYCbCrToRGBRowNEON( stbi_uc* pOut, const stbi_uc* pY, const stbi_uc* pCbNear, const stbi_uc* pCbFar,
+                                const stbi_uc* pCrNear, const stbi_uc* pCrFar, int wLores, int hs, int count, int step );
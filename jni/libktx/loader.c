@@ -1,971 +1,1406 @@
-/* -*- tab-width: 4; -*- */
-/* vi: set sw=2 ts=4: */
-
-/* $Id: aea720bec593dade0ea9b8efe4822a714d073f35 $ */
-
-/**
- * @file
- * @~English
- *
- * @brief Functions for instantiating GL or GLES textures from KTX files.
- *
- * @author Georg Kolling, Imagination Technology
- * @author Mark Callow, HI Corporation
- */
-
-/*
-Copyright (c) 2010 The Khronos Group Inc.
-
-Permission is hereby granted, free of charge, to any person obtaining a
-copy of this software and/or associated documentation files (the
-"Materials"), to deal in the Materials without restriction, including
-without limitation the rights to use, copy, modify, merge, publish,
-distribute, sublicense, and/or sell copies of the Materials, and to
-permit persons to whom the Materials are furnished to do so, subject to
-the following conditions:
-
-The above copyright notice and this permission notice shall be included
-unaltered in all copies or substantial portions of the Materials.
-Any additions, deletions, or changes to the original source files
-must be clearly indicated in accompanying documentation.
-
-If only executable code is distributed, then the accompanying
-documentation must state that "this software is based in part on the
-work of the Khronos Group".
-
-THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
-MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
-IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
-CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
-TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
-MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
-*/
-
-#include <string.h>
-#include <stdlib.h>
-
-#include "KHR/khrplatform.h"
-#include "ktx.h"
-#include "ktxint.h"
-
-#include KTX_GLFUNCPTRS
-
-/* @private is not preventing the typedefs, structs and defines from
- * appearing in the Doxygen output even though EXTRACT_PRIVATE is NO
- * in the config file. To prevent these items appearing I have changed
- * the special comments to ordinary comments, and have set
- * HIDE_UNDOC_MEMBERS = YES in the Doxygen config file.
- *
- * Items declared "static" are omitted, as expected, due to EXTRACT_STATIC
- * being NO, so there is no need to convert those to ordinary comments. 
- */
-/*
- * @private
- * @~English
- * @brief type for a pointer to a stream reading function
- */
-typedef int(*ktxStream_read)(void* dst, const GLsizei count, void* src);
-/*
- * @private
- * @~English
- * @brief type for a pointer to a stream skipping function
- */
-typedef int(*ktxStream_skip)(const GLsizei count, void* src);
-
-/*
- * @private
- * @~English
- * @brief KTX stream interface
- */
-struct ktxStream
-{
-	void* src;				/**< pointer to the stream source */
-	ktxStream_read read;	/**< pointer to function for reading bytes */
-	ktxStream_skip skip;	/**< pointer to function for skipping bytes */
-};
-
-/*
- * @private
- * @~English
- * @brief additional contextProfile bit indicating an OpenGL ES context.
- *
- * This is the same value NVIDIA returns when using an OpenGL ES profile
- * of their desktop drivers. However it is not specified in any official
- * specification as OpenGL ES does not support the GL_CONTEXT_PROFILE_MASK
- * query.
- */
-#define _CONTEXT_ES_PROFILE_BIT 0x4
-
-/*
- * @private
- * @~English
- * @name Supported Sized Format Macros
- *
- * These macros describe values that may be used with the sizedFormats
- * variable.
- */
-/**@{*/
-#define _NON_LEGACY_FORMATS 0x1 /*< @private @internal non-legacy sized formats are supported. */
-#define _LEGACY_FORMATS 0x2  /*< @private @internal legacy sized formats are supported. */
-/*
- * @private
- * @~English
- * @brief all sized formats are supported
- */
-#define _ALL_SIZED_FORMATS (_NON_LEGACY_FORMATS | _LEGACY_FORMATS)
-#define _NO_SIZED_FORMATS 0 /*< @private @internal no sized formats are supported. */
-/**@}*/
-
-/**
- * @private
- * @~English
- * @brief indicates the profile of the current context.
- */
-static GLint contextProfile = 0;
-/**
- * @private
- * @~English
- * @brief indicates what sized texture formats are supported
- *        by the current context.
- */
-static GLint sizedFormats = _ALL_SIZED_FORMATS;
-static GLboolean supportsSwizzle = GL_TRUE;
-/**
- * @private
- * @~English
- * @brief indicates which R16 & RG16 formats are supported by the current context.
- */
-static GLint R16Formats = _KTX_ALL_R16_FORMATS;
-/**
- * @private
- * @~English
- * @brief indicates if the current context supports sRGB textures.
- */
-static GLboolean supportsSRGB = GL_TRUE;
-
-/**
- * @private
- * ~English
- * @brief workaround mismatch of glGetString declaration and standard string
- *        function parameters.
- */
-#define glGetString(x) (const char*)glGetString(x)
-
-/**
- * @private
- * @~English
- * @brief Discover the capabilities of the current GL context.
- * 
- * Queries the context and sets several the following internal variables indicating
- * the capabilities of the context:
- *
- * @li sizedFormats
- * @li supportsSwizzle
- * @li supportsSRGB
- * @li b16Formats
- *
- */           
-static void discoverContextCapabilities(void)
-{
-	GLint majorVersion = 1;
-	GLint minorVersion = 0;
-
-	if (strstr(glGetString(GL_VERSION), "GL ES") != NULL)
-		contextProfile = _CONTEXT_ES_PROFILE_BIT;
-	// MAJOR & MINOR only introduced in GL {,ES} 3.0
-	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
-	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
-	if (glGetError() != GL_NO_ERROR) {
-		// < v3.0; resort to the old-fashioned way.
-		if (contextProfile & _CONTEXT_ES_PROFILE_BIT)
-			sscanf(glGetString(GL_VERSION), "OpenGL ES %d.%d ", &majorVersion, &minorVersion);
-		else
-			sscanf(glGetString(GL_VERSION), "OpenGL %d.%d ", &majorVersion, &minorVersion);
-	}
-	if (contextProfile & _CONTEXT_ES_PROFILE_BIT) {
-		if (majorVersion < 3) {
-			supportsSwizzle = GL_FALSE;
-			sizedFormats = _NO_SIZED_FORMATS;
-			R16Formats = _KTX_NO_R16_FORMATS;
-			supportsSRGB = GL_FALSE;
-		} else {
-			sizedFormats = _NON_LEGACY_FORMATS;
-		}
-		if (strstr(glGetString(GL_EXTENSIONS), "GL_OES_required_internalformat") != NULL) {
-			sizedFormats |= _ALL_SIZED_FORMATS;
-		}
-		// There are no OES extensions for sRGB textures or R16 formats.
-	} else {
-		// PROFILE_MASK was introduced in OpenGL 3.2.
-		// Profiles: CONTEXT_CORE_PROFILE_BIT 0x1, CONTEXT_COMPATIBILITY_PROFILE_BIT 0x2.
-		glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &contextProfile);
-		if (glGetError() == GL_NO_ERROR) {
-			// >= 3.2
-			if (majorVersion == 3 && minorVersion < 3)
-				supportsSwizzle = GL_FALSE;
-			if ((contextProfile & GL_CONTEXT_CORE_PROFILE_BIT))
-				sizedFormats &= ~_LEGACY_FORMATS;
-		} else {
-			// < 3.2
-			contextProfile = GL_CONTEXT_COMPATIBILITY_PROFILE_BIT;
-			supportsSwizzle = GL_FALSE;
-			// sRGB textures introduced in 2.0
-			if (majorVersion < 2 && strstr(glGetString(GL_EXTENSIONS), "GL_EXT_texture_sRGB") == NULL) {
-				supportsSRGB = GL_FALSE;
-			}
-			// R{,G]16 introduced in 3.0; R{,G}16_SNORM introduced in 3.1.
-			if (majorVersion == 3) {
-				if (minorVersion == 0)
-					R16Formats &= ~_KTX_R16_FORMATS_SNORM;
-			} else if (strstr(glGetString(GL_EXTENSIONS), "GL_ARB_texture_rg") != NULL) {
-				R16Formats &= ~_KTX_R16_FORMATS_SNORM;
-			} else {
-				R16Formats = _KTX_NO_R16_FORMATS;
-			}
-		}
-	}
-}
-
-#if SUPPORT_LEGACY_FORMAT_CONVERSION
-/**
- * @internal
- * @~English
- * @brief Convert deprecated legacy-format texture to modern format.
- * 
- * The function sets the GL_TEXTURE_SWIZZLEs necessary to get the same
- * behavior as the legacy format.
- *
- * @param [in] target       texture target on which the swizzle will
- *                          be set.
- * @param [in, out] pFormat pointer to variable holding the base format of the
- *                          texture. The new base format is written here.
- * @param [in, out] pInternalFormat  pointer to variable holding the internalformat
- *                                   of the texture. The new internalformat is
- *                                   written here.
- * @return void unrecognized formats will be passed on to OpenGL. Any loading error
- *              that arises will be handled in the usual way.
- */           
-static void convertFormat(GLenum target, GLenum* pFormat, GLenum* pInternalFormat) {
-	switch (*pFormat) {
-	  case GL_ALPHA:
-		{
-		  GLint swizzle[] = {GL_ZERO, GL_ZERO, GL_ZERO, GL_RED};
-		  *pFormat = GL_RED;
-		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
-		  switch (*pInternalFormat) {
-	        case GL_ALPHA:
-		    case GL_ALPHA4:
-		    case GL_ALPHA8:
-			  *pInternalFormat = GL_R8;
-			  break;
-		    case GL_ALPHA12:
-		    case GL_ALPHA16:
-			  *pInternalFormat = GL_R16;
-			  break;
-		  }
-		}
-	  case GL_LUMINANCE:
-		{
-		  GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
-		  *pFormat = GL_RED;
-		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
-		  switch (*pInternalFormat) {
-			case GL_LUMINANCE:
-		    case GL_LUMINANCE4:
-		    case GL_LUMINANCE8:
-			  *pInternalFormat = GL_R8;
-			  break;
-		    case GL_LUMINANCE12:
-		    case GL_LUMINANCE16:
-			  *pInternalFormat = GL_R16;
-			  break;
-#if 0
-		    // XXX Must avoid setting TEXTURE_SWIZZLE in these cases
-            // XXX Must manually swizzle.
-			case GL_SLUMINANCE:
-			case GL_SLUMINANCE8:
-			  *pInternalFormat = GL_SRGB8;
-			  break;
-#endif
-		  }
-		  break;
-		}
-	  case GL_LUMINANCE_ALPHA:
-		{
-		  GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
-		  *pFormat = GL_RG;
-		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
-		  switch (*pInternalFormat) {
-			case GL_LUMINANCE_ALPHA:
-		    case GL_LUMINANCE4_ALPHA4:
-			case GL_LUMINANCE6_ALPHA2:
-		    case GL_LUMINANCE8_ALPHA8:
-			  *pInternalFormat = GL_RG8;
-			  break;
-		    case GL_LUMINANCE12_ALPHA4:
-			case GL_LUMINANCE12_ALPHA12:
-		    case GL_LUMINANCE16_ALPHA16:
-			  *pInternalFormat = GL_RG16;
-			  break;
-#if 0
-		    // XXX Must avoid setting TEXTURE_SWIZZLE in these cases
-            // XXX Must manually swizzle.
-			case GL_SLUMINANCE_ALPHA:
-			case GL_SLUMINANCE8_ALPHA8:
-			  *pInternalFormat = GL_SRGB8_ALPHA8;
-			  break;
-#endif
-		  }
-		  break;
-		}
-	  case GL_INTENSITY:
-		{
-		  GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_RED};
-		  *pFormat = GL_RED;
-		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
-		  switch (*pInternalFormat) {
-			case GL_INTENSITY:
-		    case GL_INTENSITY4:
-		    case GL_INTENSITY8:
-			  *pInternalFormat = GL_R8;
-			  break;
-		    case GL_INTENSITY12:
-		    case GL_INTENSITY16:
-			  *pInternalFormat = GL_R16;
-			  break;
-		  }
-		  break;
-		}
-	  default:
-	    break;
-	}
-}
-#endif /* SUPPORT_LEGACY_FORMAT_CONVERSION */
-
-
-/*
- * @~English
- * @brief Load a GL texture object from a ktxStream.
- *
- * This function will unpack compressed GL_ETC1_RGB8_OES and GL_ETC2_* format
- * textures in software when the format is not supported by the GL context,
- * provided the library has been compiled with SUPPORT_SOFTWARE_ETC_UNPACK
- * defined as 1.
- * 
- * It will also convert textures with legacy formats to their modern equivalents
- * when the format is not supported by the GL context, provided that the library
- * has been compiled with SUPPORT_LEGACY_FORMAT_CONVERSION defined as 1. 
- *
- * @param [in] stream		pointer to the ktxStream from which to load.
- * @param [in,out] pTexture	name of the GL texture to load. If NULL or if
- *                          <tt>*pTexture == 0</tt> the function will generate
- *                          a texture name. The function binds either the
- *                          generated name or the name given in @p *pTexture
- * 						    to the texture target returned in @p *pTarget,
- * 						    before loading the texture data. If @p pTexture
- *                          is not NULL and a name was generated, the generated
- *                          name will be returned in *pTexture.
- * @param [out] pTarget 	@p *pTarget is set to the texture target used. The
- * 						    target is chosen based on the file contents.
- * @param [out] pDimensions	If @p pDimensions is not NULL, the width, height and
- *							depth of the texture's base level are returned in the
- *                          fields of the KTX_dimensions structure to which it points.
- * @param [out] pIsMipmapped
- *	                        If @p pIsMipmapped is not NULL, @p *pIsMipmapped is set
- *                          to GL_TRUE if the KTX texture is mipmapped, GL_FALSE
- *                          otherwise.
- * @param [out] pGlerror    @p *pGlerror is set to the value returned by
- *                          glGetError when this function returns the error
- *                          KTX_GL_ERROR. glerror can be NULL.
- * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
- *                          of key-value data pointed at by @p *ppKvd. Must not be
- *                          NULL, if @p ppKvd is not NULL.                     
- * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
- *                          memory containing key-value data read from the file.
- *                          The application is responsible for freeing the memory.
- *
- *
- * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
- *
- * @exception KTX_INVALID_VALUE @p target is @c NULL or the size of a mip
- * 							    level is greater than the size of the
- * 							    preceding level.
- * @exception KTX_INVALID_OPERATION @p ppKvd is not NULL but pKvdLen is NULL.
- * @exception KTX_UNEXPECTED_END_OF_FILE the file does not contain the
- * 										 expected amount of data.
- * @exception KTX_OUT_OF_MEMORY Sufficient memory could not be allocated to store
- *                              the requested key-value data.
- * @exception KTX_GL_ERROR      A GL error was raised by glBindTexture,
- * 								glGenTextures or gl*TexImage*. The GL error
- *                              will be returned in @p *glerror, if glerror
- *                              is not @c NULL.
- */
-static
-KTX_error_code
-ktxLoadTextureS(struct ktxStream* stream, GLuint* pTexture, GLenum* pTarget,
-				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
-				GLenum* pGlerror,
-				unsigned int* pKvdLen, unsigned char** ppKvd)
-{
-	GLint				previousUnpackAlignment;
-	KTX_header			header;
-	KTX_texinfo			texinfo;
-	void*				data = NULL;
-	khronos_uint32_t	dataSize = 0;
-	GLuint				texname;
-	int					texnameUser;
-	khronos_uint32_t    faceLodSize;
-	khronos_uint32_t    faceLodSizeRounded;
-	khronos_uint32_t	level;
-	khronos_uint32_t	face;
-	GLenum				glFormat, glInternalFormat;
-	KTX_error_code		errorCode = KTX_SUCCESS;
-	GLenum				errorTmp;
-
-	if (pGlerror)
-		*pGlerror = GL_NO_ERROR;
-
-	if (ppKvd) {
-		*ppKvd = NULL;
-    }
-
-	if (!stream || !stream->read || !stream->skip) {
-		return KTX_INVALID_VALUE;
-	}
-
-	if (!pTarget) {
-		return KTX_INVALID_VALUE;
-	}
-
-	if (!stream->read(&header, KTX_HEADER_SIZE, stream->src)) {
-		return KTX_UNEXPECTED_END_OF_FILE;
-	}
-
-	errorCode = _ktxCheckHeader(&header, &texinfo);
-	if (errorCode != KTX_SUCCESS) {
-		return errorCode;
-	}
-
-	if (ppKvd) {
-		if (pKvdLen == NULL)
-			return KTX_INVALID_OPERATION;
-		*pKvdLen = header.bytesOfKeyValueData;
-		if (*pKvdLen) {
-			*ppKvd = (unsigned char*)malloc(*pKvdLen);
-			if (*ppKvd == NULL)
-				return KTX_OUT_OF_MEMORY;
-			if (!stream->read(*ppKvd, *pKvdLen, stream->src))
-			{
-				free(*ppKvd);
-				*ppKvd = NULL;
-
-				return KTX_UNEXPECTED_END_OF_FILE;
-			}
-		}
-	} else {
-		/* skip key/value metadata */
-		if (!stream->skip((long)header.bytesOfKeyValueData, stream->src)) {
-			return KTX_UNEXPECTED_END_OF_FILE;
-		}
-	}
-
-	if (contextProfile == 0)
-		discoverContextCapabilities();
-
-	/* KTX files require an unpack alignment of 4 */
-	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment);
-	if (previousUnpackAlignment != KTX_GL_UNPACK_ALIGNMENT) {
-		glPixelStorei(GL_UNPACK_ALIGNMENT, KTX_GL_UNPACK_ALIGNMENT);
-	}
-
-	texnameUser = pTexture && *pTexture;
-	if (texnameUser) {
-		texname = *pTexture;
-	} else {
-		glGenTextures(1, &texname);
-	}
-	glBindTexture(texinfo.glTarget, texname);
-
-	// Prefer glGenerateMipmaps over GL_GENERATE_MIPMAP
-	if (texinfo.generateMipmaps && (glGenerateMipmap == NULL)) {
-		glTexParameteri(texinfo.glTarget, GL_GENERATE_MIPMAP, GL_TRUE);
-	}
-
-	if (texinfo.glTarget == GL_TEXTURE_CUBE_MAP) {
-		texinfo.glTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X;
-	}
-
-	glInternalFormat = header.glInternalFormat;
-	glFormat = header.glFormat;
-	if (!texinfo.compressed) {
-#if SUPPORT_LEGACY_FORMAT_CONVERSION
-		// If sized legacy formats are supported there is no need to convert.
-		// If only unsized formats are supported, there is no point in converting
-		// as the modern formats aren't supported either.
-		if (sizedFormats == _NON_LEGACY_FORMATS && supportsSwizzle) {
-			convertFormat(texinfo.glTarget, &glFormat, &glInternalFormat);
-			errorTmp = glGetError();
-		} else if (sizedFormats == _NO_SIZED_FORMATS)
-			glInternalFormat = header.glBaseInternalFormat;
-#else
-		// When no sized formats are supported, or legacy sized formats are not
-		// supported, must change internal format.
-		if (sizedFormats == _NO_SIZED_FORMATS
-			|| (!(sizedFormats & _LEGACY_FORMATS) &&
-				(header.glBaseInternalFormat == GL_ALPHA	
-				|| header.glBaseInternalFormat == GL_LUMINANCE
-				|| header.glBaseInternalFormat == GL_LUMINANCE_ALPHA
-				|| header.glBaseInternalFormat == GL_INTENSITY))) {
-			glInternalFormat = header.glBaseInternalFormat;
-		}
-#endif
-	}
-
-	for (level = 0; level < header.numberOfMipmapLevels; ++level)
-	{
-		GLsizei pixelWidth  = MAX(1, header.pixelWidth  >> level);
-		GLsizei pixelHeight = MAX(1, header.pixelHeight >> level);
-		GLsizei pixelDepth  = MAX(1, header.pixelDepth  >> level);
-
-		if (!stream->read(&faceLodSize, sizeof(khronos_uint32_t), stream->src)) {
-			errorCode = KTX_UNEXPECTED_END_OF_FILE;
-			goto cleanup;
-		}
-		if (header.endianness == KTX_ENDIAN_REF_REV) {
-			_ktxSwapEndian32(&faceLodSize, 1);
-		}
-		faceLodSizeRounded = (faceLodSize + 3) & ~(khronos_uint32_t)3;
-		if (!data) {
-			/* allocate memory sufficient for the first level */
-			data = malloc(faceLodSizeRounded);
-			if (!data) {
-				errorCode = KTX_OUT_OF_MEMORY;
-				goto cleanup;
-			}
-			dataSize = faceLodSizeRounded;
-		}
-		else if (dataSize < faceLodSizeRounded) {
-			/* subsequent levels cannot be larger than the first level */
-			errorCode = KTX_INVALID_VALUE;
-			goto cleanup;
-		}
-
-		for (face = 0; face < header.numberOfFaces; ++face)
-		{
-			if (!stream->read(data, faceLodSizeRounded, stream->src)) {
-				errorCode = KTX_UNEXPECTED_END_OF_FILE;
-				goto cleanup;
-			}
-
-			/* Perform endianness conversion on texture data */
-			if (header.endianness == KTX_ENDIAN_REF_REV && header.glTypeSize == 2) {
-				_ktxSwapEndian16((khronos_uint16_t*)data, faceLodSize / 2);
-			}
-			else if (header.endianness == KTX_ENDIAN_REF_REV && header.glTypeSize == 4) {
-				_ktxSwapEndian32((khronos_uint32_t*)data, faceLodSize / 4);
-			}
-
-			if (texinfo.textureDimensions == 1) {
-				if (texinfo.compressed) {
-					glCompressedTexImage1D(texinfo.glTarget + face, level, 
-						glInternalFormat, pixelWidth, 0,
-						faceLodSize, data);
-				} else {
-					glTexImage1D(texinfo.glTarget + face, level, 
-						glInternalFormat, pixelWidth, 0, 
-						glFormat, header.glType, data);
-				}
-			} else if (texinfo.textureDimensions == 2) {
-				if (header.numberOfArrayElements) {
-					pixelHeight = header.numberOfArrayElements;
-				}
-				if (texinfo.compressed) {
-				    // It is simpler to just attempt to load the format, rather than divine which
-					// formats are supported by the implementation. In the event of an error,
-					// software unpacking can be attempted.
-					glCompressedTexImage2D(texinfo.glTarget + face, level, 
-						glInternalFormat, pixelWidth, pixelHeight, 0,
-						faceLodSize, data);
-				} else {
-					glTexImage2D(texinfo.glTarget + face, level, 
-						glInternalFormat, pixelWidth, pixelHeight, 0, 
-						glFormat, header.glType, data);
-				}
-			} else if (texinfo.textureDimensions == 3) {
-				if (header.numberOfArrayElements) {
-					pixelDepth = header.numberOfArrayElements;
-				}
-				if (texinfo.compressed) {
-					glCompressedTexImage3D(texinfo.glTarget + face, level, 
-						glInternalFormat, pixelWidth, pixelHeight, pixelDepth, 0,
-						faceLodSize, data);
-				} else {
-					glTexImage3D(texinfo.glTarget + face, level, 
-						glInternalFormat, pixelWidth, pixelHeight, pixelDepth, 0, 
-						glFormat, header.glType, data);
-				}
-			}
-
-			errorTmp = glGetError();
-#if SUPPORT_SOFTWARE_ETC_UNPACK
-			// Renderion is returning INVALID_VALUE. Oops!!
-			if ((errorTmp == GL_INVALID_ENUM || errorTmp == GL_INVALID_VALUE)
-				&& texinfo.compressed
-				&& texinfo.textureDimensions == 2
-				&& (glInternalFormat == GL_ETC1_RGB8_OES || (glInternalFormat >= GL_COMPRESSED_R11_EAC && glInternalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC)))
-			    {
-				GLubyte* unpacked;
-				GLenum format, internalFormat, type;
-
-				errorCode = _ktxUnpackETC((GLubyte*)data, glInternalFormat, pixelWidth, pixelHeight,
-					                      &unpacked, &format, &internalFormat, &type,
-										  R16Formats, supportsSRGB);
-				if (errorCode != KTX_SUCCESS) {
-					goto cleanup;
-				}
-				if (!sizedFormats & _NON_LEGACY_FORMATS) {
-					if (internalFormat == GL_RGB8)
-						internalFormat = GL_RGB;
-					else if (internalFormat == GL_RGBA8)
-						internalFormat = GL_RGBA;
-				}
-				glTexImage2D(texinfo.glTarget + face, level, 
-							 internalFormat, pixelWidth, pixelHeight, 0, 
-							 format, type, unpacked);
-
-				free(unpacked);
-				errorTmp = glGetError();
-			}
-#endif
-			if (errorTmp != GL_NO_ERROR) {
-				if (pGlerror)
-					*pGlerror = errorTmp;
-				errorCode = KTX_GL_ERROR;
-				goto cleanup;
-			}
-		}
-	}
-
-cleanup:
-	free(data);
-
-	/* restore previous GL state */
-	if (previousUnpackAlignment != KTX_GL_UNPACK_ALIGNMENT) {
-		glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment);
-	}
-
-	if (errorCode == KTX_SUCCESS)
-	{
-		if (texinfo.generateMipmaps && glGenerateMipmap) {
-			glGenerateMipmap(texinfo.glTarget);
-		}
-		*pTarget = texinfo.glTarget;
-		if (pTexture) {
-			*pTexture = texname;
-		}
-		if (pDimensions) {
-			pDimensions->width = header.pixelWidth;
-			pDimensions->height = header.pixelHeight;
-			pDimensions->depth = header.pixelDepth;
-		}
-		if (pIsMipmapped) {
-			if (texinfo.generateMipmaps || header.numberOfMipmapLevels > 1)
-				*pIsMipmapped = GL_TRUE;
-			else
-				*pIsMipmapped = GL_FALSE;
-		}
-	} else {
-		if (ppKvd && *ppKvd)
-		{
-			free(*ppKvd);
-			*ppKvd = NULL;
-		}
-
-		if (!texnameUser) {
-			glDeleteTextures(1, &texname);
-		}
-	}
-	return errorCode;
-}
-
-/* Implementation of ktxStream for FILE */
-
-static
-int ktxFileStream_read(void* dst, const GLsizei count, void* src)
-{
-	if (!dst || !src || (fread(dst, count, 1, (FILE*)src) != 1))
-	{
-		return 0;
-	}
-
-	return 1;
-}
-
-static
-int ktxFileStream_skip(const GLsizei count, void* src)
-{
-	if (!src || (count < 0) || (fseek((FILE*)src, count, SEEK_CUR) != 0))
-	{
-		return 0;
-	}
-
-	return 1;
-}
-
-static
-int ktxFileInit(struct ktxStream* stream, FILE* file)
-{
-	if (!stream || !file)
-	{
-		return 0;
-	}
-
-	stream->src = (void*)file;
-	stream->read = ktxFileStream_read;
-	stream->skip = ktxFileStream_skip;
-
-	return 1;
-}
-
-/**
- * @~English
- * @brief Load a GL texture object from a stdio FILE stream.
- *
- * This function will unpack compressed GL_ETC1_RGB8_OES and GL_ETC2_* format
- * textures in software when the format is not supported by the GL context,
- * provided the library has been compiled with SUPPORT_SOFTWARE_ETC_UNPACK
- * defined as 1.
- * 
- * It will also convert texture with legacy formats to their modern equivalents
- * when the format is not supported by the GL context, provided that the library
- * has been compiled with SUPPORT_LEGACY_FORMAT_CONVERSION defined as 1. 
- *
- * @param [in] file			pointer to the stdio FILE stream from which to
- * 							load.
- * @param [in,out] pTexture	name of the GL texture to load. If NULL or if
- *                          <tt>*pTexture == 0</tt> the function will generate
- *                          a texture name. The function binds either the
- *                          generated name or the name given in @p *pTexture
- * 						    to the texture target returned in @p *pTarget,
- * 						    before loading the texture data. If @p pTexture
- *                          is not NULL and a name was generated, the generated
- *                          name will be returned in *pTexture.
- * @param [out] pTarget 	@p *pTarget is set to the texture target used. The
- * 						    target is chosen based on the file contents.
- * @param [out] pDimensions	If @p pDimensions is not NULL, the width, height and
- *							depth of the texture's base level are returned in the
- *                          fields of the KTX_dimensions structure to which it points.
- * @param [out] pIsMipmapped
- *	                        If @p pIsMipmapped is not NULL, @p *pIsMipmapped is set
- *                          to GL_TRUE if the KTX texture is mipmapped, GL_FALSE
- *                          otherwise.
- * @param [out] pGlerror    @p *pGlerror is set to the value returned by
- *                          glGetError when this function returns the error
- *                          KTX_GL_ERROR. glerror can be NULL.
- * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
- *                          of key-value data pointed at by @p *ppKvd. Must not be
- *                          NULL, if @p ppKvd is not NULL.                     
- * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
- *                          memory containing key-value data read from the file.
- *                          The application is responsible for freeing the memory.
- *
- *
- * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
- *
- * @exception KTX_INVALID_VALUE @p target is @c NULL or the size of a mip
- * 							    level is greater than the size of the
- * 							    preceding level.
- * @exception KTX_INVALID_OPERATION @p ppKvd is not NULL but pKvdLen is NULL.
- * @exception KTX_UNEXPECTED_END_OF_FILE the file does not contain the
- * 										 expected amount of data.
- * @exception KTX_OUT_OF_MEMORY Sufficient memory could not be allocated to store
- *                              the requested key-value data.
- * @exception KTX_GL_ERROR      A GL error was raised by glBindTexture,
- * 								glGenTextures or gl*TexImage*. The GL error
- *                              will be returned in @p *glerror, if glerror
- *                              is not @c NULL.
- */
-KTX_error_code
-ktxLoadTextureF(FILE* file, GLuint* pTexture, GLenum* pTarget,
-				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
-				GLenum* pGlerror,
-				unsigned int* pKvdLen, unsigned char** ppKvd)
-{
-	struct ktxStream stream;
-
-	if (!ktxFileInit(&stream, file))
-	{
-		return KTX_FILE_OPEN_FAILED;
-	}
-
-	return ktxLoadTextureS(&stream, pTexture, pTarget, pDimensions, pIsMipmapped, pGlerror, pKvdLen, ppKvd);
-}
-
-/**
- * @~English
- * @brief Load a GL texture object from a named file on disk.
- *
- * @param [in] filename		pointer to a C string that contains the path of
- * 							the file to load.
- * @param [in,out] pTexture	name of the GL texture to load. See
- *                          ktxLoadTextureF() for details.
- * @param [out] pTarget 	@p *pTarget is set to the texture target used. See
- *                          ktxLoadTextureF() for details.
- * @param [out] pDimensions @p the texture's base level width depth and height
- *                          are returned in structure to which this points.
- *                          See ktxLoadTextureF() for details.
- * @param [out] pIsMipmapped @p pIsMipMapped is set to indicate if the loaded
- *                          texture is mipmapped. See ktxLoadTextureF() for
- *                          details.
- * @param [out] pGlerror    @p *pGlerror is set to the value returned by
- *                          glGetError when this function returns the error
- *                          KTX_GL_ERROR. glerror can be NULL.
- * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
- *                          of key-value data pointed at by @p *ppKvd. Must not be
- *                          NULL, if @p ppKvd is not NULL.                     
- * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
- *                          memory containing key-value data read from the file.
- *                          The application is responsible for freeing the memory.*
- * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
- *
- * @exception KTX_FILE_OPEN_FAILED	The specified file could not be opened.
- * @exception KTX_INVALID_VALUE		See ktxLoadTextureF() for causes.
- * @exception KTX_INVALID_OPERATION	See ktxLoadTextureF() for causes.
- * @exception KTX_UNEXPECTED_END_OF_FILE See ktxLoadTextureF() for causes.
- * 								
- * @exception KTX_GL_ERROR			See ktxLoadTextureF() for causes.
- */
-KTX_error_code
-ktxLoadTextureN(const char* const filename, GLuint* pTexture, GLenum* pTarget,
-				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
-				GLenum* pGlerror,
-				unsigned int* pKvdLen, unsigned char** ppKvd)
-{
-	KTX_error_code errorCode;
-	FILE* file = fopen(filename, "rb");
-
-	if (file) {
-		errorCode = ktxLoadTextureF(file, pTexture, pTarget, pDimensions,
-								    pIsMipmapped, pGlerror, pKvdLen, ppKvd);
-		fclose(file);
-	} else
-	    errorCode = KTX_FILE_OPEN_FAILED;
-
-	return errorCode;
-}
-
-/* Implementation of ktxStream for memory */
-
-struct ktxMem
-{
-	const unsigned char* bytes;
-	GLsizei size;
-	GLsizei pos;
-};
-
-static
-int ktxMemStream_read(void* dst, const GLsizei count, void* src)
-{
-	struct ktxMem* mem = (struct ktxMem*)src;
-	
-	if(!dst || !mem || (mem->pos + count > mem->size) || (mem->pos + count < mem->pos))
-	{
-		return 0;
-	}
-
-	memcpy(dst, mem->bytes + mem->pos, count);
-	mem->pos += count;
-
-	return 1;
-}
-
-static
-int ktxMemStream_skip(const GLsizei count, void* src)
-{
-	struct ktxMem* mem = (struct ktxMem*)src;
-
-	if(!mem || (mem->pos + count > mem->size) || (mem->pos + count < mem->pos))
-	{
-		return 0;
-	}
-
-	mem->pos += count;
-
-	return 1;
-}
-
-static
-int ktxMemInit(struct ktxStream* stream, struct ktxMem* mem, const void* bytes, GLsizei size)
-{
-	if (!stream || !mem || !bytes || (size <= 0))
-	{
-		return 0;
-	}
-	
-	mem->bytes = (const unsigned char*)bytes;
-	mem->size = size;
-	mem->pos = 0;
-
-	stream->src = mem;
-	stream->read = ktxMemStream_read;
-	stream->skip = ktxMemStream_skip;
-
-	return 1;
-}
-
-/**
- * @~English
- * @brief Load a GL texture object from KTX formatted data in memory.
- *
- * @param [in] bytes		pointer to the array of bytes containing
- * 							the KTX format data to load.
- * @param [in] size			size of the memory array containing the
- *                          KTX format data.
- * @param [in,out] pTexture	name of the GL texture to load. See
- *                          ktxLoadTextureF() for details.
- * @param [out] pTarget 	@p *pTarget is set to the texture target used. See
- *                          ktxLoadTextureF() for details.
- * @param [out] pDimensions @p the texture's base level width depth and height
- *                          are returned in structure to which this points.
- *                          See ktxLoadTextureF() for details.
- * @param [out] pIsMipmapped @p *pIsMipMapped is set to indicate if the loaded
- *                          texture is mipmapped. See ktxLoadTextureF() for
- *                          details.
- * @param [out] pGlerror    @p *pGlerror is set to the value returned by
- *                          glGetError when this function returns the error
- *                          KTX_GL_ERROR. glerror can be NULL.
- * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
- *                          of key-value data pointed at by @p *ppKvd. Must not be
- *                          NULL, if @p ppKvd is not NULL.                     
- * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
- *                          memory containing key-value data read from the file.
- *                          The application is responsible for freeing the memory.*
- *
- * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
- *
- * @exception KTX_FILE_OPEN_FAILED	The specified memory could not be opened as a file.
- * @exception KTX_INVALID_VALUE		See ktxLoadTextureF() for causes.
- * @exception KTX_INVALID_OPERATION	See ktxLoadTextureF() for causes.
- * @exception KTX_UNEXPECTED_END_OF_FILE See ktxLoadTextureF() for causes.
- * 								
- * @exception KTX_GL_ERROR			See ktxLoadTextureF() for causes.
- */
-KTX_error_code
-ktxLoadTextureM(const void* bytes, GLsizei size, GLuint* pTexture, GLenum* pTarget,
-				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
-				GLenum* pGlerror,
-				unsigned int* pKvdLen, unsigned char** ppKvd)
-{
-	struct ktxMem mem;
-	struct ktxStream stream;
-
-	if (!ktxMemInit(&stream, &mem, bytes, size))
-	{
-		return KTX_FILE_OPEN_FAILED;
-	}
-
-	return ktxLoadTextureS(&stream, pTexture, pTarget, pDimensions, pIsMipmapped, pGlerror, pKvdLen, ppKvd);
-}
-
-
+/* -*- tab-width: 4; -*- */
+/* vi: set sw=2 ts=4: */
+
+/* $Id: aea720bec593dade0ea9b8efe4822a714d073f35 $ */
+
+/**
+ * @file
+ * @~English
+ *
+ * @brief Functions for instantiating GL or GLES textures from KTX files.
+ *
+ * @author Georg Kolling, Imagination Technology
+ * @author Mark Callow, HI Corporation
+ */
+
+/*
+Copyright (c) 2010 The Khronos Group Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and/or associated documentation files (the
+"Materials"), to deal in the Materials without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Materials, and to
+permit persons to whom the Materials are furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+unaltered in all copies or substantial portions of the Materials.
+Any additions, deletions, or changes to the original source files
+must be clearly indicated in accompanying documentation.
+
+If only executable code is distributed, then the accompanying
+documentation must state that "this software is based in part on the
+work of the Khronos Group".
+
+THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+MATERIALS OR THE USE OR OTHER DEALINGS IN THE MATERIALS.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "KHR/khrplatform.h"
+#include "ktx.h"
+#include "ktxint.h"
+
+#include KTX_GLFUNCPTRS
+
+/* @private is not preventing the typedefs, structs and defines from
+ * appearing in the Doxygen output even though EXTRACT_PRIVATE is NO
+ * in the config file. To prevent these items appearing I have changed
+ * the special comments to ordinary comments, and have set
+ * HIDE_UNDOC_MEMBERS = YES in the Doxygen config file.
+ *
+ * Items declared "static" are omitted, as expected, due to EXTRACT_STATIC
+ * being NO, so there is no need to convert those to ordinary comments. 
+ */
+/*
+ * @private
+ * @~English
+ * @brief type for a pointer to a stream reading function
+ */
+typedef int(*ktxStream_read)(void* dst, const GLsizei count, void* src);
+/*
+ * @private
+ * @~English
+ * @brief type for a pointer to a stream skipping function
+ */
+typedef int(*ktxStream_skip)(const GLsizei count, void* src);
+
+/*
+ * @private
+ * @~English
+ * @brief KTX stream interface
+ */
+struct ktxStream
+{
+	void* src;				/**< pointer to the stream source */
+	ktxStream_read read;	/**< pointer to function for reading bytes */
+	ktxStream_skip skip;	/**< pointer to function for skipping bytes */
+};
+
+/*
+ * @private
+ * @~English
+ * @brief additional contextProfile bit indicating an OpenGL ES context.
+ *
+ * This is the same value NVIDIA returns when using an OpenGL ES profile
+ * of their desktop drivers. However it is not specified in any official
+ * specification as OpenGL ES does not support the GL_CONTEXT_PROFILE_MASK
+ * query.
+ */
+#define _CONTEXT_ES_PROFILE_BIT 0x4
+
+/*
+ * @private
+ * @~English
+ * @name Supported Sized Format Macros
+ *
+ * These macros describe values that may be used with the sizedFormats
+ * variable.
+ */
+/**@{*/
+#define _NON_LEGACY_FORMATS 0x1 /*< @private @internal non-legacy sized formats are supported. */
+#define _LEGACY_FORMATS 0x2  /*< @private @internal legacy sized formats are supported. */
+/*
+ * @private
+ * @~English
+ * @brief all sized formats are supported
+ */
+#define _ALL_SIZED_FORMATS (_NON_LEGACY_FORMATS | _LEGACY_FORMATS)
+#define _NO_SIZED_FORMATS 0 /*< @private @internal no sized formats are supported. */
+/**@}*/
+
+/**
+ * @private
+ * @~English
+ * @brief indicates the profile of the current context.
+ */
+static GLint contextProfile = 0;
+/**
+ * @private
+ * @~English
+ * @brief indicates what sized texture formats are supported
+ *        by the current context.
+ */
+static GLint sizedFormats = _ALL_SIZED_FORMATS;
+static GLboolean supportsSwizzle = GL_TRUE;
+/**
+ * @private
+ * @~English
+ * @brief indicates which R16 & RG16 formats are supported by the current context.
+ */
+static GLint R16Formats = _KTX_ALL_R16_FORMATS;
+/**
+ * @private
+ * @~English
+ * @brief indicates if the current context supports sRGB textures.
+ */
+static GLboolean supportsSRGB = GL_TRUE;
+/**
+ * @private
+ * @~English
+ * @brief indicates if the current context supports ETC2 textures.
+ */
+static GLboolean supportsETC2 = GL_TRUE;
+/**
+ * @private
+ * @~English
+ * @brief allocator for the buffer image data is read into, set by
+ *        ktxSetImageAllocator.
+ */
+static ktxAllocFunc _ktxImageAlloc = malloc;
+static ktxFreeFunc _ktxImageFree = free;
+/**
+ * @private
+ * @~English
+ * @brief functions image data is staged through on its way to GL, set by
+ *        ktxSetUploadFunctions.
+ */
+static ktxBeginUploadFunc _ktxBeginUpload = NULL;
+static ktxEndUploadFunc _ktxEndUpload = NULL;
+static ktxFinishUploadFunc _ktxFinishUpload = NULL;
+
+/**
+ * @private
+ * @~English
+ * @brief the GL functions, the defaults of ktxSetStateFunctions.
+ */
+static void defaultGenTextures(GLsizei n, GLuint* textures)
+{
+	glGenTextures(n, textures);
+}
+
+static void defaultDeleteTextures(GLsizei n, const GLuint* textures)
+{
+	glDeleteTextures(n, textures);
+}
+
+static void defaultBindTexture(GLenum target, GLuint texture)
+{
+	glBindTexture(target, texture);
+}
+
+static void defaultPixelStore(GLenum pname, GLint param)
+{
+	glPixelStorei(pname, param);
+}
+
+static GLint defaultGetPixelStore(GLenum pname)
+{
+	GLint param = 0;
+	glGetIntegerv(pname, &param);
+	return param;
+}
+
+/**
+ * @private
+ * @~English
+ * @brief functions textures are created and bound, and the unpack alignment
+ *        set and queried with, set by ktxSetStateFunctions.
+ */
+static ktxGenTexturesFunc _ktxGenTextures = defaultGenTextures;
+static ktxDeleteTexturesFunc _ktxDeleteTextures = defaultDeleteTextures;
+static ktxBindTextureFunc _ktxBindTexture = defaultBindTexture;
+static ktxPixelStoreFunc _ktxPixelStore = defaultPixelStore;
+static ktxGetPixelStoreFunc _ktxGetPixelStore = defaultGetPixelStore;
+
+/**
+ * @private
+ * ~English
+ * @brief workaround mismatch of glGetString declaration and standard string
+ *        function parameters.
+ */
+#define glGetString(x) (const char*)glGetString(x)
+
+/**
+ * @private
+ * @~English
+ * @brief the GL queries, the defaults of ktxSetCapabilityFunctions.
+ */
+static void defaultGetVersion(GLboolean* pIsES, GLint* pMajor, GLint* pMinor)
+{
+	*pIsES = strstr(glGetString(GL_VERSION), "GL ES") != NULL;
+	*pMajor = 1;
+	*pMinor = 0;
+	// MAJOR & MINOR only introduced in GL {,ES} 3.0
+	glGetIntegerv(GL_MAJOR_VERSION, pMajor);
+	glGetIntegerv(GL_MINOR_VERSION, pMinor);
+	if (glGetError() != GL_NO_ERROR) {
+		// < v3.0; resort to the old-fashioned way.
+		if (*pIsES)
+			sscanf(glGetString(GL_VERSION), "OpenGL ES %d.%d ", pMajor, pMinor);
+		else
+			sscanf(glGetString(GL_VERSION), "OpenGL %d.%d ", pMajor, pMinor);
+	}
+}
+
+static GLboolean defaultHasExtension(const char* name)
+{
+	return strstr(glGetString(GL_EXTENSIONS), name) != NULL;
+}
+
+/**
+ * @private
+ * @~English
+ * @brief functions the version and extensions of the context are learned
+ *        with, set by ktxSetCapabilityFunctions.
+ */
+static ktxGetVersionFunc _ktxGetVersion = defaultGetVersion;
+static ktxHasExtensionFunc _ktxHasExtension = defaultHasExtension;
+
+/**
+ * @private
+ * @~English
+ * @brief Discover the capabilities of the current GL context.
+ * 
+ * Queries the context and sets several the following internal variables indicating
+ * the capabilities of the context:
+ *
+ * @li sizedFormats
+ * @li supportsSwizzle
+ * @li supportsSRGB
+ * @li b16Formats
+ * @li supportsETC2
+ *
+ */           
+static void discoverContextCapabilities(void)
+{
+	GLboolean isES = GL_FALSE;
+	GLint majorVersion = 1;
+	GLint minorVersion = 0;
+
+	// Start over from the defaults, capabilities are discovered again after
+	// ktxSetCapabilityFunctions.
+	contextProfile = 0;
+	sizedFormats = _ALL_SIZED_FORMATS;
+	supportsSwizzle = GL_TRUE;
+	R16Formats = _KTX_ALL_R16_FORMATS;
+	supportsSRGB = GL_TRUE;
+	supportsETC2 = GL_TRUE;
+
+	_ktxGetVersion(&isES, &majorVersion, &minorVersion);
+	if (isES)
+		contextProfile = _CONTEXT_ES_PROFILE_BIT;
+	if (contextProfile & _CONTEXT_ES_PROFILE_BIT) {
+		if (majorVersion < 3) {
+			supportsSwizzle = GL_FALSE;
+			sizedFormats = _NO_SIZED_FORMATS;
+			R16Formats = _KTX_NO_R16_FORMATS;
+			supportsSRGB = GL_FALSE;
+			supportsETC2 = GL_FALSE;
+		} else {
+			sizedFormats = _NON_LEGACY_FORMATS;
+		}
+		if (_ktxHasExtension("GL_OES_required_internalformat")) {
+			sizedFormats |= _ALL_SIZED_FORMATS;
+		}
+		// There are no OES extensions for sRGB textures or R16 formats.
+	} else {
+		// ETC2 is core from 4.3.
+		if ((majorVersion < 4 || (majorVersion == 4 && minorVersion < 3))
+			&& !_ktxHasExtension("GL_ARB_ES3_compatibility")) {
+			supportsETC2 = GL_FALSE;
+		}
+		// PROFILE_MASK was introduced in OpenGL 3.2.
+		// Profiles: CONTEXT_CORE_PROFILE_BIT 0x1, CONTEXT_COMPATIBILITY_PROFILE_BIT 0x2.
+		glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &contextProfile);
+		if (glGetError() == GL_NO_ERROR) {
+			// >= 3.2
+			if (majorVersion == 3 && minorVersion < 3)
+				supportsSwizzle = GL_FALSE;
+			if ((contextProfile & GL_CONTEXT_CORE_PROFILE_BIT))
+				sizedFormats &= ~_LEGACY_FORMATS;
+		} else {
+			// < 3.2
+			contextProfile = GL_CONTEXT_COMPATIBILITY_PROFILE_BIT;
+			supportsSwizzle = GL_FALSE;
+			// sRGB textures introduced in 2.0
+			if (majorVersion < 2 && !_ktxHasExtension("GL_EXT_texture_sRGB")) {
+				supportsSRGB = GL_FALSE;
+			}
+			// R{,G]16 introduced in 3.0; R{,G}16_SNORM introduced in 3.1.
+			if (majorVersion == 3) {
+				if (minorVersion == 0)
+					R16Formats &= ~_KTX_R16_FORMATS_SNORM;
+			} else if (_ktxHasExtension("GL_ARB_texture_rg")) {
+				R16Formats &= ~_KTX_R16_FORMATS_SNORM;
+			} else {
+				R16Formats = _KTX_NO_R16_FORMATS;
+			}
+		}
+	}
+}
+
+#if SUPPORT_LEGACY_FORMAT_CONVERSION
+/**
+ * @internal
+ * @~English
+ * @brief Convert deprecated legacy-format texture to modern format.
+ * 
+ * The function sets the GL_TEXTURE_SWIZZLEs necessary to get the same
+ * behavior as the legacy format.
+ *
+ * @param [in] target       texture target on which the swizzle will
+ *                          be set.
+ * @param [in, out] pFormat pointer to variable holding the base format of the
+ *                          texture. The new base format is written here.
+ * @param [in, out] pInternalFormat  pointer to variable holding the internalformat
+ *                                   of the texture. The new internalformat is
+ *                                   written here.
+ * @return void unrecognized formats will be passed on to OpenGL. Any loading error
+ *              that arises will be handled in the usual way.
+ */           
+static void convertFormat(GLenum target, GLenum* pFormat, GLenum* pInternalFormat) {
+	switch (*pFormat) {
+	  case GL_ALPHA:
+		{
+		  GLint swizzle[] = {GL_ZERO, GL_ZERO, GL_ZERO, GL_RED};
+		  *pFormat = GL_RED;
+		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		  switch (*pInternalFormat) {
+	        case GL_ALPHA:
+		    case GL_ALPHA4:
+		    case GL_ALPHA8:
+			  *pInternalFormat = GL_R8;
+			  break;
+		    case GL_ALPHA12:
+		    case GL_ALPHA16:
+			  *pInternalFormat = GL_R16;
+			  break;
+		  }
+		}
+	  case GL_LUMINANCE:
+		{
+		  GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+		  *pFormat = GL_RED;
+		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		  switch (*pInternalFormat) {
+			case GL_LUMINANCE:
+		    case GL_LUMINANCE4:
+		    case GL_LUMINANCE8:
+			  *pInternalFormat = GL_R8;
+			  break;
+		    case GL_LUMINANCE12:
+		    case GL_LUMINANCE16:
+			  *pInternalFormat = GL_R16;
+			  break;
+#if 0
+		    // XXX Must avoid setting TEXTURE_SWIZZLE in these cases
+            // XXX Must manually swizzle.
+			case GL_SLUMINANCE:
+			case GL_SLUMINANCE8:
+			  *pInternalFormat = GL_SRGB8;
+			  break;
+#endif
+		  }
+		  break;
+		}
+	  case GL_LUMINANCE_ALPHA:
+		{
+		  GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+		  *pFormat = GL_RG;
+		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		  switch (*pInternalFormat) {
+			case GL_LUMINANCE_ALPHA:
+		    case GL_LUMINANCE4_ALPHA4:
+			case GL_LUMINANCE6_ALPHA2:
+		    case GL_LUMINANCE8_ALPHA8:
+			  *pInternalFormat = GL_RG8;
+			  break;
+		    case GL_LUMINANCE12_ALPHA4:
+			case GL_LUMINANCE12_ALPHA12:
+		    case GL_LUMINANCE16_ALPHA16:
+			  *pInternalFormat = GL_RG16;
+			  break;
+#if 0
+		    // XXX Must avoid setting TEXTURE_SWIZZLE in these cases
+            // XXX Must manually swizzle.
+			case GL_SLUMINANCE_ALPHA:
+			case GL_SLUMINANCE8_ALPHA8:
+			  *pInternalFormat = GL_SRGB8_ALPHA8;
+			  break;
+#endif
+		  }
+		  break;
+		}
+	  case GL_INTENSITY:
+		{
+		  GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_RED};
+		  *pFormat = GL_RED;
+		  glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		  switch (*pInternalFormat) {
+			case GL_INTENSITY:
+		    case GL_INTENSITY4:
+		    case GL_INTENSITY8:
+			  *pInternalFormat = GL_R8;
+			  break;
+		    case GL_INTENSITY12:
+		    case GL_INTENSITY16:
+			  *pInternalFormat = GL_R16;
+			  break;
+		  }
+		  break;
+		}
+	  default:
+	    break;
+	}
+}
+#endif /* SUPPORT_LEGACY_FORMAT_CONVERSION */
+
+
+/*
+ * @~English
+ * @brief Load a GL texture object from a ktxStream.
+ *
+ * This function will unpack compressed GL_ETC1_RGB8_OES and GL_ETC2_* format
+ * textures in software when the format is not supported by the GL context,
+ * provided the library has been compiled with SUPPORT_SOFTWARE_ETC_UNPACK
+ * defined as 1.
+ * 
+ * It will also convert textures with legacy formats to their modern equivalents
+ * when the format is not supported by the GL context, provided that the library
+ * has been compiled with SUPPORT_LEGACY_FORMAT_CONVERSION defined as 1. 
+ *
+ * @param [in] stream		pointer to the ktxStream from which to load.
+ * @param [in,out] pTexture	name of the GL texture to load. If NULL or if
+ *                          <tt>*pTexture == 0</tt> the function will generate
+ *                          a texture name. The function binds either the
+ *                          generated name or the name given in @p *pTexture
+ * 						    to the texture target returned in @p *pTarget,
+ * 						    before loading the texture data. If @p pTexture
+ *                          is not NULL and a name was generated, the generated
+ *                          name will be returned in *pTexture.
+ *                          A texture given whose storage was allocated with
+ *                          glTexStorage* is filled with gl*TexSubImage*, so
+ *                          storage can be allocated before the data arrives.
+ * @param [out] pTarget 	@p *pTarget is set to the texture target used. The
+ * 						    target is chosen based on the file contents.
+ * @param [out] pDimensions	If @p pDimensions is not NULL, the width, height and
+ *							depth of the texture's base level are returned in the
+ *                          fields of the KTX_dimensions structure to which it points.
+ * @param [out] pIsMipmapped
+ *	                        If @p pIsMipmapped is not NULL, @p *pIsMipmapped is set
+ *                          to GL_TRUE if the KTX texture is mipmapped, GL_FALSE
+ *                          otherwise.
+ * @param [out] pGlerror    @p *pGlerror is set to the value returned by
+ *                          glGetError when this function returns the error
+ *                          KTX_GL_ERROR. glerror can be NULL.
+ * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
+ *                          of key-value data pointed at by @p *ppKvd. Must not be
+ *                          NULL, if @p ppKvd is not NULL.                     
+ * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
+ *                          memory containing key-value data read from the file.
+ *                          The application is responsible for freeing the memory.
+ * @param [in] skipLevels	number of levels at the top of the mip chain to
+ *                          seek past without reading. The next level is
+ *                          loaded as level 0 and @p *pDimensions describes
+ *                          it. The smallest level is always loaded.
+ *
+ *
+ * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_VALUE @p target is @c NULL or the size of a mip
+ * 							    level is greater than the size of the
+ * 							    preceding level.
+ * @exception KTX_INVALID_OPERATION @p ppKvd is not NULL but pKvdLen is NULL.
+ * @exception KTX_UNEXPECTED_END_OF_FILE the file does not contain the
+ * 										 expected amount of data.
+ * @exception KTX_OUT_OF_MEMORY Sufficient memory could not be allocated to store
+ *                              the requested key-value data.
+ * @exception KTX_GL_ERROR      A GL error was raised by glBindTexture,
+ * 								glGenTextures or gl*TexImage*. The GL error
+ *                              will be returned in @p *glerror, if glerror
+ *                              is not @c NULL.
+ */
+static
+KTX_error_code
+ktxLoadTextureS(struct ktxStream* stream, GLuint* pTexture, GLenum* pTarget,
+				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
+				GLenum* pGlerror,
+				unsigned int* pKvdLen, unsigned char** ppKvd,
+				khronos_uint32_t skipLevels)
+{
+	GLint				previousUnpackAlignment;
+	KTX_header			header;
+	KTX_texinfo			texinfo;
+	void*				data = NULL;
+	khronos_uint32_t	dataSize = 0;
+	GLuint				texname;
+	int					texnameUser;
+	khronos_uint32_t    faceLodSize;
+	khronos_uint32_t    faceLodSizeRounded;
+	khronos_uint32_t	level;
+	khronos_uint32_t	face;
+	void*				staged;
+	const GLubyte*		source = NULL;
+	const void*			pixels;
+	int					uploadPending = 0;
+	GLboolean			useStorage = GL_FALSE;
+	GLenum				storageTarget;
+	GLenum				glFormat, glInternalFormat;
+	KTX_error_code		errorCode = KTX_SUCCESS;
+	GLenum				errorTmp;
+
+	if (pGlerror)
+		*pGlerror = GL_NO_ERROR;
+
+	if (ppKvd) {
+		*ppKvd = NULL;
+    }
+
+	if (!stream || !stream->read || !stream->skip) {
+		return KTX_INVALID_VALUE;
+	}
+
+	if (!pTarget) {
+		return KTX_INVALID_VALUE;
+	}
+
+	if (!stream->read(&header, KTX_HEADER_SIZE, stream->src)) {
+		return KTX_UNEXPECTED_END_OF_FILE;
+	}
+
+	errorCode = _ktxCheckHeader(&header, &texinfo);
+	if (errorCode != KTX_SUCCESS) {
+		return errorCode;
+	}
+
+	if (ppKvd) {
+		if (pKvdLen == NULL)
+			return KTX_INVALID_OPERATION;
+		*pKvdLen = header.bytesOfKeyValueData;
+		if (*pKvdLen) {
+			*ppKvd = (unsigned char*)malloc(*pKvdLen);
+			if (*ppKvd == NULL)
+				return KTX_OUT_OF_MEMORY;
+			if (!stream->read(*ppKvd, *pKvdLen, stream->src))
+			{
+				free(*ppKvd);
+				*ppKvd = NULL;
+
+				return KTX_UNEXPECTED_END_OF_FILE;
+			}
+		}
+	} else {
+		/* skip key/value metadata */
+		if (!stream->skip((long)header.bytesOfKeyValueData, stream->src)) {
+			return KTX_UNEXPECTED_END_OF_FILE;
+		}
+	}
+
+	/* Always keep the smallest level; a level 0 GL generates the rest of
+	 * cannot be skipped. */
+	if (skipLevels >= header.numberOfMipmapLevels)
+		skipLevels = header.numberOfMipmapLevels - 1;
+
+	if (contextProfile == 0)
+		discoverContextCapabilities();
+
+	/* KTX files require an unpack alignment of 4 */
+	previousUnpackAlignment = _ktxGetPixelStore(GL_UNPACK_ALIGNMENT);
+	if (previousUnpackAlignment != KTX_GL_UNPACK_ALIGNMENT) {
+		_ktxPixelStore(GL_UNPACK_ALIGNMENT, KTX_GL_UNPACK_ALIGNMENT);
+	}
+
+	texnameUser = pTexture && *pTexture;
+	if (texnameUser) {
+		texname = *pTexture;
+	} else {
+		_ktxGenTextures(1, &texname);
+	}
+	_ktxBindTexture(texinfo.glTarget, texname);
+
+	// Prefer glGenerateMipmaps over GL_GENERATE_MIPMAP
+	if (texinfo.generateMipmaps && (glGenerateMipmap == NULL)) {
+		glTexParameteri(texinfo.glTarget, GL_GENERATE_MIPMAP, GL_TRUE);
+	}
+
+	storageTarget = texinfo.glTarget;
+	if (texinfo.glTarget == GL_TEXTURE_CUBE_MAP) {
+		texinfo.glTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+	}
+
+	glInternalFormat = header.glInternalFormat;
+	glFormat = header.glFormat;
+	if (!texinfo.compressed) {
+#if SUPPORT_LEGACY_FORMAT_CONVERSION
+		// If sized legacy formats are supported there is no need to convert.
+		// If only unsized formats are supported, there is no point in converting
+		// as the modern formats aren't supported either.
+		if (sizedFormats == _NON_LEGACY_FORMATS && supportsSwizzle) {
+			convertFormat(texinfo.glTarget, &glFormat, &glInternalFormat);
+			errorTmp = glGetError();
+		} else if (sizedFormats == _NO_SIZED_FORMATS)
+			glInternalFormat = header.glBaseInternalFormat;
+#else
+		// When no sized formats are supported, or legacy sized formats are not
+		// supported, must change internal format.
+		if (sizedFormats == _NO_SIZED_FORMATS
+			|| (!(sizedFormats & _LEGACY_FORMATS) &&
+				(header.glBaseInternalFormat == GL_ALPHA	
+				|| header.glBaseInternalFormat == GL_LUMINANCE
+				|| header.glBaseInternalFormat == GL_LUMINANCE_ALPHA
+				|| header.glBaseInternalFormat == GL_INTENSITY))) {
+			glInternalFormat = header.glBaseInternalFormat;
+		}
+#endif
+	}
+
+	/* OES_compressed_ETC1_RGB8_texture forbids glCompressedTexSubImage2D,
+	 * which immutable storage is filled with. ETC1 data is valid ETC2 RGB8
+	 * data, so where ETC2 is supported ETC1 textures are made ETC2 ones. */
+	if (glInternalFormat == GL_ETC1_RGB8_OES && supportsETC2) {
+		glInternalFormat = GL_COMPRESSED_RGB8_ETC2;
+	}
+
+	/* Allocate the whole mip chain at once with immutable storage, so the
+	 * driver doesn't reallocate and revalidate as levels arrive, and fill
+	 * it with gl*TexSubImage*. A texture the caller passes in that already
+	 * has immutable storage is filled as it is. 1D textures, unsized
+	 * formats and formats glTexStorage* is refused for are specified level
+	 * by level. */
+	if (texnameUser) {
+		GLint immutable = GL_FALSE;
+
+		glGetTexParameteriv(storageTarget, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+		useStorage = immutable ? GL_TRUE : GL_FALSE;
+	} else if (texinfo.textureDimensions > 1 && glInternalFormat != header.glBaseInternalFormat) {
+		GLsizei storageLevels = header.numberOfMipmapLevels - skipLevels;
+		GLsizei width = MAX(1, header.pixelWidth >> skipLevels);
+		GLsizei height = MAX(1, header.pixelHeight >> skipLevels);
+		GLsizei depth = MAX(1, header.pixelDepth >> skipLevels);
+
+		if (texinfo.generateMipmaps) {
+			/* room for the levels glGenerateMipmap builds */
+			GLsizei largest = MAX(width, height);
+
+			if (texinfo.textureDimensions == 3 && !header.numberOfArrayElements)
+				largest = MAX(largest, depth);
+			for (storageLevels = 1; largest > 1; largest >>= 1)
+				++storageLevels;
+		}
+
+		while (glGetError() != GL_NO_ERROR)
+			;
+		if (texinfo.textureDimensions == 2) {
+			glTexStorage2D(storageTarget, storageLevels, glInternalFormat, width,
+						   header.numberOfArrayElements ? (GLsizei)header.numberOfArrayElements : height);
+		} else {
+			glTexStorage3D(storageTarget, storageLevels, glInternalFormat, width, height,
+						   header.numberOfArrayElements ? (GLsizei)header.numberOfArrayElements : depth);
+		}
+		useStorage = glGetError() == GL_NO_ERROR ? GL_TRUE : GL_FALSE;
+	}
+
+	/* Seek past the levels that are not wanted without reading them */
+	for (level = 0; level < skipLevels; ++level)
+	{
+		if (!stream->read(&faceLodSize, sizeof(khronos_uint32_t), stream->src)) {
+			errorCode = KTX_UNEXPECTED_END_OF_FILE;
+			goto cleanup;
+		}
+		if (header.endianness == KTX_ENDIAN_REF_REV) {
+			_ktxSwapEndian32(&faceLodSize, 1);
+		}
+		faceLodSizeRounded = (faceLodSize + 3) & ~(khronos_uint32_t)3;
+		if (!stream->skip((GLsizei)(faceLodSizeRounded * header.numberOfFaces), stream->src)) {
+			errorCode = KTX_UNEXPECTED_END_OF_FILE;
+			goto cleanup;
+		}
+	}
+
+	for (level = skipLevels; level < header.numberOfMipmapLevels; ++level)
+	{
+		GLint   glLevel     = (GLint)(level - skipLevels);
+		GLsizei pixelWidth  = MAX(1, header.pixelWidth  >> level);
+		GLsizei pixelHeight = MAX(1, header.pixelHeight >> level);
+		GLsizei pixelDepth  = MAX(1, header.pixelDepth  >> level);
+
+		if (!stream->read(&faceLodSize, sizeof(khronos_uint32_t), stream->src)) {
+			errorCode = KTX_UNEXPECTED_END_OF_FILE;
+			goto cleanup;
+		}
+		if (header.endianness == KTX_ENDIAN_REF_REV) {
+			_ktxSwapEndian32(&faceLodSize, 1);
+		}
+		faceLodSizeRounded = (faceLodSize + 3) & ~(khronos_uint32_t)3;
+		if (dataSize == 0) {
+			/* the first level loaded is the largest */
+			dataSize = faceLodSizeRounded;
+		}
+		else if (dataSize < faceLodSizeRounded) {
+			/* subsequent levels cannot be larger than the first level */
+			errorCode = KTX_INVALID_VALUE;
+			goto cleanup;
+		}
+
+		/* Read all the faces of the level straight into the staging memory
+		 * when there is some. Byte swapped data is converted in the image
+		 * buffer instead, as is data the software unpacker may need. */
+		staged = NULL;
+#if !SUPPORT_SOFTWARE_ETC_UNPACK
+		if (_ktxBeginUpload && header.endianness == KTX_ENDIAN_REF) {
+			staged = _ktxBeginUpload(faceLodSizeRounded * header.numberOfFaces);
+		}
+#endif
+		if (staged) {
+			const void* start;
+			int read = stream->read(staged, faceLodSizeRounded * header.numberOfFaces, stream->src);
+
+			uploadPending = 1;
+			if (!_ktxEndUpload(&start) || !read) {
+				errorCode = read ? KTX_OUT_OF_MEMORY : KTX_UNEXPECTED_END_OF_FILE;
+				goto cleanup;
+			}
+			source = (const GLubyte*)start;
+		}
+		else if (!data) {
+			/* allocate memory sufficient for the first level */
+			data = _ktxImageAlloc(dataSize);
+			if (!data) {
+				errorCode = KTX_OUT_OF_MEMORY;
+				goto cleanup;
+			}
+		}
+
+		for (face = 0; face < header.numberOfFaces; ++face)
+		{
+			if (staged) {
+				pixels = source + face * faceLodSizeRounded;
+			} else {
+				if (!stream->read(data, faceLodSizeRounded, stream->src)) {
+					errorCode = KTX_UNEXPECTED_END_OF_FILE;
+					goto cleanup;
+				}
+
+				/* Perform endianness conversion on texture data */
+				if (header.endianness == KTX_ENDIAN_REF_REV && header.glTypeSize == 2) {
+					_ktxSwapEndian16((khronos_uint16_t*)data, faceLodSize / 2);
+				}
+				else if (header.endianness == KTX_ENDIAN_REF_REV && header.glTypeSize == 4) {
+					_ktxSwapEndian32((khronos_uint32_t*)data, faceLodSize / 4);
+				}
+				pixels = data;
+			}
+
+			if (texinfo.textureDimensions == 1) {
+				if (texinfo.compressed) {
+					glCompressedTexImage1D(texinfo.glTarget + face, glLevel, 
+						glInternalFormat, pixelWidth, 0,
+						faceLodSize, pixels);
+				} else {
+					glTexImage1D(texinfo.glTarget + face, glLevel, 
+						glInternalFormat, pixelWidth, 0, 
+						glFormat, header.glType, pixels);
+				}
+			} else if (texinfo.textureDimensions == 2) {
+				if (header.numberOfArrayElements) {
+					pixelHeight = header.numberOfArrayElements;
+				}
+				if (useStorage && texinfo.compressed) {
+					glCompressedTexSubImage2D(texinfo.glTarget + face, glLevel,
+						0, 0, pixelWidth, pixelHeight, glInternalFormat,
+						faceLodSize, pixels);
+				} else if (useStorage) {
+					glTexSubImage2D(texinfo.glTarget + face, glLevel,
+						0, 0, pixelWidth, pixelHeight,
+						glFormat, header.glType, pixels);
+				} else if (texinfo.compressed) {
+				    // It is simpler to just attempt to load the format, rather than divine which
+					// formats are supported by the implementation. In the event of an error,
+					// software unpacking can be attempted.
+					glCompressedTexImage2D(texinfo.glTarget + face, glLevel, 
+						glInternalFormat, pixelWidth, pixelHeight, 0,
+						faceLodSize, pixels);
+				} else {
+					glTexImage2D(texinfo.glTarget + face, glLevel, 
+						glInternalFormat, pixelWidth, pixelHeight, 0, 
+						glFormat, header.glType, pixels);
+				}
+			} else if (texinfo.textureDimensions == 3) {
+				if (header.numberOfArrayElements) {
+					pixelDepth = header.numberOfArrayElements;
+				}
+				if (useStorage && texinfo.compressed) {
+					glCompressedTexSubImage3D(texinfo.glTarget + face, glLevel,
+						0, 0, 0, pixelWidth, pixelHeight, pixelDepth,
+						glInternalFormat, faceLodSize, pixels);
+				} else if (useStorage) {
+					glTexSubImage3D(texinfo.glTarget + face, glLevel,
+						0, 0, 0, pixelWidth, pixelHeight, pixelDepth,
+						glFormat, header.glType, pixels);
+				} else if (texinfo.compressed) {
+					glCompressedTexImage3D(texinfo.glTarget + face, glLevel, 
+						glInternalFormat, pixelWidth, pixelHeight, pixelDepth, 0,
+						faceLodSize, pixels);
+				} else {
+					glTexImage3D(texinfo.glTarget + face, glLevel, 
+						glInternalFormat, pixelWidth, pixelHeight, pixelDepth, 0, 
+						glFormat, header.glType, pixels);
+				}
+			}
+
+			errorTmp = glGetError();
+#if SUPPORT_SOFTWARE_ETC_UNPACK
+			// Renderion is returning INVALID_VALUE. Oops!!
+			if ((errorTmp == GL_INVALID_ENUM || errorTmp == GL_INVALID_VALUE)
+				&& texinfo.compressed
+				&& texinfo.textureDimensions == 2
+				&& (glInternalFormat == GL_ETC1_RGB8_OES || (glInternalFormat >= GL_COMPRESSED_R11_EAC && glInternalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC)))
+			    {
+				GLubyte* unpacked;
+				GLenum format, internalFormat, type;
+
+				errorCode = _ktxUnpackETC((GLubyte*)data, glInternalFormat, pixelWidth, pixelHeight,
+					                      &unpacked, &format, &internalFormat, &type,
+										  R16Formats, supportsSRGB);
+				if (errorCode != KTX_SUCCESS) {
+					goto cleanup;
+				}
+				if (!sizedFormats & _NON_LEGACY_FORMATS) {
+					if (internalFormat == GL_RGB8)
+						internalFormat = GL_RGB;
+					else if (internalFormat == GL_RGBA8)
+						internalFormat = GL_RGBA;
+				}
+				glTexImage2D(texinfo.glTarget + face, glLevel, 
+							 internalFormat, pixelWidth, pixelHeight, 0, 
+							 format, type, unpacked);
+
+				free(unpacked);
+				errorTmp = glGetError();
+			}
+#endif
+			if (errorTmp != GL_NO_ERROR) {
+				if (pGlerror)
+					*pGlerror = errorTmp;
+				errorCode = KTX_GL_ERROR;
+				goto cleanup;
+			}
+		}
+
+		if (uploadPending) {
+			_ktxFinishUpload();
+			uploadPending = 0;
+		}
+	}
+
+cleanup:
+	if (uploadPending)
+		_ktxFinishUpload();
+	if (data)
+		_ktxImageFree(data);
+
+	/* restore previous GL state */
+	if (previousUnpackAlignment != KTX_GL_UNPACK_ALIGNMENT) {
+		_ktxPixelStore(GL_UNPACK_ALIGNMENT, previousUnpackAlignment);
+	}
+
+	if (errorCode == KTX_SUCCESS)
+	{
+		if (texinfo.generateMipmaps && glGenerateMipmap) {
+			glGenerateMipmap(texinfo.glTarget);
+		}
+		*pTarget = texinfo.glTarget;
+		if (pTexture) {
+			*pTexture = texname;
+		}
+		if (pDimensions) {
+			pDimensions->width = MAX(1, header.pixelWidth >> skipLevels);
+			pDimensions->height = header.pixelHeight ? MAX(1, header.pixelHeight >> skipLevels) : 0;
+			pDimensions->depth = header.pixelDepth ? MAX(1, header.pixelDepth >> skipLevels) : 0;
+		}
+		if (pIsMipmapped) {
+			if (texinfo.generateMipmaps || header.numberOfMipmapLevels - skipLevels > 1)
+				*pIsMipmapped = GL_TRUE;
+			else
+				*pIsMipmapped = GL_FALSE;
+		}
+	} else {
+		if (ppKvd && *ppKvd)
+		{
+			free(*ppKvd);
+			*ppKvd = NULL;
+		}
+
+		if (!texnameUser) {
+			_ktxDeleteTextures(1, &texname);
+		}
+	}
+	return errorCode;
+}
+
+/* Implementation of ktxStream for FILE */
+
+static
+int ktxFileStream_read(void* dst, const GLsizei count, void* src)
+{
+	if (!dst || !src || (fread(dst, count, 1, (FILE*)src) != 1))
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+static
+int ktxFileStream_skip(const GLsizei count, void* src)
+{
+	if (!src || (count < 0) || (fseek((FILE*)src, count, SEEK_CUR) != 0))
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+static
+int ktxFileInit(struct ktxStream* stream, FILE* file)
+{
+	if (!stream || !file)
+	{
+		return 0;
+	}
+
+	stream->src = (void*)file;
+	stream->read = ktxFileStream_read;
+	stream->skip = ktxFileStream_skip;
+
+	return 1;
+}
+
+/**
+ * @~English
+ * @brief Load a GL texture object from a stdio FILE stream.
+ *
+ * This function will unpack compressed GL_ETC1_RGB8_OES and GL_ETC2_* format
+ * textures in software when the format is not supported by the GL context,
+ * provided the library has been compiled with SUPPORT_SOFTWARE_ETC_UNPACK
+ * defined as 1.
+ * 
+ * It will also convert texture with legacy formats to their modern equivalents
+ * when the format is not supported by the GL context, provided that the library
+ * has been compiled with SUPPORT_LEGACY_FORMAT_CONVERSION defined as 1. 
+ *
+ * @param [in] file			pointer to the stdio FILE stream from which to
+ * 							load.
+ * @param [in,out] pTexture	name of the GL texture to load. If NULL or if
+ *                          <tt>*pTexture == 0</tt> the function will generate
+ *                          a texture name. The function binds either the
+ *                          generated name or the name given in @p *pTexture
+ * 						    to the texture target returned in @p *pTarget,
+ * 						    before loading the texture data. If @p pTexture
+ *                          is not NULL and a name was generated, the generated
+ *                          name will be returned in *pTexture.
+ *                          A texture given whose storage was allocated with
+ *                          glTexStorage* is filled with gl*TexSubImage*, so
+ *                          storage can be allocated before the data arrives.
+ * @param [out] pTarget 	@p *pTarget is set to the texture target used. The
+ * 						    target is chosen based on the file contents.
+ * @param [out] pDimensions	If @p pDimensions is not NULL, the width, height and
+ *							depth of the texture's base level are returned in the
+ *                          fields of the KTX_dimensions structure to which it points.
+ * @param [out] pIsMipmapped
+ *	                        If @p pIsMipmapped is not NULL, @p *pIsMipmapped is set
+ *                          to GL_TRUE if the KTX texture is mipmapped, GL_FALSE
+ *                          otherwise.
+ * @param [out] pGlerror    @p *pGlerror is set to the value returned by
+ *                          glGetError when this function returns the error
+ *                          KTX_GL_ERROR. glerror can be NULL.
+ * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
+ *                          of key-value data pointed at by @p *ppKvd. Must not be
+ *                          NULL, if @p ppKvd is not NULL.                     
+ * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
+ *                          memory containing key-value data read from the file.
+ *                          The application is responsible for freeing the memory.
+ *
+ *
+ * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_VALUE @p target is @c NULL or the size of a mip
+ * 							    level is greater than the size of the
+ * 							    preceding level.
+ * @exception KTX_INVALID_OPERATION @p ppKvd is not NULL but pKvdLen is NULL.
+ * @exception KTX_UNEXPECTED_END_OF_FILE the file does not contain the
+ * 										 expected amount of data.
+ * @exception KTX_OUT_OF_MEMORY Sufficient memory could not be allocated to store
+ *                              the requested key-value data.
+ * @exception KTX_GL_ERROR      A GL error was raised by glBindTexture,
+ * 								glGenTextures or gl*TexImage*. The GL error
+ *                              will be returned in @p *glerror, if glerror
+ *                              is not @c NULL.
+ */
+KTX_error_code
+ktxLoadTextureF(FILE* file, GLuint* pTexture, GLenum* pTarget,
+				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
+				GLenum* pGlerror,
+				unsigned int* pKvdLen, unsigned char** ppKvd)
+{
+	struct ktxStream stream;
+
+	if (!ktxFileInit(&stream, file))
+	{
+		return KTX_FILE_OPEN_FAILED;
+	}
+
+	return ktxLoadTextureS(&stream, pTexture, pTarget, pDimensions, pIsMipmapped, pGlerror, pKvdLen, ppKvd, 0);
+}
+
+/**
+ * @~English
+ * @brief Load a GL texture object from a named file on disk.
+ *
+ * @param [in] filename		pointer to a C string that contains the path of
+ * 							the file to load.
+ * @param [in,out] pTexture	name of the GL texture to load. See
+ *                          ktxLoadTextureF() for details.
+ * @param [out] pTarget 	@p *pTarget is set to the texture target used. See
+ *                          ktxLoadTextureF() for details.
+ * @param [out] pDimensions @p the texture's base level width depth and height
+ *                          are returned in structure to which this points.
+ *                          See ktxLoadTextureF() for details.
+ * @param [out] pIsMipmapped @p pIsMipMapped is set to indicate if the loaded
+ *                          texture is mipmapped. See ktxLoadTextureF() for
+ *                          details.
+ * @param [out] pGlerror    @p *pGlerror is set to the value returned by
+ *                          glGetError when this function returns the error
+ *                          KTX_GL_ERROR. glerror can be NULL.
+ * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
+ *                          of key-value data pointed at by @p *ppKvd. Must not be
+ *                          NULL, if @p ppKvd is not NULL.                     
+ * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
+ *                          memory containing key-value data read from the file.
+ *                          The application is responsible for freeing the memory.*
+ * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_FILE_OPEN_FAILED	The specified file could not be opened.
+ * @exception KTX_INVALID_VALUE		See ktxLoadTextureF() for causes.
+ * @exception KTX_INVALID_OPERATION	See ktxLoadTextureF() for causes.
+ * @exception KTX_UNEXPECTED_END_OF_FILE See ktxLoadTextureF() for causes.
+ * 								
+ * @exception KTX_GL_ERROR			See ktxLoadTextureF() for causes.
+ */
+KTX_error_code
+ktxLoadTextureN(const char* const filename, GLuint* pTexture, GLenum* pTarget,
+				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
+				GLenum* pGlerror,
+				unsigned int* pKvdLen, unsigned char** ppKvd)
+{
+	KTX_error_code errorCode;
+	FILE* file = fopen(filename, "rb");
+
+	if (file) {
+		errorCode = ktxLoadTextureF(file, pTexture, pTarget, pDimensions,
+								    pIsMipmapped, pGlerror, pKvdLen, ppKvd);
+		fclose(file);
+	} else
+	    errorCode = KTX_FILE_OPEN_FAILED;
+
+	return errorCode;
+}
+
+/* Implementation of ktxStream for memory */
+
+struct ktxMem
+{
+	const unsigned char* bytes;
+	GLsizei size;
+	GLsizei pos;
+};
+
+static
+int ktxMemStream_read(void* dst, const GLsizei count, void* src)
+{
+	struct ktxMem* mem = (struct ktxMem*)src;
+	
+	if(!dst || !mem || (mem->pos + count > mem->size) || (mem->pos + count < mem->pos))
+	{
+		return 0;
+	}
+
+	memcpy(dst, mem->bytes + mem->pos, count);
+	mem->pos += count;
+
+	return 1;
+}
+
+static
+int ktxMemStream_skip(const GLsizei count, void* src)
+{
+	struct ktxMem* mem = (struct ktxMem*)src;
+
+	if(!mem || (mem->pos + count > mem->size) || (mem->pos + count < mem->pos))
+	{
+		return 0;
+	}
+
+	mem->pos += count;
+
+	return 1;
+}
+
+static
+int ktxMemInit(struct ktxStream* stream, struct ktxMem* mem, const void* bytes, GLsizei size)
+{
+	if (!stream || !mem || !bytes || (size <= 0))
+	{
+		return 0;
+	}
+	
+	mem->bytes = (const unsigned char*)bytes;
+	mem->size = size;
+	mem->pos = 0;
+
+	stream->src = mem;
+	stream->read = ktxMemStream_read;
+	stream->skip = ktxMemStream_skip;
+
+	return 1;
+}
+
+/**
+ * @~English
+ * @brief Load a GL texture object from KTX formatted data in memory.
+ *
+ * @param [in] bytes		pointer to the array of bytes containing
+ * 							the KTX format data to load.
+ * @param [in] size			size of the memory array containing the
+ *                          KTX format data.
+ * @param [in,out] pTexture	name of the GL texture to load. See
+ *                          ktxLoadTextureF() for details.
+ * @param [out] pTarget 	@p *pTarget is set to the texture target used. See
+ *                          ktxLoadTextureF() for details.
+ * @param [out] pDimensions @p the texture's base level width depth and height
+ *                          are returned in structure to which this points.
+ *                          See ktxLoadTextureF() for details.
+ * @param [out] pIsMipmapped @p *pIsMipMapped is set to indicate if the loaded
+ *                          texture is mipmapped. See ktxLoadTextureF() for
+ *                          details.
+ * @param [out] pGlerror    @p *pGlerror is set to the value returned by
+ *                          glGetError when this function returns the error
+ *                          KTX_GL_ERROR. glerror can be NULL.
+ * @param [in,out] pKvdLen	If not NULL, @p *pKvdLen is set to the number of bytes
+ *                          of key-value data pointed at by @p *ppKvd. Must not be
+ *                          NULL, if @p ppKvd is not NULL.                     
+ * @param [in,out] ppKvd	If not NULL, @p *ppKvd is set to the point to a block of
+ *                          memory containing key-value data read from the file.
+ *                          The application is responsible for freeing the memory.*
+ *
+ * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_FILE_OPEN_FAILED	The specified memory could not be opened as a file.
+ * @exception KTX_INVALID_VALUE		See ktxLoadTextureF() for causes.
+ * @exception KTX_INVALID_OPERATION	See ktxLoadTextureF() for causes.
+ * @exception KTX_UNEXPECTED_END_OF_FILE See ktxLoadTextureF() for causes.
+ * 								
+ * @exception KTX_GL_ERROR			See ktxLoadTextureF() for causes.
+ */
+KTX_error_code
+ktxLoadTextureM(const void* bytes, GLsizei size, GLuint* pTexture, GLenum* pTarget,
+				KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
+				GLenum* pGlerror,
+				unsigned int* pKvdLen, unsigned char** ppKvd)
+{
+	struct ktxMem mem;
+	struct ktxStream stream;
+
+	if (!ktxMemInit(&stream, &mem, bytes, size))
+	{
+		return KTX_FILE_OPEN_FAILED;
+	}
+
+	return ktxLoadTextureS(&stream, pTexture, pTarget, pDimensions, pIsMipmapped, pGlerror, pKvdLen, ppKvd, 0);
+}
+
+/**
+ * @~English
+ * @brief Load a GL texture object from a caller supplied stream, leaving out
+ *        the largest mip levels.
+ *
+ * The skipped levels are passed over with @p skip, so a stream that can seek
+ * never reads them. The remaining levels are loaded as levels 0 to n.
+ *
+ * @param [in] src			opaque pointer passed back to @p read and @p skip.
+ * @param [in] read			function reading @p count bytes from @p src,
+ *                          returning 0 if they could not all be read.
+ * @param [in] skip			function moving @p count bytes forward in @p src,
+ *                          returning 0 on failure.
+ * @param [in] skipLevels	number of levels to leave out. Clamped so that the
+ *                          smallest level is always loaded.
+ * @param [in,out] pTexture	name of the GL texture to load. See
+ *                          ktxLoadTextureF() for details.
+ * @param [out] pTarget 	@p *pTarget is set to the texture target used. See
+ *                          ktxLoadTextureF() for details.
+ * @param [out] pDimensions @p the width, depth and height of the first level
+ *                          loaded are returned in structure to which this
+ *                          points.
+ * @param [out] pIsMipmapped @p *pIsMipMapped is set to indicate if more than
+ *                          one level was loaded, or GL generated the mipmaps.
+ * @param [out] pGlerror    @p *pGlerror is set to the value returned by
+ *                          glGetError when this function returns the error
+ *                          KTX_GL_ERROR. glerror can be NULL.
+ * @param [in,out] pKvdLen	See ktxLoadTextureF() for details.
+ * @param [in,out] ppKvd	See ktxLoadTextureF() for details.
+ *
+ * @return	KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_VALUE		@p read or @p skip is NULL, or see
+ *                                  ktxLoadTextureF() for causes.
+ * @exception KTX_INVALID_OPERATION	See ktxLoadTextureF() for causes.
+ * @exception KTX_UNEXPECTED_END_OF_FILE See ktxLoadTextureF() for causes.
+ * @exception KTX_GL_ERROR			See ktxLoadTextureF() for causes.
+ */
+KTX_error_code
+ktxLoadTextureCB(void* src, ktxReadFunc read, ktxSkipFunc skip,
+				 unsigned int skipLevels,
+				 GLuint* pTexture, GLenum* pTarget,
+				 KTX_dimensions* pDimensions, GLboolean* pIsMipmapped,
+				 GLenum* pGlerror,
+				 unsigned int* pKvdLen, unsigned char** ppKvd)
+{
+	struct ktxStream stream;
+
+	stream.src = src;
+	stream.read = read;
+	stream.skip = skip;
+
+	return ktxLoadTextureS(&stream, pTexture, pTarget, pDimensions, pIsMipmapped, pGlerror, pKvdLen, ppKvd, skipLevels);
+}
+
+
+
+/**
+ * @~English
+ * @brief Sets the functions used to allocate and free the buffer image
+ *        data is read into.
+ *
+ * The loaders read each mip level into one buffer before passing it to GL,
+ * and free it once the texture is loaded. Applications loading many textures
+ * can hand out recycled memory instead. Not thread safe; set it before
+ * loading.
+ *
+ * @param [in] allocFunc	function returning at least @p size bytes, or
+ *                          NULL if out of memory. NULL restores malloc.
+ * @param [in] freeFunc		function freeing what @p allocFunc returned. NULL
+ *                          restores free.
+ */
+void
+ktxSetImageAllocator(ktxAllocFunc allocFunc, ktxFreeFunc freeFunc)
+{
+	_ktxImageAlloc = allocFunc ? allocFunc : malloc;
+	_ktxImageFree = freeFunc ? freeFunc : free;
+}
+
+/**
+ * @~English
+ * @brief Sets the functions image data is staged through on its way to GL.
+ *
+ * For each mip level the loaders ask @p beginFunc for memory to read all of
+ * its faces into, call @p endFunc once it is filled, upload the faces from
+ * what @p endFunc returned, then call @p finishFunc. This lets the data go
+ * straight into a mapped pixel unpack buffer and the gl*TexImage* calls
+ * source it from there. Byte swapped files, and builds that may unpack ETC
+ * in software, use the image allocator instead. Not thread safe; set it
+ * before loading.
+ *
+ * @param [in] beginFunc	function returning memory for @p size bytes, or
+ *                          NULL to use the image allocator for the level.
+ *                          NULL turns staging off.
+ * @param [in] endFunc		function setting @p *ppStart to what the
+ *                          gl*TexImage* calls are passed for the first byte
+ *                          (e.g. an offset in the bound unpack buffer).
+ *                          Returns 0 if the data was lost.
+ * @param [in] finishFunc	function called after the level was uploaded,
+ *                          or after an error once @p beginFunc succeeded.
+ */
+void
+ktxSetUploadFunctions(ktxBeginUploadFunc beginFunc, ktxEndUploadFunc endFunc,
+					  ktxFinishUploadFunc finishFunc)
+{
+	if (beginFunc && endFunc && finishFunc) {
+		_ktxBeginUpload = beginFunc;
+		_ktxEndUpload = endFunc;
+		_ktxFinishUpload = finishFunc;
+	} else {
+		_ktxBeginUpload = NULL;
+		_ktxEndUpload = NULL;
+		_ktxFinishUpload = NULL;
+	}
+}
+
+/**
+ * @~English
+ * @brief Sets the functions the loaders create, bind and delete textures, and
+ *        set and query the unpack alignment with.
+ *
+ * This lets a cache of the GL state see the textures the loaders create and
+ * bind, and answer the query of the unpack alignment the loaders restore
+ * after uploading, which is a round trip to the driver otherwise. Not thread
+ * safe; set it before loading.
+ *
+ * @param [in] genFunc		replaces glGenTextures.
+ * @param [in] deleteFunc	replaces glDeleteTextures.
+ * @param [in] bindFunc		replaces glBindTexture.
+ * @param [in] storeFunc	replaces glPixelStorei.
+ * @param [in] getStoreFunc	returns a pixel store parameter, replacing
+ *                          glGetIntegerv.
+ *
+ * NULL for any of them restores the GL functions for all of them.
+ */
+void
+ktxSetStateFunctions(ktxGenTexturesFunc genFunc,
+					 ktxDeleteTexturesFunc deleteFunc,
+					 ktxBindTextureFunc bindFunc,
+					 ktxPixelStoreFunc storeFunc,
+					 ktxGetPixelStoreFunc getStoreFunc)
+{
+	if (genFunc && deleteFunc && bindFunc && storeFunc && getStoreFunc) {
+		_ktxGenTextures = genFunc;
+		_ktxDeleteTextures = deleteFunc;
+		_ktxBindTexture = bindFunc;
+		_ktxPixelStore = storeFunc;
+		_ktxGetPixelStore = getStoreFunc;
+	} else {
+		_ktxGenTextures = defaultGenTextures;
+		_ktxDeleteTextures = defaultDeleteTextures;
+		_ktxBindTexture = defaultBindTexture;
+		_ktxPixelStore = defaultPixelStore;
+		_ktxGetPixelStore = defaultGetPixelStore;
+	}
+}
+
+/**
+ * @~English
+ * @brief Sets the functions the loaders learn the version and extensions of
+ *        the current context with.
+ *
+ * This lets the loaders answer from capabilities queried once per context
+ * instead of scanning the extension string. The capabilities are discovered
+ * again on the next load. Not thread safe; set it before loading.
+ *
+ * @param [in] versionFunc		returns whether the context is OpenGL ES, and
+ *                              its major and minor version.
+ * @param [in] extensionFunc	returns whether the context has an extension.
+ *
+ * NULL for either of them restores the GL queries for both of them.
+ */
+void
+ktxSetCapabilityFunctions(ktxGetVersionFunc versionFunc,
+						  ktxHasExtensionFunc extensionFunc)
+{
+	if (versionFunc && extensionFunc) {
+		_ktxGetVersion = versionFunc;
+		_ktxHasExtension = extensionFunc;
+	} else {
+		_ktxGetVersion = defaultGetVersion;
+		_ktxHasExtension = defaultHasExtension;
+	}
+	contextProfile = 0;
+}
@@ -0,0 +1,434 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <android/log.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "gl_state.h"
+#include "loader_thread.h"
+#include "upload.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Debugging helper functions
+#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
+
+// A texture on its way from QueueTextureLoad to its handle
+typedef struct LoadRequest
+{
+    char*               pName;
+    TextureLoadFunction pLoad;
+    TextureOptions      mOptions;
+    int                 mHasOptions;
+    GLuint*             pHandle;
+    GLuint              mTexture;   // Loaded texture, 0 if the load failed
+    GLsync              mFence;     // Signalled once the GPU is done uploading mTexture
+    struct LoadRequest* pNext;
+} LoadRequest;
+
+enum
+{
+    LOADER_STOPPED,
+    LOADER_STARTING,
+    LOADER_RUNNING,
+    LOADER_STOPPING
+};
+
+static pthread_mutex_t  gLoaderMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   gLoaderWake = PTHREAD_COND_INITIALIZER;     // Work queued, or state changed
+static int              gLoaderState = LOADER_STOPPED;
+static LoadRequest*     gpQueuedLoads = NULL;                       // Oldest first
+static LoadRequest*     gpFinishedLoads = NULL;                     // Waiting for their fences
+static LoadRequest*     gpRunningLoad = NULL;                       // Off the queue, not finished yet
+static pthread_t        gLoaderThread;
+
+// Only touched by the render thread, the loader thread reads them before it signals LOADER_RUNNING
+static EGLDisplay       gLoaderDisplay = EGL_NO_DISPLAY;
+static EGLContext       gLoaderContext = EGL_NO_CONTEXT;
+static EGLSurface       gLoaderSurface = EGL_NO_SURFACE;
+static EGLContext       gSharedContext = EGL_NO_CONTEXT;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Appends a request to a list. gLoaderMutex must be held.
+static void AppendRequest( LoadRequest** ppList, LoadRequest* pRequest )
+{
+    while( *ppList != NULL )
+    {
+        ppList = &( *ppList )->pNext;
+    }
+    pRequest->pNext = NULL;
+    *ppList = pRequest;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Frees a request that has been taken off its list
+static void FreeRequest( LoadRequest* pRequest )
+{
+    free( pRequest->pName );
+    free( pRequest );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Runs the queued loads with the loader context current until StopLoaderThread
+static void* LoaderThread( void* pArg )
+{
+    int current = eglMakeCurrent( gLoaderDisplay, gLoaderSurface, gLoaderSurface, gLoaderContext );
+
+    (void)pArg;
+
+    // The thread may have shadowed the state of an older loader context. The active unit is made
+    // known, so the binds of the loads are shadowed.
+    ResetGlStateCache();
+    if( current )
+    {
+        CachedActiveTexture( GL_TEXTURE0 );
+    }
+
+    pthread_mutex_lock( &gLoaderMutex );
+    gLoaderState = current ? LOADER_RUNNING : LOADER_STOPPING;
+    pthread_cond_broadcast( &gLoaderWake );
+
+    while( gLoaderState == LOADER_RUNNING )
+    {
+        LoadRequest* pRequest = gpQueuedLoads;
+
+        if( pRequest == NULL )
+        {
+            pthread_cond_wait( &gLoaderWake, &gLoaderMutex );
+            continue;
+        }
+        gpQueuedLoads = pRequest->pNext;
+        gpRunningLoad = pRequest;
+        pthread_mutex_unlock( &gLoaderMutex );
+
+        pRequest->mTexture = pRequest->pLoad( pRequest->pName, pRequest->mHasOptions ? &pRequest->mOptions : NULL );
+
+        // The flush gets the fence to the GPU, the render thread can't flush this context for us
+        pRequest->mFence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+        glFlush();
+
+        pthread_mutex_lock( &gLoaderMutex );
+        gpRunningLoad = NULL;
+        AppendRequest( &gpFinishedLoads, pRequest );
+
+        // Nothing else to load for now, the ring's buffers aren't needed until then
+        if( gpQueuedLoads == NULL )
+        {
+            pthread_mutex_unlock( &gLoaderMutex );
+            ShutdownUploadRing();
+            pthread_mutex_lock( &gLoaderMutex );
+        }
+    }
+    pthread_mutex_unlock( &gLoaderMutex );
+
+    if( current )
+    {
+        ShutdownUploadRing();
+        eglMakeCurrent( gLoaderDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+    }
+    return NULL;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Creates the loader context in the share group of the current context, with a 1x1 pbuffer for
+// the drivers that can't make a context current without a surface
+static int CreateLoaderContext()
+{
+    static const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                               EGL_NONE };
+    static const EGLint contextAttributes[] = { EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE };
+    static const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext shared = eglGetCurrentContext();
+    EGLConfig config;
+    EGLint configCount = 0;
+
+    if( display == EGL_NO_DISPLAY || shared == EGL_NO_CONTEXT )
+    {
+        LogError( "The loader thread needs a current context to share with\n" );
+        return 0;
+    }
+
+    if( !eglChooseConfig( display, configAttributes, &config, 1, &configCount ) || configCount < 1 )
+    {
+        LogError( "No pbuffer config for the loader thread\n" );
+        return 0;
+    }
+
+    gLoaderContext = eglCreateContext( display, config, shared, contextAttributes );
+    if( gLoaderContext == EGL_NO_CONTEXT )
+    {
+        LogError( "eglCreateContext failed for the loader thread: 0x%x\n", eglGetError() );
+        return 0;
+    }
+
+    gLoaderSurface = eglCreatePbufferSurface( display, config, surfaceAttributes );
+    if( gLoaderSurface == EGL_NO_SURFACE )
+    {
+        LogError( "eglCreatePbufferSurface failed for the loader thread: 0x%x\n", eglGetError() );
+        eglDestroyContext( display, gLoaderContext );
+        gLoaderContext = EGL_NO_CONTEXT;
+        return 0;
+    }
+
+    gLoaderDisplay = display;
+    gSharedContext = shared;
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Destroys the loader context and its pbuffer, once the thread has released them
+static void DestroyLoaderContext()
+{
+    eglDestroySurface( gLoaderDisplay, gLoaderSurface );
+    eglDestroyContext( gLoaderDisplay, gLoaderContext );
+    gLoaderDisplay = EGL_NO_DISPLAY;
+    gLoaderContext = EGL_NO_CONTEXT;
+    gLoaderSurface = EGL_NO_SURFACE;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Creates the loader context and starts the thread, waiting until the context is current on it
+int StartLoaderThread()
+{
+    int running;
+
+    if( gLoaderState != LOADER_STOPPED )
+    {
+        return 1;
+    }
+    if( !CreateLoaderContext() )
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock( &gLoaderMutex );
+    gLoaderState = LOADER_STARTING;
+    if( pthread_create( &gLoaderThread, NULL, LoaderThread, NULL ) != 0 )
+    {
+        LogError( "Failed to start the loader thread\n" );
+        gLoaderState = LOADER_STOPPED;
+        pthread_mutex_unlock( &gLoaderMutex );
+        DestroyLoaderContext();
+        return 0;
+    }
+    while( gLoaderState == LOADER_STARTING )
+    {
+        pthread_cond_wait( &gLoaderWake, &gLoaderMutex );
+    }
+    running = gLoaderState == LOADER_RUNNING;
+    pthread_mutex_unlock( &gLoaderMutex );
+
+    if( !running )
+    {
+        LogError( "The loader thread couldn't make its context current: 0x%x\n", eglGetError() );
+        pthread_join( gLoaderThread, NULL );
+        DestroyLoaderContext();
+        pthread_mutex_lock( &gLoaderMutex );
+        gLoaderState = LOADER_STOPPED;
+        pthread_mutex_unlock( &gLoaderMutex );
+    }
+    return running;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Stops the thread, drops the queued loads and publishes the finished ones
+void StopLoaderThread()
+{
+    LoadRequest* pRequest;
+    int sameShareGroup;
+
+    if( gLoaderState == LOADER_STOPPED )
+    {
+        return;
+    }
+
+    pthread_mutex_lock( &gLoaderMutex );
+    gLoaderState = LOADER_STOPPING;
+    pthread_cond_broadcast( &gLoaderWake );
+    pthread_mutex_unlock( &gLoaderMutex );
+    pthread_join( gLoaderThread, NULL );
+
+    // The render context may have been lost (and replaced) since the thread started. The loaded
+    // textures and fences went with its share group then, and there is nothing to publish.
+    sameShareGroup = eglGetCurrentContext() == gSharedContext;
+
+    pthread_mutex_lock( &gLoaderMutex );
+    while( gpQueuedLoads != NULL )
+    {
+        pRequest = gpQueuedLoads;
+        gpQueuedLoads = pRequest->pNext;
+        FreeRequest( pRequest );
+    }
+    while( gpFinishedLoads != NULL )
+    {
+        pRequest = gpFinishedLoads;
+        gpFinishedLoads = pRequest->pNext;
+        if( sameShareGroup )
+        {
+            if( pRequest->mFence != 0 )
+            {
+                // Later commands of the render context wait for the upload on the GPU
+                glWaitSync( pRequest->mFence, 0, GL_TIMEOUT_IGNORED );
+                glDeleteSync( pRequest->mFence );
+            }
+            if( pRequest->mTexture != 0 )
+            {
+                *pRequest->pHandle = pRequest->mTexture;
+            }
+        }
+        FreeRequest( pRequest );
+    }
+    gLoaderState = LOADER_STOPPED;
+    pthread_mutex_unlock( &gLoaderMutex );
+
+    DestroyLoaderContext();
+    gSharedContext = EGL_NO_CONTEXT;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Queues a load for the loader thread, or loads the texture now if it isn't running
+int QueueTextureLoad( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions,
+                      GLuint* pHandle )
+{
+    LoadRequest* pRequest = (LoadRequest*)calloc( 1, sizeof(LoadRequest) );
+    GLuint texture;
+
+    if( pRequest == NULL || ( pRequest->pName = strdup( TextureFileName ) ) == NULL )
+    {
+        free( pRequest );
+        return 0;
+    }
+    pRequest->pLoad = pLoad;
+    pRequest->pHandle = pHandle;
+    if( pOptions != NULL )
+    {
+        pRequest->mOptions = *pOptions;
+        pRequest->mHasOptions = 1;
+    }
+
+    pthread_mutex_lock( &gLoaderMutex );
+    if( gLoaderState == LOADER_RUNNING )
+    {
+        AppendRequest( &gpQueuedLoads, pRequest );
+        pthread_cond_broadcast( &gLoaderWake );
+        pthread_mutex_unlock( &gLoaderMutex );
+        return 1;
+    }
+    pthread_mutex_unlock( &gLoaderMutex );
+
+    FreeRequest( pRequest );
+    texture = pLoad( TextureFileName, pOptions );
+    if( texture != 0 )
+    {
+        *pHandle = texture;
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Swaps in the textures whose fences have signalled, without waiting for the others
+int PublishLoadedTextures()
+{
+    LoadRequest** ppRequest;
+    LoadRequest* pRequest;
+    int pending;
+
+    pthread_mutex_lock( &gLoaderMutex );
+    ppRequest = &gpFinishedLoads;
+    while( ( pRequest = *ppRequest ) != NULL )
+    {
+        if( pRequest->mFence != 0 )
+        {
+            GLenum status = glClientWaitSync( pRequest->mFence, 0, 0 );
+            if( status == GL_TIMEOUT_EXPIRED )
+            {
+                ppRequest = &pRequest->pNext;
+                continue;
+            }
+            glDeleteSync( pRequest->mFence );
+        }
+
+        if( pRequest->mTexture != 0 )
+        {
+            *pRequest->pHandle = pRequest->mTexture;
+        }
+        *ppRequest = pRequest->pNext;
+        FreeRequest( pRequest );
+    }
+
+    pending = gpRunningLoad != NULL;
+    for( pRequest = gpQueuedLoads; pRequest != NULL; pRequest = pRequest->pNext )
+    {
+        pending++;
+    }
+    for( pRequest = gpFinishedLoads; pRequest != NULL; pRequest = pRequest->pNext )
+    {
+        pending++;
+    }
+    pthread_mutex_unlock( &gLoaderMutex );
+
+    return pending;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Looks for a request loading into the handle on each list
+int IsTextureLoadPending( const GLuint* pHandle )
+{
+    LoadRequest* pLists[2];
+    LoadRequest* pRequest;
+    int pending;
+    int list;
+
+    pthread_mutex_lock( &gLoaderMutex );
+    pending = gpRunningLoad != NULL && gpRunningLoad->pHandle == pHandle;
+    pLists[0] = gpQueuedLoads;
+    pLists[1] = gpFinishedLoads;
+    for( list = 0; list < 2 && !pending; ++list )
+    {
+        for( pRequest = pLists[list]; pRequest != NULL && !pending; pRequest = pRequest->pNext )
+        {
+            pending = pRequest->pHandle == pHandle;
+        }
+    }
+    pthread_mutex_unlock( &gLoaderMutex );
+
+    return pending;
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include "texture.h"
+
+// Background texture loading. A thread with an EGL context of its own, in the share group of the
+// render thread's context, runs the loaders. Each texture it finishes is fenced, and the render
+// thread swaps the texture in once the fence has signalled, so frames keep coming while textures
+// load and the render thread never waits for the GPU to finish an upload.
+//
+// StartLoaderThread, PublishLoadedTextures and StopLoaderThread must be called on the render
+// thread, with its context current. QueueTextureLoad may be called from any thread.
+
+// Loader run on the loader thread, e.g. LoadTexturePNGEx
+typedef GLuint (*TextureLoadFunction)( const char* TextureFileName, const TextureOptions* pOptions );
+
+// Creates a context sharing objects with the current one and starts the thread. Returns 0 if that
+// isn't possible; QueueTextureLoad then loads on the calling thread.
+int StartLoaderThread();
+
+// Stops the thread once its current load is done. Queued loads are dropped; finished ones are
+// published, the render context waiting on their fences on the GPU rather than the CPU.
+void StopLoaderThread();
+
+// Queues a texture to be loaded with pLoad and pOptions (copied, may be NULL). *pHandle keeps its
+// value, e.g. a placeholder texture, until PublishLoadedTextures stores the loaded texture in it;
+// a load that fails leaves it alone. Without a loader thread the texture is loaded right away.
+// Returns 0 if the load couldn't be queued.
+int QueueTextureLoad( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions,
+                      GLuint* pHandle );
+
+// Stores every texture whose upload the GPU has finished in its handle. Call it once a frame,
+// before drawing. Returns the number of loads still queued, running or uploading.
+int PublishLoadedTextures();
+
+// Returns whether a load into *pHandle is queued, running or waiting to be published. Once it
+// isn't, a handle the load didn't change means the load failed.
+int IsTextureLoadPending( const GLuint* pHandle );
@@ -0,0 +1,551 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "jobs.h"
+#include "mipmap.h"
+#include "staging.h"
+
+// Output rows per ParallelFor index. Each band streams its source rows through a ring of 'taps'
+// converted rows, so the working set stays a few rows wide whatever the image height.
+#define MIP_BAND_ROWS               16
+
+static pthread_once_t gMipTablesOnce = PTHREAD_ONCE_INIT;
+static unsigned short gByteToLinear15[256];
+static unsigned char gLinear15ToSrgb[32768];
+static void (*gpMipFilterColumns)( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int count ) = NULL;
+static void (*gpMipFilterRowRGBA)( const short* pIn, const short* pWeights, int taps, short* pOut, int width ) = NULL;
+
+// Filter taps for halving, centered between source pixels and summing to 1 << 14. Kept as
+// constants rather than computed with libm so that no device can round them differently.
+// Indexed by MIP_FILTER_*.
+static const int gMipTaps[3] = { 2, 8, 8 };
+static const short gMipWeights[3][8] =
+{
+    { 8192, 8192 },
+    { -145, -687, 1909, 7115, 7115, 1909, -687, -145 },
+    { -204, -704, 1916, 7184, 7184, 1916, -704, -204 },
+};
+
+// sRGB code to linear light in 15 bits
+static const unsigned short gSrgbToLinear15[256] =
+{
+        0,    10,    20,    30,    40,    50,    60,    70,    80,    90,    99,   110,   120,   132,   144,   157,
+      170,   184,   198,   213,   229,   246,   263,   281,   299,   319,   338,   359,   380,   403,   425,   449,
+      473,   498,   524,   551,   578,   606,   635,   665,   695,   727,   759,   792,   825,   860,   895,   931,
+      968,  1006,  1045,  1085,  1125,  1167,  1209,  1252,  1296,  1341,  1386,  1433,  1481,  1529,  1578,  1629,
+     1680,  1732,  1785,  1839,  1894,  1950,  2007,  2065,  2123,  2183,  2244,  2305,  2368,  2432,  2496,  2562,
+     2629,  2696,  2765,  2834,  2905,  2977,  3049,  3123,  3198,  3273,  3350,  3428,  3507,  3587,  3668,  3750,
+     3833,  3917,  4002,  4088,  4176,  4264,  4354,  4444,  4536,  4629,  4723,  4818,  4914,  5011,  5109,  5209,
+     5309,  5411,  5514,  5618,  5723,  5829,  5936,  6045,  6154,  6265,  6377,  6490,  6604,  6720,  6836,  6954,
+     7073,  7193,  7315,  7437,  7561,  7686,  7812,  7939,  8067,  8197,  8328,  8460,  8593,  8728,  8863,  9000,
+     9139,  9278,  9419,  9560,  9704,  9848,  9994, 10140, 10288, 10438, 10588, 10740, 10893, 11048, 11204, 11360,
+    11519, 11678, 11839, 12001, 12164, 12329, 12495, 12662, 12831, 13000, 13172, 13344, 13518, 13693, 13869, 14047,
+    14226, 14406, 14588, 14771, 14955, 15141, 15328, 15516, 15706, 15897, 16089, 16283, 16478, 16675, 16872, 17071,
+    17272, 17474, 17677, 17882, 18088, 18295, 18504, 18714, 18926, 19138, 19353, 19569, 19786, 20004, 20224, 20445,
+    20668, 20892, 21118, 21345, 21573, 21803, 22034, 22267, 22501, 22736, 22973, 23211, 23451, 23692, 23935, 24179,
+    24425, 24672, 24920, 25170, 25421, 25674, 25928, 26184, 26441, 26700, 26960, 27222, 27485, 27749, 28016, 28283,
+    28552, 28823, 29095, 29368, 29643, 29920, 30197, 30477, 30758, 31040, 31324, 31610, 31897, 32185, 32475, 32767,
+};
+
+// One level being filtered down from the level above
+typedef struct
+{
+    const MipLevel* pSrc;
+    const MipLevel* pDst;
+    int mComp;
+    int mTaps;
+    const short* pWeights;
+    const unsigned short* pToLinear[4];     // Per channel 8-bit to 15-bit table
+    int mSrgbChannels;                      // Leading channels converted back through gLinear15ToSrgb
+    int mFailed;
+} MipJob;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MipFilterColumnsScalar - vertical pass, also used for the tail of a row by the SIMD versions
+void MipFilterColumnsScalar( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int x0, int x1 )
+{
+    int x, k;
+
+    for( x = x0; x < x1; ++x )
+    {
+        int sum = 1 << 13;
+        for( k = 0; k < taps; ++k )
+        {
+            sum += pWeights[k] * ppRows[k][x];
+        }
+        sum >>= 14;
+        pOut[x] = (short)( sum < 0 ? 0 : sum > 32767 ? 32767 : sum );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MipFilterRowScalar - horizontal pass, any channel count
+void MipFilterRowScalar( const short* pIn, const short* pWeights, int taps, int comp, short* pOut, int x0, int x1 )
+{
+    int x, c, k;
+
+    for( x = x0; x < x1; ++x )
+    {
+        const short* pTaps = pIn + 2 * x * comp;
+        for( c = 0; c < comp; ++c )
+        {
+            int sum = 1 << 13;
+            for( k = 0; k < taps; ++k )
+            {
+                sum += pWeights[k] * pTaps[k * comp + c];
+            }
+            sum >>= 14;
+            pOut[x * comp + c] = (short)( sum < 0 ? 0 : sum > 32767 ? 32767 : sum );
+        }
+    }
+}
+
+
+#if defined(__SSE2__)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MipFilterColumnsSSE2 - 8 samples per iteration
+//
+// Interleaving two rows lets pmaddwd apply a pair of taps at once, with 32-bit sums. The integer
+// sums are exact, so the result matches the scalar version bit for bit.
+void MipFilterColumnsSSE2( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int count )
+{
+    __m128i weights[4];
+    __m128i round = _mm_set1_epi32( 1 << 13 );
+    __m128i zero = _mm_setzero_si128();
+    int i = 0, k;
+
+    for( k = 0; k < taps; k += 2 )
+    {
+        weights[k / 2] = _mm_setr_epi16( pWeights[k], pWeights[k + 1], pWeights[k], pWeights[k + 1],
+                                         pWeights[k], pWeights[k + 1], pWeights[k], pWeights[k + 1] );
+    }
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m128i lo = round;
+        __m128i hi = round;
+        for( k = 0; k < taps; k += 2 )
+        {
+            __m128i a = _mm_loadu_si128( (const __m128i*)( ppRows[k] + i ) );
+            __m128i b = _mm_loadu_si128( (const __m128i*)( ppRows[k + 1] + i ) );
+            lo = _mm_add_epi32( lo, _mm_madd_epi16( _mm_unpacklo_epi16( a, b ), weights[k / 2] ) );
+            hi = _mm_add_epi32( hi, _mm_madd_epi16( _mm_unpackhi_epi16( a, b ), weights[k / 2] ) );
+        }
+        lo = _mm_srai_epi32( lo, 14 );
+        hi = _mm_srai_epi32( hi, 14 );
+        _mm_storeu_si128( (__m128i*)( pOut + i ), _mm_max_epi16( _mm_packs_epi32( lo, hi ), zero ) );
+    }
+
+    MipFilterColumnsScalar( ppRows, pWeights, taps, pOut, i, count );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MipFilterRowRGBASSE2 - one output pixel per iteration
+//
+// Two neighbouring source pixels are loaded together and interleaved channel by channel, so one
+// pmaddwd applies a pair of taps to all four channels.
+void MipFilterRowRGBASSE2( const short* pIn, const short* pWeights, int taps, short* pOut, int width )
+{
+    __m128i weights[4];
+    __m128i round = _mm_set1_epi32( 1 << 13 );
+    __m128i zero = _mm_setzero_si128();
+    int x, k;
+
+    for( k = 0; k < taps; k += 2 )
+    {
+        weights[k / 2] = _mm_setr_epi16( pWeights[k], pWeights[k + 1], pWeights[k], pWeights[k + 1],
+                                         pWeights[k], pWeights[k + 1], pWeights[k], pWeights[k + 1] );
+    }
+
+    for( x = 0; x < width; ++x )
+    {
+        const short* pTaps = pIn + x * 8;
+        __m128i sum = round;
+        for( k = 0; k < taps; k += 2 )
+        {
+            __m128i pair = _mm_loadu_si128( (const __m128i*)( pTaps + k * 4 ) );
+            sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_unpacklo_epi16( pair, _mm_unpackhi_epi64( pair, pair ) ), weights[k / 2] ) );
+        }
+        sum = _mm_max_epi16( _mm_packs_epi32( _mm_srai_epi32( sum, 14 ), zero ), zero );
+        _mm_storel_epi64( (__m128i*)( pOut + x * 4 ), sum );
+    }
+}
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the conversion tables
+//
+// The linear to sRGB table picks the nearest code by comparing against the midpoints of the
+// integer table above, so it is exact and the same everywhere.
+static void BuildMipTables()
+{
+    int i, code = 0;
+
+    for( i = 0; i < 256; ++i )
+    {
+        gByteToLinear15[i] = (unsigned short)( ( i << 7 ) | ( i >> 1 ) );
+    }
+    for( i = 0; i < 32768; ++i )
+    {
+        while( code < 255 && 2 * i > gSrgbToLinear15[code] + gSrgbToLinear15[code + 1] )
+        {
+            ++code;
+        }
+        gLinear15ToSrgb[i] = (unsigned char)code;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SelectMipKernels
+void SelectMipKernels( unsigned int features )
+{
+    gpMipFilterColumns = NULL;
+    gpMipFilterRowRGBA = NULL;
+
+#if defined(__SSE2__)
+    if( features & CPU_FEATURE_SSE2 )
+    {
+        gpMipFilterColumns = MipFilterColumnsSSE2;
+        gpMipFilterRowRGBA = MipFilterRowRGBASSE2;
+    }
+#endif
+
+#if defined(HAVE_NEON)
+    if( features & CPU_FEATURE_NEON )
+    {
+        gpMipFilterColumns = MipFilterColumnsNEON;
+        gpMipFilterRowRGBA = MipFilterRowRGBANEON;
+    }
+#endif
+
+    (void)features;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetMipLevelCount - levels until both sides reach 1
+int GetMipLevelCount( int width, int height )
+{
+    int levels = 1;
+
+    while( width > 1 || height > 1 )
+    {
+        width >>= 1;
+        height >>= 1;
+        ++levels;
+    }
+    return levels;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Widens one 8-bit source row to 15 bits
+static void ConvertRowToLinear( const MipJob* pJob, const unsigned char* pIn, short* pOut, int width )
+{
+    int comp = pJob->mComp;
+    int x, c;
+
+    for( x = 0; x < width; ++x, pIn += comp, pOut += comp )
+    {
+        for( c = 0; c < comp; ++c )
+        {
+            pOut[c] = (short)pJob->pToLinear[c][pIn[c]];
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Narrows one filtered row back to 8 bits
+static void ConvertRowFromLinear( const MipJob* pJob, const short* pIn, unsigned char* pOut, int width )
+{
+    int comp = pJob->mComp;
+    int x, c;
+
+    for( x = 0; x < width; ++x, pIn += comp, pOut += comp )
+    {
+        for( c = 0; c < pJob->mSrgbChannels; ++c )
+        {
+            pOut[c] = gLinear15ToSrgb[pIn[c]];
+        }
+        for( ; c < comp; ++c )
+        {
+            pOut[c] = (unsigned char)( ( pIn[c] * 255 + 16384 ) >> 15 );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FilterMipBand - ParallelFor task producing MIP_BAND_ROWS rows of the destination level
+//
+// Output row y covers source rows 2y and 2y + 1, and its taps start 'taps / 2 - 1' rows above
+// that. Source rows are widened once into a ring indexed by their (unclamped) row number and
+// edges repeat the border rows. The vertical pass writes an edge padded row so the horizontal
+// pass never clamps.
+static void FilterMipBand( void* pUser, int band )
+{
+    MipJob* pJob = (MipJob*)pUser;
+    const MipLevel* pSrc = pJob->pSrc;
+    const MipLevel* pDst = pJob->pDst;
+    int comp = pJob->mComp;
+    int taps = pJob->mTaps;
+    int pad = taps / 2 - 1;
+    int rowLength = pSrc->mWidth * comp;
+    int paddedLength = ( pSrc->mWidth + taps ) * comp;
+    int y0 = band * MIP_BAND_ROWS;
+    int y1 = y0 + MIP_BAND_ROWS < pDst->mHeight ? y0 + MIP_BAND_ROWS : pDst->mHeight;
+    int next = 2 * y0 - pad;
+    const short* pRows[8];
+    short* pRing;
+    short* pPadded;
+    short* pFiltered;
+    int x, y, k;
+
+    pRing = (short*)AcquireStagingBuffer( ( taps * rowLength + paddedLength + pDst->mWidth * comp ) * sizeof(short) );
+    if( pRing == NULL )
+    {
+        pJob->mFailed = 1;
+        return;
+    }
+    pPadded = pRing + taps * rowLength;
+    pFiltered = pPadded + paddedLength;
+
+    for( y = y0; y < y1; ++y )
+    {
+        int top = 2 * y - pad;
+
+        for( ; next < top + taps; ++next )
+        {
+            int row = next < 0 ? 0 : next >= pSrc->mHeight ? pSrc->mHeight - 1 : next;
+            ConvertRowToLinear( pJob, pSrc->pPixels + row * pSrc->mStride, pRing + ( ( next + taps ) % taps ) * rowLength, pSrc->mWidth );
+        }
+        for( k = 0; k < taps; ++k )
+        {
+            pRows[k] = pRing + ( ( top + k + taps ) % taps ) * rowLength;
+        }
+
+        if( gpMipFilterColumns != NULL )
+        {
+            gpMipFilterColumns( pRows, pJob->pWeights, taps, pPadded + pad * comp, rowLength );
+        }
+        else
+        {
+            MipFilterColumnsScalar( pRows, pJob->pWeights, taps, pPadded + pad * comp, 0, rowLength );
+        }
+        for( x = 0; x < pad; ++x )
+        {
+            memcpy( pPadded + x * comp, pPadded + pad * comp, comp * sizeof(short) );
+        }
+        for( x = pad + pSrc->mWidth; x < pSrc->mWidth + taps; ++x )
+        {
+            memcpy( pPadded + x * comp, pPadded + ( pad + pSrc->mWidth - 1 ) * comp, comp * sizeof(short) );
+        }
+
+        if( comp == 4 && gpMipFilterRowRGBA != NULL )
+        {
+            gpMipFilterRowRGBA( pPadded, pJob->pWeights, taps, pFiltered, pDst->mWidth );
+        }
+        else
+        {
+            MipFilterRowScalar( pPadded, pJob->pWeights, taps, comp, pFiltered, 0, pDst->mWidth );
+        }
+
+        ConvertRowFromLinear( pJob, pFiltered, pDst->pPixels + y * pDst->mStride, pDst->mWidth );
+    }
+
+    ReleaseStagingBuffer( pRing );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Counts the alpha values of a level
+static void AlphaHistogram( const MipLevel* pLevel, int comp, unsigned int* pHistogram )
+{
+    int x, y;
+
+    memset( pHistogram, 0, 256 * sizeof(unsigned int) );
+    for( y = 0; y < pLevel->mHeight; ++y )
+    {
+        const unsigned char* pAlpha = pLevel->pPixels + y * pLevel->mStride + comp - 1;
+        for( x = 0; x < pLevel->mWidth; ++x )
+        {
+            ++pHistogram[pAlpha[x * comp]];
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns alpha scaled by scale / 256, rounded and clamped
+static inline int ScaleAlpha( int alpha, int scale )
+{
+    int scaled = ( alpha * scale + 128 ) >> 8;
+    return scaled > 255 ? 255 : scaled;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns how many pixels pass an alpha >= reference test with alpha scaled by scale / 256
+static unsigned int CountCovered( const unsigned int* pHistogram, int scale, int reference )
+{
+    unsigned int covered = 0;
+    int alpha;
+
+    for( alpha = 0; alpha < 256; ++alpha )
+    {
+        if( ScaleAlpha( alpha, scale ) >= reference )
+        {
+            covered += pHistogram[alpha];
+        }
+    }
+    return covered;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Rescales the alpha of a level so that the share of pixels passing the alpha test matches
+// level 0 as closely as possible
+//
+// Coverage only grows with the scale, so a binary search over the 8.8 fixed point scale (up to
+// 4x) on the level's alpha histogram finds it without touching the pixels again.
+static void PreserveCoverage( const MipLevel* pLevel, int comp, int reference, unsigned int covered0, unsigned int pixels0 )
+{
+    unsigned int histogram[256];
+    unsigned int pixels = (unsigned int)( pLevel->mWidth * pLevel->mHeight );
+    unsigned int target = (unsigned int)( ( (unsigned long long)covered0 * pixels + pixels0 / 2 ) / pixels0 );
+    unsigned int covered;
+    int low = 0, high = 1024;
+    int x, y;
+
+    AlphaHistogram( pLevel, comp, histogram );
+
+    // Smallest scale reaching the target, or one step below it if that is closer
+    while( low < high )
+    {
+        int mid = ( low + high ) / 2;
+        if( CountCovered( histogram, mid, reference ) >= target )
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    covered = CountCovered( histogram, low, reference );
+    if( low > 0 && covered >= target && target - CountCovered( histogram, low - 1, reference ) < covered - target )
+    {
+        --low;
+    }
+    if( low == 256 )
+    {
+        return;
+    }
+
+    for( y = 0; y < pLevel->mHeight; ++y )
+    {
+        unsigned char* pAlpha = pLevel->pPixels + y * pLevel->mStride + comp - 1;
+        for( x = 0; x < pLevel->mWidth; ++x )
+        {
+            pAlpha[x * comp] = (unsigned char)ScaleAlpha( pAlpha[x * comp], low );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GenerateMipChain - filters each level from the one above, the bands of a level in parallel
+//
+// Levels are built from the 8-bit level above rather than from level 0, so each pass reads a
+// quarter of the data of the previous one and the chain costs about a third of level 0 in total.
+int GenerateMipChain( MipLevel* pLevels, int levelCount, int comp, int filter, unsigned int flags, int alphaReference )
+{
+    int hasAlpha = comp == 2 || comp == 4;
+    int coverage = hasAlpha && ( flags & MIP_PRESERVE_COVERAGE );
+    unsigned int histogram[256];
+    unsigned int covered0 = 0;
+    MipJob job;
+    int level, c;
+
+    InitKernelDispatch();
+    pthread_once( &gMipTablesOnce, BuildMipTables );
+
+    if( filter < MIP_FILTER_BOX || filter > MIP_FILTER_KAISER )
+    {
+        filter = MIP_FILTER_BOX;
+    }
+
+    memset( &job, 0, sizeof(job) );
+    job.mComp = comp;
+    job.mTaps = gMipTaps[filter];
+    job.pWeights = gMipWeights[filter];
+    job.mSrgbChannels = ( flags & MIP_GAMMA_CORRECT ) ? ( hasAlpha ? comp - 1 : comp ) : 0;
+    for( c = 0; c < comp; ++c )
+    {
+        job.pToLinear[c] = c < job.mSrgbChannels ? gSrgbToLinear15 : gByteToLinear15;
+    }
+
+    if( coverage )
+    {
+        AlphaHistogram( &pLevels[0], comp, histogram );
+        covered0 = CountCovered( histogram, 256, alphaReference );
+    }
+
+    for( level = 1; level < levelCount; ++level )
+    {
+        job.pSrc = &pLevels[level - 1];
+        job.pDst = &pLevels[level];
+        ParallelFor( ( pLevels[level].mHeight + MIP_BAND_ROWS - 1 ) / MIP_BAND_ROWS, FilterMipBand, &job );
+        if( job.mFailed )
+        {
+            return 0;
+        }
+
+        if( coverage )
+        {
+            PreserveCoverage( &pLevels[level], comp, alphaReference, covered0,
+                              (unsigned int)( pLevels[0].mWidth * pLevels[0].mHeight ) );
+        }
+    }
+    return 1;
+}
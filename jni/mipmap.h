@@ -0,0 +1,74 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+// Filters for building mip chains on the CPU. All of them run in fixed point with constant
+// weights, so every device (and every SIMD path) produces bit-identical levels.
+#define MIP_FILTER_BOX              0   // 2x2 average
+#define MIP_FILTER_LANCZOS          1   // 8 tap Lanczos-2 windowed sinc, sharper with slight ringing
+#define MIP_FILTER_KAISER           2   // 8 tap Kaiser windowed sinc (beta 4), between the two
+#define MIP_FILTER_DRIVER           3   // Not built on the CPU, TextureOptions value for glGenerateMipmap
+
+#define MIP_GAMMA_CORRECT           0x00000001  // Color channels are sRGB encoded, filter them in linear light
+#define MIP_PRESERVE_COVERAGE       0x00000002  // Scale alpha so each level passes an alpha test as often as level 0
+
+#define MAX_MIP_LEVELS              16
+
+// One level of a mip chain, rows of 'comp' 8-bit channels 'mStride' bytes apart
+typedef struct
+{
+    unsigned char* pPixels;
+    int mWidth;
+    int mHeight;
+    int mStride;
+} MipLevel;
+
+// Returns the number of levels in a full chain down to 1x1
+int GetMipLevelCount( int width, int height );
+
+// Fills pLevels[1..levelCount-1] by filtering each level down from the one above, on the worker
+// pool. The caller sets up every level's size (halved, rounded down, at least 1), stride and pixels.
+// alphaReference is the alpha test threshold kept by MIP_PRESERVE_COVERAGE. Returns 0 if out of memory.
+int GenerateMipChain( MipLevel* pLevels, int levelCount, int comp, int filter, unsigned int flags, int alphaReference );
+
+// Points the filter kernels at the variants 'features' (CPU_FEATURE_*) allows. Called by the
+// kernel dispatch (dispatch.h).
+void SelectMipKernels( unsigned int features );
+
+// Vertical pass: pOut[i] = sum of pWeights[k] * ppRows[k][i] over 'taps' rows, for i in [x0, x1).
+// Samples are 15-bit, weights sum to 1 << 14, results are rounded and clamped to [0, 32767].
+void MipFilterColumnsScalar( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int x0, int x1 );
+void MipFilterColumnsSSE2( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int count );
+void MipFilterColumnsNEON( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int count );
+
+// Horizontal pass: output pixel x is the weighted sum of the 'taps' pixels starting at pIn + 2 * x * comp,
+// for x in [x0, x1). pIn is edge padded, so no taps need clamping.
+void MipFilterRowScalar( const short* pIn, const short* pWeights, int taps, int comp, short* pOut, int x0, int x1 );
+void MipFilterRowRGBASSE2( const short* pIn, const short* pWeights, int taps, short* pOut, int width );
+void MipFilterRowRGBANEON( const short* pIn, const short* pWeights, int taps, short* pOut, int width );
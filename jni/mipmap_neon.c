@@ -0,0 +1,81 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// NEON mip filter kernels - built for armeabi-v7a only, see jpeg_neon.c
+
+#include <arm_neon.h>
+
+#include "mipmap.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MipFilterColumnsNEON - 8 samples per iteration
+//
+// vqrshrn adds 1 << 13 before the arithmetic shift and saturates to 16 bits, the same rounding
+// and upper clamp as the scalar version.
+void MipFilterColumnsNEON( const short* const* ppRows, const short* pWeights, int taps, short* pOut, int count )
+{
+    int i = 0, k;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        int32x4_t lo = vdupq_n_s32( 0 );
+        int32x4_t hi = vdupq_n_s32( 0 );
+        int16x8_t result;
+
+        for( k = 0; k < taps; ++k )
+        {
+            int16x8_t row = vld1q_s16( ppRows[k] + i );
+            lo = vmlal_n_s16( lo, vget_low_s16( row ), pWeights[k] );
+            hi = vmlal_n_s16( hi, vget_high_s16( row ), pWeights[k] );
+        }
+        result = vcombine_s16( vqrshrn_n_s32( lo, 14 ), vqrshrn_n_s32( hi, 14 ) );
+        vst1q_s16( pOut + i, vmaxq_s16( result, vdupq_n_s16( 0 ) ) );
+    }
+
+    MipFilterColumnsScalar( ppRows, pWeights, taps, pOut, i, count );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MipFilterRowRGBANEON - one output pixel (all four channels) per iteration
+void MipFilterRowRGBANEON( const short* pIn, const short* pWeights, int taps, short* pOut, int width )
+{
+    int x, k;
+
+    for( x = 0; x < width; ++x )
+    {
+        const short* pTaps = pIn + x * 8;
+        int32x4_t sum = vdupq_n_s32( 0 );
+
+        for( k = 0; k < taps; ++k )
+        {
+            sum = vmlal_n_s16( sum, vld1_s16( pTaps + k * 4 ), pWeights[k] );
+        }
+        vst1_s16( pOut + x * 4, vmax_s16( vqrshrn_n_s32( sum, 14 ), vdup_n_s16( 0 ) ) );
+    }
+}
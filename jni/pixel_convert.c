@@ -0,0 +1,308 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "pixel_convert.h"
+#include "stb_image.h"
+
+// Gray value of an RGB pixel, stb_image's compute_y
+#define LUMA( p )   (unsigned char)( ( 77 * (p)[0] + 150 * (p)[1] + 29 * (p)[2] ) >> 8 )
+
+
+// Indexed by [srcComp][dstComp]
+static PixelConverter gConverters[5][5];
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar kernels, one per layout pair
+//
+// The channel counts are constants in each kernel, so every pixel is a handful of straight loads
+// and stores, instead of the per row switch and channel loops of a generic converter.
+#define DEFINE_SCALAR_CONVERTER( a, b, body )                                                      \
+    static void ConvertPixels##a##To##b##Scalar( unsigned char* pOut, const unsigned char* pIn, int count ) \
+    {                                                                                               \
+        for( ; count > 0; --count, pIn += a, pOut += b )                                            \
+        {                                                                                           \
+            body;                                                                                   \
+        }                                                                                           \
+    }
+
+DEFINE_SCALAR_CONVERTER( 1, 2, pOut[0] = pIn[0]; pOut[1] = 255 )
+DEFINE_SCALAR_CONVERTER( 1, 3, pOut[0] = pOut[1] = pOut[2] = pIn[0] )
+DEFINE_SCALAR_CONVERTER( 1, 4, pOut[0] = pOut[1] = pOut[2] = pIn[0]; pOut[3] = 255 )
+DEFINE_SCALAR_CONVERTER( 2, 1, pOut[0] = pIn[0] )
+DEFINE_SCALAR_CONVERTER( 2, 3, pOut[0] = pOut[1] = pOut[2] = pIn[0] )
+DEFINE_SCALAR_CONVERTER( 2, 4, pOut[0] = pOut[1] = pOut[2] = pIn[0]; pOut[3] = pIn[1] )
+DEFINE_SCALAR_CONVERTER( 3, 1, pOut[0] = LUMA( pIn ) )
+DEFINE_SCALAR_CONVERTER( 3, 2, pOut[0] = LUMA( pIn ); pOut[1] = 255 )
+DEFINE_SCALAR_CONVERTER( 3, 4, pOut[0] = pIn[0]; pOut[1] = pIn[1]; pOut[2] = pIn[2]; pOut[3] = 255 )
+DEFINE_SCALAR_CONVERTER( 4, 1, pOut[0] = LUMA( pIn ) )
+DEFINE_SCALAR_CONVERTER( 4, 2, pOut[0] = LUMA( pIn ); pOut[1] = pIn[3] )
+DEFINE_SCALAR_CONVERTER( 4, 3, pOut[0] = pIn[0]; pOut[1] = pIn[1]; pOut[2] = pIn[2] )
+
+#undef DEFINE_SCALAR_CONVERTER
+
+static const PixelConverter gScalarConverters[5][5] =
+{
+    { NULL, NULL,                        NULL,                        NULL,                        NULL                        },
+    { NULL, NULL,                        ConvertPixels1To2Scalar,     ConvertPixels1To3Scalar,     ConvertPixels1To4Scalar     },
+    { NULL, ConvertPixels2To1Scalar,     NULL,                        ConvertPixels2To3Scalar,     ConvertPixels2To4Scalar     },
+    { NULL, ConvertPixels3To1Scalar,     ConvertPixels3To2Scalar,     NULL,                        ConvertPixels3To4Scalar     },
+    { NULL, ConvertPixels4To1Scalar,     ConvertPixels4To2Scalar,     ConvertPixels4To3Scalar,     NULL                        },
+};
+
+void ConvertPixelsScalar( int srcComp, int dstComp, unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    gScalarConverters[srcComp][dstComp]( pOut, pIn, count );
+}
+
+
+#if defined(__SSE2__)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertPixels1To4SSE2 - 16 pixels per iteration
+//
+// Interleaving the grays with themselves and then with 255 builds g, g, g, 255.
+void ConvertPixels1To4SSE2( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    const __m128i alpha = _mm_set1_epi8( (char)0xFF );
+    int i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        __m128i gray = _mm_loadu_si128( (const __m128i*)( pIn + i ) );
+        __m128i grayGray = _mm_unpacklo_epi8( gray, gray );
+        __m128i grayAlpha = _mm_unpacklo_epi8( gray, alpha );
+
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 ),      _mm_unpacklo_epi16( grayGray, grayAlpha ) );
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 + 16 ), _mm_unpackhi_epi16( grayGray, grayAlpha ) );
+
+        grayGray = _mm_unpackhi_epi8( gray, gray );
+        grayAlpha = _mm_unpackhi_epi8( gray, alpha );
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 + 32 ), _mm_unpacklo_epi16( grayGray, grayAlpha ) );
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 + 48 ), _mm_unpackhi_epi16( grayGray, grayAlpha ) );
+    }
+
+    ConvertPixels1To4Scalar( pOut + i * 4, pIn + i, count - i );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertPixels2To4SSE2 - 8 pixels per iteration
+//
+// Each gray/alpha pair is a 16-bit lane; the gray doubled into both bytes goes in front of it.
+void ConvertPixels2To4SSE2( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    const __m128i lowBytes = _mm_set1_epi16( 0x00FF );
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m128i grayAlpha = _mm_loadu_si128( (const __m128i*)( pIn + i * 2 ) );
+        __m128i gray = _mm_and_si128( grayAlpha, lowBytes );
+        __m128i grayGray = _mm_or_si128( gray, _mm_slli_epi16( gray, 8 ) );
+
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 ),      _mm_unpacklo_epi16( grayGray, grayAlpha ) );
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 + 16 ), _mm_unpackhi_epi16( grayGray, grayAlpha ) );
+    }
+
+    ConvertPixels2To4Scalar( pOut + i * 4, pIn + i * 2, count - i );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertPixels3To4SSE2 - 4 pixels per iteration
+//
+// Without a byte shuffle, the 4 pixels are byte shifted down to the start of 4 registers and
+// gathered with 32-bit interleaves. A load reads 16 bytes for the 12 used, so the loop stops 2
+// pixels early.
+void ConvertPixels3To4SSE2( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    const __m128i alpha = _mm_set1_epi32( (int)0xFF000000 );
+    int i = 0;
+
+    for( ; i + 6 <= count; i += 4 )
+    {
+        __m128i rgb = _mm_loadu_si128( (const __m128i*)( pIn + i * 3 ) );
+        __m128i pixels01 = _mm_unpacklo_epi32( rgb, _mm_srli_si128( rgb, 3 ) );
+        __m128i pixels23 = _mm_unpacklo_epi32( _mm_srli_si128( rgb, 6 ), _mm_srli_si128( rgb, 9 ) );
+
+        _mm_storeu_si128( (__m128i*)( pOut + i * 4 ), _mm_or_si128( _mm_unpacklo_epi64( pixels01, pixels23 ), alpha ) );
+    }
+
+    ConvertPixels3To4Scalar( pOut + i * 4, pIn + i * 3, count - i );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertPixels4To3SSE2 - 4 pixels per iteration
+//
+// The reverse: with alpha cleared, each 64-bit half packs its two pixels into 6 bytes, and the
+// upper half is shifted down against the lower one.
+void ConvertPixels4To3SSE2( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    const __m128i rgbMask   = _mm_set1_epi32( 0x00FFFFFF );
+    const __m128i evenMask  = _mm_set_epi32( 0, -1, 0, -1 );
+    const __m128i lowHalf   = _mm_set_epi32( 0, 0, -1, -1 );
+    int i = 0;
+    int last;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128i rgb = _mm_and_si128( _mm_loadu_si128( (const __m128i*)( pIn + i * 4 ) ), rgbMask );
+        __m128i packed = _mm_or_si128( _mm_and_si128( rgb, evenMask ), _mm_srli_epi64( _mm_andnot_si128( evenMask, rgb ), 8 ) );
+
+        packed = _mm_or_si128( _mm_and_si128( packed, lowHalf ), _mm_srli_si128( _mm_andnot_si128( lowHalf, packed ), 2 ) );
+        last = _mm_cvtsi128_si32( _mm_srli_si128( packed, 8 ) );
+        _mm_storel_epi64( (__m128i*)( pOut + i * 3 ), packed );
+        memcpy( pOut + i * 3 + 8, &last, 4 );
+    }
+
+    ConvertPixels4To3Scalar( pOut + i * 3, pIn + i * 4, count - i );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertPixels4To1SSE2 / ConvertPixels4To2SSE2 - 8 pixels per iteration
+//
+// The channels of 8 pixels are spread into 16-bit lanes. The weights sum to 256, so the weighted
+// sum is below 65536 and wrapping 16-bit multiplies give the exact luma.
+static inline __m128i LumaSSE2( __m128i rgba0, __m128i rgba1, __m128i* pAlpha )
+{
+    const __m128i lowByte = _mm_set1_epi32( 0xFF );
+    __m128i red   = _mm_packs_epi32( _mm_and_si128( rgba0, lowByte ), _mm_and_si128( rgba1, lowByte ) );
+    __m128i green = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( rgba0, 8 ), lowByte ), _mm_and_si128( _mm_srli_epi32( rgba1, 8 ), lowByte ) );
+    __m128i blue  = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( rgba0, 16 ), lowByte ), _mm_and_si128( _mm_srli_epi32( rgba1, 16 ), lowByte ) );
+    __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( red, _mm_set1_epi16( 77 ) ), _mm_mullo_epi16( green, _mm_set1_epi16( 150 ) ) ),
+                                 _mm_mullo_epi16( blue, _mm_set1_epi16( 29 ) ) );
+
+    if( pAlpha != NULL )
+    {
+        *pAlpha = _mm_packs_epi32( _mm_srli_epi32( rgba0, 24 ), _mm_srli_epi32( rgba1, 24 ) );
+    }
+    return _mm_srli_epi16( sum, 8 );
+}
+
+void ConvertPixels4To1SSE2( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m128i luma = LumaSSE2( _mm_loadu_si128( (const __m128i*)( pIn + i * 4 ) ), _mm_loadu_si128( (const __m128i*)( pIn + i * 4 + 16 ) ), NULL );
+        _mm_storel_epi64( (__m128i*)( pOut + i ), _mm_packus_epi16( luma, luma ) );
+    }
+
+    ConvertPixels4To1Scalar( pOut + i, pIn + i * 4, count - i );
+}
+
+void ConvertPixels4To2SSE2( unsigned char* pOut, const unsigned char* pIn, int count )
+{
+    int i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m128i alpha;
+        __m128i luma = LumaSSE2( _mm_loadu_si128( (const __m128i*)( pIn + i * 4 ) ), _mm_loadu_si128( (const __m128i*)( pIn + i * 4 + 16 ) ), &alpha );
+        _mm_storeu_si128( (__m128i*)( pOut + i * 2 ), _mm_or_si128( luma, _mm_slli_epi16( alpha, 8 ) ) );
+    }
+
+    ConvertPixels4To2Scalar( pOut + i * 2, pIn + i * 4, count - i );
+}
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SelectPixelConverters
+void SelectPixelConverters( unsigned int features )
+{
+    int src, dst;
+
+    for( src = 0; src < 5; ++src )
+    {
+        for( dst = 0; dst < 5; ++dst )
+        {
+            gConverters[src][dst] = gScalarConverters[src][dst];
+        }
+    }
+
+#if defined(__SSE2__)
+    if( features & CPU_FEATURE_SSE2 )
+    {
+        gConverters[1][4] = ConvertPixels1To4SSE2;
+        gConverters[2][4] = ConvertPixels2To4SSE2;
+        gConverters[3][4] = ConvertPixels3To4SSE2;
+        gConverters[4][1] = ConvertPixels4To1SSE2;
+        gConverters[4][2] = ConvertPixels4To2SSE2;
+        gConverters[4][3] = ConvertPixels4To3SSE2;
+    }
+#endif
+
+#if defined(HAVE_NEON)
+    if( features & CPU_FEATURE_NEON )
+    {
+        gConverters[1][2] = ConvertPixels1To2NEON;
+        gConverters[1][3] = ConvertPixels1To3NEON;
+        gConverters[1][4] = ConvertPixels1To4NEON;
+        gConverters[2][1] = ConvertPixels2To1NEON;
+        gConverters[2][3] = ConvertPixels2To3NEON;
+        gConverters[2][4] = ConvertPixels2To4NEON;
+        gConverters[3][1] = ConvertPixels3To1NEON;
+        gConverters[3][2] = ConvertPixels3To2NEON;
+        gConverters[3][4] = ConvertPixels3To4NEON;
+        gConverters[4][1] = ConvertPixels4To1NEON;
+        gConverters[4][2] = ConvertPixels4To2NEON;
+        gConverters[4][3] = ConvertPixels4To3NEON;
+    }
+#endif
+
+    (void)features;
+
+    stbi_install_convert( GetPixelConverter );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetPixelConverter
+PixelConverter GetPixelConverter( int srcComp, int dstComp )
+{
+    InitKernelDispatch();
+
+    if( srcComp < 1 || srcComp > 4 || dstComp < 1 || dstComp > 4 )
+    {
+        return NULL;
+    }
+    return gConverters[srcComp][dstComp];
+}
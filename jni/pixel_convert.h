@@ -0,0 +1,67 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+// Converts 'count' pixels of one 8-bit channel layout to another, with the same results as
+// stb_image: gray expands to all color channels, alpha is added as 255 or dropped, and color
+// becomes gray through the luma weights ( 77 * r + 150 * g + 29 * b ) >> 8.
+typedef void (*PixelConverter)( unsigned char* pOut, const unsigned char* pIn, int count );
+
+// Returns the fastest kernel converting srcComp to dstComp (1-4) channel pixels, or NULL if they
+// are the same. Each layout pair has its own kernel with no per pixel or per row branches, so
+// resolve it once per image.
+PixelConverter GetPixelConverter( int srcComp, int dstComp );
+
+// Points the converter table at the kernels 'features' (CPU_FEATURE_*) allows and makes stb_image's
+// format conversions use GetPixelConverter. Called by the kernel dispatch (dispatch.h).
+void SelectPixelConverters( unsigned int features );
+
+// Scalar kernel for a layout pair, also used for the tail of a row by the SIMD versions
+void ConvertPixelsScalar( int srcComp, int dstComp, unsigned char* pOut, const unsigned char* pIn, int count );
+
+// SIMD kernels for the pairs worth vectorizing, ConvertPixels<srcComp>To<dstComp>
+void ConvertPixels1To4SSE2( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels2To4SSE2( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels3To4SSE2( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels4To1SSE2( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels4To2SSE2( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels4To3SSE2( unsigned char* pOut, const unsigned char* pIn, int count );
+
+void ConvertPixels1To2NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels1To3NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels1To4NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels2To1NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels2To3NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels2To4NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels3To1NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels3To2NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels3To4NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels4To1NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels4To2NEON( unsigned char* pOut, const unsigned char* pIn, int count );
+void ConvertPixels4To3NEON( unsigned char* pOut, const unsigned char* pIn, int count );
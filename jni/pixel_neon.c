@@ -0,0 +1,102 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// NEON pixel transform kernels - built for armeabi-v7a only, see jpeg_neon.c
+
+#include <arm_neon.h>
+
+#include "pixel_transform.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SwizzlePremultiplyRGBANEON - 8 pixels per iteration
+//
+// vld4 deinterleaves the channels, so the swizzle is free. For t = c * a, vraddhn( t, ( t + 128 ) >> 8 )
+// is ( t + 128 + ( ( t + 128 ) >> 8 ) ) >> 8, the same exact c * a / 255 as the scalar code.
+void SwizzlePremultiplyRGBANEON( unsigned int flags, unsigned char* pRow, int width )
+{
+    PixelTransform tail;
+    int i = 0;
+
+    for( ; i + 8 <= width; i += 8 )
+    {
+        uint8x8x4_t pixels = vld4_u8( pRow + i * 4 );
+
+        if( flags & PIXEL_SWIZZLE_RB )
+        {
+            uint8x8_t red = pixels.val[0];
+            pixels.val[0] = pixels.val[2];
+            pixels.val[2] = red;
+        }
+        if( flags & PIXEL_PREMULTIPLY_ALPHA )
+        {
+            int c;
+            for( c = 0; c < 3; ++c )
+            {
+                uint16x8_t t = vmull_u8( pixels.val[c], pixels.val[3] );
+                pixels.val[c] = vraddhn_u16( t, vrshrq_n_u16( t, 8 ) );
+            }
+        }
+
+        vst4_u8( pRow + i * 4, pixels );
+    }
+
+    tail.mFlags = flags & ( PIXEL_SWIZZLE_RB | PIXEL_PREMULTIPLY_ALPHA );
+    TransformPixelRowScalar( &tail, pRow + i * 4, width - i, 4 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackPixelRowNEON - 8 pixels per iteration, same arithmetic as the scalar version
+void PackPixelRowNEON( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int width, const unsigned char* pDither )
+{
+    const unsigned char ditherRow[8] = { pDither[0], pDither[1], pDither[2], pDither[3], pDither[0], pDither[1], pDither[2], pDither[3] };
+    const uint16x8_t dither = vmovl_u8( vld1_u8( ditherRow ) );
+    const uint16x8_t one = vdupq_n_u16( 1 );
+    int i = 0;
+
+    for( ; i + 8 <= width; i += 8 )
+    {
+        uint8x8x4_t pixels = vld4_u8( pIn + i * 4 );
+        uint16x8_t packed = vdupq_n_u16( 0 );
+        int c;
+
+        for( c = 0; c < 4; ++c )
+        {
+            if( pLayout->mMax[c] != 0 )
+            {
+                uint16x8_t t = vmlal_u8( dither, pixels.val[c], vdup_n_u8( pLayout->mMax[c] ) );
+                uint16x8_t level = vshrq_n_u16( vaddq_u16( vaddq_u16( t, one ), vshrq_n_u16( t, 8 ) ), 8 );
+                packed = vorrq_u16( packed, vshlq_u16( level, vdupq_n_s16( pLayout->mShift[c] ) ) );
+            }
+        }
+
+        vst1q_u16( pOut + i, packed );
+    }
+
+    PackPixelRowScalar( pLayout, pOut, pIn, i, width, pDither );
+}
@@ -0,0 +1,391 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "pixel_transform.h"
+
+static pthread_once_t gSrgbTableOnce = PTHREAD_ONCE_INIT;
+static unsigned char gSrgbToLinear[256];
+static void (*gpSwizzlePremultiplyRGBA)( unsigned int flags, unsigned char* pRow, int width ) = NULL;
+static void (*gpPackPixelRow)( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int width,
+                               const unsigned char* pDither ) = NULL;
+
+// Indexed by PIXEL_PACK_*
+static const PackLayout gPackLayouts[4] =
+{
+    { {  0,  0,  0,  0 }, {  0, 0, 0, 0 } },
+    { { 31, 63, 31,  0 }, { 11, 5, 0, 0 } },
+    { { 15, 15, 15, 15 }, { 12, 8, 4, 0 } },
+    { { 31, 31, 31,  1 }, { 11, 6, 1, 0 } },
+};
+
+// Level = ( value * max + threshold ) / 255, so a constant 127 rounds and the 4x4 Bayer matrix
+// (scaled to 8..248) dithers
+static const unsigned char gRoundThresholds[4] = { 127, 127, 127, 127 };
+static const unsigned char gBayerThresholds[4][4] =
+{
+    {   8, 136,  40, 168 },
+    { 200,  72, 232, 104 },
+    {  56, 184,  24, 152 },
+    { 248, 120, 216,  88 },
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns a * b / 255, correctly rounded for 8-bit a and b
+static inline unsigned char MulDiv255( int a, int b )
+{
+    int t = a * b + 128;
+    return (unsigned char)( ( t + ( t >> 8 ) ) >> 8 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformPixelRowScalar - all operations, any channel count
+void TransformPixelRowScalar( const PixelTransform* pTransform, unsigned char* pRow, int width, int comp )
+{
+    unsigned int flags = pTransform->mFlags;
+    int colors = ( comp == 2 || comp == 4 ) ? comp - 1 : comp;
+    int i, c;
+
+    for( i = 0; i < width; ++i, pRow += comp )
+    {
+        if( ( flags & PIXEL_SWIZZLE_RB ) && comp >= 3 )
+        {
+            unsigned char red = pRow[0];
+            pRow[0] = pRow[2];
+            pRow[2] = red;
+        }
+        if( flags & PIXEL_SRGB_TO_LINEAR )
+        {
+            for( c = 0; c < colors; ++c )
+            {
+                pRow[c] = gSrgbToLinear[pRow[c]];
+            }
+        }
+        if( ( flags & PIXEL_PREMULTIPLY_ALPHA ) && colors < comp )
+        {
+            for( c = 0; c < colors; ++c )
+            {
+                pRow[c] = MulDiv255( pRow[c], pRow[colors] );
+            }
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackPixelRowScalar - rounded or ordered dithered packing
+//
+// ( t + 1 + ( t >> 8 ) ) >> 8 is t / 255 for any t below 65535, the SIMD versions use the same.
+void PackPixelRowScalar( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int x0, int x1,
+                         const unsigned char* pDither )
+{
+    int x, c;
+
+    for( x = x0; x < x1; ++x )
+    {
+        unsigned int packed = 0;
+        for( c = 0; c < 4; ++c )
+        {
+            int t = pIn[x * 4 + c] * pLayout->mMax[c] + pDither[x & 3];
+            packed |= (unsigned int)( ( t + 1 + ( t >> 8 ) ) >> 8 ) << pLayout->mShift[c];
+        }
+        pOut[x] = (unsigned short)packed;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackPixelsDiffused - Floyd-Steinberg packing
+//
+// Each pixel depends on its left neighbour, so this stays scalar. Errors are kept in 1/16ths of
+// an 8-bit step for the current and the next row, with a pixel of padding on either side.
+int PackPixelsDiffused( int packFormat, unsigned char* pPixels, int width, int height, int stride )
+{
+    const PackLayout* pLayout = &gPackLayouts[packFormat];
+    int rowErrors = ( width + 2 ) * 4;
+    int* pErrors = (int*)calloc( 2 * rowErrors, sizeof(int) );
+    int levels[4][64];
+    int x, y, c, level;
+
+    if( pErrors == NULL )
+    {
+        return 0;
+    }
+
+    // Value of each level, in the same 1/16 steps
+    for( c = 0; c < 4; ++c )
+    {
+        for( level = 0; level <= pLayout->mMax[c]; ++level )
+        {
+            levels[c][level] = pLayout->mMax[c] ? ( level * 255 * 16 + pLayout->mMax[c] / 2 ) / pLayout->mMax[c] : 0;
+        }
+    }
+
+    for( y = 0; y < height; ++y )
+    {
+        unsigned char* pRow = pPixels + stride * y;
+        unsigned short* pOut = (unsigned short*)pRow;
+        int* pCurrent = pErrors + ( y & 1 ) * rowErrors + 4;
+        int* pNext = pErrors + ( ~y & 1 ) * rowErrors + 4;
+
+        memset( pNext - 4, 0, rowErrors * sizeof(int) );
+
+        for( x = 0; x < width; ++x )
+        {
+            unsigned int packed = 0;
+            for( c = 0; c < 4; ++c )
+            {
+                int max = pLayout->mMax[c];
+                int i = x * 4 + c;
+                int value, error, error7, error5, error3;
+
+                if( max == 0 )
+                {
+                    continue;
+                }
+
+                value = pRow[i] * 16 + pCurrent[i];
+                value = value < 0 ? 0 : ( value > 255 * 16 ? 255 * 16 : value );
+                level = ( value * max + 255 * 8 ) / ( 255 * 16 );
+                error = value - levels[c][level];
+
+                error7 = error * 7 / 16;
+                error5 = error * 5 / 16;
+                error3 = error * 3 / 16;
+                pCurrent[i + 4] += error7;
+                pNext[i - 4] += error3;
+                pNext[i] += error5;
+                pNext[i + 4] += error - error7 - error5 - error3;
+
+                packed |= (unsigned int)level << pLayout->mShift[c];
+            }
+            pOut[x] = (unsigned short)packed;
+        }
+    }
+
+    free( pErrors );
+    return 1;
+}
+
+
+#if defined(__SSE2__)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SwizzlePremultiplyRGBASSE2 - 4 pixels per iteration
+//
+// Premultiplication works on 2 pixels of 16-bit lanes, with the alpha lanes multiplied by 255 so
+// they come out unchanged; ( t + ( t >> 8 ) ) >> 8 with t = c * a + 128 is the exact c * a / 255.
+static inline __m128i PremultiplySSE2( __m128i pixels, __m128i colorMask, __m128i alphaOne, __m128i round )
+{
+    __m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( pixels, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) );
+    __m128i t = _mm_add_epi16( _mm_mullo_epi16( pixels, _mm_or_si128( _mm_and_si128( alpha, colorMask ), alphaOne ) ), round );
+    return _mm_srli_epi16( _mm_add_epi16( t, _mm_srli_epi16( t, 8 ) ), 8 );
+}
+
+void SwizzlePremultiplyRGBASSE2( unsigned int flags, unsigned char* pRow, int width )
+{
+    const __m128i zero       = _mm_setzero_si128();
+    const __m128i greenAlpha = _mm_set1_epi32( (int)0xff00ff00 );
+    const __m128i lowByte    = _mm_set1_epi32( 0x000000ff );
+    const __m128i colorMask  = _mm_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1 );
+    const __m128i alphaOne   = _mm_set_epi16( 255, 0, 0, 0, 255, 0, 0, 0 );
+    const __m128i round      = _mm_set1_epi16( 128 );
+    PixelTransform tail;
+    int i = 0;
+
+    for( ; i + 4 <= width; i += 4 )
+    {
+        __m128i pixels = _mm_loadu_si128( (const __m128i*)( pRow + i * 4 ) );
+
+        if( flags & PIXEL_SWIZZLE_RB )
+        {
+            __m128i red  = _mm_slli_epi32( _mm_and_si128( pixels, lowByte ), 16 );
+            __m128i blue = _mm_and_si128( _mm_srli_epi32( pixels, 16 ), lowByte );
+            pixels = _mm_or_si128( _mm_and_si128( pixels, greenAlpha ), _mm_or_si128( red, blue ) );
+        }
+        if( flags & PIXEL_PREMULTIPLY_ALPHA )
+        {
+            __m128i lo = PremultiplySSE2( _mm_unpacklo_epi8( pixels, zero ), colorMask, alphaOne, round );
+            __m128i hi = PremultiplySSE2( _mm_unpackhi_epi8( pixels, zero ), colorMask, alphaOne, round );
+            pixels = _mm_packus_epi16( lo, hi );
+        }
+
+        _mm_storeu_si128( (__m128i*)( pRow + i * 4 ), pixels );
+    }
+
+    tail.mFlags = flags & ( PIXEL_SWIZZLE_RB | PIXEL_PREMULTIPLY_ALPHA );
+    TransformPixelRowScalar( &tail, pRow + i * 4, width - i, 4 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackPixelRowSSE2 - 4 pixels per iteration
+//
+// Works on 2 pixels of 16-bit lanes. Multiplying by 1 << shift moves each level to its bit position
+// and, as the fields don't overlap, two shifted adds gather them into the low lane of each pixel.
+static inline __m128i PackQuantizeSSE2( __m128i channels, __m128i scale, __m128i dither, __m128i place )
+{
+    const __m128i one = _mm_set1_epi16( 1 );
+    __m128i t = _mm_add_epi16( _mm_mullo_epi16( channels, scale ), dither );
+    __m128i level = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( t, one ), _mm_srli_epi16( t, 8 ) ), 8 );
+    __m128i fields = _mm_mullo_epi16( level, place );
+
+    fields = _mm_add_epi16( fields, _mm_srli_epi64( fields, 32 ) );
+    return _mm_add_epi16( fields, _mm_srli_epi64( fields, 16 ) );
+}
+
+void PackPixelRowSSE2( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int width, const unsigned char* pDither )
+{
+    const unsigned char* m = pLayout->mMax;
+    const unsigned char* s = pLayout->mShift;
+    const __m128i zero     = _mm_setzero_si128();
+    const __m128i scale    = _mm_set_epi16( m[3], m[2], m[1], m[0], m[3], m[2], m[1], m[0] );
+    const __m128i place    = _mm_set_epi16( 1 << s[3], 1 << s[2], 1 << s[1], 1 << s[0], 1 << s[3], 1 << s[2], 1 << s[1], 1 << s[0] );
+    const __m128i ditherLo = _mm_set_epi16( pDither[1], pDither[1], pDither[1], pDither[1], pDither[0], pDither[0], pDither[0], pDither[0] );
+    const __m128i ditherHi = _mm_set_epi16( pDither[3], pDither[3], pDither[3], pDither[3], pDither[2], pDither[2], pDither[2], pDither[2] );
+    int i = 0;
+
+    for( ; i + 4 <= width; i += 4 )
+    {
+        __m128i pixels = _mm_loadu_si128( (const __m128i*)( pIn + i * 4 ) );
+        __m128i lo = PackQuantizeSSE2( _mm_unpacklo_epi8( pixels, zero ), scale, ditherLo, place );
+        __m128i hi = PackQuantizeSSE2( _mm_unpackhi_epi8( pixels, zero ), scale, ditherHi, place );
+
+        // Gather the 4 low lanes and sign extend them, so the signed pack keeps all 16 bits
+        __m128i packed = _mm_unpacklo_epi64( _mm_shuffle_epi32( lo, _MM_SHUFFLE( 3, 3, 2, 0 ) ), _mm_shuffle_epi32( hi, _MM_SHUFFLE( 3, 3, 2, 0 ) ) );
+        packed = _mm_srai_epi32( _mm_slli_epi32( packed, 16 ), 16 );
+        _mm_storel_epi64( (__m128i*)( pOut + i ), _mm_packs_epi32( packed, packed ) );
+    }
+
+    PackPixelRowScalar( pLayout, pOut, pIn, i, width, pDither );
+}
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BuildSrgbTable
+static void BuildSrgbTable()
+{
+    int i;
+
+    for( i = 0; i < 256; ++i )
+    {
+        float srgb = i / 255.0f;
+        float linear = srgb <= 0.04045f ? srgb / 12.92f : powf( ( srgb + 0.055f ) / 1.055f, 2.4f );
+        gSrgbToLinear[i] = (unsigned char)( linear * 255.0f + 0.5f );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SelectPixelKernels
+void SelectPixelKernels( unsigned int features )
+{
+    gpSwizzlePremultiplyRGBA = NULL;
+    gpPackPixelRow = NULL;
+
+#if defined(__SSE2__)
+    if( features & CPU_FEATURE_SSE2 )
+    {
+        gpSwizzlePremultiplyRGBA = SwizzlePremultiplyRGBASSE2;
+        gpPackPixelRow = PackPixelRowSSE2;
+    }
+#endif
+
+#if defined(HAVE_NEON)
+    if( features & CPU_FEATURE_NEON )
+    {
+        gpSwizzlePremultiplyRGBA = SwizzlePremultiplyRGBANEON;
+        gpPackPixelRow = PackPixelRowNEON;
+    }
+#endif
+
+    (void)features;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformPixelRow - stbi_row_func entry point
+//
+// RGBA rows use the vector kernel for swizzle and premultiply. The sRGB table lookup has no vector
+// form, so it runs first as a scalar loop over the same row, which is still in L1 at that point.
+void TransformPixelRow( void* pTransform, unsigned char* pRow, int width, int comp )
+{
+    const PixelTransform* pPixelTransform = (const PixelTransform*)pTransform;
+    unsigned int flags = pPixelTransform->mFlags;
+
+    InitKernelDispatch();
+    pthread_once( &gSrgbTableOnce, BuildSrgbTable );
+
+    if( comp != 4 || gpSwizzlePremultiplyRGBA == NULL )
+    {
+        TransformPixelRowScalar( pPixelTransform, pRow, width, comp );
+        return;
+    }
+
+    if( flags & PIXEL_SRGB_TO_LINEAR )
+    {
+        PixelTransform linearize;
+        linearize.mFlags = PIXEL_SRGB_TO_LINEAR;
+        TransformPixelRowScalar( &linearize, pRow, width, comp );
+    }
+    if( flags & ( PIXEL_SWIZZLE_RB | PIXEL_PREMULTIPLY_ALPHA ) )
+    {
+        gpSwizzlePremultiplyRGBA( flags, pRow, width );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackPixelRow - picks the thresholds for the row and runs the fastest packing kernel
+void PackPixelRow( int packFormat, int dither, unsigned short* pOut, const unsigned char* pIn, int width, int y )
+{
+    const PackLayout* pLayout = &gPackLayouts[packFormat];
+    const unsigned char* pDither = dither == PIXEL_DITHER_ORDERED ? gBayerThresholds[y & 3] : gRoundThresholds;
+
+    InitKernelDispatch();
+
+    if( gpPackPixelRow != NULL )
+    {
+        gpPackPixelRow( pLayout, pOut, pIn, width, pDither );
+    }
+    else
+    {
+        PackPixelRowScalar( pLayout, pOut, pIn, 0, width, pDither );
+    }
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+// Load time pixel fixups, applied in a single pass over each decoded row while it is in cache
+#define PIXEL_FLIP_Y                0x00000001  // Store rows bottom-up (done by the decoder, not per pixel)
+#define PIXEL_SWIZZLE_RB            0x00000002  // Swap red and blue (RGB(A) <-> BGR(A))
+#define PIXEL_SRGB_TO_LINEAR        0x00000004  // sRGB to linear color, kept in 8 bits (loses precision in the darks)
+#define PIXEL_PREMULTIPLY_ALPHA     0x00000008  // Multiply color by alpha, in linear space when combined with the above
+
+typedef struct
+{
+    unsigned int mFlags;    // PIXEL_* flags
+} PixelTransform;
+
+// Applies the per pixel operations of pTransform (a PixelTransform) to a row of 'width' pixels with
+// 'comp' 8-bit channels, in the order swizzle, linearize, premultiply. Matches stb_image's
+// stbi_row_func so it can run inside the decoder's output loop; safe to call from several threads.
+void TransformPixelRow( void* pTransform, unsigned char* pRow, int width, int comp );
+
+// Points the RGBA swizzle/premultiply and packing kernels at the variants 'features' (CPU_FEATURE_*)
+// allows. Called by the kernel dispatch (dispatch.h).
+void SelectPixelKernels( unsigned int features );
+
+// Scalar version, also used for the tail of a row by the SIMD versions
+void TransformPixelRowScalar( const PixelTransform* pTransform, unsigned char* pRow, int width, int comp );
+
+// 4 channel kernels for swizzle and premultiply, called after any sRGB conversion
+void SwizzlePremultiplyRGBASSE2( unsigned int flags, unsigned char* pRow, int width );
+void SwizzlePremultiplyRGBANEON( unsigned int flags, unsigned char* pRow, int width );
+
+// 16-bit packed formats, uploaded with the matching GL_UNSIGNED_SHORT_* type
+#define PIXEL_PACK_NONE             0
+#define PIXEL_PACK_RGB565           1
+#define PIXEL_PACK_RGBA4444         2
+#define PIXEL_PACK_RGBA5551         3
+
+// Dithering used when packing
+#define PIXEL_DITHER_NONE           0   // Round to the nearest level
+#define PIXEL_DITHER_ORDERED        1   // 4x4 Bayer matrix; rows are independent, so it runs inside the decoder
+#define PIXEL_DITHER_DIFFUSION      2   // Floyd-Steinberg; needs the rows in order, so it runs after decoding
+
+// Per channel levels - 1 and bit positions of a packed format
+typedef struct
+{
+    unsigned char mMax[4];
+    unsigned char mShift[4];
+} PackLayout;
+
+// Packs a row of 'width' RGBA pixels into 16-bit pixels, rounded or ordered dithered with pattern
+// row 'y'. pOut may point at pIn, the packed pixels never overtake the reads.
+void PackPixelRow( int packFormat, int dither, unsigned short* pOut, const unsigned char* pIn, int width, int y );
+
+// Packs 'height' rows of RGBA pixels in place with Floyd-Steinberg error diffusion, each row's packed
+// pixels replacing the start of the row. Returns 0 if out of memory.
+int PackPixelsDiffused( int packFormat, unsigned char* pPixels, int width, int height, int stride );
+
+// Scalar packing of pixels [x0, x1), also used for the tail of a row by the SIMD versions. pDither
+// holds the threshold (0-254) for each x & 3.
+void PackPixelRowScalar( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int x0, int x1,
+                         const unsigned char* pDither );
+
+void PackPixelRowSSE2( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int width, const unsigned char* pDither );
+void PackPixelRowNEON( const PackLayout* pLayout, unsigned short* pOut, const unsigned char* pIn, int width, const unsigned char* pDither );
@@ -0,0 +1,289 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "staging.h"
+
+// Buffers come in four size classes per power of two, from 4 KB up, so one is never more than
+// 25% larger than asked for. Past 256 MB they are plain allocations that are freed on release.
+#define STAGING_MIN_SHIFT           12
+#define STAGING_MAX_SHIFT           28
+
+// Precedes every buffer handed out
+typedef struct StagingBlock
+{
+    struct StagingBlock* pNewer;    // Idle list links, only valid while in the pool
+    struct StagingBlock* pOlder;
+    size_t               mCapacity; // Usable bytes after the header
+    int                  mPooled;   // Zero for buffers outside the size classes
+} StagingBlock;
+
+// Rounded so the buffer keeps the alignment malloc gave the block
+#define STAGING_HEADER_SIZE         ( ( sizeof(StagingBlock) + 15 ) & ~(size_t)15 )
+
+static pthread_mutex_t  gStagingMutex = PTHREAD_MUTEX_INITIALIZER;
+static StagingBlock*    gpNewestIdle = NULL;
+static StagingBlock*    gpOldestIdle = NULL;
+static StagingPoolStats gStagingStats = { 0, 0, 0, 0, 0, STAGING_POOL_DEFAULT_LIMIT };
+
+// Bytes the calling thread holds (negative if it released buffers acquired elsewhere), their peak
+// and their level at the last ResetThreadStagingPeak
+static __thread long long gThreadBytes = 0;
+static __thread long long gThreadPeak = 0;
+static __thread long long gThreadBase = 0;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Per thread accounting, no lock needed
+static void AddThreadBytes( long long bytes )
+{
+    gThreadBytes += bytes;
+    if( gThreadBytes > gThreadPeak )
+    {
+        gThreadPeak = gThreadBytes;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the capacity of the size class 'size' falls in, or 0 if it is too large to pool
+static size_t GetClassCapacity( size_t size )
+{
+    int shift = STAGING_MIN_SHIFT;
+    size_t step;
+
+    if( size <= ( (size_t)1 << STAGING_MIN_SHIFT ) )
+    {
+        return (size_t)1 << STAGING_MIN_SHIFT;
+    }
+
+    // 2^shift < size <= 2^(shift + 1), rounded up to a quarter of 2^shift
+    while( shift < STAGING_MAX_SHIFT && ( (size_t)1 << ( shift + 1 ) ) < size )
+    {
+        ++shift;
+    }
+    if( shift == STAGING_MAX_SHIFT )
+    {
+        return 0;
+    }
+    step = (size_t)1 << ( shift - 2 );
+    return ( size + step - 1 ) & ~( step - 1 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Idle list helpers, called with gStagingMutex held
+static void UnlinkIdle( StagingBlock* pBlock )
+{
+    if( pBlock->pNewer != NULL )
+    {
+        pBlock->pNewer->pOlder = pBlock->pOlder;
+    }
+    else
+    {
+        gpNewestIdle = pBlock->pOlder;
+    }
+    if( pBlock->pOlder != NULL )
+    {
+        pBlock->pOlder->pNewer = pBlock->pNewer;
+    }
+    else
+    {
+        gpOldestIdle = pBlock->pNewer;
+    }
+    gStagingStats.mBytesIdle -= pBlock->mCapacity;
+}
+
+static void FreeIdleDownTo( size_t bytes )
+{
+    while( gpOldestIdle != NULL && gStagingStats.mBytesIdle > bytes )
+    {
+        StagingBlock* pBlock = gpOldestIdle;
+        UnlinkIdle( pBlock );
+        free( pBlock );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AcquireStagingBuffer
+//
+// The idle list is short (the limit over the size of a texture), so finding a block of the right
+// class is a linear scan, newest first so recently touched memory is handed out again.
+void* AcquireStagingBuffer( size_t size )
+{
+    size_t capacity = GetClassCapacity( size );
+    int pooled = capacity != 0;
+    StagingBlock* pBlock = NULL;
+
+    pthread_mutex_lock( &gStagingMutex );
+
+    ++gStagingStats.mAcquires;
+    if( pooled )
+    {
+        for( pBlock = gpNewestIdle; pBlock != NULL && pBlock->mCapacity != capacity; pBlock = pBlock->pOlder )
+        {
+        }
+    }
+    if( pBlock != NULL )
+    {
+        UnlinkIdle( pBlock );
+        ++gStagingStats.mReuses;
+        gStagingStats.mBytesInUse += capacity;
+        pthread_mutex_unlock( &gStagingMutex );
+        AddThreadBytes( capacity );
+        return (unsigned char*)pBlock + STAGING_HEADER_SIZE;
+    }
+    pthread_mutex_unlock( &gStagingMutex );
+
+    if( !pooled )
+    {
+        capacity = size;
+    }
+    if( capacity > (size_t)-1 - STAGING_HEADER_SIZE )
+    {
+        return NULL;
+    }
+
+    // Idle buffers of other classes are given back to the system before giving up
+    pBlock = (StagingBlock*)malloc( STAGING_HEADER_SIZE + capacity );
+    if( pBlock == NULL )
+    {
+        TrimStagingPool();
+        pBlock = (StagingBlock*)malloc( STAGING_HEADER_SIZE + capacity );
+        if( pBlock == NULL )
+        {
+            return NULL;
+        }
+    }
+    pBlock->pNewer = NULL;
+    pBlock->pOlder = NULL;
+    pBlock->mCapacity = capacity;
+    pBlock->mPooled = pooled;
+
+    pthread_mutex_lock( &gStagingMutex );
+    gStagingStats.mBytesInUse += capacity;
+    if( gStagingStats.mBytesInUse + gStagingStats.mBytesIdle > gStagingStats.mPeakBytes )
+    {
+        gStagingStats.mPeakBytes = gStagingStats.mBytesInUse + gStagingStats.mBytesIdle;
+    }
+    pthread_mutex_unlock( &gStagingMutex );
+    AddThreadBytes( capacity );
+
+    return (unsigned char*)pBlock + STAGING_HEADER_SIZE;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ReleaseStagingBuffer
+void ReleaseStagingBuffer( void* pBuffer )
+{
+    StagingBlock* pBlock;
+
+    if( pBuffer == NULL )
+    {
+        return;
+    }
+    pBlock = (StagingBlock*)( (unsigned char*)pBuffer - STAGING_HEADER_SIZE );
+    AddThreadBytes( -(long long)pBlock->mCapacity );
+
+    pthread_mutex_lock( &gStagingMutex );
+
+    gStagingStats.mBytesInUse -= pBlock->mCapacity;
+    if( !pBlock->mPooled || pBlock->mCapacity > gStagingStats.mLimit )
+    {
+        pthread_mutex_unlock( &gStagingMutex );
+        free( pBlock );
+        return;
+    }
+
+    FreeIdleDownTo( gStagingStats.mLimit - pBlock->mCapacity );
+
+    pBlock->pNewer = NULL;
+    pBlock->pOlder = gpNewestIdle;
+    if( gpNewestIdle != NULL )
+    {
+        gpNewestIdle->pNewer = pBlock;
+    }
+    else
+    {
+        gpOldestIdle = pBlock;
+    }
+    gpNewestIdle = pBlock;
+    gStagingStats.mBytesIdle += pBlock->mCapacity;
+
+    pthread_mutex_unlock( &gStagingMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SetStagingPoolLimit
+void SetStagingPoolLimit( size_t limit )
+{
+    pthread_mutex_lock( &gStagingMutex );
+    gStagingStats.mLimit = limit;
+    FreeIdleDownTo( limit );
+    pthread_mutex_unlock( &gStagingMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TrimStagingPool
+void TrimStagingPool()
+{
+    pthread_mutex_lock( &gStagingMutex );
+    FreeIdleDownTo( 0 );
+    pthread_mutex_unlock( &gStagingMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetStagingPoolStats
+void GetStagingPoolStats( StagingPoolStats* pStats )
+{
+    pthread_mutex_lock( &gStagingMutex );
+    *pStats = gStagingStats;
+    pthread_mutex_unlock( &gStagingMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResetThreadStagingPeak
+void ResetThreadStagingPeak()
+{
+    gThreadBase = gThreadBytes;
+    gThreadPeak = gThreadBytes;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetThreadStagingPeak
+size_t GetThreadStagingPeak()
+{
+    return (size_t)( gThreadPeak - gThreadBase );
+}
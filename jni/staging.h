@@ -0,0 +1,70 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+// Pool of large scratch buffers (file contents, decoded pixels, mip chains, decoder planes) that
+// are only needed until a texture is uploaded. Released buffers are kept, up to a byte limit, and
+// handed to the next request of the same size class, so loading many textures doesn't go through
+// the allocator (and fault in fresh pages) for every one of them. Safe to use from any thread.
+
+// Idle bytes kept for reuse unless SetStagingPoolLimit says otherwise
+#define STAGING_POOL_DEFAULT_LIMIT  ( 32 * 1024 * 1024 )
+
+typedef struct
+{
+    unsigned int mAcquires;         // Buffers handed out
+    unsigned int mReuses;           // ... of which came from the pool, mReuses / mAcquires is the reuse rate
+    size_t       mBytesInUse;       // Capacity of the buffers handed out and not released yet
+    size_t       mBytesIdle;        // Capacity of the buffers waiting in the pool
+    size_t       mPeakBytes;        // High-water mark of mBytesInUse + mBytesIdle
+    size_t       mLimit;            // Cap on mBytesIdle
+} StagingPoolStats;
+
+// Returns a buffer of at least 'size' bytes, 16-byte aligned, or NULL if out of memory. Its
+// contents are undefined. Release it with ReleaseStagingBuffer, never free().
+void* AcquireStagingBuffer( size_t size );
+
+// Gives a buffer back to the pool, or to the system if the pool is full. NULL is ignored.
+void ReleaseStagingBuffer( void* pBuffer );
+
+// Sets the cap on idle bytes and frees idle buffers, oldest first, until the pool fits in it
+void SetStagingPoolLimit( size_t limit );
+
+// Frees every idle buffer, e.g. once a level has finished loading
+void TrimStagingPool();
+
+void GetStagingPoolStats( StagingPoolStats* pStats );
+
+// High-water mark of the bytes held by buffers the calling thread acquired, since it last called
+// ResetThreadStagingPeak. Brackets one load to measure its transient memory; buffers the worker
+// pool acquires on the load's behalf (mip filter rows) aren't included.
+void ResetThreadStagingPeak();
+size_t GetThreadStagingPeak();
@@ -1,8 +1,8 @@
-#ifndef _stb_image_h
-#define _stb_image_h
-
-#define STBI_HEADER_FILE_ONLY
-
-#include "stb_image.c"
-
-#endif
+#ifndef _stb_image_h
+#define _stb_image_h
+
+#define STBI_HEADER_FILE_ONLY
+
+#include "stb_image.c"
+
+#endif
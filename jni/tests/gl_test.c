@@ -0,0 +1,2244 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl31.h>     // glGetTexLevelParameteriv, to read back textures
+
+#include "block_codec.h"
+#include "file.h"
+#include "gl_caps.h"
+#include "gl_state.h"
+#include "ktx.h"
+#include "ktxint.h"
+#include "loader_thread.h"
+#include "mipmap.h"
+#include "staging.h"
+#include "texture.h"
+#include "texture_cache.h"
+#include "texture_memory.h"
+#include "texture_residency.h"
+#include "upload.h"
+#include "upload_scheduler.h"
+
+// Loads textures on the host's GL (Mesa's llvmpipe will do) through a headless EGL context, and
+// checks what the loaders leave in GL by drawing each mip level and reading it back.
+//
+//     gl_test [-a asset directory] [-d data directory]
+//
+// The app's textures come from the asset directory, ../../assets by default, the mipmapped ones
+// from the data directory, tests/data by default. Files a test writes go to $TMPDIR, /tmp by
+// default. Returns non-zero if any test fails.
+//
+// glMapBufferRange is linked wrapped (-Wl,--wrap) so the tests can make it fail, and have the
+// loaders upload from client memory instead of the upload ring. glCompressedTexSubImage2D is
+// wrapped to count the calls drivers may refuse but Mesa takes, glGetIntegerv to count the queries
+// the state cache and the capabilities should spare.
+
+typedef GLuint (*Loader)( const char* pFileName, const TextureOptions* pOptions );
+
+typedef struct
+{
+    const char* pName;
+    int         mInData;    // In the data directory rather than the asset directory
+    Loader      pLoader;
+} TestTexture;
+
+typedef struct
+{
+    const char* pName;
+    int         (*pFunction)();     // Returns the number of failures
+} Test;
+
+static const char* gAssetDirectory = "../../assets";
+static const char* gDataDirectory = "data";
+static const char* gTempDirectory = "/tmp";
+
+static EGLDisplay gDisplay = EGL_NO_DISPLAY;
+static EGLConfig gConfig;
+
+static GLuint gProgram = 0;
+static GLuint gFramebuffer = 0;
+static GLuint gRenderbuffer = 0;
+
+static int gFailMapping = 0;
+static int gETC1SubImageCalls = 0;
+static GLenum gCountedQuery = GL_UNPACK_ALIGNMENT;
+static int gQueryCount = 0;
+
+static const TestTexture gTextures[] =
+{
+    { "tex_png.png",                0, LoadTexturePNGEx },
+    { "420_333x217.jpg",            1, LoadTexturePNGEx },
+    { "tex_etc2.ktx",               0, LoadTextureETC_KTXEx },
+    { "etc2_512x256_mips.ktx",      1, LoadTextureETC_KTXEx },
+    { "tex_s3tc.dds",               0, LoadTextureS3TCEx },
+    { "dxt5_512x256_mips.dds",      1, LoadTextureS3TCEx },
+};
+
+#define TEXTURE_COUNT           ( sizeof(gTextures) / sizeof(gTextures[0]) )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Fails the mapping while gFailMapping is set
+void* __real_glMapBufferRange( GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access );
+
+void* __wrap_glMapBufferRange( GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access )
+{
+    if( gFailMapping )
+    {
+        return NULL;
+    }
+    return __real_glMapBufferRange( target, offset, length, access );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Counts the ETC1 updates OES_compressed_ETC1_RGB8_texture forbids
+void __real_glCompressedTexSubImage2D( GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                       GLenum format, GLsizei size, const void* pData );
+
+void __wrap_glCompressedTexSubImage2D( GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                       GLenum format, GLsizei size, const void* pData )
+{
+    if( format == GL_ETC1_RGB8_OES )
+    {
+        ++gETC1SubImageCalls;
+    }
+    __real_glCompressedTexSubImage2D( target, level, x, y, width, height, format, size, pData );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Counts the queries of gCountedQuery, e.g. of the unpack alignment the state cache should answer
+void __real_glGetIntegerv( GLenum name, GLint* pValue );
+
+void __wrap_glGetIntegerv( GLenum name, GLint* pValue )
+{
+    if( name == gCountedQuery )
+    {
+        ++gQueryCount;
+    }
+    __real_glGetIntegerv( name, pValue );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Makes a GLES3 context, sharing objects with 'share' unless it is EGL_NO_CONTEXT. It has no
+// surface, everything is drawn into framebuffer objects.
+static EGLContext CreateContext( EGLContext share )
+{
+    static const EGLint attributes[] = { EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE };
+
+    return eglCreateContext( gDisplay, gConfig, share, attributes );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Opens the display without a window system, returns 0 if there is no GLES3 config
+static int InitDisplay()
+{
+    static const EGLint attributes[] =
+    {
+        EGL_RENDERABLE_TYPE,    EGL_OPENGL_ES3_BIT,
+        EGL_SURFACE_TYPE,       EGL_PBUFFER_BIT,
+        EGL_NONE
+    };
+    PFNEGLGETPLATFORMDISPLAYEXTPROC pGetPlatformDisplay;
+    EGLint configCount = 0;
+
+    pGetPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress( "eglGetPlatformDisplayEXT" );
+    if( pGetPlatformDisplay != NULL )
+    {
+        gDisplay = pGetPlatformDisplay( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL );
+    }
+    if( gDisplay == EGL_NO_DISPLAY )
+    {
+        gDisplay = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+    }
+
+    return eglInitialize( gDisplay, NULL, NULL ) &&
+           eglBindAPI( EGL_OPENGL_ES_API ) &&
+           eglChooseConfig( gDisplay, attributes, &gConfig, 1, &configCount ) &&
+           configCount > 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the program and framebuffer ReadLevel draws with, in the current context
+static int InitReadback()
+{
+    static const char* pVertexSource =
+        "#version 300 es\n"
+        "out vec2 uv;\n"
+        "void main()\n"
+        "{\n"
+        "    uv = vec2( gl_VertexID & 1, gl_VertexID >> 1 );\n"
+        "    gl_Position = vec4( uv * 2.0 - 1.0, 0.0, 1.0 );\n"
+        "}\n";
+    static const char* pFragmentSource =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "void main()\n"
+        "{\n"
+        "    color = textureLod( tex, uv, 0.0 );\n"
+        "}\n";
+    GLuint vertexShader = glCreateShader( GL_VERTEX_SHADER );
+    GLuint fragmentShader = glCreateShader( GL_FRAGMENT_SHADER );
+    GLint linked = 0;
+
+    glShaderSource( vertexShader, 1, &pVertexSource, NULL );
+    glCompileShader( vertexShader );
+    glShaderSource( fragmentShader, 1, &pFragmentSource, NULL );
+    glCompileShader( fragmentShader );
+
+    gProgram = glCreateProgram();
+    glAttachShader( gProgram, vertexShader );
+    glAttachShader( gProgram, fragmentShader );
+    glLinkProgram( gProgram );
+    glDeleteShader( vertexShader );
+    glDeleteShader( fragmentShader );
+    glGetProgramiv( gProgram, GL_LINK_STATUS, &linked );
+
+    glGenFramebuffers( 1, &gFramebuffer );
+    glGenRenderbuffers( 1, &gRenderbuffer );
+    return linked;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Draws mip level 'level' of a 2D texture at its own size and returns its RGBA pixels, NULL if the
+// texture has no such level. Free them.
+//
+// The level is drawn on its own, as the base and max level, so it reads the same whether or not
+// the rest of the chain is complete. The state goes through the state cache (see gl_state.h), as
+// the loaders' does.
+static unsigned char* ReadLevel( GLuint texture, int level, int* pWidth, int* pHeight )
+{
+    unsigned char* pPixels;
+    GLint width = 0;
+    GLint height = 0;
+
+    CachedBindTexture( GL_TEXTURE_2D, texture );
+    glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width );
+    glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height );
+    if( width == 0 || height == 0 )
+    {
+        return NULL;
+    }
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+
+    glBindRenderbuffer( GL_RENDERBUFFER, gRenderbuffer );
+    glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height );
+    glBindFramebuffer( GL_FRAMEBUFFER, gFramebuffer );
+    glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, gRenderbuffer );
+    glViewport( 0, 0, width, height );
+    CachedUseProgram( gProgram );
+    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+
+    pPixels = (unsigned char*)malloc( width * height * 4 );
+    glReadPixels( 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pPixels );
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+
+    *pWidth = width;
+    *pHeight = height;
+    return pPixels;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Compares the mip levels of a 2D texture from 'firstLevel' on with every level of another,
+// returns the number of levels that differ in size or contents. 'pLevelCount' gets the number of
+// levels compared.
+static int CompareTextureLevels( GLuint first, int firstLevel, GLuint second, const char* pName, int* pLevelCount )
+{
+    int differ = 0;
+    int level;
+
+    for( level = 0; ; ++level )
+    {
+        int firstWidth, firstHeight, secondWidth, secondHeight;
+        unsigned char* pFirst = ReadLevel( first, firstLevel + level, &firstWidth, &firstHeight );
+        unsigned char* pSecond = ReadLevel( second, level, &secondWidth, &secondHeight );
+
+        if( pFirst == NULL && pSecond == NULL )
+        {
+            break;
+        }
+        if( pFirst == NULL || pSecond == NULL || firstWidth != secondWidth || firstHeight != secondHeight )
+        {
+            printf( "  %s: level %d is missing or a different size\n", pName, level );
+            ++differ;
+        }
+        else if( memcmp( pFirst, pSecond, firstWidth * firstHeight * 4 ) != 0 )
+        {
+            printf( "  %s: level %d differs\n", pName, level );
+            ++differ;
+        }
+        free( pFirst );
+        free( pSecond );
+    }
+
+    *pLevelCount = level;
+    return differ;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Compares every mip level of two 2D textures, returns the number of levels that differ in size
+// or contents. 'pLevelCount' gets the number of levels the first one has.
+static int CompareTextures( GLuint first, GLuint second, const char* pName, int* pLevelCount )
+{
+    return CompareTextureLevels( first, 0, second, pName, pLevelCount );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the name a test texture is opened with
+static const char* TexturePath( const TestTexture* pTexture, char* pPath, size_t size )
+{
+    snprintf( pPath, size, "%s/%s", pTexture->mInData ? gDataDirectory : gAssetDirectory, pTexture->pName );
+    return pPath;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the path of a file the tests write
+static const char* TempPath( const char* pName, char* pPath, size_t size )
+{
+    snprintf( pPath, size, "%s/%s", gTempDirectory, pName );
+    return pPath;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads a whole file, returns NULL if it can't. Free it.
+static unsigned char* LoadFile( const char* pPath, unsigned int* pSize )
+{
+    FILE* pFile = fopen( pPath, "rb" );
+    unsigned char* pData = NULL;
+    long size;
+
+    if( pFile == NULL )
+    {
+        return NULL;
+    }
+    if( fseek( pFile, 0, SEEK_END ) == 0 && ( size = ftell( pFile ) ) > 0 && fseek( pFile, 0, SEEK_SET ) == 0 )
+    {
+        pData = (unsigned char*)malloc( size );
+        if( pData != NULL && fread( pData, 1, size, pFile ) != (size_t)size )
+        {
+            free( pData );
+            pData = NULL;
+        }
+        *pSize = (unsigned int)size;
+    }
+    fclose( pFile );
+    return pData;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the bytes of levels 'first' to 'last' (excluded) of a block compressed mip chain
+static unsigned int GetBlockLevelsSize( int blockFormat, int width, int height, int first, int last )
+{
+    unsigned int size = 0;
+    int level;
+
+    for( level = first; level < last; ++level )
+    {
+        size += GetBlockLevelSize( blockFormat, width >> level > 1 ? width >> level : 1,
+                                   height >> level > 1 ? height >> level : 1 );
+    }
+    return size;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds the mip chain of a block compressed level 0 with the CPU builder the loaders use, with
+// their default settings. Returns all the levels one after the other and their count, NULL on
+// failure. Free them.
+static unsigned char* BuildBlockLevels( int blockFormat, const unsigned char* pLevel0, int width, int height,
+                                        int* pLevelCount )
+{
+    unsigned int level0Size = GetBlockLevelSize( blockFormat, width, height );
+    unsigned char* pChain;
+    unsigned char* pLevels;
+
+    pChain = BuildBlockMipChain( blockFormat, pLevel0, width, height, MIP_FILTER_BOX, 0, 128, pLevelCount );
+    if( pChain == NULL )
+    {
+        return NULL;
+    }
+    pLevels = (unsigned char*)malloc( GetBlockLevelsSize( blockFormat, width, height, 0, *pLevelCount ) );
+    memcpy( pLevels, pLevel0, level0Size );
+    memcpy( pLevels + level0Size, pChain, GetBlockLevelsSize( blockFormat, width, height, 1, *pLevelCount ) );
+    ReleaseStagingBuffer( pChain );
+    return pLevels;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Encodes a level 0 of smooth gradients in 'blockFormat' and builds its mip chain, see
+// BuildBlockLevels
+static unsigned char* EncodeBlockLevels( int blockFormat, int width, int height, int* pLevelCount )
+{
+    unsigned char* pLevel0 = (unsigned char*)malloc( GetBlockLevelSize( blockFormat, width, height ) );
+    unsigned char* pBlock = pLevel0;
+    unsigned char* pLevels;
+    int blockX, blockY;
+
+    for( blockY = 0; blockY < height; blockY += 4 )
+    {
+        for( blockX = 0; blockX < width; blockX += 4 )
+        {
+            unsigned char pixels[16 * 4];
+            int x, y;
+
+            for( y = 0; y < 4; ++y )
+            {
+                for( x = 0; x < 4; ++x )
+                {
+                    unsigned char* pPixel = pixels + ( y * 4 + x ) * 4;
+
+                    pPixel[0] = (unsigned char)( ( blockX + x ) * 255 / width );
+                    pPixel[1] = (unsigned char)( ( blockY + y ) * 255 / height );
+                    pPixel[2] = (unsigned char)( ( blockX + blockY ) * 4 );
+                    pPixel[3] = 255;
+                }
+            }
+            EncodeBlock( blockFormat, pixels, pBlock );
+            pBlock += GetBlockBytes( blockFormat );
+        }
+    }
+
+    pLevels = BuildBlockLevels( blockFormat, pLevel0, width, height, pLevelCount );
+    free( pLevel0 );
+    return pLevels;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Writes levels 'first' and down of a block compressed mip chain to a 2D KTX file, packed smallest
+// first if 'smallestFirst' is set. Returns 0 if it can't.
+static int WriteBlockKTX( const char* pPath, GLenum format, int blockFormat, const unsigned char* pLevels, int width,
+                          int height, int first, int levelCount, int smallestFirst )
+{
+    KTX_image_info images[MAX_MIP_LEVELS];
+    KTX_texture_info info;
+    KTX_hash_table keyValues = NULL;
+    unsigned char* pKeyValueData = NULL;
+    unsigned int keyValueSize = 0;
+    int written;
+    int level;
+
+    memset( &info, 0, sizeof(info) );
+    info.glTypeSize = 1;
+    info.glInternalFormat = format;
+    info.glBaseInternalFormat = blockFormat == BLOCK_FORMAT_ETC2_RGBA || blockFormat == BLOCK_FORMAT_DXT5 ? GL_RGBA : GL_RGB;
+    info.pixelWidth = width >> first > 1 ? width >> first : 1;
+    info.pixelHeight = height >> first > 1 ? height >> first : 1;
+    info.numberOfFaces = 1;
+    info.numberOfMipmapLevels = levelCount - first;
+
+    for( level = first; level < levelCount; ++level )
+    {
+        images[level - first].size = (GLsizei)GetBlockLevelsSize( blockFormat, width, height, level, level + 1 );
+        images[level - first].data = (GLubyte*)pLevels + GetBlockLevelsSize( blockFormat, width, height, 0, level );
+    }
+
+    if( smallestFirst )
+    {
+        keyValues = ktxHashTable_Create();
+        ktxHashTable_AddKVPair( keyValues, KTX_LEVEL_ORDER_KEY, sizeof(KTX_LEVEL_ORDER_SMALLEST_FIRST),
+                                KTX_LEVEL_ORDER_SMALLEST_FIRST );
+        ktxHashTable_Serialize( keyValues, &keyValueSize, &pKeyValueData );
+        ktxHashTable_Destroy( keyValues );
+    }
+
+    written = ktxWriteKTXN( pPath, &info, keyValueSize, pKeyValueData, levelCount - first, images ) == KTX_SUCCESS;
+    free( pKeyValueData );
+    return written;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads levels 'first' and down of a block compressed mip chain to a new texture, level by level
+// with glCompressedTexImage2D, which every compressed format may be specified with
+static GLuint UploadBlockLevels( GLenum format, int blockFormat, const unsigned char* pLevels, int width, int height,
+                                 int first, int levelCount )
+{
+    GLuint texture;
+    int level;
+
+    CachedGenTextures( 1, &texture );
+    CachedBindTexture( GL_TEXTURE_2D, texture );
+    for( level = first; level < levelCount; ++level )
+    {
+        glCompressedTexImage2D( GL_TEXTURE_2D, level - first, format, width >> level > 1 ? width >> level : 1,
+                                height >> level > 1 ? height >> level : 1, 0,
+                                (GLsizei)GetBlockLevelsSize( blockFormat, width, height, level, level + 1 ),
+                                pLevels + GetBlockLevelsSize( blockFormat, width, height, 0, level ) );
+    }
+    return texture;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a KTX file with the given options, runs the upload scheduler until it is done with it and
+// compares it with a reference texture. Returns the number of failures.
+static int CheckKTXLoad( const char* pPath, const char* pCase, const TextureOptions* pOptions, GLuint reference,
+                         int immutable )
+{
+    GLuint texture;
+    GLint isImmutable = GL_FALSE;
+    int levels = 0;
+    int differ;
+
+    gETC1SubImageCalls = 0;
+    texture = LoadTextureETC_KTXEx( pPath, pOptions );
+
+    if( texture == 0 )
+    {
+        printf( "  %s: didn't load\n", pCase );
+        return 1;
+    }
+    while( RunScheduledUploads( 1000 ) > 0 )
+    {
+        // Streamed levels arrive a band at a time
+    }
+
+    differ = CompareTextures( reference, texture, pCase, &levels );
+    if( gETC1SubImageCalls > 0 )
+    {
+        printf( "  %s: updated ETC1 levels with glCompressedTexSubImage2D\n", pCase );
+        ++differ;
+    }
+    CachedBindTexture( GL_TEXTURE_2D, texture );
+    glGetTexParameteriv( GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &isImmutable );
+    if( immutable && !isImmutable )
+    {
+        printf( "  %s: has no immutable storage\n", pCase );
+        ++differ;
+    }
+    printf( "  %s: %d levels, %s\n", pCase, levels, differ ? "FAILED" : "match" );
+
+    DeleteTexture( texture );
+    return differ;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a test texture on this thread with the given options (may be NULL) and compares it with
+// 'texture'. Returns the number of failures.
+static int CompareWithLoad( GLuint texture, const TestTexture* pTexture, const TextureOptions* pOptions,
+                            const char* pCase )
+{
+    GLuint loaded;
+    char path[1024];
+    int levels = 0;
+    int differ;
+
+    loaded = pTexture->pLoader( TexturePath( pTexture, path, sizeof(path) ), pOptions );
+    if( loaded == 0 )
+    {
+        printf( "  %s: didn't load\n", pCase );
+        return 1;
+    }
+
+    differ = CompareTextures( loaded, texture, pCase, &levels );
+    printf( "  %s: %d levels, %s\n", pCase, levels, differ ? "FAILED" : "match" );
+    DeleteTexture( loaded );
+    return differ;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Makes a 1x1 texture to leave in the handles of queued loads
+static GLuint CreatePlaceholder()
+{
+    static const unsigned char pixel[4] = { 255, 0, 255, 255 };
+    GLuint texture;
+
+    CachedGenTextures( 1, &texture );
+    CachedBindTexture( GL_TEXTURE_2D, texture );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel );
+    return texture;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Publishes the textures the loader thread finishes once a "frame" until none are left, or about
+// 10 seconds have passed. Returns the number of loads still pending.
+static int PublishAll()
+{
+    int pending = 0;
+    int frame;
+
+    for( frame = 0; frame < 10000; ++frame )
+    {
+        pending = PublishLoadedTextures();
+        if( pending == 0 )
+        {
+            break;
+        }
+        usleep( 1000 );
+    }
+    return pending;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads every texture through the upload ring and again from client memory, with mapping failing,
+// and checks they match, with and without the top level skipped. Also checks the ring statistics
+// count the uploads that went through it and the ones that fell back.
+static int TestUploadRing()
+{
+    int failures = 0;
+    unsigned int file;
+    unsigned int skip;
+
+    for( file = 0; file < TEXTURE_COUNT; ++file )
+    {
+        for( skip = 0; skip < 2; ++skip )
+        {
+            UploadRingStats before, ring, client;
+            TextureOptions options;
+            GLuint ringTexture, clientTexture;
+            char path[1024];
+            int levels = 0;
+            int differ;
+
+            memset( &options, 0, sizeof(options) );
+            options.mSkipMipLevels = skip;
+            TexturePath( &gTextures[file], path, sizeof(path) );
+
+            GetUploadRingStats( &before );
+            ringTexture = gTextures[file].pLoader( path, &options );
+            GetUploadRingStats( &ring );
+            gFailMapping = 1;
+            clientTexture = gTextures[file].pLoader( path, &options );
+            gFailMapping = 0;
+            GetUploadRingStats( &client );
+
+            if( ringTexture == 0 || clientTexture == 0 )
+            {
+                printf( "  %s: didn't load\n", gTextures[file].pName );
+                ++failures;
+                continue;
+            }
+
+            differ = CompareTextures( ringTexture, clientTexture, gTextures[file].pName, &levels );
+            if( ring.mBytes == before.mBytes || ring.mUploads == before.mUploads ||
+                ring.mIssueNanoseconds == before.mIssueNanoseconds || ring.mFallbacks != before.mFallbacks )
+            {
+                printf( "  %s: the ring statistics don't count its upload\n", gTextures[file].pName );
+                ++differ;
+            }
+            if( client.mBytes != ring.mBytes || client.mFallbacks == ring.mFallbacks )
+            {
+                printf( "  %s: the ring statistics don't count the fallback\n", gTextures[file].pName );
+                ++differ;
+            }
+            printf( "  %s, skipping %u: %d levels, %s\n", gTextures[file].pName, skip, levels, differ ? "FAILED" : "match" );
+            failures += differ;
+
+            DeleteTexture( ringTexture );
+            DeleteTexture( clientTexture );
+        }
+    }
+
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads every texture through a ring of one buffer, so each upload waits for the one before, and
+// checks they load as they do with the default ring
+static int TestSmallUploadRing()
+{
+    int failures = 0;
+    unsigned int file;
+
+    for( file = 0; file < TEXTURE_COUNT; ++file )
+    {
+        GLuint reference, texture;
+        char path[1024];
+        int levels = 0;
+        int differ;
+
+        TexturePath( &gTextures[file], path, sizeof(path) );
+        reference = gTextures[file].pLoader( path, NULL );
+        SetUploadRingSize( 1 );
+        texture = gTextures[file].pLoader( path, NULL );
+        ShutdownUploadRing();
+        SetUploadRingSize( UPLOAD_RING_DEFAULT_BUFFERS );
+
+        differ = CompareTextures( reference, texture, gTextures[file].pName, &levels );
+        printf( "  %s: %d levels, %s\n", gTextures[file].pName, levels, differ ? "FAILED" : "match" );
+        failures += differ;
+
+        DeleteTexture( reference );
+        DeleteTexture( texture );
+    }
+
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads ETC1 files every way the loaders upload them and checks they match ETC1 textures made with
+// glCompressedTexImage2D, the only upload OES_compressed_ETC1_RGB8_texture allows. Where ETC2 is
+// supported ETC1 textures are ETC2 ones and must get immutable storage like any other.
+static int TestETC1()
+{
+    const KTX_header* pHeader;
+    TextureOptions options;
+    unsigned char* pFile;
+    unsigned char* pLevels;
+    unsigned int fileSize = 0;
+    unsigned int level0Offset;
+    int immutable = IsETC2Supported();
+    int failures = 0;
+    int levelCount;
+    GLuint reference;
+    char path[1024];
+    TestTexture etc1 = { "tex_etc1.ktx", 0, LoadTextureETC_KTXEx };
+
+    // The single level file, as it is and with the mip chain built on the CPU
+    TexturePath( &etc1, path, sizeof(path) );
+    pFile = LoadFile( path, &fileSize );
+    pHeader = (const KTX_header*)pFile;
+    level0Offset = KTX_HEADER_SIZE + ( pFile != NULL ? pHeader->bytesOfKeyValueData : 0 ) + sizeof(khronos_uint32_t);
+    if( pFile == NULL || fileSize < level0Offset || pHeader->glInternalFormat != GL_ETC1_RGB8_OES ||
+        GetBlockLevelSize( BLOCK_FORMAT_ETC1, pHeader->pixelWidth, pHeader->pixelHeight ) > fileSize - level0Offset )
+    {
+        printf( "  Couldn't read %s\n", path );
+        free( pFile );
+        return 1;
+    }
+
+    reference = UploadBlockLevels( GL_ETC1_RGB8_OES, BLOCK_FORMAT_ETC1, pFile + level0Offset, pHeader->pixelWidth,
+                                   pHeader->pixelHeight, 0, 1 );
+    failures += CheckKTXLoad( path, "tex_etc1.ktx", NULL, reference, immutable );
+    DeleteTexture( reference );
+
+    pLevels = BuildBlockLevels( BLOCK_FORMAT_ETC1, pFile + level0Offset, pHeader->pixelWidth, pHeader->pixelHeight,
+                                &levelCount );
+    reference = UploadBlockLevels( GL_ETC1_RGB8_OES, BLOCK_FORMAT_ETC1, pLevels, pHeader->pixelWidth,
+                                   pHeader->pixelHeight, 0, levelCount );
+    memset( &options, 0, sizeof(options) );
+    options.mBuildCompressedMips = 1;
+    failures += CheckKTXLoad( path, "tex_etc1.ktx, mips built", &options, reference, immutable );
+    DeleteTexture( reference );
+    free( pLevels );
+    free( pFile );
+
+    // A file with mips, loaded whole, without its top level, and streamed
+    pLevels = EncodeBlockLevels( BLOCK_FORMAT_ETC1, 256, 128, &levelCount );
+    TempPath( "gl_test_etc1.ktx", path, sizeof(path) );
+    if( !WriteBlockKTX( path, GL_ETC1_RGB8_OES, BLOCK_FORMAT_ETC1, pLevels, 256, 128, 0, levelCount, 0 ) )
+    {
+        printf( "  Couldn't write %s\n", path );
+        free( pLevels );
+        return failures + 1;
+    }
+
+    reference = UploadBlockLevels( GL_ETC1_RGB8_OES, BLOCK_FORMAT_ETC1, pLevels, 256, 128, 0, levelCount );
+    failures += CheckKTXLoad( path, "256x128 mips", NULL, reference, immutable );
+    memset( &options, 0, sizeof(options) );
+    options.mStreamLevels = 1;
+    failures += CheckKTXLoad( path, "256x128 mips, streamed", &options, reference, immutable );
+    DeleteTexture( reference );
+
+    reference = UploadBlockLevels( GL_ETC1_RGB8_OES, BLOCK_FORMAT_ETC1, pLevels, 256, 128, 1, levelCount );
+    memset( &options, 0, sizeof(options) );
+    options.mSkipMipLevels = 1;
+    failures += CheckKTXLoad( path, "256x128 mips, skipping 1", &options, reference, immutable );
+    options.mStreamLevels = 1;
+    failures += CheckKTXLoad( path, "256x128 mips, skipping 1, streamed", &options, reference, immutable );
+    DeleteTexture( reference );
+
+    remove( path );
+    free( pLevels );
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Writes a KTX file with mips packed smallest first, checks the writer did pack it that way, and
+// loads it every way: whole, without top levels, down to its last level, capped by size, and
+// streamed, where it is read straight through or falls back to reading it whole.
+static int TestSmallestFirstKTX()
+{
+    static const struct
+    {
+        const char*  pName;
+        unsigned int mSkip;
+        unsigned int mMaxDimension;
+        unsigned int mStream;
+        int          mFirstLevel;
+    } cases[] =
+    {
+        { "whole",                      0, 0,  0, 0 },
+        { "skipping 2",                 2, 0,  0, 2 },
+        { "skipping to the last level", 8, 0,  0, 8 },
+        { "capped at 64",               0, 64, 0, 2 },
+        { "streamed",                   0, 0,  1, 0 },
+        { "streamed, skipping 2",       2, 0,  1, 2 },
+        { "streamed, last level",       8, 0,  1, 8 },
+    };
+    unsigned char* pLevels;
+    unsigned char* pFile;
+    unsigned int fileSize = 0;
+    unsigned int firstSize;
+    unsigned int test;
+    int failures = 0;
+    int levelCount;
+    char path[1024];
+
+    pLevels = EncodeBlockLevels( BLOCK_FORMAT_ETC2_RGB, 256, 128, &levelCount );
+    TempPath( "gl_test_smallest_first.ktx", path, sizeof(path) );
+    if( !WriteBlockKTX( path, GL_COMPRESSED_RGB8_ETC2, BLOCK_FORMAT_ETC2_RGB, pLevels, 256, 128, 0, levelCount, 1 ) )
+    {
+        printf( "  Couldn't write %s\n", path );
+        free( pLevels );
+        return 1;
+    }
+
+    // The first level in the file is the 1x1 one
+    pFile = LoadFile( path, &fileSize );
+    if( pFile == NULL || fileSize < KTX_HEADER_SIZE + ( (const KTX_header*)pFile )->bytesOfKeyValueData + 4 )
+    {
+        printf( "  Couldn't read %s back\n", path );
+        ++failures;
+    }
+    else
+    {
+        memcpy( &firstSize, pFile + KTX_HEADER_SIZE + ( (const KTX_header*)pFile )->bytesOfKeyValueData, 4 );
+        if( firstSize != GetBlockLevelSize( BLOCK_FORMAT_ETC2_RGB, 1, 1 ) )
+        {
+            printf( "  The writer put a %u byte level first\n", firstSize );
+            ++failures;
+        }
+    }
+    free( pFile );
+
+    for( test = 0; test < sizeof(cases) / sizeof(cases[0]); ++test )
+    {
+        TextureOptions options;
+        GLuint reference;
+
+        memset( &options, 0, sizeof(options) );
+        options.mSkipMipLevels = cases[test].mSkip;
+        options.mMaxDimension = cases[test].mMaxDimension;
+        options.mStreamLevels = cases[test].mStream;
+        reference = UploadBlockLevels( GL_COMPRESSED_RGB8_ETC2, BLOCK_FORMAT_ETC2_RGB, pLevels, 256, 128,
+                                       cases[test].mFirstLevel, levelCount );
+        failures += CheckKTXLoad( path, cases[test].pName, &options, reference, 0 );
+        DeleteTexture( reference );
+    }
+
+    remove( path );
+    free( pLevels );
+    return failures;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Queues every texture, every other one without its top level, to the loader thread, and checks
+// the textures it publishes match ones loaded on this thread. Queued handles keep the placeholder
+// until published, failed loads keep it for good. Then stops the thread with the loads in flight,
+// which must publish only finished textures, and starts it again.
+static int TestLoaderThread()
+{
+    GLuint handles[TEXTURE_COUNT];
+    GLuint placeholder = CreatePlaceholder();
+    GLuint missing = placeholder;
+    TextureOptions options;
+    unsigned int file;
+    int failures = 0;
+    int round;
+
+    for( round = 0; round < 3; ++round )
+    {
+        int published = 0;
+        char name[64];
+
+        if( !StartLoaderThread() )
+        {
+            printf( "  Couldn't start the loader thread\n" );
+            DeleteTexture( placeholder );
+            return failures + 1;
+        }
+
+        for( file = 0; file < TEXTURE_COUNT; ++file )
+        {
+            char path[1024];
+
+            memset( &options, 0, sizeof(options) );
+            options.mSkipMipLevels = file & 1;
+            handles[file] = placeholder;
+            if( !QueueTextureLoad( TexturePath( &gTextures[file], path, sizeof(path) ), gTextures[file].pLoader,
+                                   &options, &handles[file] ) )
+            {
+                printf( "  %s: couldn't be queued\n", gTextures[file].pName );
+                ++failures;
+            }
+
+            // The request has its own copy of the name and options
+            memset( path, 0, sizeof(path) );
+            memset( &options, 0xff, sizeof(options) );
+        }
+        if( round == 0 )
+        {
+            QueueTextureLoad( "missing.png", LoadTexturePNGEx, NULL, &missing );
+        }
+        if( handles[0] != placeholder )
+        {
+            printf( "  %s: published before PublishLoadedTextures\n", gTextures[0].pName );
+            ++failures;
+        }
+
+        if( round == 1 )
+        {
+            // Stopped in flight, each handle gets its texture or keeps the placeholder
+            StopLoaderThread();
+        }
+        else
+        {
+            if( PublishAll() != 0 )
+            {
+                printf( "  Loads still pending after 10 seconds\n" );
+                ++failures;
+            }
+            StopLoaderThread();
+        }
+
+        for( file = 0; file < TEXTURE_COUNT; ++file )
+        {
+            memset( &options, 0, sizeof(options) );
+            options.mSkipMipLevels = file & 1;
+            snprintf( name, sizeof(name), "%s%s, round %d", gTextures[file].pName, file & 1 ? ", skipping 1" : "",
+                      round );
+            if( handles[file] == placeholder )
+            {
+                if( round != 1 )
+                {
+                    printf( "  %s: never published\n", name );
+                    ++failures;
+                }
+                continue;
+            }
+            failures += CompareWithLoad( handles[file], &gTextures[file], &options, name );
+            DeleteTexture( handles[file] );
+            ++published;
+        }
+        if( round == 1 )
+        {
+            printf( "  stopped in flight, %d of %d published\n", published, (int)TEXTURE_COUNT );
+        }
+    }
+
+    if( missing != placeholder )
+    {
+        printf( "  missing.png: a failed load replaced the placeholder\n" );
+        ++failures;
+    }
+    DeleteTexture( placeholder );
+    return failures;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads the PNG and the JPEG capped below their size, at once and deferred, and checks they hold
+// the levels of their full size chain that fit. Then has the residency manager drop levels of the
+// PNG to meet a budget, which must reload it with only those levels and keep them.
+static int TestMaxDimension()
+{
+    static const struct
+    {
+        unsigned int mFile;
+        unsigned int mMaxDimension;
+        unsigned int mDefer;
+        int          mFirstLevel;
+    } cases[] =
+    {
+        { 0, 256, 0, 3 },
+        { 0, 256, 1, 3 },
+        { 0, 1,   0, 11 },
+        { 1, 16,  0, 2 },   // 1/8 size is 42x28, its level 2 is the first that fits
+        { 1, 16,  1, 2 },
+    };
+    const TestTexture* pTexture = &gTextures[0];
+    TextureOptions options;
+    ResidencyStats stats;
+    GLuint placeholder;
+    GLuint reference;
+    GLuint handle;
+    GLint width = 0;
+    unsigned int test;
+    int failures = 0;
+    int levels = 0;
+    int differ;
+    int frame;
+    int settled = 0;
+    unsigned int loads = 0;
+    char path[1024];
+    char name[64];
+
+    for( test = 0; test < sizeof(cases) / sizeof(cases[0]); ++test )
+    {
+        GLuint texture;
+
+        memset( &options, 0, sizeof(options) );
+        options.mMipFilter = MIP_FILTER_BOX;
+        pTexture = &gTextures[cases[test].mFile];
+        snprintf( name, sizeof(name), "%s capped at %u%s", pTexture->pName, cases[test].mMaxDimension,
+                  cases[test].mDefer ? ", deferred" : "" );
+
+        // The JPEG reference is decoded at 1/8 size too
+        if( cases[test].mFile == 1 )
+        {
+            options.mMaxDimension = 42;
+        }
+        reference = pTexture->pLoader( TexturePath( pTexture, path, sizeof(path) ), &options );
+        options.mMaxDimension = cases[test].mMaxDimension;
+        options.mDeferUpload = cases[test].mDefer;
+        texture = pTexture->pLoader( path, &options );
+        if( reference == 0 || texture == 0 )
+        {
+            printf( "  %s: didn't load\n", name );
+            DeleteTexture( reference );
+            DeleteTexture( texture );
+            ++failures;
+            continue;
+        }
+        while( RunScheduledUploads( 1 << 20 ) > 0 )
+        {
+            // Deferred levels arrive a few at a time
+        }
+
+        differ = CompareTextureLevels( reference, cases[test].mFirstLevel, texture, name, &levels );
+        printf( "  %s: %d levels, %s\n", name, levels, differ ? "FAILED" : "match" );
+        failures += differ;
+        DeleteTexture( reference );
+        DeleteTexture( texture );
+    }
+
+    // 2048x1024 RGBA takes about 11MB with its mips, 512x256 less than 1MB
+    pTexture = &gTextures[0];
+    memset( &options, 0, sizeof(options) );
+    options.mMipFilter = MIP_FILTER_BOX;
+    placeholder = CreatePlaceholder();
+    handle = placeholder;
+    if( !StartLoaderThread() )
+    {
+        printf( "  Couldn't start the loader thread\n" );
+        DeleteTexture( placeholder );
+        return failures + 1;
+    }
+    SetTextureMemoryBudget( 1 << 20 );
+    ManageTextureResidency( TexturePath( pTexture, path, sizeof(path) ), pTexture->pLoader, &options, &handle );
+    for( frame = 0; frame < 10000 && settled < 300; ++frame )
+    {
+        BindResidentTexture( &handle );
+        PublishLoadedTextures();
+        UpdateTextureResidency();
+
+        // Once down to 512, it must stay there: the texture the reload replaced is no longer counted
+        GetResidencyStats( &stats );
+        CachedBindTexture( GL_TEXTURE_2D, handle );
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+        if( settled > 0 && stats.mLevelDrops + stats.mReloads + stats.mEvictions != loads )
+        {
+            printf( "  %s under a 1MB budget: reloaded again once it fit\n", pTexture->pName );
+            ++failures;
+            break;
+        }
+        if( handle != placeholder && width == 512 )
+        {
+            loads = stats.mLevelDrops + stats.mReloads + stats.mEvictions;
+            ++settled;
+        }
+        usleep( 1000 );
+    }
+    StopLoaderThread();
+    SetTextureMemoryBudget( 0 );
+
+    CachedBindTexture( GL_TEXTURE_2D, handle );
+    glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+    if( width != 512 )
+    {
+        printf( "  %s under a 1MB budget: reloaded %d wide, not 512\n", pTexture->pName, width );
+        ++failures;
+    }
+    else
+    {
+        reference = pTexture->pLoader( path, &options );
+        snprintf( name, sizeof(name), "%s under a 1MB budget", pTexture->pName );
+        differ = CompareTextureLevels( reference, 2, handle, name, &levels );
+        printf( "  %s: %d levels, %s\n", name, levels, differ ? "FAILED" : "match" );
+        failures += differ;
+        DeleteTexture( reference );
+    }
+
+    ResetTextureResidency();
+    if( handle != placeholder )
+    {
+        DeleteTexture( handle );
+    }
+    DeleteTexture( placeholder );
+    return failures;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks ResetTextureMemory forgets the registered textures and the totals, but keeps the budget
+static int TestTextureMemoryReset()
+{
+    TextureMemoryTotals totals;
+    TextureMemoryInfo info;
+    GLuint texture;
+    int failures = 0;
+    char path[1024];
+
+    SetTextureMemoryBudget( 1 << 20 );
+    texture = gTextures[0].pLoader( TexturePath( &gTextures[0], path, sizeof(path) ), NULL );
+    GetTextureMemoryTotals( &totals );
+    if( texture == 0 || !GetTextureMemoryInfo( texture, &info ) || totals.mGpuBytes == 0 )
+    {
+        printf( "  %s: not registered\n", gTextures[0].pName );
+        ++failures;
+    }
+
+    ResetTextureMemory();
+    GetTextureMemoryTotals( &totals );
+    printf( "  reset: %u textures, %u bytes, %u byte budget\n", totals.mTextureCount, (unsigned int)totals.mGpuBytes,
+            (unsigned int)totals.mGpuBudget );
+    if( GetTextureMemoryInfo( texture, &info ) || totals.mTextureCount != 0 || totals.mGpuBytes != 0 ||
+        totals.mPeakGpuBytes != 0 || totals.mGpuBudget != 1 << 20 )
+    {
+        ++failures;
+    }
+
+    SetTextureMemoryBudget( 0 );
+    DeleteTexture( texture );
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Defers the PNG's upload in a context that is then lost, the way Init finds things when it runs
+// again, and checks the scheduler forgets it instead of uploading to the placeholder that gets its
+// name in the new context
+static int TestLostContext()
+{
+    EGLContext context = eglGetCurrentContext();
+    EGLContext lost = CreateContext( EGL_NO_CONTEXT );
+    EGLContext other = CreateContext( EGL_NO_CONTEXT );
+    TextureOptions options;
+    GLuint texture = 0;
+    GLuint placeholder;
+    GLint baseLevel = -1;
+    GLint width = 0;
+    GLenum error;
+    int pending;
+    int failures = 0;
+    char path[1024];
+
+    if( lost == EGL_NO_CONTEXT || other == EGL_NO_CONTEXT ||
+        !eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, lost ) )
+    {
+        printf( "  Couldn't make a context to lose current\n" );
+        ++failures;
+    }
+    else
+    {
+        ResetGlStateCache();
+        memset( &options, 0, sizeof(options) );
+        options.mDeferUpload = 1;
+        texture = gTextures[0].pLoader( TexturePath( &gTextures[0], path, sizeof(path) ), &options );
+        if( texture == 0 || !IsTextureUploadScheduled( texture ) )
+        {
+            printf( "  %s: no levels left to upload\n", gTextures[0].pName );
+            ++failures;
+        }
+    }
+    eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+    if( lost != EGL_NO_CONTEXT )
+    {
+        eglDestroyContext( gDisplay, lost );
+    }
+
+    if( other != EGL_NO_CONTEXT && eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, other ) )
+    {
+        // What Init forgets of the old context
+        ResetGlStateCache();
+        ResetUploadScheduler();
+        ResetTextureMemory();
+        ResetTextureResidency();
+        ResetTextureCache();
+
+        placeholder = CreatePlaceholder();
+        while( glGetError() != GL_NO_ERROR )
+        {
+            // Only errors from the scheduler count
+        }
+        pending = RunScheduledUploads( 1 << 20 );
+        error = glGetError();
+        glGetTexParameteriv( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &baseLevel );
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+
+        printf( "  placeholder %u in the new context, %s %u: %d pending, base level %d, width %d, error 0x%x\n",
+                placeholder, placeholder == texture ? "as was" : "unlike", texture, pending, baseLevel, width, error );
+        if( IsTextureUploadScheduled( texture ) || pending != 0 || baseLevel != 0 || width != 1 || error != GL_NO_ERROR )
+        {
+            ++failures;
+        }
+        CachedDeleteTextures( 1, &placeholder );
+    }
+    else
+    {
+        printf( "  Couldn't make a new context current\n" );
+        ++failures;
+    }
+    eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context );
+    if( other != EGL_NO_CONTEXT )
+    {
+        eglDestroyContext( gDisplay, other );
+    }
+
+    // Back on this context, whose state the cache no longer knows
+    ResetGlStateCache();
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads the PNG and the JPEG cut short, through the upload ring, from client memory, with the mip
+// chain built on the CPU and deferred. Each load must fail without leaving a texture behind.
+static int TestTruncatedFiles()
+{
+    static const struct
+    {
+        unsigned int mFile;
+        unsigned int mSize;
+    } files[] =
+    {
+        { 0, 3000 },
+        { 1, 2000 },
+    };
+    static const struct
+    {
+        const char*  pName;
+        int          mFailMapping;
+        unsigned int mMipFilter;
+        unsigned int mDefer;
+    } cases[] =
+    {
+        { "through the ring",       0, MIP_FILTER_DRIVER, 0 },
+        { "from client memory",     1, MIP_FILTER_DRIVER, 0 },
+        { "with CPU mips",          1, MIP_FILTER_BOX,    0 },
+        { "deferred",               0, MIP_FILTER_BOX,    1 },
+    };
+    TextureMemoryTotals before, after;
+    unsigned int file;
+    unsigned int test;
+    int failures = 0;
+
+    for( file = 0; file < sizeof(files) / sizeof(files[0]); ++file )
+    {
+        const TestTexture* pTexture = &gTextures[files[file].mFile];
+        unsigned char* pFile;
+        unsigned int fileSize = 0;
+        FILE* pCut;
+        char path[1024];
+        char cutPath[1024];
+
+        pFile = LoadFile( TexturePath( pTexture, path, sizeof(path) ), &fileSize );
+        TempPath( "gl_test_truncated", cutPath, sizeof(cutPath) );
+        pCut = fopen( cutPath, "wb" );
+        if( pFile == NULL || fileSize <= files[file].mSize || pCut == NULL ||
+            fwrite( pFile, 1, files[file].mSize, pCut ) != files[file].mSize )
+        {
+            printf( "  Couldn't cut %s to %u bytes\n", path, files[file].mSize );
+            ++failures;
+        }
+        if( pCut != NULL )
+        {
+            fclose( pCut );
+        }
+        free( pFile );
+
+        for( test = 0; test < sizeof(cases) / sizeof(cases[0]); ++test )
+        {
+            TextureOptions options;
+            GLuint texture;
+
+            memset( &options, 0, sizeof(options) );
+            options.mMipFilter = cases[test].mMipFilter;
+            options.mDeferUpload = cases[test].mDefer;
+            gFailMapping = cases[test].mFailMapping;
+            GetTextureMemoryTotals( &before );
+            texture = pTexture->pLoader( cutPath, &options );
+            while( RunScheduledUploads( 1 << 20 ) > 0 )
+            {
+                // A deferred load that got through would upload here
+            }
+            GetTextureMemoryTotals( &after );
+            gFailMapping = 0;
+
+            printf( "  %s cut to %u bytes, %s: %s\n", pTexture->pName, files[file].mSize, cases[test].pName,
+                    texture == 0 && after.mTextureCount == before.mTextureCount ? "failed" : "FAILED to fail" );
+            if( texture != 0 || after.mTextureCount != before.mTextureCount )
+            {
+                DeleteTexture( texture );
+                ++failures;
+            }
+        }
+        remove( cutPath );
+    }
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Streams the mipmapped KTX and DDS files, whole, skipping 2 levels and capped at 64, and checks
+// the scheduler leaves the same levels as loading them at once
+static int TestStreaming()
+{
+    static const struct
+    {
+        const char*  pName;
+        unsigned int mSkip;
+        unsigned int mMaxDimension;
+    } cases[] =
+    {
+        { "whole",          0, 0 },
+        { "skipping 2",     2, 0 },
+        { "capped at 64",   0, 64 },
+    };
+    static const unsigned int files[] = { 3, 5 };
+    unsigned int file;
+    unsigned int test;
+    int failures = 0;
+
+    for( file = 0; file < sizeof(files) / sizeof(files[0]); ++file )
+    {
+        const TestTexture* pTexture = &gTextures[files[file]];
+
+        for( test = 0; test < sizeof(cases) / sizeof(cases[0]); ++test )
+        {
+            TextureOptions options;
+            GLuint texture;
+            char path[1024];
+            char name[64];
+
+            memset( &options, 0, sizeof(options) );
+            options.mSkipMipLevels = cases[test].mSkip;
+            options.mMaxDimension = cases[test].mMaxDimension;
+            options.mStreamLevels = 1;
+            snprintf( name, sizeof(name), "%s streamed, %s", pTexture->pName, cases[test].pName );
+
+            texture = pTexture->pLoader( TexturePath( pTexture, path, sizeof(path) ), &options );
+            if( texture == 0 )
+            {
+                printf( "  %s: didn't load\n", name );
+                ++failures;
+                continue;
+            }
+            while( RunScheduledUploads( 1000 ) > 0 )
+            {
+                // Streamed levels arrive a band at a time
+            }
+
+            options.mStreamLevels = 0;
+            failures += CompareWithLoad( texture, pTexture, &options, name );
+            DeleteTexture( texture );
+        }
+    }
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reports a texture in a slot as drawn over a square 'size' of the viewport, centered, then runs
+// a frame of residency
+static void RunResidencyFrame( GLuint* pFirst, float firstSize, GLuint* pSecond, float secondSize )
+{
+    GLuint* pHandles[2] = { pFirst, pSecond };
+    float sizes[2] = { firstSize, secondSize };
+    int slot;
+
+    for( slot = 0; slot < 2; ++slot )
+    {
+        float s = sizes[slot];
+        const float quad[6][4] =
+        {
+            { -s, -s, 0.0f, 0.0f }, { s, -s, 1.0f, 0.0f }, { -s, s, 0.0f, 1.0f },
+            { s, -s, 1.0f, 0.0f },  { s, s, 1.0f, 1.0f },  { -s, s, 0.0f, 1.0f },
+        };
+
+        if( pHandles[slot] != NULL )
+        {
+            BindResidentTexture( pHandles[slot] );
+            ReportTextureFootprint( pHandles[slot], &quad[0][0], &quad[0][2], sizeof(quad[0]), 6 );
+        }
+    }
+    PublishLoadedTextures();
+    UpdateTextureResidency();
+    usleep( 1000 );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Starts the loader thread and manages the mipmapped KTX and DDS files, 512x256, on a 512x512
+// viewport, the KTX drawn 64 pixels wide and the DDS full size until both are loaded. Returns 0
+// if they don't load.
+static int StartResidency( GLuint* pKtx, GLuint* pDds, GLuint placeholder )
+{
+    char path[1024];
+    int frame;
+
+    *pKtx = placeholder;
+    *pDds = placeholder;
+    if( !StartLoaderThread() )
+    {
+        printf( "  Couldn't start the loader thread\n" );
+        return 0;
+    }
+    SetResidencyViewport( 512, 512 );
+    ManageTextureResidency( TexturePath( &gTextures[3], path, sizeof(path) ), gTextures[3].pLoader, NULL, pKtx );
+    ManageTextureResidency( TexturePath( &gTextures[5], path, sizeof(path) ), gTextures[5].pLoader, NULL, pDds );
+    for( frame = 0; frame < 10000 && ( *pKtx == placeholder || *pDds == placeholder ); ++frame )
+    {
+        RunResidencyFrame( pKtx, 0.125f, pDds, 1.0f );
+    }
+    if( *pKtx == placeholder || *pDds == placeholder )
+    {
+        printf( "  The managed textures didn't load\n" );
+        return 0;
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Stops the loader thread and residency, and deletes the textures in the slots. Reloads still in
+// flight are let into their slots first, residency deleting the textures they replace; pDds may
+// be NULL.
+static void StopResidency( GLuint* pKtx, GLuint* pDds, GLuint placeholder )
+{
+    GLuint* pHandles[2] = { pKtx, pDds };
+    int frame;
+    int slot;
+
+    for( frame = 0; frame < 10000 && ( IsTextureLoadPending( pKtx ) || ( pDds != NULL && IsTextureLoadPending( pDds ) ) ); ++frame )
+    {
+        RunResidencyFrame( NULL, 0.0f, NULL, 0.0f );
+    }
+    StopLoaderThread();
+    ResetTextureResidency();
+    for( slot = 0; slot < 2; ++slot )
+    {
+        if( pHandles[slot] != NULL && *pHandles[slot] != placeholder )
+        {
+            DeleteTexture( *pHandles[slot] );
+        }
+    }
+    DeleteTexture( placeholder );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks the KTX drawn 64 pixels wide, which only needs level 3, has its base level clamped to it
+// once that has lasted RESIDENCY_DROP_FRAMES, without being reloaded
+static int TestResidency()
+{
+    GLuint placeholder = CreatePlaceholder();
+    GLuint ktx, dds;
+    GLint baseLevel = 0;
+    GLint width = 0;
+    int failures = 0;
+    int frame;
+
+    if( !StartResidency( &ktx, &dds, placeholder ) )
+    {
+        StopResidency( &ktx, &dds, placeholder );
+        return 1;
+    }
+    for( frame = 0; frame < RESIDENCY_DROP_FRAMES + 1; ++frame )
+    {
+        RunResidencyFrame( &ktx, 0.125f, &dds, 1.0f );
+    }
+    CachedBindTexture( GL_TEXTURE_2D, ktx );
+    glGetTexParameteriv( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &baseLevel );
+    glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+    printf( "  %s at 64 pixels: base level %d, %d wide\n", gTextures[3].pName, baseLevel, width );
+    if( baseLevel != 3 || width != 512 )
+    {
+        ++failures;
+    }
+
+    StopResidency( &ktx, &dds, placeholder );
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks that under a budget the DDS drawn full size doesn't fit in, the KTX unused for
+// RESIDENCY_IDLE_FRAMES is evicted first and the DDS drops levels, then that binding the KTX again
+// reloads it
+static int TestResidencyBudget()
+{
+    const TestTexture* pKtx = &gTextures[3];
+    const TestTexture* pDds = &gTextures[5];
+    ResidencyStats stats;
+    GLuint placeholder = CreatePlaceholder();
+    GLuint ktx, dds;
+    GLint width = 0;
+    int failures = 0;
+    int frame;
+
+    if( !StartResidency( &ktx, &dds, placeholder ) )
+    {
+        StopResidency( &ktx, &dds, placeholder );
+        return 1;
+    }
+
+    // The DDS takes about 170KB, the budget only fits its level 1 and down
+    SetTextureMemoryBudget( 64 * 1024 );
+    for( frame = 0; frame < RESIDENCY_IDLE_FRAMES + 1000; ++frame )
+    {
+        RunResidencyFrame( NULL, 0.0f, &dds, 1.0f );
+        GetResidencyStats( &stats );
+        if( frame > RESIDENCY_IDLE_FRAMES && ktx == placeholder && stats.mLevelDrops > 0 && stats.mResidentCount == 1 &&
+            !IsTextureUploadScheduled( dds ) )
+        {
+            break;
+        }
+    }
+    CachedBindTexture( GL_TEXTURE_2D, dds );
+    glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+    printf( "  under a 64KB budget: %s %s, %s %d wide, %u evictions, %u level drops\n", pKtx->pName,
+            ktx == placeholder ? "evicted" : "kept", pDds->pName, width, stats.mEvictions, stats.mLevelDrops );
+    if( ktx != placeholder || stats.mEvictions != 1 || stats.mLevelDrops == 0 || width >= 512 )
+    {
+        ++failures;
+    }
+
+    // Bound again, the evicted texture comes back
+    SetTextureMemoryBudget( 0 );
+    for( frame = 0; frame < 10000 && ktx == placeholder; ++frame )
+    {
+        RunResidencyFrame( &ktx, 0.125f, &dds, 1.0f );
+    }
+    GetResidencyStats( &stats );
+    if( ktx == placeholder || stats.mReloads == 0 )
+    {
+        printf( "  %s: not reloaded once bound again\n", pKtx->pName );
+        ++failures;
+    }
+
+    StopResidency( &ktx, &dds, placeholder );
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Manages a copy of the KTX, with and without the loader thread, and hides the copy before a
+// budget makes residency reload it with fewer levels. The failed reload must leave the texture in
+// its slot and not be tried again for RESIDENCY_RETRY_FRAMES; once the copy is back, the retry
+// must replace it.
+static int TestResidencyRetry()
+{
+    const TestTexture* pKtx = &gTextures[3];
+    unsigned char* pFile;
+    unsigned int fileSize = 0;
+    FILE* pCopy;
+    int failures = 0;
+    int threaded;
+    char path[1024];
+    char copyPath[1024];
+    char hiddenPath[1024];
+
+    pFile = LoadFile( TexturePath( pKtx, path, sizeof(path) ), &fileSize );
+    TempPath( "gl_test_retry.ktx", copyPath, sizeof(copyPath) );
+    TempPath( "gl_test_retry_hidden.ktx", hiddenPath, sizeof(hiddenPath) );
+    pCopy = fopen( copyPath, "wb" );
+    if( pFile == NULL || pCopy == NULL || fwrite( pFile, 1, fileSize, pCopy ) != fileSize )
+    {
+        printf( "  Couldn't copy %s to %s\n", path, copyPath );
+        ++failures;
+    }
+    if( pCopy != NULL )
+    {
+        fclose( pCopy );
+    }
+    free( pFile );
+
+    for( threaded = 0; threaded < 2; ++threaded )
+    {
+        const char* pMode = threaded ? "loader thread" : "no loader thread";
+        ResidencyStats stats;
+        TextureMemoryTotals totals;
+        GLuint placeholder = CreatePlaceholder();
+        GLuint ktx = placeholder;
+        GLuint loaded;
+        GLint width = 0;
+        unsigned int drops;
+        int frame;
+
+        if( threaded && !StartLoaderThread() )
+        {
+            printf( "  Couldn't start the loader thread\n" );
+            ++failures;
+        }
+        SetResidencyViewport( 512, 512 );
+        ManageTextureResidency( copyPath, pKtx->pLoader, NULL, &ktx );
+        for( frame = 0; frame < 10000 && ktx == placeholder; ++frame )
+        {
+            RunResidencyFrame( &ktx, 0.125f, NULL, 0.0f );
+        }
+        loaded = ktx;
+
+        // The first reload the budget asks for fails
+        rename( copyPath, hiddenPath );
+        SetTextureMemoryBudget( 64 * 1024 );
+        memset( &stats, 0, sizeof(stats) );
+        for( frame = 0; frame < 10000 && stats.mFailedLoads == 0; ++frame )
+        {
+            RunResidencyFrame( &ktx, 0.125f, NULL, 0.0f );
+            GetResidencyStats( &stats );
+        }
+        drops = stats.mLevelDrops;
+        for( frame = 0; frame < RESIDENCY_RETRY_FRAMES / 2; ++frame )
+        {
+            RunResidencyFrame( &ktx, 0.125f, NULL, 0.0f );
+        }
+        GetResidencyStats( &stats );
+        if( loaded == placeholder || ktx != loaded || stats.mFailedLoads != 1 || stats.mLevelDrops != drops )
+        {
+            printf( "  %s: %u failed loads, %u reloads since the first failed, texture %s\n", pMode, stats.mFailedLoads,
+                    stats.mLevelDrops - drops, ktx == loaded ? "kept" : "lost" );
+            ++failures;
+        }
+
+        // Once the file is back the retry goes through
+        rename( hiddenPath, copyPath );
+        for( frame = 0; frame < 10000 && ktx == loaded; ++frame )
+        {
+            RunResidencyFrame( &ktx, 0.125f, NULL, 0.0f );
+        }
+
+        // A frame more for residency to delete the texture the reload replaced
+        RunResidencyFrame( &ktx, 0.125f, NULL, 0.0f );
+        GetTextureMemoryTotals( &totals );
+        CachedBindTexture( GL_TEXTURE_2D, ktx );
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width );
+        printf( "  %s: reload failed %u times, retried after %d frames, %d wide\n", pMode, stats.mFailedLoads,
+                frame, width );
+        if( ktx == loaded || width >= 512 || totals.mTextureCount != 1 )
+        {
+            ++failures;
+        }
+
+        SetTextureMemoryBudget( 0 );
+        StopResidency( &ktx, NULL, placeholder );
+    }
+    remove( copyPath );
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Acquires textures through the cache: by name, with other options, under another name with
+// content hashing on, and from a missing file. Checks the handles it shares, its counters, and
+// that only the last release deletes a texture.
+static int TestTextureCache()
+{
+    const TestTexture* pPng = &gTextures[0];
+    const TestTexture* pJpeg = &gTextures[1];
+    TextureCacheStats stats;
+    TextureOptions options;
+    unsigned char* pFile;
+    unsigned int fileSize = 0;
+    GLuint first, second, skipped, jpeg, copy, missing;
+    int failures = 0;
+    FILE* pCopy;
+    char path[1024];
+    char copyPath[1024];
+
+    ResetTextureCache();
+    memset( &options, 0, sizeof(options) );
+    options.mSkipMipLevels = 1;
+
+    TexturePath( pPng, path, sizeof(path) );
+    first = AcquireTexture( path, pPng->pLoader, NULL );
+    second = AcquireTexture( path, pPng->pLoader, NULL );
+    skipped = AcquireTexture( path, pPng->pLoader, &options );
+    if( first == 0 || second != first || skipped == 0 || skipped == first )
+    {
+        printf( "  %s: acquired as %u, %u and %u skipping 1\n", pPng->pName, first, second, skipped );
+        ++failures;
+    }
+
+    // The same bytes under another name
+    pFile = LoadFile( TexturePath( pJpeg, path, sizeof(path) ), &fileSize );
+    TempPath( "gl_test_copy.jpg", copyPath, sizeof(copyPath) );
+    pCopy = fopen( copyPath, "wb" );
+    if( pFile == NULL || pCopy == NULL || fwrite( pFile, 1, fileSize, pCopy ) != fileSize )
+    {
+        printf( "  Couldn't copy %s to %s\n", path, copyPath );
+        ++failures;
+    }
+    if( pCopy != NULL )
+    {
+        fclose( pCopy );
+    }
+    free( pFile );
+
+    SetTextureCacheContentHashing( 1 );
+    jpeg = AcquireTexture( path, pJpeg->pLoader, NULL );
+    copy = AcquireTexture( copyPath, pJpeg->pLoader, NULL );
+    if( jpeg == 0 || copy != jpeg )
+    {
+        printf( "  %s: acquired as %u, its copy as %u\n", pJpeg->pName, jpeg, copy );
+        ++failures;
+    }
+
+    missing = AcquireTexture( "missing.png", LoadTexturePNGEx, NULL );
+    GetTextureCacheStats( &stats );
+    if( missing != 0 || stats.mEntryCount != 4 || stats.mTextureCount != 3 || stats.mHits != 1 ||
+        stats.mContentHits != 1 || stats.mMisses != 3 )
+    {
+        printf( "  missing.png acquired as %u; %u entries, %u textures, %u hits, %u content hits, %u misses\n",
+                missing, stats.mEntryCount, stats.mTextureCount, stats.mHits, stats.mContentHits, stats.mMisses );
+        ++failures;
+    }
+
+    ReleaseTexture( first );
+    if( !glIsTexture( first ) )
+    {
+        printf( "  %s: deleted while still acquired\n", pPng->pName );
+        ++failures;
+    }
+    ReleaseTexture( second );
+    ReleaseTexture( jpeg );
+    ReleaseTexture( copy );
+    if( glIsTexture( first ) || glIsTexture( jpeg ) )
+    {
+        printf( "  The last release left the texture\n" );
+        ++failures;
+    }
+    ReleaseTexture( skipped );
+
+    GetTextureCacheStats( &stats );
+    if( stats.mTextureCount != 0 )
+    {
+        printf( "  %u textures still cached once released\n", stats.mTextureCount );
+        ++failures;
+    }
+
+    SetTextureCacheContentHashing( 0 );
+    ResetTextureCache();
+    remove( copyPath );
+    return failures;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads every texture with the state cache starting from nothing known, and checks the state it
+// knows then matches GL's, and that only the first load asks GL for the unpack alignment. Then
+// checks a repeated frame of render state is skipped whole, and that a texture created after one
+// is deleted gets its binding and parameters set, whether or not GL reuses the name. Last, checks
+// the upload ring doesn't forget what is known when it first sees a new context.
+static int TestStateCache()
+{
+    EGLContext context = eglGetCurrentContext();
+    EGLContext other;
+    GLuint textures[TEXTURE_COUNT];
+    GlStateStats before, after;
+    GLuint reused;
+    GLint value = 0;
+    unsigned int file;
+    int failures = 0;
+    int mismatches;
+    int round;
+
+    ResetGlStateCache();
+    gCountedQuery = GL_UNPACK_ALIGNMENT;
+    gQueryCount = 0;
+    for( file = 0; file < TEXTURE_COUNT; ++file )
+    {
+        TextureOptions options;
+        char path[1024];
+
+        memset( &options, 0, sizeof(options) );
+        options.mSkipMipLevels = file & 1;
+        textures[file] = gTextures[file].pLoader( TexturePath( &gTextures[file], path, sizeof(path) ), &options );
+        if( textures[file] == 0 )
+        {
+            printf( "  %s: didn't load\n", gTextures[file].pName );
+            ++failures;
+        }
+    }
+    printf( "  %d loads asked for the unpack alignment %d times\n", (int)TEXTURE_COUNT, gQueryCount );
+    if( gQueryCount > 1 )
+    {
+        ++failures;
+    }
+    mismatches = CountGlStateMismatches();
+    if( mismatches != 0 )
+    {
+        printf( "  %d pieces of state differ from GL after the loads\n", mismatches );
+        ++failures;
+    }
+
+    // What Render sets every frame
+    for( round = 0; round < 2; ++round )
+    {
+        GetGlStateStats( &before );
+        CachedUseProgram( gProgram );
+        CachedEnableVertexAttribArray( 0 );
+        CachedEnableVertexAttribArray( 1 );
+        CachedActiveTexture( GL_TEXTURE0 );
+        CachedBindTexture( GL_TEXTURE_2D, textures[0] );
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+        CachedBindBuffer( GL_ARRAY_BUFFER, 0 );
+        GetGlStateStats( &after );
+        printf( "  frame %d: %u calls issued, %u skipped\n", round, after.mIssued - before.mIssued,
+                after.mSkipped - before.mSkipped );
+    }
+    if( after.mIssued != before.mIssued )
+    {
+        ++failures;
+    }
+    CachedDisableVertexAttribArray( 0 );
+    CachedDisableVertexAttribArray( 1 );
+
+    for( file = 0; file < TEXTURE_COUNT; ++file )
+    {
+        DeleteTexture( textures[file] );
+    }
+
+    // Whether or not it has the name of the first texture, the new one starts from GL's defaults
+    CachedGenTextures( 1, &reused );
+    CachedBindTexture( GL_TEXTURE_2D, reused );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &value );
+    if( (GLuint)value != reused )
+    {
+        printf( "  texture %u %s reused: not bound\n", reused, reused == textures[0] ? "was" : "wasn't" );
+        ++failures;
+    }
+    glGetTexParameteriv( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &value );
+    if( value != GL_LINEAR_MIPMAP_LINEAR )
+    {
+        printf( "  texture %u %s reused: its filter wasn't set\n", reused, reused == textures[0] ? "was" : "wasn't" );
+        ++failures;
+    }
+    CachedDeleteTextures( 1, &reused );
+
+    mismatches = CountGlStateMismatches();
+    if( mismatches != 0 )
+    {
+        printf( "  %d pieces of state differ from GL at the end\n", mismatches );
+        ++failures;
+    }
+
+    // The active unit a thread makes known after making a context current, as the loader thread
+    // does, stays known once the upload ring first sees the context
+    other = CreateContext( context );
+    if( other != EGL_NO_CONTEXT && eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, other ) )
+    {
+        char path[1024];
+
+        ResetGlStateCache();
+        CachedActiveTexture( GL_TEXTURE0 );
+        reused = gTextures[0].pLoader( TexturePath( &gTextures[0], path, sizeof(path) ), NULL );
+        GetGlStateStats( &before );
+        CachedActiveTexture( GL_TEXTURE0 );
+        GetGlStateStats( &after );
+        printf( "  active unit after the ring's first upload in a new context: %s\n",
+                after.mSkipped > before.mSkipped ? "known" : "forgotten" );
+        if( reused == 0 || after.mSkipped == before.mSkipped )
+        {
+            ++failures;
+        }
+        DeleteTexture( reused );
+    }
+    else
+    {
+        printf( "  Couldn't make a second context current\n" );
+        ++failures;
+    }
+    eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context );
+    if( other != EGL_NO_CONTEXT )
+    {
+        eglDestroyContext( gDisplay, other );
+    }
+    ResetGlStateCache();
+    return failures;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether the current context lists an extension, from glGetStringi from OpenGL ES 3.0 on
+// and from the space separated string before it
+static int ListsExtension( const char* pName, int majorVersion )
+{
+    const char* pExtensions;
+    size_t length = strlen( pName );
+    GLint count = 0;
+    GLint index;
+
+    if( majorVersion >= 3 )
+    {
+        glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+        for( index = 0; index < count; ++index )
+        {
+            if( strcmp( (const char*)glGetStringi( GL_EXTENSIONS, index ), pName ) == 0 )
+            {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for( pExtensions = (const char*)glGetString( GL_EXTENSIONS ); pExtensions != NULL && *pExtensions != '\0'; )
+    {
+        size_t nameLength = strcspn( pExtensions, " " );
+
+        if( nameLength == length && memcmp( pExtensions, pName, length ) == 0 )
+        {
+            return 1;
+        }
+        pExtensions += nameLength;
+        pExtensions += strspn( pExtensions, " " );
+    }
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks the capabilities GetGlCaps reports for the current context against GL's own queries,
+// returns the number of differences
+static int CheckGlCaps( const char* pContext )
+{
+    static const char* const extensions[] =
+    {
+        "GL_OES_compressed_ETC1_RGB8_texture", "GL_IMG_texture_compression_pvrtc",
+        "GL_EXT_texture_compression_s3tc", "GL_EXT_texture_compression_dxt1", "GL_EXT_texture_compression_s3tc_srgb",
+        "GL_KHR_texture_compression_astc_ldr", "GL_EXT_texture_storage", "GL_NV_pixel_buffer_object",
+        "GL_OES_required_internalformat", "GL_EXT_texture_sRGB", "GL_ARB_texture_rg",
+    };
+    // The S3TC, PVRTC, ETC1, ETC2/EAC and ASTC families
+    static const GLenum families[][2] =
+    {
+        { 0x83F0, 0x83F3 }, { 0x8C4C, 0x8C4F }, { 0x8C00, 0x8C03 }, { 0x8D64, 0x8D64 }, { 0x9270, 0x9279 },
+        { 0x93B0, 0x93BD }, { 0x93D0, 0x93DD },
+    };
+    const GlCaps* pCaps = GetGlCaps();
+    const char* pVersion = (const char*)glGetString( GL_VERSION );
+    GLint* pFormats;
+    GLint formatCount = 0;
+    GLint maxTextureSize = 0;
+    int majorVersion = 0;
+    int minorVersion = 0;
+    int differ = 0;
+    int index;
+    unsigned int family;
+    unsigned int extension;
+
+    sscanf( pVersion, "OpenGL ES %d.%d", &majorVersion, &minorVersion );
+    glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxTextureSize );
+    printf( "  %s: OpenGL%s %d.%d, max texture size %d, extensions 0x%x, compressed formats 0x%llx\n", pContext,
+            pCaps->mIsES ? " ES" : "", pCaps->mMajorVersion, pCaps->mMinorVersion, pCaps->mMaxTextureSize,
+            pCaps->mExtensions, pCaps->mCompressedFormats );
+    if( !pCaps->mIsES || pCaps->mMajorVersion != majorVersion || pCaps->mMinorVersion != minorVersion ||
+        pCaps->mMaxTextureSize != maxTextureSize )
+    {
+        printf( "  %s: %s, max texture size %d\n", pContext, pVersion, maxTextureSize );
+        ++differ;
+    }
+
+    for( extension = 0; extension < sizeof(extensions) / sizeof(extensions[0]); ++extension )
+    {
+        if( HasGlExtensionNamed( extensions[extension] ) != ListsExtension( extensions[extension], majorVersion ) ||
+            HasGlExtension( 1u << extension ) != ListsExtension( extensions[extension], majorVersion ) )
+        {
+            printf( "  %s: %s doesn't match the extension list\n", pContext, extensions[extension] );
+            ++differ;
+        }
+    }
+    if( HasGlExtensionNamed( "GL_EXT_texture_compression" ) || HasGlExtensionNamed( "GL_EXT_texture_storage_" ) )
+    {
+        printf( "  %s: matched part of an extension name\n", pContext );
+        ++differ;
+    }
+
+    // Every format the context lists in the families is supported
+    glGetIntegerv( GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount );
+    pFormats = (GLint*)calloc( formatCount + 1, sizeof(GLint) );
+    glGetIntegerv( GL_COMPRESSED_TEXTURE_FORMATS, pFormats );
+    for( index = 0; index < formatCount; ++index )
+    {
+        for( family = 0; family < sizeof(families) / sizeof(families[0]); ++family )
+        {
+            if( (GLenum)pFormats[index] >= families[family][0] && (GLenum)pFormats[index] <= families[family][1] &&
+                !IsCompressedFormatSupported( pFormats[index] ) )
+            {
+                printf( "  %s: format 0x%x is listed but not supported\n", pContext, pFormats[index] );
+                ++differ;
+            }
+        }
+    }
+    free( pFormats );
+
+    // ETC2 and EAC are core from OpenGL ES 3.0 on
+    if( majorVersion >= 3 && ( !IsETC2Supported() || !IsCompressedFormatSupported( GL_COMPRESSED_RGBA8_ETC2_EAC ) ) )
+    {
+        printf( "  %s: ETC2 isn't supported\n", pContext );
+        ++differ;
+    }
+    if( IsS3TCSupported() != IsCompressedFormatSupported( GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ) ||
+        IsPVRTCSupported() != IsCompressedFormatSupported( GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG ) )
+    {
+        printf( "  %s: IsS3TCSupported or IsPVRTCSupported disagrees with the format bits\n", pContext );
+        ++differ;
+    }
+    return differ;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Asks for the capabilities of the current context twice, and checks GL was queried for them
+// 'expected' times
+static int CheckGlCapsQueries( const char* pContext, int expected )
+{
+    gCountedQuery = GL_MAX_TEXTURE_SIZE;
+    gQueryCount = 0;
+    GetGlCaps();
+    GetGlCaps();
+    if( gQueryCount != expected )
+    {
+        printf( "  %s: queried %d times, not %d\n", pContext, gQueryCount, expected );
+        return 1;
+    }
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks the capabilities of this context, of a second one sharing it, of an OpenGL ES 2.0 one
+// when the config allows it and with no context, and that each is queried once, when it is first
+// current. Loads the PVR texture, which must fail without
+// PVRTC, and the KTX, DDS and PNG ones.
+static int TestGlCaps()
+{
+    static const EGLint es2Attributes[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    EGLContext context = eglGetCurrentContext();
+    EGLContext other;
+    const GlCaps* pCaps;
+    GLuint texture;
+    unsigned int file;
+    int failures = 0;
+    char path[1024];
+
+    // The tests before may have made other contexts current, this one is known once queried
+    GetGlCaps();
+    failures += CheckGlCapsQueries( "this context", 0 );
+    failures += CheckGlCaps( "this context" );
+
+    snprintf( path, sizeof(path), "%s/tex_pvr.pvr", gAssetDirectory );
+    texture = LoadTexturePVRTC( path );
+    if( ( texture != 0 ) != IsPVRTCSupported() )
+    {
+        printf( "  tex_pvr.pvr %s with PVRTC %s\n", texture ? "loaded" : "didn't load",
+                IsPVRTCSupported() ? "supported" : "unsupported" );
+        ++failures;
+    }
+    DeleteTexture( texture );
+    for( file = 0; file < TEXTURE_COUNT; ++file )
+    {
+        texture = gTextures[file].pLoader( TexturePath( &gTextures[file], path, sizeof(path) ), NULL );
+        if( texture == 0 )
+        {
+            printf( "  %s: didn't load\n", gTextures[file].pName );
+            ++failures;
+        }
+        DeleteTexture( texture );
+    }
+
+    // Each context is queried when it is first current
+    other = CreateContext( context );
+    if( other == EGL_NO_CONTEXT || !eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, other ) )
+    {
+        printf( "  Couldn't make a second context current\n" );
+        ++failures;
+    }
+    else
+    {
+        failures += CheckGlCapsQueries( "second context", 1 );
+        failures += CheckGlCaps( "second context" );
+    }
+    eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+    if( other != EGL_NO_CONTEXT )
+    {
+        eglDestroyContext( gDisplay, other );
+    }
+
+    other = eglCreateContext( gDisplay, gConfig, EGL_NO_CONTEXT, es2Attributes );
+    if( other != EGL_NO_CONTEXT && eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, other ) )
+    {
+        failures += CheckGlCapsQueries( "OpenGL ES 2.0 context", 1 );
+        failures += CheckGlCaps( "OpenGL ES 2.0 context" );
+        eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+    }
+    else
+    {
+        printf( "  No OpenGL ES 2.0 context, skipped\n" );
+    }
+    if( other != EGL_NO_CONTEXT )
+    {
+        eglDestroyContext( gDisplay, other );
+    }
+
+    // Without a context nothing is supported
+    failures += CheckGlCapsQueries( "no context", 0 );
+    pCaps = GetGlCaps();
+    if( pCaps->mMajorVersion != 0 || pCaps->mMaxTextureSize != 0 || pCaps->mExtensions != 0 ||
+        pCaps->mCompressedFormats != 0 || IsETCSupported() || IsETC2Supported() || IsS3TCSupported() )
+    {
+        printf( "  Capabilities reported with no context current\n" );
+        ++failures;
+    }
+
+    // Back on this context, whose state the cache no longer knows
+    eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context );
+    ResetGlStateCache();
+    failures += CheckGlCapsQueries( "this context again", 1 );
+    failures += CheckGlCaps( "this context again" );
+    return failures;
+}
+
+static const Test gTests[] =
+{
+    { "upload ring",                TestUploadRing },
+    { "one buffer upload ring",     TestSmallUploadRing },
+    { "ETC1",                       TestETC1 },
+    { "KTX packed smallest first",  TestSmallestFirstKTX },
+    { "loader thread",              TestLoaderThread },
+    { "max dimension",              TestMaxDimension },
+    { "truncated files",            TestTruncatedFiles },
+    { "texture memory reset",       TestTextureMemoryReset },
+    { "lost context",               TestLostContext },
+    { "streamed levels",            TestStreaming },
+    { "residency",                  TestResidency },
+    { "residency budget",           TestResidencyBudget },
+    { "residency retry",            TestResidencyRetry },
+    { "texture cache",              TestTextureCache },
+    { "state cache",                TestStateCache },
+    { "GL capabilities",            TestGlCaps },
+};
+
+#define TEST_COUNT              ( sizeof(gTests) / sizeof(gTests[0]) )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Runs every test in one context
+int main( int argc, char** argv )
+{
+    EGLContext context;
+    unsigned int test;
+    int failures = 0;
+    int i;
+
+    if( getenv( "TMPDIR" ) != NULL )
+    {
+        gTempDirectory = getenv( "TMPDIR" );
+    }
+
+    for( i = 1; i < argc; ++i )
+    {
+        if( strcmp( argv[i], "-a" ) == 0 && i + 1 < argc )
+        {
+            gAssetDirectory = argv[++i];
+        }
+        else if( strcmp( argv[i], "-d" ) == 0 && i + 1 < argc )
+        {
+            gDataDirectory = argv[++i];
+        }
+        else
+        {
+            fprintf( stderr, "usage: %s [-a asset directory] [-d data directory]\n", argv[0] );
+            return 2;
+        }
+    }
+
+    if( !InitDisplay() )
+    {
+        fprintf( stderr, "No EGL display with a GLES3 config\n" );
+        return 2;
+    }
+    context = CreateContext( EGL_NO_CONTEXT );
+    if( context == EGL_NO_CONTEXT || !eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context ) )
+    {
+        fprintf( stderr, "Couldn't make a GLES3 context current\n" );
+        return 2;
+    }
+    if( !InitReadback() )
+    {
+        fprintf( stderr, "Couldn't build the readback program\n" );
+        return 2;
+    }
+    printf( "%s, %s\n", glGetString( GL_RENDERER ), glGetString( GL_VERSION ) );
+
+    // The host asset manager is a directory (see host_android.c), the names are paths
+    SetAssetManager( (AAssetManager*)"." );
+
+    for( test = 0; test < TEST_COUNT; ++test )
+    {
+        int testFailures;
+
+        printf( "%s\n", gTests[test].pName );
+        testFailures = gTests[test].pFunction();
+        printf( "%s: %d failures\n", gTests[test].pName, testFailures );
+        failures += testFailures;
+    }
+
+    ShutdownUploadRing();
+    eglMakeCurrent( gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+    eglDestroyContext( gDisplay, context );
+    eglTerminate( gDisplay );
+    return failures != 0;
+}
@@ -0,0 +1,125 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <android/asset_manager.h>
+#include <android/log.h>
+
+// Host versions of the few NDK functions the native code calls, so it runs in a Linux process:
+// logging goes to stderr, and assets are files under the directory the asset manager names.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Prints warnings and errors, and everything else too when TEXTURELOADER_VERBOSE is set
+int __android_log_print( int priority, const char* pTag, const char* pFormat, ... )
+{
+    static int verbose = -1;
+    va_list arguments;
+    int length;
+
+    if( verbose < 0 )
+    {
+        verbose = getenv( "TEXTURELOADER_VERBOSE" ) != NULL;
+    }
+    if( priority < ANDROID_LOG_WARN && !verbose )
+    {
+        return 0;
+    }
+
+    va_start( arguments, pFormat );
+    fprintf( stderr, "%s: ", pTag );
+    length = vfprintf( stderr, pFormat, arguments );
+    va_end( arguments );
+    return length;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Assets are stdio files. Names are relative to the asset manager's directory, unless absolute.
+struct AAsset
+{
+    FILE* pFile;
+    off_t mLength;
+};
+
+AAsset* AAssetManager_open( AAssetManager* pManager, const char* pFileName, int mode )
+{
+    char path[1024];
+    AAsset* pAsset;
+    FILE* pFile;
+
+    (void)mode;
+    if( pFileName[0] == '/' || pManager == NULL )
+    {
+        snprintf( path, sizeof(path), "%s", pFileName );
+    }
+    else
+    {
+        snprintf( path, sizeof(path), "%s/%s", (const char*)pManager, pFileName );
+    }
+
+    pFile = fopen( path, "rb" );
+    if( pFile == NULL )
+    {
+        return NULL;
+    }
+
+    pAsset = (AAsset*)malloc( sizeof(AAsset) );
+    pAsset->pFile = pFile;
+    fseeko( pFile, 0, SEEK_END );
+    pAsset->mLength = ftello( pFile );
+    fseeko( pFile, 0, SEEK_SET );
+    return pAsset;
+}
+
+int AAsset_read( AAsset* pAsset, void* pBuffer, size_t count )
+{
+    return (int)fread( pBuffer, 1, count, pAsset->pFile );
+}
+
+off_t AAsset_seek( AAsset* pAsset, off_t offset, int whence )
+{
+    if( fseeko( pAsset->pFile, offset, whence ) != 0 )
+    {
+        return -1;
+    }
+    return ftello( pAsset->pFile );
+}
+
+off_t AAsset_getLength( AAsset* pAsset )
+{
+    return pAsset->mLength;
+}
+
+void AAsset_close( AAsset* pAsset )
+{
+    fclose( pAsset->pFile );
+    free( pAsset );
+}
@@ -0,0 +1,51 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+// Host stand-in for the NDK's asset manager, implemented in host_android.c over stdio. The asset
+// manager is the name of the directory the assets are opened from, e.g.
+// SetAssetManager( (AAssetManager*)"../../assets" ).
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
+
+enum
+{
+    AASSET_MODE_UNKNOWN   = 0,
+    AASSET_MODE_RANDOM    = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER    = 3
+};
+
+AAsset* AAssetManager_open( AAssetManager* pManager, const char* pFileName, int mode );
+int AAsset_read( AAsset* pAsset, void* pBuffer, size_t count );
+off_t AAsset_seek( AAsset* pAsset, off_t offset, int whence );
+off_t AAsset_getLength( AAsset* pAsset );
+void AAsset_close( AAsset* pAsset );
@@ -0,0 +1,366 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "pixel_convert.h"
+#include "stb_image.h"
+
+// Times the kernels with the scalar code and with the SIMD variants this machine has, through
+// ForceCpuFeatures (see dispatch.h), and prints the cost per megapixel.
+//
+//     kernel_bench [-d data directory] [more JPEGs]
+//
+// JPEGs are decoded on one thread, so the figures are the CPU cost rather than the worker pool's
+// wall time, in three configurations: all scalar; SIMD IDCT and color conversion with stb_image's
+// own chroma upsampling (as before the fused kernels); and SIMD with chroma upsampling fused into
+// the color conversion. Channel layout conversions of a 2048x1024 image are timed with stb_image's
+// old generic routine (a switch per row), the specialized scalar kernels and the dispatched ones,
+// next to memcpy's rate for the same traffic. Each figure is the fastest of several runs of at
+// least 50 ms.
+
+#define BENCH_RUNS              5
+#define BENCH_RUN_NANOSECONDS   50000000ull
+
+static const char* gDataDirectory = "data";
+
+static const char* const gJpegNames[] =
+{
+    "420_333x217.jpg",
+    "422_517x263_restart.jpg",
+};
+
+#define JPEG_COUNT              ( sizeof(gJpegNames) / sizeof(gJpegNames[0]) )
+
+#define CONVERT_WIDTH           2048
+#define CONVERT_HEIGHT          1024
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns a monotonic time in nanoseconds
+static unsigned long long GetNanoseconds()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads a file into memory, returning NULL if it can't
+static unsigned char* LoadFile( const char* pPath, int* pSize )
+{
+    FILE* pFile = fopen( pPath, "rb" );
+    unsigned char* pData;
+    long size;
+
+    if( pFile == NULL )
+    {
+        return NULL;
+    }
+    fseek( pFile, 0, SEEK_END );
+    size = ftell( pFile );
+    fseek( pFile, 0, SEEK_SET );
+    pData = (unsigned char*)malloc( size );
+    if( fread( pData, 1, size, pFile ) != (size_t)size )
+    {
+        free( pData );
+        pData = NULL;
+    }
+    fclose( pFile );
+    *pSize = (int)size;
+    return pData;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernel configurations of the JPEG decoder
+#define JPEG_SCALAR             0
+#define JPEG_SIMD_UNFUSED       1
+#define JPEG_SIMD_FUSED         2
+
+static void SelectJpegConfiguration( int configuration )
+{
+    ForceCpuFeatures( configuration == JPEG_SCALAR ? 0 : GetCpuFeatures() );
+    if( configuration == JPEG_SIMD_UNFUSED )
+    {
+        stbi_install_upsample_YCbCr_to_RGB( NULL );
+    }
+    stbi_install_parallel_for( NULL );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the milliseconds per megapixel of decoding a JPEG to reqComp channels
+static double TimeJpeg( const unsigned char* pData, int size, int reqComp )
+{
+    double best = 0.0;
+    int run;
+
+    for( run = 0; run < BENCH_RUNS; ++run )
+    {
+        unsigned long long start = GetNanoseconds();
+        unsigned long long elapsed;
+        double pixels = 0.0;
+
+        do
+        {
+            int width, height, comp;
+            stbi_uc* pPixels = stbi_load_from_memory( pData, size, &width, &height, &comp, reqComp );
+
+            if( pPixels == NULL )
+            {
+                return 0.0;
+            }
+            stbi_image_free( pPixels );
+            pixels += (double)width * height;
+            elapsed = GetNanoseconds() - start;
+        } while( elapsed < BENCH_RUN_NANOSECONDS );
+
+        if( run == 0 || elapsed / pixels < best )
+        {
+            best = elapsed / pixels;
+        }
+    }
+    return best;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Prints the decode cost of a JPEG in each configuration
+static void BenchmarkJpeg( const char* pPath )
+{
+    int size = 0;
+    unsigned char* pData = LoadFile( pPath, &size );
+    int width, height, comp;
+    int reqComp;
+
+    if( pData == NULL || !stbi_info_from_memory( pData, size, &width, &height, &comp ) )
+    {
+        fprintf( stderr, "Couldn't read %s\n", pPath );
+        free( pData );
+        return;
+    }
+
+    for( reqComp = 3; reqComp <= 4; ++reqComp )
+    {
+        double times[3];
+        int configuration;
+
+        for( configuration = JPEG_SCALAR; configuration <= JPEG_SIMD_FUSED; ++configuration )
+        {
+            SelectJpegConfiguration( configuration );
+            times[configuration] = TimeJpeg( pData, size, reqComp );
+        }
+        printf( "  %-32s %4dx%-4d %s  %6.2f  %6.2f  %6.2f\n", strrchr( pPath, '/' ) ? strrchr( pPath, '/' ) + 1 : pPath,
+                width, height, reqComp == 3 ? "RGB " : "RGBA", times[JPEG_SCALAR], times[JPEG_SIMD_UNFUSED],
+                times[JPEG_SIMD_FUSED] );
+    }
+    free( pData );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// stb_image's conversion before pixel_convert.c: a switch on the layout pair for every row
+#define COMBO(a,b)  ((a)*8+(b))
+#define CASE(a,b)   case COMBO(a,b): for(i=x-1; i >= 0; --i, src += a, dest += b)
+#define compute_y(r, g, b)  (unsigned char)( ( (r) * 77 + (g) * 150 + 29 * (b) ) >> 8 )
+
+static void ConvertRowsGeneric( unsigned char* good, const unsigned char* data, int img_n, int req_comp, int x, int y )
+{
+    int i, j;
+
+    for (j=0; j < (int) y; ++j) {
+        const unsigned char *src = data + j * x * img_n;
+        unsigned char *dest = good + j * x * req_comp;
+
+        switch (COMBO(img_n, req_comp)) {
+            CASE(1,2) dest[0]=src[0], dest[1]=255; break;
+            CASE(1,3) dest[0]=dest[1]=dest[2]=src[0]; break;
+            CASE(1,4) dest[0]=dest[1]=dest[2]=src[0], dest[3]=255; break;
+            CASE(2,1) dest[0]=src[0]; break;
+            CASE(2,3) dest[0]=dest[1]=dest[2]=src[0]; break;
+            CASE(2,4) dest[0]=dest[1]=dest[2]=src[0], dest[3]=src[1]; break;
+            CASE(3,4) dest[0]=src[0],dest[1]=src[1],dest[2]=src[2],dest[3]=255; break;
+            CASE(3,1) dest[0]=compute_y(src[0],src[1],src[2]); break;
+            CASE(3,2) dest[0]=compute_y(src[0],src[1],src[2]), dest[1] = 255; break;
+            CASE(4,1) dest[0]=compute_y(src[0],src[1],src[2]); break;
+            CASE(4,2) dest[0]=compute_y(src[0],src[1],src[2]), dest[1] = src[3]; break;
+            CASE(4,3) dest[0]=src[0],dest[1]=src[1],dest[2]=src[2]; break;
+        }
+    }
+}
+
+#undef CASE
+#undef COMBO
+#undef compute_y
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Converting ways, 'converter' is used by CONVERT_KERNEL
+#define CONVERT_GENERIC         0
+#define CONVERT_KERNEL          1
+#define CONVERT_COPY            2
+
+// Returns the nanoseconds of converting (or copying) the image once
+static double TimeConvert( int method, PixelConverter converter, unsigned char* pOut, const unsigned char* pIn,
+                           int srcComp, int dstComp )
+{
+    double best = 0.0;
+    int run;
+
+    for( run = 0; run < BENCH_RUNS; ++run )
+    {
+        unsigned long long start = GetNanoseconds();
+        unsigned long long elapsed;
+        int count = 0;
+
+        do
+        {
+            if( method == CONVERT_GENERIC )
+            {
+                ConvertRowsGeneric( pOut, pIn, srcComp, dstComp, CONVERT_WIDTH, CONVERT_HEIGHT );
+            }
+            else if( method == CONVERT_KERNEL )
+            {
+                int y;
+
+                // Row by row, as the decoders call them
+                for( y = 0; y < CONVERT_HEIGHT; ++y )
+                {
+                    converter( pOut + y * CONVERT_WIDTH * dstComp, pIn + y * CONVERT_WIDTH * srcComp, CONVERT_WIDTH );
+                }
+            }
+            else
+            {
+                memcpy( pOut, pIn, (size_t)CONVERT_WIDTH * CONVERT_HEIGHT * ( srcComp > dstComp ? srcComp : dstComp ) );
+            }
+            ++count;
+            elapsed = GetNanoseconds() - start;
+        } while( elapsed < BENCH_RUN_NANOSECONDS );
+
+        if( run == 0 || (double)elapsed / count < best )
+        {
+            best = (double)elapsed / count;
+        }
+    }
+    return best;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Prints the conversion cost of every layout pair
+static void BenchmarkConversions()
+{
+    size_t size = (size_t)CONVERT_WIDTH * CONVERT_HEIGHT * 4;
+    unsigned char* pIn = (unsigned char*)malloc( size );
+    unsigned char* pOut = (unsigned char*)malloc( size );
+    int srcComp, dstComp;
+    size_t i;
+
+    for( i = 0; i < size; ++i )
+    {
+        pIn[i] = (unsigned char)( i * 2654435761u >> 13 );
+    }
+
+    for( srcComp = 1; srcComp <= 4; ++srcComp )
+    {
+        for( dstComp = 1; dstComp <= 4; ++dstComp )
+        {
+            double generic, scalar, dispatched, copy;
+            double bytes = (double)CONVERT_WIDTH * CONVERT_HEIGHT * ( srcComp + dstComp );
+            double copyBytes = 2.0 * CONVERT_WIDTH * CONVERT_HEIGHT * ( srcComp > dstComp ? srcComp : dstComp );
+
+            if( srcComp == dstComp )
+            {
+                continue;
+            }
+
+            ForceCpuFeatures( 0 );
+            generic = TimeConvert( CONVERT_GENERIC, NULL, pOut, pIn, srcComp, dstComp );
+            scalar = TimeConvert( CONVERT_KERNEL, GetPixelConverter( srcComp, dstComp ), pOut, pIn, srcComp, dstComp );
+            ForceCpuFeatures( GetCpuFeatures() );
+            dispatched = TimeConvert( CONVERT_KERNEL, GetPixelConverter( srcComp, dstComp ), pOut, pIn, srcComp, dstComp );
+            copy = TimeConvert( CONVERT_COPY, NULL, pOut, pIn, srcComp, dstComp );
+
+            printf( "  %d->%d  %6.2f  %6.2f  %6.2f ms   %5.1f GB/s, memcpy %5.1f GB/s\n", srcComp, dstComp,
+                    generic / 1e6, scalar / 1e6, dispatched / 1e6, bytes / dispatched, copyBytes / copy );
+        }
+    }
+
+    free( pIn );
+    free( pOut );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Runs the benchmarks
+int main( int argc, char** argv )
+{
+    unsigned int file;
+    int i;
+
+    for( i = 1; i < argc && argv[i][0] == '-'; ++i )
+    {
+        if( strcmp( argv[i], "-d" ) == 0 && i + 1 < argc )
+        {
+            gDataDirectory = argv[++i];
+        }
+        else
+        {
+            fprintf( stderr, "usage: %s [-d data directory] [more JPEGs]\n", argv[0] );
+            return 2;
+        }
+    }
+
+    printf( "CPU features 0x%x\n\n", GetCpuFeatures() );
+    printf( "JPEG decode, ms per megapixel on one thread (scalar, SIMD with stb upsampling, SIMD fused)\n" );
+    for( file = 0; file < JPEG_COUNT; ++file )
+    {
+        char path[1024];
+
+        snprintf( path, sizeof(path), "%s/%s", gDataDirectory, gJpegNames[file] );
+        BenchmarkJpeg( path );
+    }
+    for( ; i < argc; ++i )
+    {
+        BenchmarkJpeg( argv[i] );
+    }
+
+    printf( "\nChannel layout conversion of %dx%d pixels (stb switch, specialized scalar, dispatched)\n",
+            CONVERT_WIDTH, CONVERT_HEIGHT );
+    BenchmarkConversions();
+
+    ForceCpuFeatures( GetCpuFeatures() );
+    return 0;
+}
@@ -0,0 +1,468 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "dispatch.h"
+#include "hdr.h"
+#include "mipmap.h"
+#include "pixel_convert.h"
+#include "pixel_transform.h"
+#include "stb_image.h"
+
+// Runs every kernel table bound by the dispatch (see dispatch.h) with each combination of the CPU
+// features this machine has, through ForceCpuFeatures, and checks the results match the scalar
+// code bit for bit: JPEG decoding (IDCT, color conversion and fused chroma upsampling), channel
+// layout conversion, pixel transforms and packing, mip filters and HDR packing.
+//
+//     kernel_test [-d data directory]
+//
+// The JPEGs come from the data directory, tests/data by default. Returns non-zero if any differ.
+
+#define MAX_CASES               256
+
+// A case writes its results to an Output, first with the scalar code, then with each feature set
+typedef struct
+{
+    unsigned char* pData;
+    size_t mSize;
+    size_t mCapacity;
+} Output;
+
+typedef void (*CaseFunction)( Output* pOutput, int argument );
+
+typedef struct
+{
+    char         mName[64];
+    CaseFunction pFunction;
+    int          mArgument;
+    Output       mReference;
+} TestCase;
+
+static TestCase gCases[MAX_CASES];
+static int gCaseCount = 0;
+static const char* gDataDirectory = "data";
+
+static const char* const gJpegNames[] =
+{
+    "420_1x1.jpg",
+    "420_9x17.jpg",
+    "420_17x5.jpg",
+    "420_333x217.jpg",
+    "420_333x217_restart.jpg",
+    "422_35x9.jpg",
+    "422_517x263_restart.jpg",
+    "440_9x3.jpg",
+    "gray_257x129.jpg",
+};
+
+#define JPEG_COUNT              ( sizeof(gJpegNames) / sizeof(gJpegNames[0]) )
+
+static unsigned char* gJpegData[JPEG_COUNT];
+static int gJpegSizes[JPEG_COUNT];
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Appends bytes to an output
+static void Append( Output* pOutput, const void* pData, size_t size )
+{
+    if( pOutput->mSize + size > pOutput->mCapacity )
+    {
+        pOutput->mCapacity = ( pOutput->mSize + size ) * 2;
+        pOutput->pData = (unsigned char*)realloc( pOutput->pData, pOutput->mCapacity );
+    }
+    memcpy( pOutput->pData + pOutput->mSize, pData, size );
+    pOutput->mSize += size;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Fills a buffer with the same pseudo random bytes on every run
+static void FillRandom( unsigned char* pData, size_t size, unsigned int seed )
+{
+    size_t i;
+
+    for( i = 0; i < size; ++i )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        pData[i] = (unsigned char)( seed >> 24 );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads a file into memory, returning NULL if it can't
+static unsigned char* LoadFile( const char* pPath, int* pSize )
+{
+    FILE* pFile = fopen( pPath, "rb" );
+    unsigned char* pData;
+    long size;
+
+    if( pFile == NULL )
+    {
+        return NULL;
+    }
+    fseek( pFile, 0, SEEK_END );
+    size = ftell( pFile );
+    fseek( pFile, 0, SEEK_SET );
+    pData = (unsigned char*)malloc( size );
+    if( fread( pData, 1, size, pFile ) != (size_t)size )
+    {
+        free( pData );
+        pData = NULL;
+    }
+    fclose( pFile );
+    *pSize = (int)size;
+    return pData;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Channel layout conversion, argument is srcComp * 8 + dstComp. Every length up to 139 pixels,
+// from a misaligned source.
+static void TestConvert( Output* pOutput, int argument )
+{
+    int srcComp = argument >> 3;
+    int dstComp = argument & 7;
+    PixelConverter convert = GetPixelConverter( srcComp, dstComp );
+    unsigned char in[140 * 4 + 1];
+    unsigned char out[140 * 4];
+    int count;
+
+    FillRandom( in, sizeof(in), argument );
+    for( count = 0; count < 140; ++count )
+    {
+        convert( out, in + 1, count );
+        Append( pOutput, out, count * dstComp );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Pixel transforms, argument is comp * 16 + PIXEL_* flags
+static void TestTransform( Output* pOutput, int argument )
+{
+    PixelTransform transform;
+    unsigned char row[68 * 4];
+    int comp = argument >> 4;
+    int width;
+
+    transform.mFlags = argument & 15;
+    for( width = 0; width < 68; ++width )
+    {
+        FillRandom( row, sizeof(row), argument * 100 + width );
+        TransformPixelRow( &transform, row, width, comp );
+        Append( pOutput, row, width * comp );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// 16-bit packing, argument is PIXEL_PACK_* * 4 + PIXEL_DITHER_*
+static void TestPack( Output* pOutput, int argument )
+{
+    int packFormat = argument >> 2;
+    int dither = argument & 3;
+    unsigned char in[68 * 4];
+    unsigned short out[68];
+    int width;
+    int y;
+
+    if( dither == PIXEL_DITHER_DIFFUSION )
+    {
+        unsigned char pixels[37 * 11 * 4];
+
+        FillRandom( pixels, sizeof(pixels), argument );
+        PackPixelsDiffused( packFormat, pixels, 37, 11, 37 * 4 );
+        Append( pOutput, pixels, sizeof(pixels) );
+        return;
+    }
+
+    for( width = 0; width < 68; ++width )
+    {
+        for( y = 0; y < 4; ++y )
+        {
+            FillRandom( in, sizeof(in), argument * 1000 + width * 4 + y );
+            PackPixelRow( packFormat, dither, out, in, width, y );
+            Append( pOutput, out, width * sizeof(out[0]) );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Mip chains, argument is ( MIP_FILTER_* * 4 + MIP_* flags ) * 8 + comp. Odd sizes and a padded
+// stride, so every row has a tail.
+static void TestMip( Output* pOutput, int argument )
+{
+    MipLevel levels[MAX_MIP_LEVELS];
+    int comp = argument & 7;
+    unsigned int flags = ( argument >> 3 ) & 3;
+    int filter = argument >> 5;
+    int width = 75;
+    int height = 43;
+    int levelCount = GetMipLevelCount( width, height );
+    int level;
+
+    for( level = 0; level < levelCount; ++level )
+    {
+        levels[level].mWidth = width;
+        levels[level].mHeight = height;
+        levels[level].mStride = width * comp + 3;
+        levels[level].pPixels = (unsigned char*)calloc( levels[level].mStride, height );
+        width = width > 1 ? width >> 1 : 1;
+        height = height > 1 ? height >> 1 : 1;
+    }
+    FillRandom( levels[0].pPixels, levels[0].mStride * levels[0].mHeight, argument );
+
+    if( !GenerateMipChain( levels, levelCount, comp, filter, flags, 128 ) )
+    {
+        Append( pOutput, "out of memory", 13 );
+    }
+    for( level = 0; level < levelCount; ++level )
+    {
+        for( height = 0; height < levels[level].mHeight; ++height )
+        {
+            Append( pOutput, levels[level].pPixels + height * levels[level].mStride, levels[level].mWidth * comp );
+        }
+        free( levels[level].pPixels );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HDR packing, argument is HDR_PACK_*. Random values over the whole range of both formats, and
+// the special ones.
+static void TestHdr( Output* pOutput, int argument )
+{
+    static const float special[] = { 0.0f, -0.0f, -1.0f, 1.0f, 65504.0f, 65536.0f, 1e30f, 1e-30f, 6.1e-5f, 5.96e-8f };
+    float in[3 * 203];
+    unsigned int out[203];
+    unsigned int seed = 12345;
+    int count;
+    int i;
+
+    for( i = 0; i < 3 * 203; ++i )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        in[i] = ldexpf( (float)( seed >> 8 ) / ( 1 << 24 ), (int)( seed % 48 ) - 32 );
+    }
+    for( i = 0; i < (int)( sizeof(special) / sizeof(special[0]) ); ++i )
+    {
+        in[i] = special[i];
+    }
+    in[i++] = INFINITY;
+    in[i++] = -INFINITY;
+    in[i++] = NAN;
+
+    for( count = 0; count <= 203; count += 29 )
+    {
+        PackHdrPixels( argument, out, in, count );
+        Append( pOutput, out, count * sizeof(out[0]) );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JPEG decoding, argument is the file index * 32 + scale shift * 8 + req_comp
+static void TestJpeg( Output* pOutput, int argument )
+{
+    int file = argument >> 5;
+    int width, height, comp;
+    stbi_uc* pPixels;
+
+    pPixels = stbi_load_from_memory_scaled( gJpegData[file], gJpegSizes[file], &width, &height, &comp,
+                                            argument & 7, ( argument >> 3 ) & 3 );
+    if( pPixels == NULL )
+    {
+        Append( pOutput, "failed", 6 );
+        return;
+    }
+    Append( pOutput, &width, sizeof(width) );
+    Append( pOutput, &height, sizeof(height) );
+    Append( pOutput, pPixels, width * height * ( ( argument & 7 ) ? ( argument & 7 ) : comp ) );
+    stbi_image_free( pPixels );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Adds a case to run, named from a printf format
+static void AddCase( CaseFunction pFunction, int argument, const char* pFormat, ... ) __attribute__(( format( printf, 3, 4 ) ));
+
+static void AddCase( CaseFunction pFunction, int argument, const char* pFormat, ... )
+{
+    TestCase* pCase = &gCases[gCaseCount++];
+    va_list arguments;
+
+    memset( pCase, 0, sizeof(*pCase) );
+    va_start( arguments, pFormat );
+    vsnprintf( pCase->mName, sizeof(pCase->mName), pFormat, arguments );
+    va_end( arguments );
+    pCase->pFunction = pFunction;
+    pCase->mArgument = argument;
+}
+
+static void AddCases()
+{
+    static const char* const filterNames[] = { "box", "lanczos", "kaiser" };
+    int src, dst, comp, flags, format, dither, filter;
+    unsigned int file;
+
+    for( src = 1; src <= 4; ++src )
+    {
+        for( dst = 1; dst <= 4; ++dst )
+        {
+            if( src != dst )
+            {
+                AddCase( TestConvert, src * 8 + dst, "convert %d to %d channels", src, dst );
+            }
+        }
+    }
+    for( comp = 1; comp <= 4; ++comp )
+    {
+        for( flags = 0; flags < 16; flags += PIXEL_SWIZZLE_RB )
+        {
+            AddCase( TestTransform, comp * 16 + flags, "transform %d channels, flags 0x%x", comp, flags );
+        }
+    }
+    for( format = PIXEL_PACK_RGB565; format <= PIXEL_PACK_RGBA5551; ++format )
+    {
+        for( dither = PIXEL_DITHER_NONE; dither <= PIXEL_DITHER_DIFFUSION; ++dither )
+        {
+            AddCase( TestPack, format * 4 + dither, "pack format %d, dither %d", format, dither );
+        }
+    }
+    for( filter = MIP_FILTER_BOX; filter <= MIP_FILTER_KAISER; ++filter )
+    {
+        for( flags = 0; flags <= ( MIP_GAMMA_CORRECT | MIP_PRESERVE_COVERAGE ); ++flags )
+        {
+            for( comp = 1; comp <= 4; ++comp )
+            {
+                AddCase( TestMip, ( filter * 4 + flags ) * 8 + comp, "mip %s, flags %d, %d channels",
+                         filterNames[filter], flags, comp );
+            }
+        }
+    }
+    for( format = HDR_PACK_RGB9E5; format <= HDR_PACK_R11G11B10F; ++format )
+    {
+        AddCase( TestHdr, format, "hdr format %d", format );
+    }
+    for( file = 0; file < JPEG_COUNT; ++file )
+    {
+        for( comp = 0; comp <= 4; ++comp )
+        {
+            AddCase( TestJpeg, file * 32 + comp, "%s, req_comp %d", gJpegNames[file], comp );
+        }
+        AddCase( TestJpeg, file * 32 + 2 * 8 + 4, "%s, 1/4 scale", gJpegNames[file] );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Runs every case with the scalar code, then with each combination of the available features
+int main( int argc, char** argv )
+{
+    unsigned int available;
+    unsigned int features;
+    unsigned int file;
+    int failures = 0;
+    int i;
+
+    for( i = 1; i < argc; ++i )
+    {
+        if( strcmp( argv[i], "-d" ) == 0 && i + 1 < argc )
+        {
+            gDataDirectory = argv[++i];
+        }
+        else
+        {
+            fprintf( stderr, "usage: %s [-d data directory]\n", argv[0] );
+            return 2;
+        }
+    }
+
+    for( file = 0; file < JPEG_COUNT; ++file )
+    {
+        char path[1024];
+
+        snprintf( path, sizeof(path), "%s/%s", gDataDirectory, gJpegNames[file] );
+        gJpegData[file] = LoadFile( path, &gJpegSizes[file] );
+        if( gJpegData[file] == NULL )
+        {
+            fprintf( stderr, "Couldn't read %s\n", path );
+            return 2;
+        }
+    }
+
+    AddCases();
+    available = GetCpuFeatures();
+    printf( "CPU features 0x%x, %d cases\n", available, gCaseCount );
+
+    ForceCpuFeatures( 0 );
+    for( i = 0; i < gCaseCount; ++i )
+    {
+        gCases[i].pFunction( &gCases[i].mReference, gCases[i].mArgument );
+    }
+
+    // Every subset of the available features, including the empty one to check the scalar code
+    // gives the same results twice
+    for( features = 0; features <= available; ++features )
+    {
+        int differ = 0;
+
+        if( ( features & available ) != features )
+        {
+            continue;
+        }
+
+        ForceCpuFeatures( features );
+        for( i = 0; i < gCaseCount; ++i )
+        {
+            Output output;
+
+            memset( &output, 0, sizeof(output) );
+            gCases[i].pFunction( &output, gCases[i].mArgument );
+            if( output.mSize != gCases[i].mReference.mSize ||
+                memcmp( output.pData, gCases[i].mReference.pData, output.mSize ) != 0 )
+            {
+                printf( "  %s differs with features 0x%x\n", gCases[i].mName, features );
+                ++differ;
+            }
+            free( output.pData );
+        }
+        printf( "features 0x%x: %d of %d cases differ from the scalar code\n", features, differ, gCaseCount );
+        failures += differ;
+    }
+
+    ForceCpuFeatures( available );
+    return failures != 0;
+}
@@ -1,521 +1,2065 @@
-/* Copyright (c) <2012>, Intel Corporation
-*
-* Redistribution and use in source and binary forms, with or without 
-* modification, are permitted provided that the following conditions are met:
-*
-* - Redistributions of source code must retain the above copyright notice, 
-*   this list of conditions and the following disclaimer.
-* - Redistributions in binary form must reproduce the above copyright notice, 
-*   this list of conditions and the following disclaimer in the documentation 
-*   and/or other materials provided with the distribution.
-* - Neither the name of Intel Corporation nor the names of its contributors 
-*   may be used to endorse or promote products derived from this software 
-*   without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-* POSSIBILITY OF SUCH DAMAGE.
-*
-*/
-
-#include <assert.h>
-#include <memory.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <android/log.h>
-#include "ktx.h"
-#include "ktxint.h"
-
-#include "file.h"
-#include "texture.h"
-#include "stb_image.h"
-
-// Make sure all compression formats are defined
-#define GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG   0x8C00
-#define GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG   0x8C01
-#define GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG  0x8C02
-#define GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG  0x8C03
-
-#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
-#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
-#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
-#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Debugging helper functions
-#define  Log(...)  __android_log_print( ANDROID_LOG_INFO, "TextureLoader", __VA_ARGS__ )
-#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
-
-static void CheckGlError( const char* pFunctionName ) 
-{
-    GLint error = glGetError();
-    if( error != GL_NO_ERROR ) 
-    {
-        LogError( "%s returned glError 0x%x\n", pFunctionName, error );
-    }
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Check if ETC is supported (by hardware)
-int IsETCSupported()
-{
-    int count = 0;
-    extern int GLEW_OES_compressed_ETC1_RGB8_texture;
-    GLEW_OES_compressed_ETC1_RGB8_texture = 0;
-
-    glGetIntegerv( GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count );
-    if( count > 0 )
-    {
-        GLint* formats = (GLint*)calloc( count, sizeof(GLint) );
-
-        glGetIntegerv( GL_COMPRESSED_TEXTURE_FORMATS, formats );
-
-        int index;
-        for( index = 0; index < count; index++ )
-        {
-            switch( formats[index] )
-            {
-                case GL_ETC1_RGB8_OES:
-                    GLEW_OES_compressed_ETC1_RGB8_texture = 1;
-                    break;
-            }
-        }
-
-        free( formats );
-    }
-    return 1;
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Check if ETC2 is supported (by hardware)
-int IsETC2Supported()
-{
-    // ETC2 is a standard feature in OpenGL ES 3.0 so it's always supported
-
-    return 1;
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Check if PVRTC is supported
-int IsPVRTCSupported()
-{
-    int PVRTCSupported = -1;
-    
-    // Determine if we have support for PVRTC
-    const GLubyte* pExtensions = glGetString( GL_EXTENSIONS );
-    PVRTCSupported = strstr( (char*)pExtensions, "GL_IMG_texture_compression_pvrtc" ) != NULL;
-    
-    return PVRTCSupported;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Check if S3TC is supported
-int IsS3TCSupported()
-{
-    int S3TCSupported = -1;
-    
-    // Determine if we have support for PVRTC
-    const GLubyte* pExtensions = glGetString( GL_EXTENSIONS );
-    S3TCSupported = strstr( (char*)pExtensions, "GL_EXT_texture_compression_s3tc" ) != NULL;
-    
-    return S3TCSupported;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Loads a PNG texture and returns a handle
-//
-// PNG loading code provided as public domain by Sean Barrett (http://nothings.org/)
-GLuint LoadTexturePNG( const char* TextureFileName )
-{   
-    // Load Texture File
-    char* pFileData = NULL;
-    unsigned int fileSize = 0;
-    
-    ReadFile( TextureFileName, &pFileData, &fileSize );
-    
-    int width, height, numComponents;
-    unsigned char* pData = stbi_load_from_memory( (unsigned char*)pFileData, fileSize, &width, &height, &numComponents, 0 );
-
-    // Generate handle
-    GLuint handle;
-    glGenTextures( 1, &handle );
-    
-    // Bind the texture
-    glBindTexture( GL_TEXTURE_2D, handle );
-    
-    // Set filtering mode for 2D textures (using mipmaps with bilinear filtering)
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
-    
-    // Determine the format
-    GLenum format;
-    
-    switch( numComponents )
-    {
-        case 1:
-        {
-            // Gray
-            format = GL_LUMINANCE;
-            break;
-        }
-        case 2: 
-        {
-            // Gray and Alpha
-            format = GL_LUMINANCE_ALPHA;
-            break;
-        }
-        case 3: 
-        {
-            // RGB
-            format = GL_RGB;
-            break;
-        }
-        case 4: 
-        {
-            // RGBA
-            format = GL_RGBA;
-            break;
-        }
-        default: 
-        {
-            // Unknown format
-            assert(0);
-            return 0;
-        }
-    }
-    
-    // Initialize the texture
-    glTexImage2D( GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pData);
-    CheckGlError( "glTexImage2D" );
-    
-    // Generate mipmaps - to have better quality control and decrease load times, this should be done offline
-    glGenerateMipmap( GL_TEXTURE_2D );
-    CheckGlError( "glGenerateMipmap" );
-
-    // clean up
-    free( pFileData );
-    free( pData );
-    
-    // Return handle
-    return handle;  
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Loads a ETC texture and returns a handle
-//
-// KTX file defined at http://www.khronos.org/opengles/sdk/tools/KTX/file_format_spec/
-// This uses the KTX/ETC library provided by the Khronos Group (see libktx for details)
-GLuint LoadTextureETC_KTX( const char* TextureFileName )
-{    
-    // Read/Load Texture File
-    char* pData = NULL;
-    unsigned int fileSize = 0;
-    
-    ReadFile( TextureFileName, &pData, &fileSize );
-    
-    // Generate handle & Load Texture
-    GLuint handle = 0;
-    GLenum target;
-    GLboolean mipmapped;
-        
-    KTX_error_code result = ktxLoadTextureM( pData, fileSize, &handle, &target, NULL, &mipmapped, NULL, NULL, NULL );
-        
-    if( result != KTX_SUCCESS )
-    {
-        LogError( "KTXLib couldn't load texture %s. Error: %d", TextureFileName, result );
-        return 0;
-    }
- 
-    // Bind the texture
-    glBindTexture( target, handle );
-        
-    // Set filtering mode for 2D textures (bilinear filtering)
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-    if( mipmapped )
-    {
-        // Use mipmaps with bilinear filtering
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
-    }
-
-    // clean up
-    free( pData );
-    
-    // Return handle
-    return handle;  
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Loads a PVRTC texture and returns a handle (mipmap support included)
-//
-// Extension defined here: http://www.khronos.org/registry/gles/extensions/IMG/IMG_texture_compression_pvrtc.txt
-// File format defined here: http://www.imgtec.net/powervr/insider/docs/PVR%20File%20Format.Specification.1.0.11.External.pdf
-typedef struct
-{
-    unsigned int       mVersion;            
-    unsigned int       mFlags;          
-    unsigned long long mPixelFormat;        
-    unsigned int       mColourSpace;        
-    unsigned int       mChannelType;        
-    unsigned int       mHeight;         
-    unsigned int       mWidth;          
-    unsigned int       mDepth;          
-    unsigned int       mNumSurfaces;        
-    unsigned int       mNumFaces;       
-    unsigned int       mMipmapCount;     
-    unsigned int       mMetaDataSize;   
-} __attribute__((packed)) PVRHeaderV3;  // Header must be packed because of the 64-bit mPixelFormat (ARM will pad 4 extra bytes to make it aligned)
-
-GLuint LoadTexturePVRTC( const char* TextureFileName )
-{
-    // Load the texture file
-    char* pData = NULL;
-    unsigned int fileSize = 0;
-    
-    ReadFile( TextureFileName, &pData, &fileSize );
-    
-    // Grab the header
-    PVRHeaderV3* pHeader = (PVRHeaderV3*)pData;
-    
-    // Generate handle
-    GLuint handle;
-    glGenTextures( 1, &handle );
-    
-    // Bind the texture
-    glBindTexture( GL_TEXTURE_2D, handle );
-    
-    // Set filtering mode for 2D textures (bilenear filtering)
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-    if( pHeader->mMipmapCount > 1 )
-    {
-        // Use mipmaps with bilinear filtering
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
-    }
-    
-    // Determine the format
-    GLenum format;
-    GLuint bitsPerPixel;
-
-    switch( pHeader->mPixelFormat )
-    {
-        case 0:
-        {
-            // PVRTC 2bpp RGB
-            format = GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG;
-            bitsPerPixel = 2;
-            break;
-        }
-        case 1: 
-        {
-            // PVRTC 2bpp RGBA
-            format = GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG;
-            bitsPerPixel = 2;
-            break;
-        }
-        case 2: 
-        {
-            // PVRTC 4bpp RGB
-            format = GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG;
-            bitsPerPixel = 4;
-            break;
-        }
-        case 3: 
-        {
-            // PVRTC 4bpp RGBA
-            format = GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG;
-            bitsPerPixel = 4;
-            break;
-        }
-        default: 
-        {
-            // Unknown format
-            assert(0);
-            return 0;
-        }
-    } 
-    
-    // Initialize the texture
-    unsigned int offset = sizeof(PVRHeaderV3) + pHeader->mMetaDataSize;
-    unsigned int mipWidth = pHeader->mWidth;
-    unsigned int mipHeight = pHeader->mHeight;
-
-    unsigned int mip = 0;
-    do
-    {
-        // Determine size (width * height * bbp/8)
-        // pixelDataSize must be at least two blocks (4x4 pixels for 4bpp, 8x4 pixels for 2bpp), so min size is 32  
-        unsigned int pixelDataSize = ( mipWidth * mipHeight * bitsPerPixel ) >> 3;
-        pixelDataSize = (pixelDataSize < 32) ? 32 : pixelDataSize;
-
-        // Upload texture data for this mip
-        glCompressedTexImage2D(GL_TEXTURE_2D, mip, format, mipWidth, mipHeight, 0, pixelDataSize, pData + offset);
-        CheckGlError("glCompressedTexImage2D");
-    
-        // Next mips is half the size (divide by 2) with a min of 1
-        mipWidth = mipWidth >> 1;
-        mipWidth = ( mipWidth == 0 ) ? 1 : mipWidth;
-
-        mipHeight = mipHeight >> 1;
-        mipHeight = ( mipHeight == 0 ) ? 1 : mipHeight; 
-
-        // Move to next mip
-        offset += pixelDataSize;
-        mip++;
-    } while(mip < pHeader->mMipmapCount);
-
-    // clean up
-    free( pData );
-  
-    // Return handle
-    return handle;
-}
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Loads a S3TC texture and returns a handle
-//
-// Extension defined here: http://oss.sgi.com/projects/ogl-sample/registry/EXT/texture_compression_s3tc.txt
-// File format defined here: http://msdn.microsoft.com/en-us/library/windows/desktop/bb943982(v=vs.85).aspx
-
-typedef struct 
-{ 
-    unsigned int mSize;
-    unsigned int mFlags;
-    unsigned int mFourCC;
-    unsigned int mRGBBitCount;
-    unsigned int mRedBitMask;
-    unsigned int mGreenBitMask;
-    unsigned int mBlueBitMask;
-    unsigned int mAlphaBitMask;
-} DDSPixelFormat;
-
-typedef struct 
-{
-    char           mFileType[4];
-    unsigned int   mSize;
-    unsigned int   mFlags;
-    unsigned int   mHeight;
-    unsigned int   mWidth;
-    unsigned int   mPitchOrLinearSize;
-    unsigned int   mDepth;
-    unsigned int   mMipMapCount;
-    unsigned int   mReserved1[11];
-    DDSPixelFormat mPixelFormat;
-    unsigned int   mCaps;
-    unsigned int   mCaps2;
-    unsigned int   mCaps3;
-    unsigned int   mCaps4;
-    unsigned int   mReserved2;
-} DDSHeader;
-
-GLuint LoadTextureS3TC( const char* TextureFileName )
-{
-    // Load the texture file
-    char* pData = NULL;
-    unsigned int fileSize = 0;
-    
-    ReadFile( TextureFileName, &pData, &fileSize );
-    
-    // Read the header
-    DDSHeader* pHeader = (DDSHeader*)pData;
-
-    // Generate handle
-    GLuint handle;
-    glGenTextures( 1, &handle );
-    
-    // Bind the texture
-    glBindTexture( GL_TEXTURE_2D, handle );
-    
-    // Set filtering mode for 2D textures (bilinear filtering)
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-    if( pHeader->mMipMapCount > 1 )
-    {
-        // Use mipmaps with bilinear filtering
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
-    }
-    
-    // Determine texture format
-    GLenum format;
-    GLuint blockSize;
-    switch( pHeader->mPixelFormat.mFourCC )
-    {
-        case 0x31545844: 
-        {
-            //FOURCC_DXT1
-            format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-            blockSize = 8;
-            break;
-        }
-        case 0x33545844: 
-        {
-            //FOURCC_DXT3
-            format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-            blockSize = 16;
-            break;
-        }
-        case 0x35545844: 
-        {
-            //FOURCC_DXT5
-            format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-            blockSize = 16;
-            break;
-        }
-        default: 
-        {
-            // Unknown format
-            assert(0);
-            return 0;
-        }
-    }
-   
-    // Initialize the texture
-    unsigned int offset = 0;
-    unsigned int mipWidth = pHeader->mWidth;
-    unsigned int mipHeight = pHeader->mHeight;
-
-    unsigned int mip = 0;
-    do
-    {
-        // Determine size
-        // As defined in extension: size = ceil(<w>/4) * ceil(<h>/4) * blockSize
-        unsigned int pixelDataSize = ((mipWidth + 3) >> 2) * ((mipHeight + 3) >> 2) * blockSize;
-    
-        // Upload texture data for this mip
-        glCompressedTexImage2D( GL_TEXTURE_2D, mip, format, mipWidth, mipHeight, 0, pixelDataSize, (pData + sizeof(DDSHeader)) + offset ); 
-        CheckGlError( "glCompressedTexImage2D" );
-        
-        // Next mips is half the size (divide by 2) with a min of 1
-        mipWidth = mipWidth >> 1;
-        mipWidth = ( mipWidth == 0 ) ? 1 : mipWidth;
-
-        mipHeight = mipHeight >> 1;
-        mipHeight = ( mipHeight == 0 ) ? 1 : mipHeight; 
-
-        // Move to next mip map
-        offset += pixelDataSize;
-        mip++;
-    } while(mip < pHeader->mMipMapCount);
-
-    // clean up
-    free( pData );
-        
-    // Return handle
-    return handle;
-}
-
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <assert.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <android/log.h>
+#include "ktx.h"
+#include "ktxint.h"
+
+#include "block_codec.h"
+#include "file.h"
+#include "gl_caps.h"
+#include "gl_state.h"
+#include "dispatch.h"
+#include "hdr.h"
+#include "mipmap.h"
+#include "pixel_transform.h"
+#include "staging.h"
+#include "texture.h"
+#include "texture_memory.h"
+#include "upload.h"
+#include "upload_scheduler.h"
+#include "stb_image.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Debugging helper functions
+#define  Log(...)  __android_log_print( ANDROID_LOG_INFO, "TextureLoader", __VA_ARGS__ )
+#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
+
+static void CheckGlError( const char* pFunctionName ) 
+{
+    GLint error = glGetError();
+    if( error != GL_NO_ERROR ) 
+    {
+        LogError( "%s returned glError 0x%x\n", pFunctionName, error );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// libktx reads each mip level straight into a region of the upload ring (see upload.h)
+static __thread UploadRegion gKtxUploadRegion;
+
+static void* BeginKTXUpload( size_t size )
+{
+    return BeginUpload( size, 0, &gKtxUploadRegion ) ? gKtxUploadRegion.pData : NULL;
+}
+
+static int EndKTXUpload( const void** ppStart )
+{
+    // The levels are uploaded from offset 0 of the bound buffer
+    *ppStart = NULL;
+    if( !EndUpload( &gKtxUploadRegion ) )
+    {
+        CancelUpload( &gKtxUploadRegion );
+        return 0;
+    }
+    return 1;
+}
+
+static void FinishKTXUpload()
+{
+    FinishUpload( &gKtxUploadRegion );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// libktx learns the version and extensions of the context from its capabilities (see gl_caps.h)
+static void GetKTXContextVersion( GLboolean* pIsES, GLint* pMajor, GLint* pMinor )
+{
+    const GlCaps* pCaps = GetGlCaps();
+
+    *pIsES = pCaps->mIsES ? GL_TRUE : GL_FALSE;
+    *pMajor = pCaps->mMajorVersion;
+    *pMinor = pCaps->mMinorVersion;
+}
+
+static GLboolean HasKTXContextExtension( const char* pName )
+{
+    return HasGlExtensionNamed( pName ) ? GL_TRUE : GL_FALSE;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Makes stb_image's JPEG planes and libktx's level buffer come from the staging pool, like the
+// file contents and decoded pixels, so back to back loads reuse the same memory. libktx levels
+// go through the upload ring when it can be mapped, its state changes through the GL state cache
+// like ours, and it asks the capabilities of the context what it supports.
+static pthread_once_t gStagingAllocatorsOnce = PTHREAD_ONCE_INIT;
+
+static void InstallStagingAllocators()
+{
+    stbi_install_scratch( AcquireStagingBuffer, ReleaseStagingBuffer );
+    ktxSetImageAllocator( AcquireStagingBuffer, ReleaseStagingBuffer );
+    ktxSetUploadFunctions( BeginKTXUpload, EndKTXUpload, FinishKTXUpload );
+    ktxSetStateFunctions( CachedGenTextures, CachedDeleteTextures, CachedBindTexture, CachedPixelStorei, GetCachedPixelStore );
+    ktxSetCapabilityFunctions( GetKTXContextVersion, HasKTXContextExtension );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Records a loaded texture in the memory accounting (see texture_memory.h). Its transient CPU cost
+// is what the loading thread held in staging buffers at its peak, plus the pixel unpack buffer the
+// pixels went through, if any.
+static void RegisterLoadedTexture( const char* pName, GLuint handle, GLenum internalFormat, GLenum type, int width,
+                                   int height, int levelCount, int layerCount, unsigned int sourceBytes,
+                                   size_t pixelBufferBytes )
+{
+    TextureMemoryInfo info;
+
+    memset( &info, 0, sizeof(info) );
+    info.mHandle = handle;
+    info.mInternalFormat = internalFormat;
+    info.mType = type;
+    info.mWidth = width;
+    info.mHeight = height;
+    info.mLevelCount = levelCount;
+    info.mLayerCount = layerCount;
+    info.mCpuPeakBytes = GetThreadStagingPeak() + pixelBufferBytes;
+    info.mSourceBytes = sourceBytes;
+    strncpy( info.mName, pName, sizeof(info.mName) - 1 );
+
+    RegisterTexture( &info );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Check if ETC is supported (by hardware)
+//
+// ETC1 data is valid ETC2 RGB8 data, so OpenGL ES 3.0 decodes it even without the ETC1 extension
+int IsETCSupported()
+{
+    return IsCompressedFormatSupported( GL_ETC1_RGB8_OES ) || IsCompressedFormatSupported( GL_COMPRESSED_RGB8_ETC2 );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Check if ETC2 is supported (by hardware)
+int IsETC2Supported()
+{
+    // ETC2 is a standard feature in OpenGL ES 3.0, GetGlCaps marks it supported from there on
+
+    return IsCompressedFormatSupported( GL_COMPRESSED_RGB8_ETC2 );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Check if PVRTC is supported
+int IsPVRTCSupported()
+{
+    return IsCompressedFormatSupported( GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Check if S3TC is supported
+int IsS3TCSupported()
+{
+    return IsCompressedFormatSupported( GL_COMPRESSED_RGBA_S3TC_DXT1_EXT );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a PNG texture and returns a handle
+//
+// PNG loading code provided as public domain by Sean Barrett (http://nothings.org/)
+GLuint LoadTexturePNG( const char* TextureFileName )
+{
+    return LoadTexturePNGEx( TextureFileName, NULL );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the power of two JPEG downscale (0-3) that fits width x height within maxDimension
+static int GetJpegScaleShift( int width, int height, unsigned int maxDimension )
+{
+    int largest = width > height ? width : height;
+    int shift = 0;
+
+    if( maxDimension == 0 )
+    {
+        return 0;
+    }
+    while( shift < 3 && (unsigned int)( ( largest + ( 1 << shift ) - 1 ) >> shift ) > maxDimension )
+    {
+        ++shift;
+    }
+    return shift;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Resolution cap applied to every load on top of its TextureOptions, for low memory devices
+static unsigned int gMaxDimension = 0;
+static unsigned int gSkipMipLevels = 0;
+
+void SetTextureResolutionCap( unsigned int maxDimension, unsigned int skipMipLevels )
+{
+    gMaxDimension = maxDimension;
+    gSkipMipLevels = skipMipLevels;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the largest width/height wanted by the options, the global cap or the GPU, whichever is
+// smallest, or 0 when none limits it
+static unsigned int GetMaxDimension( const TextureOptions* pOptions )
+{
+    unsigned int maxDimension = gMaxDimension;
+    unsigned int maxTextureSize = (unsigned int)GetGlCaps()->mMaxTextureSize;
+
+    if( pOptions != NULL && pOptions->mMaxDimension != 0 && ( maxDimension == 0 || pOptions->mMaxDimension < maxDimension ) )
+    {
+        maxDimension = pOptions->mMaxDimension;
+    }
+    if( maxTextureSize != 0 && ( maxDimension == 0 || maxTextureSize < maxDimension ) )
+    {
+        maxDimension = maxTextureSize;
+    }
+    return maxDimension;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns how many levels at the top of a width x height file with levelCount mip levels to leave
+// out: at least the number asked for, and enough for the first level loaded to fit the max
+// dimension. The smallest level is always loaded.
+static unsigned int GetSkippedMipLevels( const TextureOptions* pOptions, unsigned int width, unsigned int height,
+                                         unsigned int levelCount )
+{
+    unsigned int maxDimension = GetMaxDimension( pOptions );
+    unsigned int largest = width > height ? width : height;
+    unsigned int skip = gSkipMipLevels;
+
+    if( pOptions != NULL && pOptions->mSkipMipLevels > skip )
+    {
+        skip = pOptions->mSkipMipLevels;
+    }
+    while( maxDimension != 0 && skip < 31 && ( largest >> skip ) > maxDimension )
+    {
+        ++skip;
+    }
+    return levelCount == 0 ? 0 : skip < levelCount ? skip : levelCount - 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the size of a texture dimension at the given mip level
+static unsigned int GetMipDimension( unsigned int size, unsigned int level )
+{
+    size >>= level;
+    return size > 0 ? size : 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocates immutable storage for all levels of the bound 2D texture
+//
+// The driver allocates and validates the whole chain once instead of on every glTexImage2D, and
+// knows the texture is complete before the first draw. Returns 0 when the driver refuses the format
+// (e.g. an extension format it only accepts through glTexImage2D) or has no glTexStorage2D, the
+// caller falls back then.
+static int AllocateTextureStorage( GLenum internalFormat, int levelCount, int width, int height )
+{
+    if( !GetGlCaps()->mTextureStorage )
+    {
+        return 0;
+    }
+
+    while( glGetError() != GL_NO_ERROR )
+    {
+        // Drop errors left behind by earlier calls
+    }
+
+    glTexStorage2D( GL_TEXTURE_2D, levelCount, internalFormat, width, height );
+    return glGetError() == GL_NO_ERROR;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the format a texture of compressed 'format' data is created with
+//
+// OES_compressed_ETC1_RGB8_texture forbids glCompressedTexSubImage2D, which immutable storage and
+// banded uploads fill levels with. ETC1 data is valid ETC2 RGB8 data, so where ETC2 is supported
+// ETC1 textures are made ETC2 ones. libktx does the same for the levels it uploads.
+static GLenum GetCompressedTextureFormat( GLenum format )
+{
+    return format == GL_ETC1_RGB8_OES && IsETC2Supported() ? GL_COMPRESSED_RGB8_ETC2 : format;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads one level of a compressed 2D texture, into its immutable storage when it has one
+static void UploadCompressedLevel( int storage, int level, GLenum format, int width, int height, GLsizei size,
+                                   const GLvoid* pData )
+{
+    if( storage )
+    {
+        glCompressedTexSubImage2D( GL_TEXTURE_2D, level, 0, 0, width, height, format, size, pData );
+        CheckGlError( "glCompressedTexSubImage2D" );
+    }
+    else
+    {
+        glCompressedTexImage2D( GL_TEXTURE_2D, level, format, width, height, 0, size, pData );
+        CheckGlError( "glCompressedTexImage2D" );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// How a PNG/JPEG is decoded and what happens to its rows on the way
+typedef struct
+{
+    int mScaleShift;            // JPEG downscale (0-3)
+    int mComponents;            // Channels to decode
+    int mIsJpeg;
+    PixelTransform mTransform;
+    int mPackFormat;            // PIXEL_PACK_*, rows are decoded as RGBA and packed in place
+    int mDither;                // PIXEL_DITHER_*
+    int mLevelCount;            // Mip levels built on the CPU, 1 when glGenerateMipmap makes them
+    int mMipFilter;             // MIP_FILTER_*
+    unsigned int mMipFlags;     // MIP_* flags
+    int mAlphaReference;        // Alpha test threshold for MIP_PRESERVE_COVERAGE
+    unsigned char* pFirstRow;   // Where image row 0 goes and the signed step between rows, set while decoding
+    int mRowStride;
+} DecodeSettings;
+
+// Returns non-zero if the decode reads back what it wrote (PNG unfiltering, row transforms,
+// packing, mip filtering), which a write-only buffer mapping doesn't allow
+static int DecodeReadsOutput( const DecodeSettings* pSettings )
+{
+    return !pSettings->mIsJpeg || ( pSettings->mTransform.mFlags & ~PIXEL_FLIP_Y ) || pSettings->mPackFormat != PIXEL_PACK_NONE ||
+           pSettings->mLevelCount > 1;
+}
+
+// Returns non-zero if rows are packed by the decoder as they come out. Mip levels are filtered
+// from the full precision pixels, so with a CPU built chain every level is packed afterwards.
+static int PacksWhileDecoding( const DecodeSettings* pSettings )
+{
+    return pSettings->mPackFormat != PIXEL_PACK_NONE && pSettings->mDither != PIXEL_DITHER_DIFFUSION && pSettings->mLevelCount == 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Per row work, run by stb_image from inside its output loop (possibly on several threads)
+static void ProcessDecodedRow( void* pUser, unsigned char* pRow, int width, int comp )
+{
+    DecodeSettings* pSettings = (DecodeSettings*)pUser;
+
+    if( pSettings->mTransform.mFlags & ~PIXEL_FLIP_Y )
+    {
+        TransformPixelRow( &pSettings->mTransform, pRow, width, comp );
+    }
+    if( PacksWhileDecoding( pSettings ) )
+    {
+        int y = (int)( ( pRow - pSettings->pFirstRow ) / pSettings->mRowStride );
+        PackPixelRow( pSettings->mPackFormat, pSettings->mDither, (unsigned short*)pRow, pRow, width, y );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes an image into height rows of 'stride' bytes at pDest
+//
+// The pixel transform and packing run on each row from inside the decoder's output loop, and a
+// vertical flip just makes the decoder store the rows bottom-up, so the pixels are only written
+// once. Error diffusion needs the rows in order and is the only separate pass.
+static int DecodeImageInto( const unsigned char* pFileData, unsigned int fileSize, int width, int height,
+                            DecodeSettings* pSettings, unsigned char* pDest, int stride )
+{
+    int x, y, comp;
+    int rowStride = stride;
+    unsigned char* pFirstRow = pDest;
+    stbi_row_func pRowFunc = NULL;
+
+    if( pSettings->mTransform.mFlags & PIXEL_FLIP_Y )
+    {
+        pFirstRow += stride * ( height - 1 );
+        rowStride = -stride;
+    }
+    if( ( pSettings->mTransform.mFlags & ~PIXEL_FLIP_Y ) || PacksWhileDecoding( pSettings ) )
+    {
+        pRowFunc = ProcessDecodedRow;
+    }
+    pSettings->pFirstRow = pFirstRow;
+    pSettings->mRowStride = rowStride;
+
+    if( !stbi_load_from_memory_into( pFileData, fileSize, &x, &y, &comp, pSettings->mComponents, pSettings->mScaleShift,
+                                     pFirstRow, rowStride, pRowFunc, pSettings ) )
+    {
+        return 0;
+    }
+
+    if( pSettings->mPackFormat != PIXEL_PACK_NONE && pSettings->mDither == PIXEL_DITHER_DIFFUSION && pSettings->mLevelCount == 1 )
+    {
+        return PackPixelsDiffused( pSettings->mPackFormat, pFirstRow, width, height, rowStride );
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Packs a decoded level in place, with the dither pattern following image rows
+static int PackLevel( const DecodeSettings* pSettings, const MipLevel* pLevel )
+{
+    unsigned char* pFirstRow = pLevel->pPixels;
+    int rowStride = pLevel->mStride;
+    int y;
+
+    if( pSettings->mTransform.mFlags & PIXEL_FLIP_Y )
+    {
+        pFirstRow += rowStride * ( pLevel->mHeight - 1 );
+        rowStride = -rowStride;
+    }
+    if( pSettings->mDither == PIXEL_DITHER_DIFFUSION )
+    {
+        return PackPixelsDiffused( pSettings->mPackFormat, pFirstRow, pLevel->mWidth, pLevel->mHeight, rowStride );
+    }
+    for( y = 0; y < pLevel->mHeight; ++y )
+    {
+        unsigned char* pRow = pFirstRow + y * rowStride;
+        PackPixelRow( pSettings->mPackFormat, pSettings->mDither, (unsigned short*)pRow, pRow, pLevel->mWidth, y );
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sets the size and stride of each mip level, with rows padded to the default GL_UNPACK_ALIGNMENT
+// of 4, and returns the bytes needed to hold them one after the other
+static int LayoutLevels( MipLevel* pLevels, int levelCount, int width, int height, int comp )
+{
+    int size = 0;
+    int level;
+
+    for( level = 0; level < levelCount; ++level )
+    {
+        pLevels[level].pPixels = NULL;
+        pLevels[level].mWidth = width;
+        pLevels[level].mHeight = height;
+        pLevels[level].mStride = ( width * comp + 3 ) & ~3;
+        size += pLevels[level].mStride * height;
+
+        width = width > 1 ? width >> 1 : 1;
+        height = height > 1 ? height >> 1 : 1;
+    }
+    return size;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes an image into level 0 of a chain laid out from pBase, then builds and packs the
+// remaining levels on the CPU
+static int DecodeImageLevels( const unsigned char* pFileData, unsigned int fileSize, DecodeSettings* pSettings,
+                              MipLevel* pLevels, unsigned char* pBase )
+{
+    int level;
+
+    for( level = 0; level < pSettings->mLevelCount; ++level )
+    {
+        pLevels[level].pPixels = pBase;
+        pBase += pLevels[level].mStride * pLevels[level].mHeight;
+    }
+
+    if( !DecodeImageInto( pFileData, fileSize, pLevels[0].mWidth, pLevels[0].mHeight, pSettings, pLevels[0].pPixels, pLevels[0].mStride ) )
+    {
+        return 0;
+    }
+    if( pSettings->mLevelCount == 1 )
+    {
+        return 1;
+    }
+
+    if( !GenerateMipChain( pLevels, pSettings->mLevelCount, pSettings->mComponents, pSettings->mMipFilter,
+                           pSettings->mMipFlags, pSettings->mAlphaReference ) )
+    {
+        return 0;
+    }
+    if( pSettings->mPackFormat != PIXEL_PACK_NONE )
+    {
+        for( level = 0; level < pSettings->mLevelCount; ++level )
+        {
+            if( !PackLevel( pSettings, &pLevels[level] ) )
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes an image (and its CPU built mip levels) into a region of the upload ring
+//
+// The decoder writes the final pixels straight into the mapped buffer, so glTexImage2D can source
+// them from the buffer object instead of the driver copying a client side array. Returns 0 on
+// failure, with nothing left bound; otherwise the region's buffer is bound until FinishUpload.
+static int DecodeToUploadRegion( const unsigned char* pFileData, unsigned int fileSize, DecodeSettings* pSettings,
+                                 MipLevel* pLevels, int size, UploadRegion* pRegion )
+{
+    int decoded;
+
+    if( !BeginUpload( size, DecodeReadsOutput( pSettings ), pRegion ) )
+    {
+        return 0;
+    }
+
+    decoded = DecodeImageLevels( pFileData, fileSize, pSettings, pLevels, (unsigned char*)pRegion->pData );
+
+    // A lost mapping means the contents are undefined
+    if( !EndUpload( pRegion ) || !decoded )
+    {
+        CancelUpload( pRegion );
+        return 0;
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Appends a level to a scheduled upload
+static void AddScheduledLevel( ScheduledUpload* pUpload, int width, int height, unsigned int offset, unsigned int stride,
+                               unsigned int size )
+{
+    ScheduledLevel* pLevel = &pUpload->mLevels[pUpload->mLevelCount++];
+
+    pLevel->mWidth = width;
+    pLevel->mHeight = height;
+    pLevel->mOffset = offset;
+    pLevel->mStride = stride;
+    pLevel->mSize = size;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Hands a decoded mip chain (laid out one level after the other from pData) to the upload
+// scheduler, which uploads it to the texture's immutable storage over the next frames
+static void ScheduleDecodedLevels( GLuint handle, GLenum format, GLenum type, int pixelBytes, const MipLevel* pLevels,
+                                   int levelCount, unsigned char* pData )
+{
+    ScheduledUpload upload;
+    int level;
+
+    memset( &upload, 0, sizeof(upload) );
+    upload.mTexture = handle;
+    upload.mFormat = format;
+    upload.mType = type;
+    upload.mPixelBytes = pixelBytes;
+    upload.mBandRows = 1;
+    for( level = 0; level < levelCount; ++level )
+    {
+        AddScheduledLevel( &upload, pLevels[level].mWidth, pLevels[level].mHeight,
+                           (unsigned int)( pLevels[level].pPixels - pData ), pLevels[level].mStride,
+                           pLevels[level].mStride * pLevels[level].mHeight );
+    }
+
+    ScheduleTextureUpload( &upload, pData );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Creates a texture with immutable storage for the levels of a streamed upload, their offsets in
+// the file filled in, and hands it and the file to the upload scheduler. Returns 0 without touching
+// the file if there is no immutable storage for the format, the caller then loads it as usual.
+static GLuint StreamTextureLevels( const char* TextureFileName, AAsset* pFile, ScheduledUpload* pUpload,
+                                   unsigned int sourceBytes )
+{
+    GLuint handle;
+
+    CachedGenTextures( 1, &handle );
+    CachedBindTexture( GL_TEXTURE_2D, handle );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
+    if( !AllocateTextureStorage( pUpload->mFormat, pUpload->mLevelCount, pUpload->mLevels[0].mWidth,
+                                 pUpload->mLevels[0].mHeight ) )
+    {
+        CachedDeleteTextures( 1, &handle );
+        return 0;
+    }
+
+    pUpload->mTexture = handle;
+    pUpload->pFile = pFile;
+    ScheduleTextureUpload( pUpload, NULL );
+
+    RegisterLoadedTexture( TextureFileName, handle, pUpload->mFormat, 0, pUpload->mLevels[0].mWidth,
+                           pUpload->mLevels[0].mHeight, pUpload->mLevelCount, 1, sourceBytes, 0 );
+    return handle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a PNG texture and returns a handle, applying the given loading hints (may be NULL)
+GLuint LoadTexturePNGEx( const char* TextureFileName, const TextureOptions* pOptions )
+{   
+    // Load Texture File
+    char* pFileData = NULL;
+    unsigned int fileSize = 0;
+    
+    ResetThreadStagingPeak();
+    ReadFile( TextureFileName, &pFileData, &fileSize );
+    
+    // Bind the SIMD IDCT/color conversion for JPEG sourced textures and the specialized channel
+    // layout conversions before stb_image runs (a no-op once JNI_OnLoad has done it)
+    InitKernelDispatch();
+    pthread_once( &gStagingAllocatorsOnce, InstallStagingAllocators );
+
+    int width, height, numComponents;
+    int size, level, offset;
+    int firstLevel = 0;
+    unsigned int largest;
+    unsigned char* pData = NULL;
+    MipLevel levels[MAX_MIP_LEVELS];
+    UploadRegion region;
+    int staged;
+    int defer = pOptions != NULL && pOptions->mDeferUpload;
+    int scheduled = 0;
+    DecodeSettings settings;
+
+    if( !stbi_info_from_memory( (unsigned char*)pFileData, fileSize, &width, &height, &numComponents ) )
+    {
+        LogError( "%s: unknown image format\n", TextureFileName );
+        ReleaseStagingBuffer( pFileData );
+        return 0;
+    }
+
+    memset( &settings, 0, sizeof(settings) );
+    settings.mIsJpeg = fileSize > 2 && (unsigned char)pFileData[0] == 0xFF && (unsigned char)pFileData[1] == 0xD8;
+    settings.mComponents = numComponents;
+    if( pOptions != NULL )
+    {
+        settings.mTransform.mFlags = pOptions->mPixelTransform;
+        settings.mPackFormat = pOptions->mPackedFormat;
+        settings.mDither = pOptions->mDither;
+        settings.mMipFilter = pOptions->mMipFilter;
+        settings.mMipFlags = pOptions->mMipFlags;
+        settings.mAlphaReference = pOptions->mAlphaReference;
+    }
+    if( settings.mAlphaReference == 0 )
+    {
+        settings.mAlphaReference = 128;
+    }
+
+    // With a size limit, JPEGs are scaled down while decoding (in the DCT domain) instead of
+    // decoding the full image
+    if( settings.mIsJpeg && GetMaxDimension( pOptions ) != 0 )
+    {
+        settings.mScaleShift = GetJpegScaleShift( width, height, GetMaxDimension( pOptions ) );
+        width  = ( width  + ( 1 << settings.mScaleShift ) - 1 ) >> settings.mScaleShift;
+        height = ( height + ( 1 << settings.mScaleShift ) - 1 ) >> settings.mScaleShift;
+    }
+
+    // Other formats, and JPEGs still too large at 1/8, are decoded whole and uploaded from the first
+    // level of their CPU built chain that fits
+    largest = (unsigned int)( width > height ? width : height );
+    while( GetMaxDimension( pOptions ) != 0 && ( largest >> firstLevel ) > GetMaxDimension( pOptions ) )
+    {
+        ++firstLevel;
+    }
+    if( firstLevel > 0 && settings.mMipFilter == MIP_FILTER_DRIVER )
+    {
+        settings.mMipFilter = MIP_FILTER_BOX;
+    }
+
+    // Packed formats are decoded as RGBA and packed over the front of each row
+    if( settings.mPackFormat != PIXEL_PACK_NONE )
+    {
+        settings.mComponents = 4;
+    }
+
+    // A deferred texture is shown from its small levels while the large ones stream in, glGenerateMipmap
+    // would need level 0 first
+    if( defer && settings.mMipFilter == MIP_FILTER_DRIVER )
+    {
+        settings.mMipFilter = MIP_FILTER_BOX;
+    }
+
+    // The whole mip chain is built on the CPU and uploaded level by level, unless the driver is asked to
+    settings.mLevelCount = settings.mMipFilter == MIP_FILTER_DRIVER ? 1 : GetMipLevelCount( width, height );
+    if( settings.mLevelCount > MAX_MIP_LEVELS )
+    {
+        settings.mLevelCount = 1;
+    }
+    if( firstLevel >= settings.mLevelCount )
+    {
+        firstLevel = 0;
+    }
+    size = LayoutLevels( levels, settings.mLevelCount, width, height, settings.mComponents );
+
+    // Deferred levels stay in client memory until the scheduler uploads them, as do chains whose
+    // top levels are left out, which would only take up ring space
+    memset( &region, 0, sizeof(region) );
+    staged = !defer && firstLevel == 0 &&
+             DecodeToUploadRegion( (unsigned char*)pFileData, fileSize, &settings, levels, size, &region );
+
+    // Fall back to decoding into client memory
+    if( !staged )
+    {
+        pData = (unsigned char*)AcquireStagingBuffer( size );
+        if( pData == NULL || !DecodeImageLevels( (unsigned char*)pFileData, fileSize, &settings, levels, pData ) )
+        {
+            LogError( "%s: failed to decode\n", TextureFileName );
+            ReleaseStagingBuffer( pData );
+            ReleaseStagingBuffer( pFileData );
+            return 0;
+        }
+    }
+
+    // Generate handle
+    GLuint handle;
+    CachedGenTextures( 1, &handle );
+    
+    // Bind the texture
+    CachedBindTexture( GL_TEXTURE_2D, handle );
+    
+    // Set filtering mode for 2D textures (using mipmaps with bilinear filtering)
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
+    
+    // Determine the format
+    GLenum format;
+    GLenum sizedFormat;
+    GLenum type = GL_UNSIGNED_BYTE;
+    int storage;
+    
+    switch( settings.mPackFormat )
+    {
+        case PIXEL_PACK_RGB565:
+        {
+            format = GL_RGB;
+            sizedFormat = GL_RGB565;
+            type = GL_UNSIGNED_SHORT_5_6_5;
+            break;
+        }
+        case PIXEL_PACK_RGBA4444:
+        {
+            format = GL_RGBA;
+            sizedFormat = GL_RGBA4;
+            type = GL_UNSIGNED_SHORT_4_4_4_4;
+            break;
+        }
+        case PIXEL_PACK_RGBA5551:
+        {
+            format = GL_RGBA;
+            sizedFormat = GL_RGB5_A1;
+            type = GL_UNSIGNED_SHORT_5_5_5_1;
+            break;
+        }
+        default:
+        {
+            switch( numComponents )
+            {
+                case 1:
+                {
+                    // Gray
+                    format = GL_LUMINANCE;
+                    sizedFormat = GL_R8;
+                    break;
+                }
+                case 2: 
+                {
+                    // Gray and Alpha
+                    format = GL_LUMINANCE_ALPHA;
+                    sizedFormat = GL_RG8;
+                    break;
+                }
+                case 3: 
+                {
+                    // RGB
+                    format = GL_RGB;
+                    sizedFormat = GL_RGB8;
+                    break;
+                }
+                case 4: 
+                {
+                    // RGBA
+                    format = GL_RGBA;
+                    sizedFormat = GL_RGBA8;
+                    break;
+                }
+                default: 
+                {
+                    // Unknown format
+                    assert(0);
+                    return 0;
+                }
+            }
+        }
+    }
+
+    // The texture starts at the first level uploaded
+    width = levels[firstLevel].mWidth;
+    height = levels[firstLevel].mHeight;
+
+    // Allocate the whole chain, glGenerateMipmap fills the levels that are not built on the CPU
+    storage = AllocateTextureStorage( sizedFormat, GetMipLevelCount( width, height ), width, height );
+    if( storage && ( format == GL_LUMINANCE || format == GL_LUMINANCE_ALPHA ) )
+    {
+        // Luminance has no sized format: gray lives in red, alpha in green, and is swizzled back
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_RED );
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED );
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED );
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, format == GL_LUMINANCE ? GL_ONE : GL_GREEN );
+        format = format == GL_LUMINANCE ? GL_RED : GL_RG;
+    }
+
+    if( defer && storage && pData != NULL )
+    {
+        // The scheduler owns the pixels from here on
+        ScheduleDecodedLevels( handle, format, type, type != GL_UNSIGNED_BYTE ? 2 : settings.mComponents,
+                               levels + firstLevel, settings.mLevelCount - firstLevel, pData );
+        pData = NULL;
+        scheduled = 1;
+    }
+
+    // Initialize each level, from its offset into the pixel buffer when one is bound
+    offset = 0;
+    for( level = 0; level < firstLevel; ++level )
+    {
+        offset += levels[level].mStride * levels[level].mHeight;
+    }
+    for( level = firstLevel; level < settings.mLevelCount && !scheduled; ++level )
+    {
+        const MipLevel* pLevel = &levels[level];
+
+        // Packed rows keep the stride of the RGBA rows they were packed from
+        if( type != GL_UNSIGNED_BYTE )
+        {
+            CachedPixelStorei( GL_UNPACK_ROW_LENGTH, pLevel->mStride / 2 );
+        }
+
+        if( storage )
+        {
+            glTexSubImage2D( GL_TEXTURE_2D, level - firstLevel, 0, 0, pLevel->mWidth, pLevel->mHeight, format, type,
+                             staged ? (const GLvoid*)(intptr_t)offset : pData + offset );
+            CheckGlError( "glTexSubImage2D" );
+        }
+        else
+        {
+            glTexImage2D( GL_TEXTURE_2D, level - firstLevel, format, pLevel->mWidth, pLevel->mHeight, 0, format, type,
+                          staged ? (const GLvoid*)(intptr_t)offset : pData + offset );
+            CheckGlError( "glTexImage2D" );
+        }
+        offset += pLevel->mStride * pLevel->mHeight;
+    }
+
+    if( type != GL_UNSIGNED_BYTE )
+    {
+        CachedPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+    }
+    FinishUpload( &region );
+    
+    // Generate mipmaps - to have better quality control and decrease load times, this should be done offline
+    if( settings.mLevelCount == 1 )
+    {
+        glGenerateMipmap( GL_TEXTURE_2D );
+        CheckGlError( "glGenerateMipmap" );
+    }
+
+    RegisterLoadedTexture( TextureFileName, handle, storage ? sizedFormat : format, type, width, height,
+                           GetMipLevelCount( width, height ), 1, fileSize, staged ? size : 0 );
+
+    // clean up
+    ReleaseStagingBuffer( pFileData );
+    ReleaseStagingBuffer( pData );
+    
+    // Return handle
+    return handle;  
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a Radiance (.hdr) texture and returns a handle
+GLuint LoadTextureHDR( const char* TextureFileName )
+{
+    return LoadTextureHDREx( TextureFileName, NULL );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads an HDR texture as GL_RGB9_E5 or GL_R11F_G11F_B10F, applying the given loading hints (may be NULL)
+//
+// RGBE files are decoded straight into the packed format, so the 12 bytes a pixel float image is
+// never built. Anything else stb_image can read (including LDR images) goes through its float
+// decoder and the SIMD packer. Only PIXEL_FLIP_Y of mPixelTransform applies. Neither format is
+// color renderable in ES 3.0, so glGenerateMipmap can't build a chain and the texture has a
+// single level.
+GLuint LoadTextureHDREx( const char* TextureFileName, const TextureOptions* pOptions )
+{
+    char* pFileData = NULL;
+    unsigned int fileSize = 0;
+    int packFormat = HDR_PACK_RGB9E5;
+    int flip = 0;
+    int width, height, numComponents, rowStride, decoded;
+    unsigned int offset;
+    unsigned int* pData = NULL;
+    unsigned int* pFirstRow;
+    UploadRegion region;
+    int staged;
+    GLenum internalFormat, type;
+
+    ResetThreadStagingPeak();
+    ReadFile( TextureFileName, &pFileData, &fileSize );
+    pthread_once( &gStagingAllocatorsOnce, InstallStagingAllocators );
+
+    if( pOptions != NULL )
+    {
+        packFormat = pOptions->mHdrFormat;
+        flip = ( pOptions->mPixelTransform & PIXEL_FLIP_Y ) != 0;
+    }
+
+    offset = ParseRadianceHeader( (unsigned char*)pFileData, fileSize, &width, &height );
+    if( offset == 0 && !stbi_info_from_memory( (unsigned char*)pFileData, fileSize, &width, &height, &numComponents ) )
+    {
+        LogError( "%s: unknown image format\n", TextureFileName );
+        ReleaseStagingBuffer( pFileData );
+        return 0;
+    }
+
+    // Decode into the upload ring, or client memory if it can't be mapped. RGBE rows are decoded in
+    // place, which reads the mapping back.
+    staged = BeginUpload( width * height * sizeof(unsigned int), offset != 0, &region );
+    pData = staged ? (unsigned int*)region.pData : (unsigned int*)AcquireStagingBuffer( width * height * sizeof(unsigned int) );
+    if( pData == NULL )
+    {
+        ReleaseStagingBuffer( pFileData );
+        return 0;
+    }
+    pFirstRow = flip ? pData + ( height - 1 ) * width : pData;
+    rowStride = flip ? -width : width;
+
+    if( offset != 0 )
+    {
+        decoded = DecodeRadiance( (unsigned char*)pFileData, fileSize, offset, packFormat, pFirstRow, width, height, rowStride );
+    }
+    else
+    {
+        float* pPixels = stbi_loadf_from_memory( (unsigned char*)pFileData, fileSize, &width, &height, &numComponents, 3 );
+        int y;
+
+        decoded = pPixels != NULL;
+        for( y = 0; y < height && decoded; ++y )
+        {
+            PackHdrPixels( packFormat, pFirstRow + y * rowStride, pPixels + y * width * 3, width );
+        }
+        stbi_image_free( pPixels );
+    }
+    ReleaseStagingBuffer( pFileData );
+
+    // A lost mapping means the contents are undefined
+    if( staged )
+    {
+        decoded = EndUpload( &region ) && decoded;
+        pData = NULL;   // Offset 0 in the bound buffer from here on
+    }
+
+    if( !decoded )
+    {
+        LogError( "%s: failed to decode\n", TextureFileName );
+        CancelUpload( &region );
+        ReleaseStagingBuffer( pData );
+        return 0;
+    }
+
+    // Generate handle
+    GLuint handle;
+    CachedGenTextures( 1, &handle );
+
+    // Bind the texture
+    CachedBindTexture( GL_TEXTURE_2D, handle );
+
+    // Set filtering mode for 2D textures (bilinear filtering, no mipmaps)
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+
+    internalFormat = packFormat == HDR_PACK_RGB9E5 ? GL_RGB9_E5 : GL_R11F_G11F_B10F;
+    type = packFormat == HDR_PACK_RGB9E5 ? GL_UNSIGNED_INT_5_9_9_9_REV : GL_UNSIGNED_INT_10F_11F_11F_REV;
+    if( AllocateTextureStorage( internalFormat, 1, width, height ) )
+    {
+        glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, type, pData );
+        CheckGlError( "glTexSubImage2D" );
+    }
+    else
+    {
+        glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGB, type, pData );
+        CheckGlError( "glTexImage2D" );
+    }
+    FinishUpload( &region );
+
+    RegisterLoadedTexture( TextureFileName, handle, internalFormat, type, width, height, 1, 1, fileSize,
+                           staged ? width * height * sizeof(unsigned int) : 0 );
+
+    // clean up
+    ReleaseStagingBuffer( pData );
+
+    // Return handle
+    return handle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Builds levels 1 and down of a single level block compressed texture (bound to GL_TEXTURE_2D)
+// from its level 0 and uploads them, into its immutable storage if 'storage' is set. Returns
+// non-zero once the chain is complete.
+static int UploadBlockMipChain( GLenum format, int blockFormat, const unsigned char* pLevel0, int width, int height,
+                                int storage, const TextureOptions* pOptions )
+{
+    int filter = pOptions->mMipFilter == MIP_FILTER_DRIVER ? MIP_FILTER_BOX : (int)pOptions->mMipFilter;
+    unsigned int flags = pOptions->mMipFlags;
+    int alphaReference = pOptions->mAlphaReference != 0 ? (int)pOptions->mAlphaReference : 128;
+    unsigned char* pBlocks;
+    unsigned char* pLevel;
+    int levelCount, level;
+
+    // sRGB formats are always filtered in linear light
+    if( format == GL_COMPRESSED_SRGB8_ETC2 || format == GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC )
+    {
+        flags |= MIP_GAMMA_CORRECT;
+    }
+
+    pBlocks = BuildBlockMipChain( blockFormat, pLevel0, width, height, filter, flags, alphaReference, &levelCount );
+    if( pBlocks == NULL )
+    {
+        LogError( "Couldn't build the mip chain of a %dx%d texture\n", width, height );
+        return 0;
+    }
+
+    pLevel = pBlocks;
+    for( level = 1; level < levelCount; ++level )
+    {
+        unsigned int size;
+
+        width = width > 1 ? width >> 1 : 1;
+        height = height > 1 ? height >> 1 : 1;
+        size = GetBlockLevelSize( blockFormat, width, height );
+
+        UploadCompressedLevel( storage, level, format, width, height, size, pLevel );
+        pLevel += size;
+    }
+
+    ReleaseStagingBuffer( pBlocks );
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the BLOCK_FORMAT_* the CPU can rebuild mips for, or BLOCK_FORMAT_NONE
+static int GetKTXBlockFormat( GLenum internalFormat )
+{
+    switch( internalFormat )
+    {
+        case GL_ETC1_RGB8_OES:
+        {
+            return BLOCK_FORMAT_ETC1;
+        }
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        {
+            return BLOCK_FORMAT_ETC2_RGB;
+        }
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        {
+            return BLOCK_FORMAT_ETC2_RGBA;
+        }
+        default:
+        {
+            return BLOCK_FORMAT_NONE;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a ETC texture and returns a handle
+//
+// KTX file defined at http://www.khronos.org/opengles/sdk/tools/KTX/file_format_spec/
+// This uses the KTX/ETC library provided by the Khronos Group (see libktx for details)
+GLuint LoadTextureETC_KTX( const char* TextureFileName )
+{
+    return LoadTextureETC_KTXEx( TextureFileName, NULL );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Stream libktx reads a KTX file through: the header, which was read already to work out how
+// many levels to leave out, then the rest of the file, seeking past the skipped levels
+typedef struct
+{
+    const unsigned char* pHeader;
+    unsigned int         mHeaderLeft;
+    AAsset*              pFile;
+    unsigned int         mBytesRead;    // From the file, after the header
+} KTXFileStream;
+
+static int ReadKTXStream( void* pDest, const GLsizei count, void* pSource )
+{
+    KTXFileStream* pStream = (KTXFileStream*)pSource;
+    unsigned int size = (unsigned int)count;
+    unsigned int headerSize = size < pStream->mHeaderLeft ? size : pStream->mHeaderLeft;
+
+    if( count < 0 )
+    {
+        return 0;
+    }
+    memcpy( pDest, pStream->pHeader, headerSize );
+    pStream->pHeader += headerSize;
+    pStream->mHeaderLeft -= headerSize;
+    size -= headerSize;
+
+    if( size > 0 && !ReadFilePart( pStream->pFile, (unsigned char*)pDest + headerSize, size ) )
+    {
+        return 0;
+    }
+    pStream->mBytesRead += size;
+    return 1;
+}
+
+static int SkipKTXStream( const GLsizei count, void* pSource )
+{
+    KTXFileStream* pStream = (KTXFileStream*)pSource;
+    unsigned int size = (unsigned int)count;
+    unsigned int headerSize = size < pStream->mHeaderLeft ? size : pStream->mHeaderLeft;
+
+    if( count < 0 )
+    {
+        return 0;
+    }
+    pStream->pHeader += headerSize;
+    pStream->mHeaderLeft -= headerSize;
+    size -= headerSize;
+
+    return size == 0 || SkipFilePart( pStream->pFile, size );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether the key/value data of a KTX file marks its levels as packed smallest first.
+// 'swap' is set for byte swapped files.
+static int IsKTXPackedSmallestFirst( const char* pKeyValues, unsigned int size, int swap )
+{
+    unsigned int keySize = sizeof(KTX_LEVEL_ORDER_KEY);
+    unsigned int valueSize = sizeof(KTX_LEVEL_ORDER_SMALLEST_FIRST) - 1;
+    unsigned int position = 0;
+
+    // Each pair is its size, the key and its terminator, then the value, padded to 4 bytes
+    while( size - position >= sizeof(khronos_uint32_t) )
+    {
+        khronos_uint32_t pairSize;
+
+        memcpy( &pairSize, pKeyValues + position, sizeof(pairSize) );
+        if( swap )
+        {
+            _ktxSwapEndian32( &pairSize, 1 );
+        }
+        position += sizeof(pairSize);
+        if( pairSize > size - position )
+        {
+            break;
+        }
+        if( pairSize >= keySize + valueSize && memcmp( pKeyValues + position, KTX_LEVEL_ORDER_KEY, keySize ) == 0 )
+        {
+            return memcmp( pKeyValues + position + keySize, KTX_LEVEL_ORDER_SMALLEST_FIRST, valueSize ) == 0;
+        }
+        position += ( pairSize + 3 ) & ~3u;
+        if( position > size )
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads the key/value data of a KTX file with mips, the file positioned after its header, and
+// returns whether it marks the levels as packed smallest first. Leaves the file after the header.
+static int IsKTXFilePackedSmallestFirst( AAsset* pFile, const KTX_header* pHeader, unsigned int fileSize )
+{
+    char* pKeyValues;
+    int smallestFirst;
+
+    if( pHeader->numberOfMipmapLevels < 2 || pHeader->bytesOfKeyValueData == 0 ||
+        pHeader->bytesOfKeyValueData > fileSize - KTX_HEADER_SIZE )
+    {
+        return 0;
+    }
+
+    pKeyValues = (char*)AcquireStagingBuffer( pHeader->bytesOfKeyValueData );
+    smallestFirst = pKeyValues != NULL && ReadFilePart( pFile, pKeyValues, pHeader->bytesOfKeyValueData ) &&
+                    IsKTXPackedSmallestFirst( pKeyValues, pHeader->bytesOfKeyValueData,
+                                              pHeader->endianness == KTX_ENDIAN_REF_REV );
+    ReleaseStagingBuffer( pKeyValues );
+    SeekFile( pFile, KTX_HEADER_SIZE );
+    return smallestFirst;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads the levels of a KTX file packed smallest first, the file positioned after its header, and
+// lays them out as an ordinary KTX file for libktx: largest level first, without the key/value
+// data and the top 'skip' levels. Returns the staging buffer holding it and its size, or NULL if
+// the file is cut short.
+static char* ReadKTXLevelsLargestFirst( AAsset* pFile, const KTX_header* pHeader, unsigned int skip, unsigned int fileSize,
+                                        unsigned int* pSize )
+{
+    unsigned int levelCount = pHeader->numberOfMipmapLevels;
+    unsigned int faceCount = pHeader->numberOfFaces == 6 && pHeader->numberOfArrayElements == 0 ? 6 : 1;
+    unsigned int levelOffsets[MAX_MIP_LEVELS];
+    unsigned int levelSizes[MAX_MIP_LEVELS];
+    unsigned int dataSize, offset, size, level;
+    KTX_header header;
+    char* pLevels;
+    char* pData;
+
+    if( levelCount > MAX_MIP_LEVELS || skip >= levelCount || pHeader->bytesOfKeyValueData > fileSize - KTX_HEADER_SIZE )
+    {
+        return NULL;
+    }
+    dataSize = fileSize - KTX_HEADER_SIZE - pHeader->bytesOfKeyValueData;
+    pLevels = (char*)AcquireStagingBuffer( dataSize );
+    if( pLevels == NULL || !SkipFilePart( pFile, pHeader->bytesOfKeyValueData ) ||
+        !ReadFilePart( pFile, pLevels, dataSize ) )
+    {
+        ReleaseStagingBuffer( pLevels );
+        return NULL;
+    }
+
+    // Every level is its size followed by its faces, each padded to 4 bytes, smallest first
+    offset = 0;
+    for( level = levelCount; level-- > 0; )
+    {
+        khronos_uint32_t imageSize;
+
+        if( dataSize - offset < sizeof(imageSize) )
+        {
+            ReleaseStagingBuffer( pLevels );
+            return NULL;
+        }
+        memcpy( &imageSize, pLevels + offset, sizeof(imageSize) );
+        if( pHeader->endianness == KTX_ENDIAN_REF_REV )
+        {
+            _ktxSwapEndian32( &imageSize, 1 );
+        }
+        if( imageSize > dataSize || ( ( imageSize + 3 ) & ~3u ) > ( dataSize - offset - sizeof(imageSize) ) / faceCount )
+        {
+            ReleaseStagingBuffer( pLevels );
+            return NULL;
+        }
+        levelOffsets[level] = offset;
+        levelSizes[level] = sizeof(imageSize) + faceCount * ( ( imageSize + 3 ) & ~3u );
+        offset += levelSizes[level];
+    }
+
+    size = KTX_HEADER_SIZE;
+    for( level = skip; level < levelCount; ++level )
+    {
+        size += levelSizes[level];
+    }
+    pData = (char*)AcquireStagingBuffer( size );
+    if( pData == NULL )
+    {
+        ReleaseStagingBuffer( pLevels );
+        return NULL;
+    }
+
+    // The header describes the levels that are left, in the file's byte order
+    memcpy( &header, pHeader, sizeof(header) );
+    header.pixelWidth = GetMipDimension( header.pixelWidth, skip );
+    header.pixelHeight = header.pixelHeight > 0 ? GetMipDimension( header.pixelHeight, skip ) : 0;
+    header.pixelDepth = header.pixelDepth > 0 ? GetMipDimension( header.pixelDepth, skip ) : 0;
+    header.numberOfMipmapLevels = levelCount - skip;
+    header.bytesOfKeyValueData = 0;
+    if( pHeader->endianness == KTX_ENDIAN_REF_REV )
+    {
+        _ktxSwapEndian32( &header.glType, 12 );
+    }
+    memcpy( pData, &header, sizeof(header) );
+
+    offset = KTX_HEADER_SIZE;
+    for( level = skip; level < levelCount; ++level )
+    {
+        memcpy( pData + offset, pLevels + levelOffsets[level], levelSizes[level] );
+        offset += levelSizes[level];
+    }
+    ReleaseStagingBuffer( pLevels );
+
+    *pSize = size;
+    return pData;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Streams the levels of a 2D ETC KTX file through the upload scheduler, the file positioned after
+// its header. Returns 0 for files it can't stream, with the file back after the header.
+static GLuint StreamKTXLevels( const char* TextureFileName, AAsset* pFile, const KTX_header* pHeader, unsigned int skip,
+                               int smallestFirst, unsigned int fileSize )
+{
+    int blockFormat = GetKTXBlockFormat( pHeader->glInternalFormat );
+    unsigned int levelCount = pHeader->numberOfMipmapLevels;
+    unsigned int levelOffsets[MAX_MIP_LEVELS];
+    unsigned int offset = KTX_HEADER_SIZE + pHeader->bytesOfKeyValueData;
+    ScheduledUpload upload;
+    unsigned int level;
+    GLuint handle;
+
+    if( pHeader->endianness != KTX_ENDIAN_REF || blockFormat == BLOCK_FORMAT_NONE || pHeader->numberOfFaces != 1 ||
+        pHeader->numberOfArrayElements != 0 || pHeader->pixelDepth != 0 || pHeader->pixelHeight == 0 ||
+        levelCount < skip + 2 || levelCount > MAX_MIP_LEVELS || pHeader->bytesOfKeyValueData > fileSize - KTX_HEADER_SIZE )
+    {
+        return 0;
+    }
+
+    // Every level is its size followed by its blocks, in file order
+    for( level = 0; level < levelCount; ++level )
+    {
+        unsigned int fileLevel = smallestFirst ? levelCount - 1 - level : level;
+        unsigned int size = GetBlockLevelSize( blockFormat, GetMipDimension( pHeader->pixelWidth, fileLevel ),
+                                               GetMipDimension( pHeader->pixelHeight, fileLevel ) );
+
+        levelOffsets[fileLevel] = offset + sizeof(khronos_uint32_t);
+        offset += sizeof(khronos_uint32_t) + ( ( size + 3 ) & ~3u );
+    }
+
+    memset( &upload, 0, sizeof(upload) );
+    upload.mFormat = GetCompressedTextureFormat( pHeader->glInternalFormat );
+    upload.mBandRows = 4;
+    for( level = skip; level < levelCount; ++level )
+    {
+        int width = GetMipDimension( pHeader->pixelWidth, level );
+        int height = GetMipDimension( pHeader->pixelHeight, level );
+
+        AddScheduledLevel( &upload, width, height, levelOffsets[level], GetBlockLevelSize( blockFormat, width, 1 ),
+                           GetBlockLevelSize( blockFormat, width, height ) );
+    }
+
+    handle = offset <= fileSize ? StreamTextureLevels( TextureFileName, pFile, &upload, offset ) : 0;
+    if( handle == 0 )
+    {
+        SeekFile( pFile, KTX_HEADER_SIZE );
+    }
+    return handle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a ETC texture and returns a handle, applying the given loading hints (may be NULL)
+GLuint LoadTextureETC_KTXEx( const char* TextureFileName, const TextureOptions* pOptions )
+{    
+    // Read the header first, the resolution cap decides how much of the rest is read
+    char* pData = NULL;
+    unsigned int fileSize = 0;
+    unsigned int sourceBytes = 0;
+    KTX_header fileHeader;
+    KTX_header header;
+    
+    ResetThreadStagingPeak();
+    pthread_once( &gStagingAllocatorsOnce, InstallStagingAllocators );
+
+    AAsset* pFile = OpenFile( TextureFileName, &fileSize );
+    if( pFile == NULL || fileSize < sizeof(fileHeader) || !ReadFilePart( pFile, &fileHeader, sizeof(fileHeader) ) )
+    {
+        LogError( "Couldn't read %s\n", TextureFileName );
+        if( pFile != NULL )
+        {
+            CloseFile( pFile );
+        }
+        return 0;
+    }
+
+    // libktx checks the header, byte swapped files only need their fields swapping back
+    memcpy( &header, &fileHeader, sizeof(header) );
+    if( header.endianness == KTX_ENDIAN_REF_REV )
+    {
+        _ktxSwapEndian32( &header.glType, 12 );
+    }
+    unsigned int skip = GetSkippedMipLevels( pOptions, header.pixelWidth, header.pixelHeight, header.numberOfMipmapLevels );
+
+    // Files packed smallest first (see ktx.h) stream straight through, libktx reads them reversed
+    int smallestFirst = IsKTXFilePackedSmallestFirst( pFile, &header, fileSize );
+
+    // Streamed levels are read by the upload scheduler, files it can't stream load as usual
+    if( pOptions != NULL && pOptions->mStreamLevels )
+    {
+        GLuint streamed = StreamKTXLevels( TextureFileName, pFile, &header, skip, smallestFirst, fileSize );
+        if( streamed != 0 )
+        {
+            return streamed;
+        }
+    }
+    
+    // Generate handle & Load Texture
+    GLuint handle = 0;
+    GLenum target;
+    GLboolean mipmapped;
+    KTX_dimensions dimensions;
+    KTX_error_code result = KTX_UNEXPECTED_END_OF_FILE;
+    int storage = 0;
+
+    if( smallestFirst )
+    {
+        // libktx takes the levels largest first, they are put back in that order in memory
+        unsigned int size = 0;
+
+        pData = ReadKTXLevelsLargestFirst( pFile, &header, skip, fileSize, &size );
+        if( pData != NULL )
+        {
+            result = ktxLoadTextureM( pData, size, &handle, &target, &dimensions, &mipmapped, NULL, NULL, NULL );
+        }
+        sourceBytes = fileSize;
+    }
+    else if( skip == 0 && pOptions != NULL && pOptions->mBuildCompressedMips )
+    {
+        // A single level file the chain is built for gets storage for all of it up front, libktx
+        // fills level 0 of the texture it is given
+        if( header.endianness == KTX_ENDIAN_REF && header.numberOfMipmapLevels == 1 && header.numberOfFaces == 1 &&
+            header.numberOfArrayElements == 0 && header.pixelDepth == 0 && header.pixelHeight > 0 &&
+            GetKTXBlockFormat( header.glInternalFormat ) != BLOCK_FORMAT_NONE )
+        {
+            CachedGenTextures( 1, &handle );
+            CachedBindTexture( GL_TEXTURE_2D, handle );
+            storage = AllocateTextureStorage( GetCompressedTextureFormat( header.glInternalFormat ),
+                                              GetMipLevelCount( header.pixelWidth, header.pixelHeight ),
+                                              header.pixelWidth, header.pixelHeight );
+            if( !storage )
+            {
+                CachedDeleteTextures( 1, &handle );
+                handle = 0;
+            }
+        }
+
+        // Building the mip chain needs level 0 in client memory, the file is read in one go
+        pData = (char*)AcquireStagingBuffer( fileSize );
+        if( pData != NULL && ReadFilePart( pFile, pData + sizeof(fileHeader), fileSize - sizeof(fileHeader) ) )
+        {
+            memcpy( pData, &fileHeader, sizeof(fileHeader) );
+            result = ktxLoadTextureM( pData, fileSize, &handle, &target, &dimensions, &mipmapped, NULL, NULL, NULL );
+            sourceBytes = fileSize;
+        }
+    }
+    else
+    {
+        // libktx reads the levels straight into the upload ring, seeking past skipped ones, and
+        // uploads the rest as levels 0 and down
+        KTXFileStream stream;
+
+        stream.pHeader = (const unsigned char*)&fileHeader;
+        stream.mHeaderLeft = sizeof(fileHeader);
+        stream.pFile = pFile;
+        stream.mBytesRead = 0;
+        result = ktxLoadTextureCB( &stream, ReadKTXStream, SkipKTXStream, skip, &handle, &target, &dimensions, &mipmapped,
+                                   NULL, NULL, NULL );
+        sourceBytes = sizeof(fileHeader) + stream.mBytesRead;
+    }
+    CloseFile( pFile );
+        
+    if( result != KTX_SUCCESS )
+    {
+        LogError( "KTXLib couldn't load texture %s. Error: %d", TextureFileName, result );
+        if( storage )
+        {
+            // libktx only deletes the textures it created
+            CachedDeleteTextures( 1, &handle );
+        }
+        ReleaseStagingBuffer( pData );
+        return 0;
+    }
+ 
+    // Bind the texture
+    CachedBindTexture( target, handle );
+        
+    // Set filtering mode for 2D textures (bilinear filtering)
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+
+    // libktx uploaded level 0, the rest of the chain is built from the level 0 data in the file
+    if( !mipmapped && target == GL_TEXTURE_2D && pData != NULL && header.numberOfMipmapLevels <= 1 && pOptions != NULL &&
+        pOptions->mBuildCompressedMips )
+    {
+        const KTX_header* pHeader = (const KTX_header*)pData;
+        unsigned int dataOffset = KTX_HEADER_SIZE + pHeader->bytesOfKeyValueData + sizeof(khronos_uint32_t);
+        int blockFormat = GetKTXBlockFormat( pHeader->glInternalFormat );
+
+        if( pHeader->endianness == KTX_ENDIAN_REF && blockFormat != BLOCK_FORMAT_NONE && pHeader->numberOfFaces == 1 &&
+            pHeader->numberOfArrayElements == 0 && dataOffset <= fileSize &&
+            GetBlockLevelSize( blockFormat, pHeader->pixelWidth, pHeader->pixelHeight ) <= fileSize - dataOffset )
+        {
+            mipmapped = (GLboolean)UploadBlockMipChain( GetCompressedTextureFormat( pHeader->glInternalFormat ), blockFormat,
+                                                        (unsigned char*)pData + dataOffset, pHeader->pixelWidth,
+                                                        pHeader->pixelHeight, storage, pOptions );
+        }
+    }
+
+    if( mipmapped )
+    {
+        // Use mipmaps with bilinear filtering
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
+    }
+
+    RegisterLoadedTexture( TextureFileName, handle, header.glInternalFormat, header.glType, dimensions.width, dimensions.height,
+                           !mipmapped ? 1 : header.numberOfMipmapLevels > 1 ? (int)( header.numberOfMipmapLevels - skip )
+                                                                              : GetMipLevelCount( dimensions.width, dimensions.height ),
+                           header.numberOfFaces * ( header.numberOfArrayElements > 1 ? header.numberOfArrayElements : 1 ),
+                           sourceBytes, 0 );
+
+    // clean up
+    ReleaseStagingBuffer( pData );
+    
+    // Return handle
+    return handle;  
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads the next 'size' bytes of a file straight into a region of the upload ring, or into a
+// staging buffer (*ppData) if none can be mapped or the caller needs the data on the CPU after it
+// is uploaded. *pBase is what the upload calls pass for the start of the data: an offset of 0 in
+// the bound buffer or the staging buffer. Returns 0 if the data couldn't be read.
+static int ReadUploadData( AAsset* pFile, unsigned int size, int keepOnCpu, UploadRegion* pRegion, char** ppData,
+                           intptr_t* pBase )
+{
+    *ppData = NULL;
+    *pBase = 0;
+    memset( pRegion, 0, sizeof(*pRegion) );
+
+    if( !keepOnCpu && BeginUpload( size, 0, pRegion ) )
+    {
+        int read = ReadFilePart( pFile, pRegion->pData, size );
+
+        if( EndUpload( pRegion ) && read )
+        {
+            return 1;
+        }
+        CancelUpload( pRegion );
+        return 0;
+    }
+
+    *ppData = (char*)AcquireStagingBuffer( size );
+    if( *ppData == NULL || !ReadFilePart( pFile, *ppData, size ) )
+    {
+        ReleaseStagingBuffer( *ppData );
+        *ppData = NULL;
+        return 0;
+    }
+    *pBase = (intptr_t)*ppData;
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a PVRTC texture and returns a handle (mipmap support included)
+//
+// Extension defined here: http://www.khronos.org/registry/gles/extensions/IMG/IMG_texture_compression_pvrtc.txt
+// File format defined here: http://www.imgtec.net/powervr/insider/docs/PVR%20File%20Format.Specification.1.0.11.External.pdf
+typedef struct
+{
+    unsigned int       mVersion;            
+    unsigned int       mFlags;          
+    unsigned long long mPixelFormat;        
+    unsigned int       mColourSpace;        
+    unsigned int       mChannelType;        
+    unsigned int       mHeight;         
+    unsigned int       mWidth;          
+    unsigned int       mDepth;          
+    unsigned int       mNumSurfaces;        
+    unsigned int       mNumFaces;       
+    unsigned int       mMipmapCount;     
+    unsigned int       mMetaDataSize;   
+} __attribute__((packed)) PVRHeaderV3;  // Header must be packed because of the 64-bit mPixelFormat (ARM will pad 4 extra bytes to make it aligned)
+
+GLuint LoadTexturePVRTC( const char* TextureFileName )
+{
+    return LoadTexturePVRTCEx( TextureFileName, NULL );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a PVRTC texture and returns a handle, applying the given loading hints (may be NULL).
+// Levels left out by the resolution cap are seeked past, only the ones uploaded are read.
+GLuint LoadTexturePVRTCEx( const char* TextureFileName, const TextureOptions* pOptions )
+{
+    // Read the header
+    PVRHeaderV3 header;
+    unsigned int fileSize = 0;
+    
+    ResetThreadStagingPeak();
+    AAsset* pFile = OpenFile( TextureFileName, &fileSize );
+    if( pFile == NULL || !ReadFilePart( pFile, &header, sizeof(header) ) )
+    {
+        LogError( "Couldn't read %s\n", TextureFileName );
+        if( pFile != NULL )
+        {
+            CloseFile( pFile );
+        }
+        return 0;
+    }
+    
+    // Determine the format
+    GLenum format;
+    GLuint bitsPerPixel;
+
+    switch( header.mPixelFormat )
+    {
+        case 0:
+        {
+            // PVRTC 2bpp RGB
+            format = GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG;
+            bitsPerPixel = 2;
+            break;
+        }
+        case 1: 
+        {
+            // PVRTC 2bpp RGBA
+            format = GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG;
+            bitsPerPixel = 2;
+            break;
+        }
+        case 2: 
+        {
+            // PVRTC 4bpp RGB
+            format = GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG;
+            bitsPerPixel = 4;
+            break;
+        }
+        case 3: 
+        {
+            // PVRTC 4bpp RGBA
+            format = GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG;
+            bitsPerPixel = 4;
+            break;
+        }
+        default: 
+        {
+            // Unknown format
+            assert(0);
+            CloseFile( pFile );
+            return 0;
+        }
+    } 
+    if( !IsCompressedFormatSupported( format ) )
+    {
+        LogError( "%s: the GPU doesn't support format 0x%x\n", TextureFileName, format );
+        CloseFile( pFile );
+        return 0;
+    }
+
+    // Add up the size of the levels left out and of the ones loaded
+    // pixelDataSize must be at least two blocks (4x4 pixels for 4bpp, 8x4 pixels for 2bpp), so min size is 32
+    unsigned int levelCount = header.mMipmapCount > 1 ? header.mMipmapCount : 1;
+    unsigned int skip = GetSkippedMipLevels( pOptions, header.mWidth, header.mHeight, levelCount );
+    unsigned int skipSize = header.mMetaDataSize;
+    unsigned int dataSize = 0;
+    unsigned int mip;
+    int stream = pOptions != NULL && pOptions->mStreamLevels && levelCount - skip > 1 && levelCount - skip <= MAX_MIP_LEVELS;
+    ScheduledUpload upload;
+
+    memset( &upload, 0, sizeof(upload) );
+    upload.mFormat = format;
+    for( mip = 0; mip < levelCount; ++mip )
+    {
+        unsigned int pixelDataSize = ( GetMipDimension( header.mWidth, mip ) * GetMipDimension( header.mHeight, mip ) * bitsPerPixel ) >> 3;
+        pixelDataSize = (pixelDataSize < 32) ? 32 : pixelDataSize;
+
+        if( mip < skip )
+        {
+            skipSize += pixelDataSize;
+        }
+        else
+        {
+            if( stream )
+            {
+                AddScheduledLevel( &upload, GetMipDimension( header.mWidth, mip ), GetMipDimension( header.mHeight, mip ),
+                                   sizeof(header) + skipSize + dataSize, 0, pixelDataSize );
+            }
+            dataSize += pixelDataSize;
+        }
+    }
+
+    // Streamed levels are read by the upload scheduler, PVRTC ones whole
+    if( stream )
+    {
+        GLuint streamed = StreamTextureLevels( TextureFileName, pFile, &upload, sizeof(header) + dataSize );
+        if( streamed != 0 )
+        {
+            return streamed;
+        }
+    }
+
+    // Read the levels that are loaded, deferred ones are uploaded from client memory
+    UploadRegion region;
+    char* pData = NULL;
+    intptr_t base = 0;
+    int defer = pOptions != NULL && pOptions->mDeferUpload && levelCount - skip <= MAX_MIP_LEVELS;
+    if( !SkipFilePart( pFile, skipSize ) || !ReadUploadData( pFile, dataSize, defer, &region, &pData, &base ) )
+    {
+        LogError( "Couldn't read the texture data of %s\n", TextureFileName );
+        CloseFile( pFile );
+        return 0;
+    }
+    CloseFile( pFile );
+    
+    // Generate handle
+    GLuint handle;
+    CachedGenTextures( 1, &handle );
+    
+    // Bind the texture
+    CachedBindTexture( GL_TEXTURE_2D, handle );
+    
+    // Set filtering mode for 2D textures (bilenear filtering)
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    if( levelCount - skip > 1 )
+    {
+        // Use mipmaps with bilinear filtering
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
+    }
+    
+    // Initialize the texture, the first level read becomes level 0
+    unsigned int offset = 0;
+    unsigned int mipWidth = GetMipDimension( header.mWidth, skip );
+    unsigned int mipHeight = GetMipDimension( header.mHeight, skip );
+    int storage = AllocateTextureStorage( format, (int)( levelCount - skip ), mipWidth, mipHeight );
+
+    // PVRTC levels can only be uploaded whole
+    int schedule = defer && storage && pData != NULL;
+    memset( &upload, 0, sizeof(upload) );
+    upload.mTexture = handle;
+    upload.mFormat = format;
+
+    mip = 0;
+    do
+    {
+        // Determine size (width * height * bbp/8)
+        unsigned int pixelDataSize = ( mipWidth * mipHeight * bitsPerPixel ) >> 3;
+        pixelDataSize = (pixelDataSize < 32) ? 32 : pixelDataSize;
+
+        // Upload texture data for this mip, or leave it to the scheduler
+        if( schedule )
+        {
+            AddScheduledLevel( &upload, mipWidth, mipHeight, offset, 0, pixelDataSize );
+        }
+        else
+        {
+            UploadCompressedLevel( storage, mip, format, mipWidth, mipHeight, pixelDataSize, (const GLvoid*)( base + offset ) );
+        }
+    
+        // Next mips is half the size (divide by 2) with a min of 1
+        mipWidth = mipWidth >> 1;
+        mipWidth = ( mipWidth == 0 ) ? 1 : mipWidth;
+
+        mipHeight = mipHeight >> 1;
+        mipHeight = ( mipHeight == 0 ) ? 1 : mipHeight; 
+
+        // Move to next mip
+        offset += pixelDataSize;
+        mip++;
+    } while(mip < levelCount - skip);
+    FinishUpload( &region );
+
+    if( schedule )
+    {
+        // The scheduler owns the data from here on
+        ScheduleTextureUpload( &upload, pData );
+        pData = NULL;
+    }
+
+    RegisterLoadedTexture( TextureFileName, handle, format, 0, GetMipDimension( header.mWidth, skip ),
+                           GetMipDimension( header.mHeight, skip ), mip, 1, sizeof(header) + dataSize, base == 0 ? dataSize : 0 );
+
+    // clean up
+    ReleaseStagingBuffer( pData );
+  
+    // Return handle
+    return handle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a S3TC texture and returns a handle
+//
+// Extension defined here: http://oss.sgi.com/projects/ogl-sample/registry/EXT/texture_compression_s3tc.txt
+// File format defined here: http://msdn.microsoft.com/en-us/library/windows/desktop/bb943982(v=vs.85).aspx
+
+typedef struct 
+{ 
+    unsigned int mSize;
+    unsigned int mFlags;
+    unsigned int mFourCC;
+    unsigned int mRGBBitCount;
+    unsigned int mRedBitMask;
+    unsigned int mGreenBitMask;
+    unsigned int mBlueBitMask;
+    unsigned int mAlphaBitMask;
+} DDSPixelFormat;
+
+typedef struct 
+{
+    char           mFileType[4];
+    unsigned int   mSize;
+    unsigned int   mFlags;
+    unsigned int   mHeight;
+    unsigned int   mWidth;
+    unsigned int   mPitchOrLinearSize;
+    unsigned int   mDepth;
+    unsigned int   mMipMapCount;
+    unsigned int   mReserved1[11];
+    DDSPixelFormat mPixelFormat;
+    unsigned int   mCaps;
+    unsigned int   mCaps2;
+    unsigned int   mCaps3;
+    unsigned int   mCaps4;
+    unsigned int   mReserved2;
+} DDSHeader;
+
+GLuint LoadTextureS3TC( const char* TextureFileName )
+{
+    return LoadTextureS3TCEx( TextureFileName, NULL );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads a S3TC texture and returns a handle, applying the given loading hints (may be NULL)
+GLuint LoadTextureS3TCEx( const char* TextureFileName, const TextureOptions* pOptions )
+{
+    // Read the header
+    DDSHeader header;
+    unsigned int fileSize = 0;
+    
+    ResetThreadStagingPeak();
+    AAsset* pFile = OpenFile( TextureFileName, &fileSize );
+    if( pFile == NULL || !ReadFilePart( pFile, &header, sizeof(header) ) )
+    {
+        LogError( "Couldn't read %s\n", TextureFileName );
+        if( pFile != NULL )
+        {
+            CloseFile( pFile );
+        }
+        return 0;
+    }
+    
+    // Determine texture format
+    GLenum format;
+    GLuint blockSize;
+    int blockFormat;
+    switch( header.mPixelFormat.mFourCC )
+    {
+        case 0x31545844: 
+        {
+            //FOURCC_DXT1
+            format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            blockSize = 8;
+            blockFormat = BLOCK_FORMAT_DXT1;
+            break;
+        }
+        case 0x33545844: 
+        {
+            //FOURCC_DXT3
+            format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            blockSize = 16;
+            blockFormat = BLOCK_FORMAT_DXT3;
+            break;
+        }
+        case 0x35545844: 
+        {
+            //FOURCC_DXT5
+            format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            blockSize = 16;
+            blockFormat = BLOCK_FORMAT_DXT5;
+            break;
+        }
+        default: 
+        {
+            // Unknown format
+            assert(0);
+            CloseFile( pFile );
+            return 0;
+        }
+    }
+    if( !IsCompressedFormatSupported( format ) )
+    {
+        LogError( "%s: the GPU doesn't support format 0x%x\n", TextureFileName, format );
+        CloseFile( pFile );
+        return 0;
+    }
+
+    // Add up the size of the levels left out and of the ones loaded
+    // As defined in extension: size = ceil(<w>/4) * ceil(<h>/4) * blockSize
+    unsigned int levelCount = header.mMipMapCount > 1 ? header.mMipMapCount : 1;
+    unsigned int skip = GetSkippedMipLevels( pOptions, header.mWidth, header.mHeight, levelCount );
+    unsigned int skipSize = 0;
+    unsigned int dataSize = 0;
+    unsigned int mip;
+    int stream = pOptions != NULL && pOptions->mStreamLevels && levelCount - skip > 1 && levelCount - skip <= MAX_MIP_LEVELS;
+    ScheduledUpload upload;
+
+    memset( &upload, 0, sizeof(upload) );
+    upload.mFormat = format;
+    upload.mBandRows = 4;
+    for( mip = 0; mip < levelCount; ++mip )
+    {
+        unsigned int pixelDataSize = ( ( GetMipDimension( header.mWidth, mip ) + 3 ) >> 2 ) *
+                                     ( ( GetMipDimension( header.mHeight, mip ) + 3 ) >> 2 ) * blockSize;
+
+        if( mip < skip )
+        {
+            skipSize += pixelDataSize;
+        }
+        else
+        {
+            if( stream )
+            {
+                AddScheduledLevel( &upload, GetMipDimension( header.mWidth, mip ), GetMipDimension( header.mHeight, mip ),
+                                   sizeof(header) + skipSize + dataSize, ( ( GetMipDimension( header.mWidth, mip ) + 3 ) >> 2 ) * blockSize,
+                                   pixelDataSize );
+            }
+            dataSize += pixelDataSize;
+        }
+    }
+
+    // Streamed levels are read by the upload scheduler, in bands of block rows
+    if( stream )
+    {
+        GLuint streamed = StreamTextureLevels( TextureFileName, pFile, &upload, sizeof(header) + dataSize );
+        if( streamed != 0 )
+        {
+            return streamed;
+        }
+    }
+
+    // Read the levels that are loaded, building the mip chain needs level 0 in client memory and
+    // deferred levels are uploaded from it
+    UploadRegion region;
+    char* pData = NULL;
+    intptr_t base = 0;
+    int buildMips = levelCount == 1 && pOptions != NULL && pOptions->mBuildCompressedMips;
+    int defer = !buildMips && pOptions != NULL && pOptions->mDeferUpload && levelCount - skip <= MAX_MIP_LEVELS;
+    if( !SkipFilePart( pFile, skipSize ) || !ReadUploadData( pFile, dataSize, buildMips || defer, &region, &pData, &base ) )
+    {
+        LogError( "Couldn't read the texture data of %s\n", TextureFileName );
+        CloseFile( pFile );
+        return 0;
+    }
+    CloseFile( pFile );
+
+    // Generate handle
+    GLuint handle;
+    CachedGenTextures( 1, &handle );
+    
+    // Bind the texture
+    CachedBindTexture( GL_TEXTURE_2D, handle );
+    
+    // Set filtering mode for 2D textures (bilinear filtering)
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    if( levelCount - skip > 1 )
+    {
+        // Use mipmaps with bilinear filtering
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
+    }
+   
+    // Initialize the texture, the first level read becomes level 0
+    unsigned int width = GetMipDimension( header.mWidth, skip );
+    unsigned int height = GetMipDimension( header.mHeight, skip );
+    unsigned int offset = 0;
+    unsigned int mipWidth = width;
+    unsigned int mipHeight = height;
+    int storage = AllocateTextureStorage( format, buildMips ? GetMipLevelCount( width, height ) : (int)( levelCount - skip ),
+                                          width, height );
+
+    // S3TC levels can be uploaded in bands of whole blocks
+    int schedule = defer && storage && pData != NULL;
+    memset( &upload, 0, sizeof(upload) );
+    upload.mTexture = handle;
+    upload.mFormat = format;
+    upload.mBandRows = 4;
+
+    mip = 0;
+    do
+    {
+        // Determine size
+        unsigned int pixelDataSize = ((mipWidth + 3) >> 2) * ((mipHeight + 3) >> 2) * blockSize;
+    
+        // Upload texture data for this mip, or leave it to the scheduler
+        if( schedule )
+        {
+            AddScheduledLevel( &upload, mipWidth, mipHeight, offset, ( ( mipWidth + 3 ) >> 2 ) * blockSize, pixelDataSize );
+        }
+        else
+        {
+            UploadCompressedLevel( storage, mip, format, mipWidth, mipHeight, pixelDataSize, (const GLvoid*)( base + offset ) );
+        }
+        
+        // Next mips is half the size (divide by 2) with a min of 1
+        mipWidth = mipWidth >> 1;
+        mipWidth = ( mipWidth == 0 ) ? 1 : mipWidth;
+
+        mipHeight = mipHeight >> 1;
+        mipHeight = ( mipHeight == 0 ) ? 1 : mipHeight; 
+
+        // Move to next mip map
+        offset += pixelDataSize;
+        mip++;
+    } while(mip < levelCount - skip);
+    FinishUpload( &region );
+
+    if( schedule )
+    {
+        // The scheduler owns the data from here on
+        ScheduleTextureUpload( &upload, pData );
+        pData = NULL;
+    }
+
+    // Single level files get the rest of the chain built from level 0
+    if( buildMips && UploadBlockMipChain( format, blockFormat, (unsigned char*)pData, width, height, storage, pOptions ) )
+    {
+        CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
+        mip = GetMipLevelCount( width, height );
+    }
+
+    RegisterLoadedTexture( TextureFileName, handle, format, 0, width, height, mip, 1, sizeof(header) + dataSize,
+                           base == 0 ? dataSize : 0 );
+
+    // clean up
+    ReleaseStagingBuffer( pData );
+        
+    // Return handle
+    return handle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletes a loaded texture
+void DeleteTexture( GLuint handle )
+{
+    CancelScheduledUploads( handle );
+    UnregisterTexture( handle );
+    CachedDeleteTextures( 1, &handle );
+}
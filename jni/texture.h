@@ -1,50 +1,103 @@
-/* Copyright (c) <2012>, Intel Corporation
-*
-* Redistribution and use in source and binary forms, with or without 
-* modification, are permitted provided that the following conditions are met:
-*
-* - Redistributions of source code must retain the above copyright notice, 
-*   this list of conditions and the following disclaimer.
-* - Redistributions in binary form must reproduce the above copyright notice, 
-*   this list of conditions and the following disclaimer in the documentation 
-*   and/or other materials provided with the distribution.
-* - Neither the name of Intel Corporation nor the names of its contributors 
-*   may be used to endorse or promote products derived from this software 
-*   without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-* POSSIBILITY OF SUCH DAMAGE.
-*
-*/
-
-#pragma once
-
-#include <GLES3/gl3.h>
-#include <GLES3/gl3ext.h>
-// Check if PVRTC is supported
-int IsPVRTCSupported();
-
-// Check if S3TC is supported
-int IsS3TCSupported();
-
-// Check if ETC is supported by hardware
-int IsETCSupported();
-int IsETC2Supported();
-
-// Loads a texture and returns a handle
-GLuint LoadTexturePNG( const char* TextureFileName );
-GLuint LoadTextureETC_KTX( const char* TextureFileName );
-GLuint LoadTextureETC_PKM( const char* TextureFileName );
-GLuint LoadTexturePVRTC( const char* TextureFileName );
-GLuint LoadTextureS3TC( const char* TextureFileName );
-
-    
\ No newline at end of file
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <GLES3/gl3ext.h>
+
+// Make sure all compression formats are defined
+#define GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG   0x8C00
+#define GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG   0x8C01
+#define GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG  0x8C02
+#define GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG  0x8C03
+
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+
+#define GL_ETC1_RGB8_OES                  0x8D64
+
+// Check if PVRTC is supported
+int IsPVRTCSupported();
+
+// Check if S3TC is supported
+int IsS3TCSupported();
+
+// Check if ETC is supported by hardware
+int IsETCSupported();
+int IsETC2Supported();
+
+// Optional loading hints, zero fields keep the default behaviour
+typedef struct
+{
+    unsigned int mMaxDimension;     // Largest width/height wanted, JPEGs are decoded at 1/2, 1/4 or 1/8 size to fit,
+                                    // KTX/PVRTC/S3TC files with mips start at the first level that fits and other
+                                    // PNG/JPEG start at the first level of their CPU built chain that fits
+    unsigned int mSkipMipLevels;    // Top KTX/PVRTC/S3TC mip levels to leave out, never read from the file
+    unsigned int mPixelTransform;   // PIXEL_* flags (see pixel_transform.h), applied while decoding PNG/JPEG
+    unsigned int mPackedFormat;     // PIXEL_PACK_* 16-bit format to quantize PNG/JPEG to, halving memory
+    unsigned int mDither;           // PIXEL_DITHER_* used by mPackedFormat
+    unsigned int mMipFilter;        // MIP_FILTER_* (see mipmap.h) the PNG/JPEG mip chain is built with, on the CPU
+    unsigned int mMipFlags;         // MIP_GAMMA_CORRECT, MIP_PRESERVE_COVERAGE
+    unsigned int mAlphaReference;   // Alpha test threshold MIP_PRESERVE_COVERAGE keeps, 0 means 128
+    unsigned int mBuildCompressedMips;  // Non-zero builds the missing mip chain of single level ETC/S3TC files on the CPU
+    unsigned int mHdrFormat;        // HDR_PACK_* (see hdr.h) HDR textures are stored in, GL_RGB9_E5 by default
+    unsigned int mDeferUpload;      // Non-zero leaves the large PNG/JPEG/PVRTC/S3TC levels to RunScheduledUploads (see
+                                    // upload_scheduler.h), PNG/JPEG then build their mip chain on the CPU
+    unsigned int mStreamLevels;     // Non-zero has RunScheduledUploads read the levels of 2D KTX/PVRTC/S3TC files with
+                                    // mips as it uploads them, smallest first; the load returns once the header is read
+} TextureOptions;
+
+// KTX files may be packed with their levels smallest first (KTX_LEVEL_ORDER_KEY, see ktx.h), so
+// streaming them reads straight through. They load with or without mStreamLevels.
+
+// Loads a texture and returns a handle
+GLuint LoadTexturePNG( const char* TextureFileName );
+GLuint LoadTexturePNGEx( const char* TextureFileName, const TextureOptions* pOptions );
+GLuint LoadTextureHDR( const char* TextureFileName );
+GLuint LoadTextureHDREx( const char* TextureFileName, const TextureOptions* pOptions );
+GLuint LoadTextureETC_KTX( const char* TextureFileName );
+GLuint LoadTextureETC_KTXEx( const char* TextureFileName, const TextureOptions* pOptions );
+GLuint LoadTextureETC_PKM( const char* TextureFileName );
+GLuint LoadTexturePVRTC( const char* TextureFileName );
+GLuint LoadTexturePVRTCEx( const char* TextureFileName, const TextureOptions* pOptions );
+GLuint LoadTextureS3TC( const char* TextureFileName );
+GLuint LoadTextureS3TCEx( const char* TextureFileName, const TextureOptions* pOptions );
+
+// Deletes a texture returned by one of the loaders, with its memory entry (see texture_memory.h)
+// and any of its levels the upload scheduler still has
+void DeleteTexture( GLuint handle );
+
+    
+
+// Caps the resolution of every texture loaded from now on, whatever its options ask for (the
+// stricter of the two wins): the largest width/height, and the number of top mip levels to leave
+// out. Zero for both loads at full resolution.
+void SetTextureResolutionCap( unsigned int maxDimension, unsigned int skipMipLevels );
@@ -0,0 +1,333 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "file.h"
+#include "texture.h"
+#include "texture_cache.h"
+
+// Bytes hashed at a time
+#define TEXTURE_CACHE_HASH_CHUNK    ( 64 * 1024 )
+
+// A file name a texture was acquired under. Names with the same content share the texture, the
+// references are counted per name.
+typedef struct
+{
+    char*               pName;
+    TextureLoadFunction pLoad;
+    TextureOptions      mOptions;
+    GLuint              mHandle;
+    int                 mRefCount;
+    int                 mHashed;        // mHash and mSize are set
+    unsigned long long  mHash;
+    unsigned int        mSize;
+} TextureCacheEntry;
+
+static TextureCacheEntry*   gpCacheEntries = NULL;
+static int                  gCacheCount = 0;
+static int                  gCacheCapacity = 0;
+static int                  gCacheHashing = 0;
+static TextureCacheStats    gCacheStats = { 0 };
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether an entry was acquired with the same loader and options
+static int IsSameLoad( const TextureCacheEntry* pEntry, TextureLoadFunction pLoad, const TextureOptions* pOptions )
+{
+    return pEntry->pLoad == pLoad && memcmp( &pEntry->mOptions, pOptions, sizeof(*pOptions) ) == 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Hashes the contents of a file
+//
+// 64-bit FNV-1a over 8 byte words rather than bytes, which is plenty to tell texture files apart
+// and runs at memory speed. Returns zero if the file can't be read.
+static int HashFile( const char* pFileName, unsigned long long* pHash, unsigned int* pSize )
+{
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    unsigned char* pChunk;
+    unsigned int size;
+    unsigned int offset;
+    AAsset* pFile = OpenFile( pFileName, &size );
+
+    if( pFile == NULL )
+    {
+        return 0;
+    }
+    pChunk = (unsigned char*)malloc( TEXTURE_CACHE_HASH_CHUNK );
+    if( pChunk == NULL )
+    {
+        CloseFile( pFile );
+        return 0;
+    }
+
+    for( offset = 0; offset < size; offset += TEXTURE_CACHE_HASH_CHUNK )
+    {
+        unsigned int chunkSize = size - offset < TEXTURE_CACHE_HASH_CHUNK ? size - offset : TEXTURE_CACHE_HASH_CHUNK;
+        unsigned int i;
+
+        if( !ReadFilePart( pFile, pChunk, chunkSize ) )
+        {
+            free( pChunk );
+            CloseFile( pFile );
+            return 0;
+        }
+        for( i = 0; i + 8 <= chunkSize; i += 8 )
+        {
+            unsigned long long word;
+
+            memcpy( &word, pChunk + i, 8 );
+            hash = ( hash ^ word ) * 0x100000001b3ULL;
+        }
+        for( ; i < chunkSize; ++i )
+        {
+            hash = ( hash ^ pChunk[i] ) * 0x100000001b3ULL;
+        }
+    }
+
+    free( pChunk );
+    CloseFile( pFile );
+    *pHash = hash;
+    *pSize = size;
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Adds an entry, returns NULL if there's no memory for it
+static TextureCacheEntry* AddCacheEntry( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions,
+                                         GLuint handle )
+{
+    TextureCacheEntry* pEntry;
+
+    if( gCacheCount == gCacheCapacity )
+    {
+        int capacity = gCacheCapacity > 0 ? gCacheCapacity * 2 : 8;
+        TextureCacheEntry* pEntries = (TextureCacheEntry*)realloc( gpCacheEntries, capacity * sizeof(TextureCacheEntry) );
+
+        if( pEntries == NULL )
+        {
+            return NULL;
+        }
+        gpCacheEntries = pEntries;
+        gCacheCapacity = capacity;
+    }
+
+    pEntry = &gpCacheEntries[gCacheCount];
+    memset( pEntry, 0, sizeof(*pEntry) );
+    pEntry->pName = strdup( TextureFileName );
+    if( pEntry->pName == NULL )
+    {
+        return NULL;
+    }
+    pEntry->pLoad = pLoad;
+    pEntry->mOptions = *pOptions;
+    pEntry->mHandle = handle;
+    ++gCacheCount;
+    return pEntry;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the texture cached for a file, loading it on a miss
+GLuint AcquireTexture( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions )
+{
+    TextureOptions options;
+    TextureCacheEntry* pEntry = NULL;
+    unsigned long long hash = 0;
+    unsigned int size = 0;
+    int hashed = 0;
+    GLuint handle = 0;
+    int index;
+
+    memset( &options, 0, sizeof(options) );
+    if( pOptions != NULL )
+    {
+        options = *pOptions;
+    }
+
+    for( index = 0; index < gCacheCount; ++index )
+    {
+        if( strcmp( gpCacheEntries[index].pName, TextureFileName ) == 0 && IsSameLoad( &gpCacheEntries[index], pLoad, &options ) )
+        {
+            gpCacheEntries[index].mRefCount++;
+            gCacheStats.mHits++;
+            return gpCacheEntries[index].mHandle;
+        }
+    }
+
+    if( gCacheHashing && HashFile( TextureFileName, &hash, &size ) )
+    {
+        hashed = 1;
+        for( index = 0; index < gCacheCount; ++index )
+        {
+            TextureCacheEntry* pOther = &gpCacheEntries[index];
+
+            if( !IsSameLoad( pOther, pLoad, &options ) )
+            {
+                continue;
+            }
+            // Cached before hashing was turned on
+            if( !pOther->mHashed )
+            {
+                pOther->mHashed = HashFile( pOther->pName, &pOther->mHash, &pOther->mSize );
+            }
+            if( pOther->mHashed && pOther->mHash == hash && pOther->mSize == size )
+            {
+                handle = pOther->mHandle;
+                gCacheStats.mContentHits++;
+                break;
+            }
+        }
+    }
+
+    if( handle == 0 )
+    {
+        handle = pLoad( TextureFileName, pOptions );
+        if( handle == 0 )
+        {
+            return 0;
+        }
+        gCacheStats.mMisses++;
+    }
+
+    pEntry = AddCacheEntry( TextureFileName, pLoad, &options, handle );
+    if( pEntry == NULL )
+    {
+        // Still a working texture, just not a shared one
+        return handle;
+    }
+    pEntry->mRefCount = 1;
+    pEntry->mHashed = hashed;
+    pEntry->mHash = hash;
+    pEntry->mSize = size;
+    return handle;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Drops a reference, deleting the texture and forgetting its names with the last one
+void ReleaseTexture( GLuint handle )
+{
+    int released = 0;
+    int index;
+
+    if( handle == 0 )
+    {
+        return;
+    }
+
+    for( index = 0; index < gCacheCount; ++index )
+    {
+        if( gpCacheEntries[index].mHandle == handle && gpCacheEntries[index].mRefCount > 0 )
+        {
+            if( !released )
+            {
+                gpCacheEntries[index].mRefCount--;
+                released = 1;
+            }
+            if( gpCacheEntries[index].mRefCount > 0 )
+            {
+                return;
+            }
+        }
+    }
+    if( !released )
+    {
+        // Not from the cache (or its entry couldn't be added), the caller's only reference
+        DeleteTexture( handle );
+        return;
+    }
+
+    index = 0;
+    while( index < gCacheCount )
+    {
+        if( gpCacheEntries[index].mHandle == handle )
+        {
+            free( gpCacheEntries[index].pName );
+            gpCacheEntries[index] = gpCacheEntries[--gCacheCount];
+        }
+        else
+        {
+            ++index;
+        }
+    }
+    DeleteTexture( handle );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Turns content hashing on or off
+void SetTextureCacheContentHashing( int enable )
+{
+    gCacheHashing = enable;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Forgets every cached texture
+void ResetTextureCache()
+{
+    int index;
+
+    for( index = 0; index < gCacheCount; ++index )
+    {
+        free( gpCacheEntries[index].pName );
+    }
+    free( gpCacheEntries );
+    gpCacheEntries = NULL;
+    gCacheCount = 0;
+    gCacheCapacity = 0;
+    memset( &gCacheStats, 0, sizeof(gCacheStats) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the cache counters, and the entries and textures cached now
+void GetTextureCacheStats( TextureCacheStats* pStats )
+{
+    int index;
+
+    *pStats = gCacheStats;
+    pStats->mEntryCount = gCacheCount;
+    pStats->mTextureCount = 0;
+    for( index = 0; index < gCacheCount; ++index )
+    {
+        int first = 1;
+        int other;
+
+        // Counted at the first name sharing it
+        for( other = 0; other < index && first; ++other )
+        {
+            first = gpCacheEntries[other].mHandle != gpCacheEntries[index].mHandle;
+        }
+        pStats->mTextureCount += first;
+    }
+}
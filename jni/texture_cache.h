@@ -0,0 +1,68 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include "loader_thread.h"
+
+// Shares the textures loaded from the same file. AcquireTexture loads a texture the first time it
+// is asked for and hands out the same handle after that, counting the references; ReleaseTexture
+// drops one, and the last one deletes the texture (see DeleteTexture). Textures are keyed by file
+// name, loader and options. With content hashing on, a file not loaded under its name yet is
+// hashed first, and shares the texture of any file with the same bytes loaded with the same loader
+// and options.
+//
+// The cache doesn't keep a texture alive by itself, and must be used on the render thread.
+
+typedef struct
+{
+    unsigned int mEntryCount;       // File names cached
+    unsigned int mTextureCount;     // Textures they share
+    unsigned int mHits;             // Acquires that found the name
+    unsigned int mContentHits;      // Acquires that found the same bytes under another name
+    unsigned int mMisses;           // Acquires that loaded a texture
+} TextureCacheStats;
+
+// Returns the texture loaded from the file with the loader and options given (pOptions may be
+// NULL), loading it if it isn't cached. Each call takes a reference to release. Returns 0 if the
+// texture couldn't be loaded, which isn't cached.
+GLuint AcquireTexture( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions );
+
+// Drops a reference to a texture returned by AcquireTexture, deleting it with the last one
+void ReleaseTexture( GLuint handle );
+
+// Sets whether files not cached under their name are hashed to find identical ones, off by default.
+// Hashing reads a file once more on a miss.
+void SetTextureCacheContentHashing( int enable );
+
+// Forgets every cached texture without deleting them, e.g. once their context is lost
+void ResetTextureCache();
+
+void GetTextureCacheStats( TextureCacheStats* pStats );
@@ -0,0 +1,339 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <android/log.h>
+
+#include "texture_memory.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Debugging helper functions
+#define  LogWarning(...)  __android_log_print( ANDROID_LOG_WARN, "TextureLoader", __VA_ARGS__ )
+
+static pthread_mutex_t      gTextureMemoryMutex = PTHREAD_MUTEX_INITIALIZER;
+static TextureMemoryInfo*   gpEntries = NULL;       // Unordered, entries are moved when one is removed
+static unsigned int         gEntryCount = 0;
+static unsigned int         gEntryCapacity = 0;
+static TextureMemoryTotals  gTotals;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the bytes of one block of a compressed format and its size in texels, or 0 if the
+// format isn't a compressed one
+static int GetBlockLayout( GLenum internalFormat, int* pBlockWidth, int* pBlockHeight )
+{
+    *pBlockWidth = 4;
+    *pBlockHeight = 4;
+
+    switch( internalFormat )
+    {
+        case GL_ETC1_RGB8_OES:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_R11_EAC:
+        case GL_COMPRESSED_SIGNED_R11_EAC:
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:
+        case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG:
+        {
+            return 8;
+        }
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        case GL_COMPRESSED_RG11_EAC:
+        case GL_COMPRESSED_SIGNED_RG11_EAC:
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        {
+            return 16;
+        }
+        case GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:
+        case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG:
+        {
+            *pBlockWidth = 8;
+            return 8;
+        }
+        default:
+        {
+            return 0;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the bytes a texel of an uncompressed format takes in video memory
+static int GetTexelBytes( GLenum internalFormat, GLenum type )
+{
+    switch( type )
+    {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+        {
+            return 2;
+        }
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        {
+            return 4;
+        }
+    }
+
+    switch( internalFormat )
+    {
+        case GL_ALPHA:
+        case GL_LUMINANCE:
+        case GL_RED:
+        case GL_R8:
+        {
+            return 1;
+        }
+        case GL_LUMINANCE_ALPHA:
+        case GL_RG:
+        case GL_RG8:
+        case GL_RGB565:
+        case GL_RGBA4:
+        case GL_RGB5_A1:
+        {
+            return 2;
+        }
+        case GL_RGBA16F:
+        {
+            return 8;
+        }
+        case GL_RGBA32F:
+        {
+            return 16;
+        }
+        default:
+        {
+            // RGB(A)8 and the 32-bit packed formats; GPUs store 3 channels in 4 bytes
+            return 4;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EstimateTextureBytes
+size_t EstimateTextureBytes( GLenum internalFormat, GLenum type, int width, int height, int levelCount )
+{
+    int blockWidth, blockHeight;
+    int blockBytes = GetBlockLayout( internalFormat, &blockWidth, &blockHeight );
+    int texelBytes = blockBytes == 0 ? GetTexelBytes( internalFormat, type ) : 0;
+    size_t bytes = 0;
+    int level;
+
+    for( level = 0; level < levelCount; ++level )
+    {
+        if( blockBytes != 0 )
+        {
+            size_t blocksX = ( width + blockWidth - 1 ) / blockWidth;
+            size_t blocksY = ( height + blockHeight - 1 ) / blockHeight;
+
+            // PVRTC levels are never smaller than 2x2 blocks
+            if( internalFormat >= GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG && internalFormat <= GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG )
+            {
+                blocksX = blocksX < 2 ? 2 : blocksX;
+                blocksY = blocksY < 2 ? 2 : blocksY;
+            }
+            bytes += blocksX * blocksY * blockBytes;
+        }
+        else
+        {
+            bytes += (size_t)width * height * texelBytes;
+        }
+
+        width = width > 1 ? width >> 1 : 1;
+        height = height > 1 ? height >> 1 : 1;
+    }
+    return bytes;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the index of a handle's entry, or -1. Called with gTextureMemoryMutex held.
+static int FindEntry( GLuint handle )
+{
+    unsigned int i;
+
+    for( i = 0; i < gEntryCount; ++i )
+    {
+        if( gpEntries[i].mHandle == handle )
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Removes the entry at 'index' from the totals and the table. Called with gTextureMemoryMutex held.
+static void RemoveEntry( int index )
+{
+    gTotals.mGpuBytes -= gpEntries[index].mGpuBytes;
+    gTotals.mSourceBytes -= gpEntries[index].mSourceBytes;
+    --gTotals.mTextureCount;
+
+    gpEntries[index] = gpEntries[--gEntryCount];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RegisterTexture
+void RegisterTexture( TextureMemoryInfo* pInfo )
+{
+    int index;
+    size_t totalBytes, budget;
+
+    pInfo->mGpuBytes = EstimateTextureBytes( pInfo->mInternalFormat, pInfo->mType, pInfo->mWidth, pInfo->mHeight,
+                                             pInfo->mLevelCount ) * ( pInfo->mLayerCount > 1 ? pInfo->mLayerCount : 1 );
+
+    pthread_mutex_lock( &gTextureMemoryMutex );
+
+    // GL reuses the names of deleted textures
+    index = FindEntry( pInfo->mHandle );
+    if( index >= 0 )
+    {
+        RemoveEntry( index );
+    }
+
+    if( gEntryCount == gEntryCapacity )
+    {
+        unsigned int capacity = gEntryCapacity != 0 ? gEntryCapacity * 2 : 64;
+        TextureMemoryInfo* pEntries = (TextureMemoryInfo*)realloc( gpEntries, capacity * sizeof(TextureMemoryInfo) );
+
+        if( pEntries == NULL )
+        {
+            pthread_mutex_unlock( &gTextureMemoryMutex );
+            return;
+        }
+        gpEntries = pEntries;
+        gEntryCapacity = capacity;
+    }
+    gpEntries[gEntryCount++] = *pInfo;
+
+    ++gTotals.mTextureCount;
+    gTotals.mGpuBytes += pInfo->mGpuBytes;
+    gTotals.mSourceBytes += pInfo->mSourceBytes;
+    if( gTotals.mGpuBytes > gTotals.mPeakGpuBytes )
+    {
+        gTotals.mPeakGpuBytes = gTotals.mGpuBytes;
+    }
+    if( pInfo->mCpuPeakBytes > gTotals.mCpuPeakBytes )
+    {
+        gTotals.mCpuPeakBytes = pInfo->mCpuPeakBytes;
+    }
+    totalBytes = gTotals.mGpuBytes;
+    budget = gTotals.mGpuBudget;
+
+    pthread_mutex_unlock( &gTextureMemoryMutex );
+
+    if( budget != 0 && totalBytes > budget )
+    {
+        LogWarning( "%s: %u KB of textures loaded, over the %u KB budget\n", pInfo->mName,
+                    (unsigned int)( totalBytes >> 10 ), (unsigned int)( budget >> 10 ) );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UnregisterTexture
+void UnregisterTexture( GLuint handle )
+{
+    int index;
+
+    pthread_mutex_lock( &gTextureMemoryMutex );
+    index = FindEntry( handle );
+    if( index >= 0 )
+    {
+        RemoveEntry( index );
+    }
+    pthread_mutex_unlock( &gTextureMemoryMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResetTextureMemory
+void ResetTextureMemory()
+{
+    size_t budget;
+
+    pthread_mutex_lock( &gTextureMemoryMutex );
+    budget = gTotals.mGpuBudget;
+    free( gpEntries );
+    gpEntries = NULL;
+    gEntryCount = 0;
+    gEntryCapacity = 0;
+    memset( &gTotals, 0, sizeof(gTotals) );
+    gTotals.mGpuBudget = budget;
+    pthread_mutex_unlock( &gTextureMemoryMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetTextureMemoryInfo
+int GetTextureMemoryInfo( GLuint handle, TextureMemoryInfo* pInfo )
+{
+    int index;
+
+    pthread_mutex_lock( &gTextureMemoryMutex );
+    index = FindEntry( handle );
+    if( index >= 0 )
+    {
+        *pInfo = gpEntries[index];
+    }
+    pthread_mutex_unlock( &gTextureMemoryMutex );
+
+    return index >= 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GetTextureMemoryTotals
+void GetTextureMemoryTotals( TextureMemoryTotals* pTotals )
+{
+    pthread_mutex_lock( &gTextureMemoryMutex );
+    *pTotals = gTotals;
+    pthread_mutex_unlock( &gTextureMemoryMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SetTextureMemoryBudget
+void SetTextureMemoryBudget( size_t bytes )
+{
+    pthread_mutex_lock( &gTextureMemoryMutex );
+    gTotals.mGpuBudget = bytes;
+    pthread_mutex_unlock( &gTextureMemoryMutex );
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include "texture.h"
+
+// What one loaded texture costs. The loaders register every texture they create, so the totals
+// cover everything they loaded and haven't had unregistered.
+typedef struct
+{
+    GLuint       mHandle;
+    GLenum       mInternalFormat;   // As given to glTexImage2D/glCompressedTexImage2D
+    GLenum       mType;             // Pixel type of uncompressed formats, 0 for compressed ones
+    int          mWidth;
+    int          mHeight;
+    int          mLevelCount;       // Mip levels, including the ones glGenerateMipmap builds
+    int          mLayerCount;       // Cube faces times array layers, 1 for a 2D texture
+    size_t       mGpuBytes;         // Estimated video memory, filled in by RegisterTexture
+    size_t       mCpuPeakBytes;     // Transient CPU (and pixel buffer) memory the load needed at its peak
+    size_t       mSourceBytes;      // Bytes read from the file it was loaded from
+    char         mName[64];         // File name, truncated
+} TextureMemoryInfo;
+
+typedef struct
+{
+    unsigned int mTextureCount;
+    size_t       mGpuBytes;         // Sum over the registered textures
+    size_t       mPeakGpuBytes;     // High-water mark of mGpuBytes
+    size_t       mCpuPeakBytes;     // Largest transient CPU peak of a single load
+    size_t       mSourceBytes;      // Sum over the registered textures
+    size_t       mGpuBudget;        // See SetTextureMemoryBudget, 0 if none
+} TextureMemoryTotals;
+
+// Estimates the video memory of a texture from its format and mip chain: whole blocks for
+// compressed formats, and the usual padding of 3 channel formats to 4 bytes a texel. Drivers add
+// their own alignment, so this is a lower bound rather than an exact figure.
+size_t EstimateTextureBytes( GLenum internalFormat, GLenum type, int width, int height, int levelCount );
+
+// Adds (or replaces) the entry for pInfo->mHandle, computing pInfo->mGpuBytes first
+void RegisterTexture( TextureMemoryInfo* pInfo );
+
+// Removes a texture's entry, call it with glDeleteTextures. Unknown handles are ignored.
+void UnregisterTexture( GLuint handle );
+
+// Forgets every entry and the totals, but not the budget, once the context the textures were in
+// is lost and took them with it
+void ResetTextureMemory();
+
+// Copies the entry of a texture, returns 0 if it isn't registered
+int GetTextureMemoryInfo( GLuint handle, TextureMemoryInfo* pInfo );
+
+void GetTextureMemoryTotals( TextureMemoryTotals* pTotals );
+
+// Sets the video memory the textures should fit in (0 for no limit). Registering a texture that
+// takes the total past it logs a warning; the textures managed by texture_residency.h are reloaded
+// with fewer levels, or evicted when unused, to bring the total back under it.
+void SetTextureMemoryBudget( size_t bytes );
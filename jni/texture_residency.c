@@ -0,0 +1,555 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <android/log.h>
+
+#include "gl_state.h"
+#include "texture.h"
+#include "texture_memory.h"
+#include "texture_residency.h"
+#include "upload_scheduler.h"
+
+#define  LogInfo(...)  __android_log_print( ANDROID_LOG_INFO, "TextureLoader", __VA_ARGS__ )
+
+// A texture slot whose residency is managed
+typedef struct
+{
+    GLuint*             pHandle;
+    GLuint              mHandle;        // Texture last seen in the slot
+    GLuint              mPlaceholder;   // Texture in the slot when it was first managed, shown while evicted
+    int                 mOwned;         // mHandle was loaded here, and is deleted when it is replaced
+    int                 mPending;       // A load into the slot is queued
+    int                 mFailedLoads;   // Loads in a row that failed
+    unsigned int        mRetryFrame;    // Frame from which a failed reload may be tried again
+    int                 mEvicted;       // The slot holds its placeholder, until it is bound again
+    int                 mEvict;         // The budget evicts it this frame
+    unsigned int        mLastUsedFrame; // Frame it was last bound in
+    char*               pName;
+    TextureLoadFunction pLoad;
+    TextureOptions      mOptions;
+    unsigned int        mLargest;       // Largest dimension of the first texture loaded, 0 until it is
+    int                 mWidth;         // Of the first texture loaded, whose levels residency counts
+    int                 mHeight;
+    int                 mLevelCount;
+    GLenum              mFormat;
+    GLenum              mType;
+    int                 mReloadable;    // Cleared once a reload doesn't start at the level asked for
+    int                 mLoadedLevel;   // Level the texture in the slot starts at
+    int                 mRequestedLevel;    // Level the queued reload starts at
+    int                 mBaseLevel;     // GL_TEXTURE_BASE_LEVEL set on it
+    int                 mNeededLevel;   // Finest level reported this frame, -1 if none was
+    int                 mWantedLevel;
+    int                 mTargetLevel;   // mWantedLevel, or coarser to meet the memory budget
+    int                 mDropFrames;    // Frames in a row a coarser level was enough
+} ResidentTexture;
+
+static ResidentTexture* gpResidentTextures = NULL;
+static int              gResidentCount = 0;
+static int              gResidentCapacity = 0;
+static int              gViewportWidth = 1;
+static int              gViewportHeight = 1;
+static ResidencyStats   gResidencyStats = { 0 };
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the entry of a slot, or NULL
+static ResidentTexture* FindResidentTexture( const GLuint* pHandle )
+{
+    int index;
+
+    for( index = 0; index < gResidentCount; ++index )
+    {
+        if( gpResidentTextures[index].pHandle == pHandle )
+        {
+            return &gpResidentTextures[index];
+        }
+    }
+    return NULL;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Estimated video memory of a texture starting at the given level
+static size_t GetLevelBytes( const ResidentTexture* pTexture, int level )
+{
+    int width = pTexture->mWidth >> level;
+    int height = pTexture->mHeight >> level;
+
+    return EstimateTextureBytes( pTexture->mFormat, pTexture->mType, width > 0 ? width : 1, height > 0 ? height : 1,
+                                 pTexture->mLevelCount - level );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Starts managing a slot and queues its first load
+int ManageTextureResidency( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions,
+                            GLuint* pHandle )
+{
+    ResidentTexture* pTexture = FindResidentTexture( pHandle );
+
+    if( pTexture == NULL )
+    {
+        if( gResidentCount == gResidentCapacity )
+        {
+            int capacity = gResidentCapacity > 0 ? gResidentCapacity * 2 : 8;
+            ResidentTexture* pEntries = (ResidentTexture*)realloc( gpResidentTextures, capacity * sizeof(ResidentTexture) );
+
+            if( pEntries == NULL )
+            {
+                return QueueTextureLoad( TextureFileName, pLoad, pOptions, pHandle );
+            }
+            gpResidentTextures = pEntries;
+            gResidentCapacity = capacity;
+        }
+        pTexture = &gpResidentTextures[gResidentCount++];
+    }
+    else
+    {
+        free( pTexture->pName );
+    }
+
+    memset( pTexture, 0, sizeof(*pTexture) );
+    pTexture->pHandle = pHandle;
+    pTexture->mHandle = *pHandle;
+    pTexture->mPlaceholder = *pHandle;
+    pTexture->mLastUsedFrame = gResidencyStats.mFrame;
+    pTexture->pName = strdup( TextureFileName );
+    pTexture->pLoad = pLoad;
+    if( pOptions != NULL )
+    {
+        pTexture->mOptions = *pOptions;
+    }
+    // HDR files always load at full size
+    pTexture->mReloadable = pLoad != LoadTextureHDREx;
+    pTexture->mNeededLevel = -1;
+
+    pTexture->mPending = QueueTextureLoad( TextureFileName, pLoad, pOptions, pHandle );
+    return pTexture->mPending;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sets the size of the viewport
+void SetResidencyViewport( int width, int height )
+{
+    gViewportWidth = width > 0 ? width : 1;
+    gViewportHeight = height > 0 ? height : 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Works out the finest level the triangles can sample
+//
+// Across a triangle the texel coordinates are an affine function of the pixel coordinates, its
+// derivatives follow from two edges. The largest of them, in texels per pixel, is the scale GL
+// picks the level from (log2 of it), as long as the triangles are drawn without perspective.
+void ReportTextureFootprint( const GLuint* pHandle, const float* pPositions, const float* pTexCoords, int stride,
+                             int vertexCount )
+{
+    ResidentTexture* pTexture = FindResidentTexture( pHandle );
+    float scale = 0.0f;
+    int vertex;
+    int level;
+
+    if( pTexture == NULL || pTexture->mLargest == 0 )
+    {
+        return;
+    }
+
+    for( vertex = 0; vertex + 2 < vertexCount; vertex += 3 )
+    {
+        float x[3], y[3], u[3], v[3];
+        float determinant, dudx, dvdx, dudy, dvdy, scaleX, scaleY;
+        int corner;
+
+        for( corner = 0; corner < 3; ++corner )
+        {
+            const float* pPosition = (const float*)( (const char*)pPositions + ( vertex + corner ) * stride );
+            const float* pTexCoord = (const float*)( (const char*)pTexCoords + ( vertex + corner ) * stride );
+
+            x[corner] = ( pPosition[0] + 1.0f ) * 0.5f * gViewportWidth;
+            y[corner] = ( pPosition[1] + 1.0f ) * 0.5f * gViewportHeight;
+            u[corner] = pTexCoord[0] * pTexture->mWidth;
+            v[corner] = pTexCoord[1] * pTexture->mHeight;
+        }
+
+        determinant = ( x[1] - x[0] ) * ( y[2] - y[0] ) - ( x[2] - x[0] ) * ( y[1] - y[0] );
+        if( fabsf( determinant ) < 1e-6f )
+        {
+            continue;
+        }
+        dudx = ( ( u[1] - u[0] ) * ( y[2] - y[0] ) - ( u[2] - u[0] ) * ( y[1] - y[0] ) ) / determinant;
+        dvdx = ( ( v[1] - v[0] ) * ( y[2] - y[0] ) - ( v[2] - v[0] ) * ( y[1] - y[0] ) ) / determinant;
+        dudy = ( ( u[2] - u[0] ) * ( x[1] - x[0] ) - ( u[1] - u[0] ) * ( x[2] - x[0] ) ) / determinant;
+        dvdy = ( ( v[2] - v[0] ) * ( x[1] - x[0] ) - ( v[1] - v[0] ) * ( x[2] - x[0] ) ) / determinant;
+
+        scaleX = sqrtf( dudx * dudx + dvdx * dvdx );
+        scaleY = sqrtf( dudy * dudy + dvdy * dvdy );
+        scale = fmaxf( scale, fmaxf( scaleX, scaleY ) );
+    }
+
+    // Rounded down, so the level sampled is never finer than the one kept
+    level = scale > 1.0f ? (int)floorf( log2f( scale ) ) : 0;
+    if( level > pTexture->mLevelCount - 1 )
+    {
+        level = pTexture->mLevelCount - 1;
+    }
+    if( pTexture->mNeededLevel < 0 || level < pTexture->mNeededLevel )
+    {
+        pTexture->mNeededLevel = level;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Picks up the texture a load stored in the slot, deleting the one it replaces. A load that
+// finished without storing one failed: the slot keeps what it has, and waits longer with each
+// failure in a row before it is reloaded again.
+static void AdoptPublishedTexture( ResidentTexture* pTexture )
+{
+    TextureMemoryInfo info;
+
+    if( *pTexture->pHandle == pTexture->mHandle )
+    {
+        if( pTexture->mPending && !IsTextureLoadPending( pTexture->pHandle ) )
+        {
+            int backOff = pTexture->mFailedLoads < 3 ? pTexture->mFailedLoads : 3;
+
+            LogInfo( "Loading %s failed, retrying in %d frames", pTexture->pName, RESIDENCY_RETRY_FRAMES << backOff );
+            pTexture->mPending = 0;
+            pTexture->mFailedLoads++;
+            pTexture->mRetryFrame = gResidencyStats.mFrame + ( RESIDENCY_RETRY_FRAMES << backOff );
+            gResidencyStats.mFailedLoads++;
+        }
+        return;
+    }
+
+    if( pTexture->mOwned )
+    {
+        DeleteTexture( pTexture->mHandle );
+    }
+    pTexture->mHandle = *pTexture->pHandle;
+    pTexture->mOwned = 1;
+    pTexture->mPending = 0;
+    pTexture->mFailedLoads = 0;
+    pTexture->mEvicted = 0;
+    pTexture->mBaseLevel = 0;
+
+    if( !GetTextureMemoryInfo( pTexture->mHandle, &info ) || info.mLayerCount != 1 )
+    {
+        // Nothing to count levels of, e.g. a cube map
+        pTexture->mLargest = 0;
+        return;
+    }
+
+    if( pTexture->mLargest == 0 )
+    {
+        pTexture->mLargest = info.mWidth > info.mHeight ? info.mWidth : info.mHeight;
+        pTexture->mWidth = info.mWidth;
+        pTexture->mHeight = info.mHeight;
+        pTexture->mLevelCount = info.mLevelCount;
+        pTexture->mFormat = info.mInternalFormat;
+        pTexture->mType = info.mType;
+        pTexture->mLoadedLevel = 0;
+    }
+    else
+    {
+        unsigned int largest = info.mWidth > info.mHeight ? info.mWidth : info.mHeight;
+        int level = 0;
+
+        while( level < 31 && ( pTexture->mLargest >> level ) > largest )
+        {
+            ++level;
+        }
+        pTexture->mLoadedLevel = level;
+
+        // The loader couldn't skip levels (or a resolution cap skipped more), no use asking again
+        if( level != pTexture->mRequestedLevel )
+        {
+            pTexture->mReloadable = 0;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Follows the level reported this frame: finer ones at once, coarser ones once they have lasted
+static void UpdateWantedLevel( ResidentTexture* pTexture )
+{
+    int needed = pTexture->mNeededLevel;
+
+    pTexture->mNeededLevel = -1;
+    if( needed < 0 )
+    {
+        // Not drawn, it keeps what it has
+        pTexture->mDropFrames = 0;
+    }
+    else if( needed <= pTexture->mWantedLevel )
+    {
+        pTexture->mWantedLevel = needed;
+        pTexture->mDropFrames = 0;
+    }
+    else if( ++pTexture->mDropFrames >= RESIDENCY_DROP_FRAMES )
+    {
+        pTexture->mWantedLevel = needed;
+        pTexture->mDropFrames = 0;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Reloads a texture starting at the given level
+static void ReloadTexture( ResidentTexture* pTexture, int level )
+{
+    TextureOptions options = pTexture->mOptions;
+    unsigned int largest = pTexture->mLargest >> level;
+
+    // Leaving out the top levels of compressed files, decoding JPEGs smaller
+    options.mMaxDimension = largest > 0 ? largest : 1;
+    pTexture->mRequestedLevel = level;
+    pTexture->mPending = QueueTextureLoad( pTexture->pName, pTexture->pLoad, &options, pTexture->pHandle );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletes a texture to meet the budget, its slot shows the placeholder until it is bound again
+static void EvictTexture( ResidentTexture* pTexture )
+{
+    LogInfo( "Evicting %s, unused for %u frames, %u bytes", pTexture->pName,
+             gResidencyStats.mFrame - pTexture->mLastUsedFrame, (unsigned int)GetLevelBytes( pTexture, pTexture->mLoadedLevel ) );
+
+    DeleteTexture( pTexture->mHandle );
+    *pTexture->pHandle = pTexture->mPlaceholder;
+    pTexture->mHandle = pTexture->mPlaceholder;
+    pTexture->mOwned = 0;
+    pTexture->mEvicted = 1;
+    pTexture->mEvict = 0;
+    gResidencyStats.mEvictions++;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Binds the texture in a slot, reloading it if the budget evicted it
+void BindResidentTexture( GLuint* pHandle )
+{
+    ResidentTexture* pTexture = FindResidentTexture( pHandle );
+
+    if( pTexture != NULL )
+    {
+        pTexture->mLastUsedFrame = gResidencyStats.mFrame;
+        if( pTexture->mEvicted && !pTexture->mPending && gResidencyStats.mFrame >= pTexture->mRetryFrame )
+        {
+            ReloadTexture( pTexture, pTexture->mReloadable ? pTexture->mWantedLevel : 0 );
+            gResidencyStats.mReloads++;
+        }
+    }
+
+    CachedBindTexture( GL_TEXTURE_2D, *pHandle );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Video memory the texture in a slot is going to take: its target levels if it can be reloaded
+// with them, otherwise the levels it has
+static size_t GetProjectedBytes( const ResidentTexture* pTexture )
+{
+    if( pTexture->mEvicted || pTexture->mEvict )
+    {
+        return 0;
+    }
+    return GetLevelBytes( pTexture, pTexture->mReloadable ? pTexture->mTargetLevel : pTexture->mLoadedLevel );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Keeps the levels of every managed texture to what it needs
+void UpdateTextureResidency()
+{
+    TextureMemoryTotals totals;
+    size_t projected;
+    int overBudget;
+    int index;
+
+    // The textures reloads replace are deleted before the totals are taken
+    for( index = 0; index < gResidentCount; ++index )
+    {
+        AdoptPublishedTexture( &gpResidentTextures[index] );
+    }
+
+    GetTextureMemoryTotals( &totals );
+    projected = totals.mGpuBytes;
+    overBudget = totals.mGpuBudget != 0 && totals.mGpuBytes > totals.mGpuBudget;
+    gResidencyStats.mFrame++;
+
+    // The memory the textures would take if each had only the levels it needs
+    for( index = 0; index < gResidentCount; ++index )
+    {
+        ResidentTexture* pTexture = &gpResidentTextures[index];
+
+        if( pTexture->mLargest == 0 )
+        {
+            continue;
+        }
+        UpdateWantedLevel( pTexture );
+        pTexture->mTargetLevel = pTexture->mWantedLevel;
+        pTexture->mEvict = 0;
+        if( pTexture->mReloadable && !pTexture->mEvicted )
+        {
+            projected = projected + GetLevelBytes( pTexture, pTexture->mTargetLevel ) - GetLevelBytes( pTexture, pTexture->mLoadedLevel );
+        }
+    }
+
+    // Over budget, the least recently used texture is evicted if it has been idle for long enough,
+    // or drops a level; among textures used as recently, the one costing the most goes first
+    while( totals.mGpuBudget != 0 && projected > totals.mGpuBudget )
+    {
+        ResidentTexture* pOldest = NULL;
+        size_t oldestBytes = 0;
+        size_t bytes;
+
+        for( index = 0; index < gResidentCount; ++index )
+        {
+            ResidentTexture* pTexture = &gpResidentTextures[index];
+            int idle = gResidencyStats.mFrame - pTexture->mLastUsedFrame >= RESIDENCY_IDLE_FRAMES;
+
+            if( pTexture->mLargest == 0 || !pTexture->mOwned || pTexture->mPending || pTexture->mEvict ||
+                ( !idle && !( pTexture->mReloadable && pTexture->mTargetLevel < pTexture->mLevelCount - 1 ) ) )
+            {
+                continue;
+            }
+            bytes = GetProjectedBytes( pTexture );
+            if( pOldest == NULL || pTexture->mLastUsedFrame < pOldest->mLastUsedFrame ||
+                ( pTexture->mLastUsedFrame == pOldest->mLastUsedFrame && bytes > oldestBytes ) )
+            {
+                pOldest = pTexture;
+                oldestBytes = bytes;
+            }
+        }
+        if( pOldest == NULL )
+        {
+            break;
+        }
+
+        if( gResidencyStats.mFrame - pOldest->mLastUsedFrame >= RESIDENCY_IDLE_FRAMES )
+        {
+            pOldest->mEvict = 1;
+            projected -= oldestBytes;
+        }
+        else
+        {
+            pOldest->mTargetLevel++;
+            projected -= oldestBytes - GetProjectedBytes( pOldest );
+        }
+    }
+
+    // Reload the textures missing levels they need, or holding memory the budget needs back, and
+    // clamp the others
+    for( index = 0; index < gResidentCount; ++index )
+    {
+        ResidentTexture* pTexture = &gpResidentTextures[index];
+        int target = pTexture->mTargetLevel;
+        int baseLevel;
+
+        if( pTexture->mLargest == 0 || pTexture->mPending || pTexture->mEvicted )
+        {
+            continue;
+        }
+
+        if( pTexture->mEvict )
+        {
+            EvictTexture( pTexture );
+            continue;
+        }
+
+        if( pTexture->mReloadable && gResidencyStats.mFrame >= pTexture->mRetryFrame &&
+            ( target < pTexture->mLoadedLevel || ( target > pTexture->mLoadedLevel && overBudget ) ) )
+        {
+            if( target < pTexture->mLoadedLevel )
+            {
+                gResidencyStats.mReloads++;
+            }
+            else
+            {
+                gResidencyStats.mLevelDrops++;
+            }
+            ReloadTexture( pTexture, target );
+            continue;
+        }
+
+        // The upload scheduler raises the base level as it uploads, the texture is clamped once it is done
+        baseLevel = target > pTexture->mLoadedLevel ? target - pTexture->mLoadedLevel : 0;
+        if( baseLevel != pTexture->mBaseLevel && !IsTextureUploadScheduled( pTexture->mHandle ) )
+        {
+            CachedBindTexture( GL_TEXTURE_2D, pTexture->mHandle );
+            CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel );
+            pTexture->mBaseLevel = baseLevel;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Forgets every managed slot
+void ResetTextureResidency()
+{
+    int index;
+
+    for( index = 0; index < gResidentCount; ++index )
+    {
+        free( gpResidentTextures[index].pName );
+    }
+    free( gpResidentTextures );
+    gpResidentTextures = NULL;
+    gResidentCount = 0;
+    gResidentCapacity = 0;
+    memset( &gResidencyStats, 0, sizeof(gResidencyStats) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the residency counters, and the textures resident now
+void GetResidencyStats( ResidencyStats* pStats )
+{
+    int index;
+
+    *pStats = gResidencyStats;
+    pStats->mManagedCount = gResidentCount;
+    pStats->mResidentCount = 0;
+    pStats->mResidentBytes = 0;
+    for( index = 0; index < gResidentCount; ++index )
+    {
+        TextureMemoryInfo info;
+
+        if( gpResidentTextures[index].mOwned && GetTextureMemoryInfo( gpResidentTextures[index].mHandle, &info ) )
+        {
+            pStats->mResidentCount++;
+            pStats->mResidentBytes += info.mGpuBytes;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <GLES3/gl3.h>
+
+#include "loader_thread.h"
+
+// Screen-space driven mip residency under a video memory budget. A managed texture is loaded into
+// a handle slot, like QueueTextureLoad does; the renderer binds it with BindResidentTexture, which
+// records the frame it was last used in, and reports the geometry it draws it with. Its footprint
+// in the viewport gives the finest mip level sampling can pick, and UpdateTextureResidency keeps
+// each texture to what it needs:
+//  - GL_TEXTURE_BASE_LEVEL is clamped to the finest level needed, so larger levels that are
+//    loaded aren't sampled, and can be restored at once when the texture grows on screen again
+//  - when the textures are over the video memory budget (see SetTextureMemoryBudget), the ones
+//    holding larger levels than they need are reloaded without them. Then, least recently used
+//    first, textures unused for RESIDENCY_IDLE_FRAMES are evicted and the others drop a level at a
+//    time, until the budget is met. An evicted texture's slot gets its placeholder back (the
+//    handle it held when it was first managed) and is reloaded the next time it is bound.
+//  - a texture that needs levels it doesn't have is reloaded with them
+// A reload replaces the texture in its slot once PublishLoadedTextures stores it there, and the
+// texture it replaces is deleted. Smaller levels become wanted at once, larger ones only after
+// RESIDENCY_DROP_FRAMES frames in a row, so a texture doesn't keep being reloaded as it animates.
+// A reload that fails (e.g. its file is gone) leaves the slot as it was, and is tried again after
+// RESIDENCY_RETRY_FRAMES, then twice as long after each further failure, up to 8 times as long.
+//
+// Residency only works in whole levels of the first texture loaded into a slot; textures whose
+// loader can't skip levels (HDR) are only ever clamped or evicted. Evictions are logged, and
+// GetResidencyStats counts every decision, for tuning the budget. Everything here must be called
+// on the render thread.
+
+// Frames a texture must need fewer levels before the larger ones are dropped
+#define RESIDENCY_DROP_FRAMES   30
+
+// Frames a texture must go unused before the budget may evict it rather than drop its top levels
+#define RESIDENCY_IDLE_FRAMES   120
+
+// Frames a slot waits after a failed load before it is reloaded again
+#define RESIDENCY_RETRY_FRAMES  60
+
+typedef struct
+{
+    unsigned int mFrame;            // UpdateTextureResidency calls so far
+    unsigned int mManagedCount;     // Slots managed
+    unsigned int mResidentCount;    // Of those, slots holding their own texture (loaded, not evicted)
+    size_t       mResidentBytes;    // Estimated video memory of those textures
+    unsigned int mEvictions;        // Textures deleted to meet the budget
+    unsigned int mLevelDrops;       // Reloads with fewer levels, to meet the budget
+    unsigned int mReloads;          // Reloads with more levels, or after an eviction
+    unsigned int mFailedLoads;      // Loads that didn't store a texture in their slot
+} ResidencyStats;
+
+// Starts managing the texture in *pHandle and queues its first load (see QueueTextureLoad).
+// *pHandle must stay valid until ResetTextureResidency. Returns 0 if the load couldn't be queued.
+int ManageTextureResidency( const char* TextureFileName, TextureLoadFunction pLoad, const TextureOptions* pOptions,
+                            GLuint* pHandle );
+
+// Binds the texture in a slot to GL_TEXTURE_2D and marks it used this frame. A slot whose texture
+// was evicted has it reloaded, its placeholder is bound until it is published.
+void BindResidentTexture( GLuint* pHandle );
+
+// Sets the size in pixels of the viewport the reported geometry is drawn to
+void SetResidencyViewport( int width, int height );
+
+// Reports that the texture in *pHandle is drawn with a list of triangles: 'vertexCount' vertices,
+// 'stride' bytes apart, with their x, y position in normalized device coordinates at pPositions
+// and their u, v texture coordinates at pTexCoords
+void ReportTextureFootprint( const GLuint* pHandle, const float* pPositions, const float* pTexCoords, int stride,
+                             int vertexCount );
+
+// Applies the footprints reported since the last call. Call it once a frame, after
+// PublishLoadedTextures.
+void UpdateTextureResidency();
+
+// Stops managing every texture, leaving the textures as they are, e.g. before they are loaded
+// again for a new context
+void ResetTextureResidency();
+
+void GetResidencyStats( ResidencyStats* pStats );
@@ -0,0 +1,343 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <EGL/egl.h>
+
+#include "gl_caps.h"
+#include "gl_state.h"
+#include "upload.h"
+
+// Buffers grow in steps of this size, so slightly larger textures don't reallocate them each time
+#define UPLOAD_BUFFER_GRANULARITY   ( 256 * 1024 )
+
+// How long one wait for a fence lasts before it is retried
+#define UPLOAD_FENCE_TIMEOUT        100000000ull
+
+typedef struct
+{
+    GLuint mBuffer;
+    size_t mCapacity;
+    GLsync mFence;      // Signalled once the uploads last sourced from the buffer are done
+} UploadSlot;
+
+// Every thread uploading with its own context (e.g. the loader thread) has a ring of its own
+static __thread UploadSlot      gUploadSlots[UPLOAD_RING_MAX_BUFFERS];
+static __thread unsigned int    gUploadSlotCount = UPLOAD_RING_DEFAULT_BUFFERS;
+static __thread unsigned int    gNextUploadSlot = 0;
+static __thread EGLContext      gUploadContext = EGL_NO_CONTEXT;
+
+// The stats are read from other threads
+static pthread_mutex_t gUploadStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+static UploadRingStats gUploadStats;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Monotonic time in nanoseconds
+static unsigned long long GetNanoseconds()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletes the GL objects of a slot
+static void DeleteSlot( UploadSlot* pSlot )
+{
+    if( pSlot->mFence != 0 )
+    {
+        glDeleteSync( pSlot->mFence );
+    }
+    if( pSlot->mBuffer != 0 )
+    {
+        CachedDeleteBuffers( 1, &pSlot->mBuffer );
+    }
+
+    pthread_mutex_lock( &gUploadStatsMutex );
+    gUploadStats.mBufferBytes -= pSlot->mCapacity;
+    pthread_mutex_unlock( &gUploadStatsMutex );
+
+    memset( pSlot, 0, sizeof(*pSlot) );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Forgets the ring buffers when the current context isn't the one they were created in. They
+// were destroyed with their context, and their names may mean something else in this one. The GL
+// state cache is left alone: whoever made the context current reset it, and may have made state
+// known since (e.g. the loader thread's active unit).
+static void CheckUploadContext()
+{
+    EGLContext context = eglGetCurrentContext();
+    size_t capacity = 0;
+    unsigned int slot;
+
+    if( context != gUploadContext )
+    {
+        for( slot = 0; slot < UPLOAD_RING_MAX_BUFFERS; ++slot )
+        {
+            capacity += gUploadSlots[slot].mCapacity;
+        }
+        memset( gUploadSlots, 0, sizeof(gUploadSlots) );
+        gNextUploadSlot = 0;
+        gUploadContext = context;
+
+        pthread_mutex_lock( &gUploadStatsMutex );
+        gUploadStats.mBufferBytes -= capacity;
+        pthread_mutex_unlock( &gUploadStatsMutex );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Waits for the GPU to finish the uploads last sourced from a slot's buffer
+static void WaitForSlot( UploadSlot* pSlot )
+{
+    GLenum status;
+
+    if( pSlot->mFence == 0 )
+    {
+        return;
+    }
+
+    status = glClientWaitSync( pSlot->mFence, 0, 0 );
+    if( status == GL_TIMEOUT_EXPIRED )
+    {
+        unsigned long long start = GetNanoseconds();
+
+        // The flush makes sure the fence reaches the GPU, or the wait may never end
+        do
+        {
+            status = glClientWaitSync( pSlot->mFence, GL_SYNC_FLUSH_COMMANDS_BIT, UPLOAD_FENCE_TIMEOUT );
+        } while( status == GL_TIMEOUT_EXPIRED );
+
+        pthread_mutex_lock( &gUploadStatsMutex );
+        gUploadStats.mStalls++;
+        gUploadStats.mStallNanoseconds += GetNanoseconds() - start;
+        pthread_mutex_unlock( &gUploadStatsMutex );
+    }
+
+    glDeleteSync( pSlot->mFence );
+    pSlot->mFence = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Maps a region of 'size' bytes in the next ring buffer, or a buffer of its own when too large
+int BeginUpload( size_t size, int readable, UploadRegion* pRegion )
+{
+    GLbitfield access;
+
+    memset( pRegion, 0, sizeof(*pRegion) );
+    pRegion->mSlot = -1;
+    pRegion->mSize = size;
+    if( size == 0 || !GetGlCaps()->mPixelBufferObjects )
+    {
+        return 0;
+    }
+
+    CheckUploadContext();
+
+    if( size > UPLOAD_RING_MAX_BUFFER_SIZE )
+    {
+        glGenBuffers( 1, &pRegion->mBuffer );
+        CachedBindBuffer( GL_PIXEL_UNPACK_BUFFER, pRegion->mBuffer );
+        glBufferData( GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW );
+    }
+    else
+    {
+        UploadSlot* pSlot = &gUploadSlots[gNextUploadSlot];
+
+        pRegion->mSlot = gNextUploadSlot;
+        gNextUploadSlot = ( gNextUploadSlot + 1 ) % gUploadSlotCount;
+
+        WaitForSlot( pSlot );
+        if( pSlot->mBuffer == 0 )
+        {
+            glGenBuffers( 1, &pSlot->mBuffer );
+        }
+        pRegion->mBuffer = pSlot->mBuffer;
+        CachedBindBuffer( GL_PIXEL_UNPACK_BUFFER, pSlot->mBuffer );
+
+        if( pSlot->mCapacity < size )
+        {
+            size_t capacity = ( size + UPLOAD_BUFFER_GRANULARITY - 1 ) & ~(size_t)( UPLOAD_BUFFER_GRANULARITY - 1 );
+
+            glBufferData( GL_PIXEL_UNPACK_BUFFER, capacity, NULL, GL_STREAM_DRAW );
+
+            pthread_mutex_lock( &gUploadStatsMutex );
+            gUploadStats.mBufferBytes += capacity - pSlot->mCapacity;
+            pthread_mutex_unlock( &gUploadStatsMutex );
+            pSlot->mCapacity = capacity;
+        }
+    }
+
+    // The fence says the GPU is done with the buffer, so a write only mapping needn't be synchronized.
+    // Reading a mapping without GL_MAP_READ_BIT is undefined, and read access rules out both flags.
+    access = readable ? GL_MAP_READ_BIT | GL_MAP_WRITE_BIT
+                      : GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+    pRegion->pData = glMapBufferRange( GL_PIXEL_UNPACK_BUFFER, 0, size, access );
+    if( pRegion->pData == NULL )
+    {
+        CachedBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+        if( pRegion->mSlot < 0 )
+        {
+            CachedDeleteBuffers( 1, &pRegion->mBuffer );
+        }
+        pRegion->mBuffer = 0;
+
+        pthread_mutex_lock( &gUploadStatsMutex );
+        gUploadStats.mFallbacks++;
+        pthread_mutex_unlock( &gUploadStatsMutex );
+        return 0;
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Unmaps a filled region, the upload calls come next
+int EndUpload( UploadRegion* pRegion )
+{
+    GLboolean intact = glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+
+    pRegion->pData = NULL;
+    pRegion->mStartTime = GetNanoseconds();
+    return intact;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Fences (or deletes) a region's buffer once the upload calls have been issued
+void FinishUpload( UploadRegion* pRegion )
+{
+    unsigned long long elapsed;
+
+    if( pRegion->mBuffer == 0 )
+    {
+        return;
+    }
+
+    CachedBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+    if( pRegion->mSlot >= 0 )
+    {
+        gUploadSlots[pRegion->mSlot].mFence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    }
+    else
+    {
+        // GL keeps the storage until the uploads from it are done
+        CachedDeleteBuffers( 1, &pRegion->mBuffer );
+    }
+    elapsed = GetNanoseconds() - pRegion->mStartTime;
+
+    pthread_mutex_lock( &gUploadStatsMutex );
+    gUploadStats.mBytes += pRegion->mSize;
+    gUploadStats.mIssueNanoseconds += elapsed;
+    gUploadStats.mUploads++;
+    pthread_mutex_unlock( &gUploadStatsMutex );
+
+    pRegion->mBuffer = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Releases a region nothing was uploaded from, its buffer needs no fence
+void CancelUpload( UploadRegion* pRegion )
+{
+    if( pRegion->mBuffer == 0 )
+    {
+        return;
+    }
+
+    if( pRegion->pData != NULL )
+    {
+        glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+        pRegion->pData = NULL;
+    }
+    CachedBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+    if( pRegion->mSlot < 0 )
+    {
+        CachedDeleteBuffers( 1, &pRegion->mBuffer );
+    }
+    pRegion->mBuffer = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Sets the number of ring buffers, deleting the ones no longer used
+void SetUploadRingSize( unsigned int bufferCount )
+{
+    unsigned int slot;
+
+    if( bufferCount < 1 )
+    {
+        bufferCount = 1;
+    }
+    if( bufferCount > UPLOAD_RING_MAX_BUFFERS )
+    {
+        bufferCount = UPLOAD_RING_MAX_BUFFERS;
+    }
+
+    CheckUploadContext();
+    for( slot = bufferCount; slot < UPLOAD_RING_MAX_BUFFERS; ++slot )
+    {
+        DeleteSlot( &gUploadSlots[slot] );
+    }
+    gUploadSlotCount = bufferCount;
+    gNextUploadSlot = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Deletes every ring buffer, the ring starts over on its next use
+void ShutdownUploadRing()
+{
+    unsigned int slot;
+
+    CheckUploadContext();
+    for( slot = 0; slot < UPLOAD_RING_MAX_BUFFERS; ++slot )
+    {
+        DeleteSlot( &gUploadSlots[slot] );
+    }
+    gNextUploadSlot = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the counters since the library was loaded
+void GetUploadRingStats( UploadRingStats* pStats )
+{
+    pthread_mutex_lock( &gUploadStatsMutex );
+    *pStats = gUploadStats;
+    pthread_mutex_unlock( &gUploadStatsMutex );
+}
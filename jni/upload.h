@@ -0,0 +1,98 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <GLES3/gl3.h>
+
+// Ring of pixel unpack buffers texture data is staged in on its way to GL. The loaders read or
+// decode straight into a mapped buffer and the gl*TexImage* calls source the data from offsets in
+// it, so the driver doesn't copy a client side array synchronously on the GL thread. Each buffer
+// is fenced after its uploads and only mapped again once the GPU has consumed them.
+//
+// Everything here must be called on the thread the GL context is current on, and each such thread
+// has a ring of its own. The memory of a mapped region may be filled by any thread (e.g. the
+// worker pool) until EndUpload. A ring notices when it is used with a new context and starts
+// over, the old context's buffers went with it.
+
+#define UPLOAD_RING_DEFAULT_BUFFERS     3
+#define UPLOAD_RING_MAX_BUFFERS         8
+
+// Regions larger than this get a buffer of their own, deleted after its upload, so the ring
+// doesn't keep that much GL memory for the odd large texture
+#define UPLOAD_RING_MAX_BUFFER_SIZE     ( 16 * 1024 * 1024 )
+
+typedef struct
+{
+    GLuint             mBuffer;     // Bound to GL_PIXEL_UNPACK_BUFFER from BeginUpload to FinishUpload, 0 if unused
+    int                mSlot;       // Ring buffer it lives in, -1 for a buffer of its own
+    size_t             mSize;
+    void*              pData;       // Mapped memory, NULL after EndUpload
+    unsigned long long mStartTime;  // When EndUpload handed it to the upload calls
+} UploadRegion;
+
+typedef struct
+{
+    unsigned long long mBytes;              // Uploaded through the ring
+    unsigned long long mIssueNanoseconds;   // From unmapping a region to the return of its upload calls. The
+                                            // transfers run after, mBytes over it is the rate the uploads are
+                                            // handed to the driver, not the transfer rate.
+    unsigned int       mUploads;            // Regions uploaded
+    unsigned int       mStalls;             // Times BeginUpload waited for the GPU to release a buffer
+    unsigned long long mStallNanoseconds;   // Time spent waiting
+    unsigned int       mFallbacks;          // Regions that couldn't be mapped, the loader used client memory
+    size_t             mBufferBytes;        // GL memory the buffers of every thread's ring hold
+} UploadRingStats;
+
+// Maps a region of 'size' bytes and leaves its buffer bound to GL_PIXEL_UNPACK_BUFFER. Non-zero
+// 'readable' maps it for reading too, for decoders that read back what they wrote (slower, the
+// driver can't hand out fresh memory). Returns 0 if no region could be mapped or the context has
+// no pixel buffer objects, the caller then uploads from client memory; pRegion->mBuffer is 0 and
+// FinishUpload ignores it.
+int BeginUpload( size_t size, int readable, UploadRegion* pRegion );
+
+// Unmaps the region once it is filled; the upload calls that follow pass offsets into it. Returns
+// 0 if the mapping was lost, in which case the contents are undefined.
+int EndUpload( UploadRegion* pRegion );
+
+// Fences the region's buffer after the upload calls sourced from it and unbinds it
+void FinishUpload( UploadRegion* pRegion );
+
+// Gives a region back without uploading from it, e.g. when decoding into it failed. Unmaps it
+// first if EndUpload wasn't called.
+void CancelUpload( UploadRegion* pRegion );
+
+// Sets how many buffers the calling thread's ring cycles through (1 to UPLOAD_RING_MAX_BUFFERS). More buffers let
+// more uploads be in flight before BeginUpload has to wait for the GPU.
+void SetUploadRingSize( unsigned int bufferCount );
+
+// Deletes the calling thread's ring buffers and fences, e.g. once a level has finished loading
+void ShutdownUploadRing();
+
+void GetUploadRingStats( UploadRingStats* pStats );
@@ -0,0 +1,540 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <android/log.h>
+
+#include "gl_state.h"
+#include "staging.h"
+#include "upload_scheduler.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Debugging helper functions
+#define  LogError(...)  __android_log_print( ANDROID_LOG_ERROR, "TextureLoader", __VA_ARGS__ )
+
+// Upload rate assumed for a format until one of its bands has been timed, in bytes per nanosecond
+#define UPLOAD_SCHEDULER_INITIAL_RATE   0.1
+
+// Weight of the latest band in the running estimate of a format's upload rate
+#define UPLOAD_SCHEDULER_RATE_WEIGHT    0.25
+
+// Formats whose upload rates are tracked, any others are assumed to upload at the initial rate
+#define UPLOAD_SCHEDULER_MAX_FORMATS    16
+
+// A texture with levels left to upload
+typedef struct ScheduledTexture
+{
+    ScheduledUpload          mUpload;
+    unsigned char*           pData;         // The levels, or the buffer bands are streamed through
+    unsigned int             mBufferSize;   // Of the buffer of streamed uploads
+    unsigned int             mFilePosition; // Where the next read of a streamed upload starts
+    int                      mLevel;    // Level being uploaded, from coarse to fine
+    int                      mRow;      // First row of mLevel not uploaded yet
+    GLsync                   mFence;    // Signalled once the storage and small levels are in place
+    struct ScheduledTexture* pNext;
+} ScheduledTexture;
+
+typedef struct
+{
+    GLenum mFormat;
+    GLenum mType;
+    double mBytesPerNanosecond;
+} UploadRate;
+
+// Textures are added from any thread; only the render thread uploads to and removes them, so it
+// can upload a band without holding the mutex
+static pthread_mutex_t   gSchedulerMutex = PTHREAD_MUTEX_INITIALIZER;
+static ScheduledTexture* gpScheduledTextures = NULL;    // Oldest first
+static UploadRate        gUploadRates[UPLOAD_SCHEDULER_MAX_FORMATS];
+static int               gUploadRateCount = 0;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Monotonic time in nanoseconds
+static unsigned long long GetNanoseconds()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the rate estimate of a format, adding one if there is room. gSchedulerMutex must be held.
+static UploadRate* FindUploadRate( GLenum format, GLenum type )
+{
+    int index;
+
+    for( index = 0; index < gUploadRateCount; ++index )
+    {
+        if( gUploadRates[index].mFormat == format && gUploadRates[index].mType == type )
+        {
+            return &gUploadRates[index];
+        }
+    }
+    if( gUploadRateCount == UPLOAD_SCHEDULER_MAX_FORMATS )
+    {
+        return NULL;
+    }
+
+    gUploadRates[gUploadRateCount].mFormat = format;
+    gUploadRates[gUploadRateCount].mType = type;
+    gUploadRates[gUploadRateCount].mBytesPerNanosecond = 0.0;
+    return &gUploadRates[gUploadRateCount++];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns where rows [row, row + rowCount) of a level start in its data, and their size. Bands of
+// compressed levels start on a block row; levels uploaded whole pass row 0 and the height.
+static unsigned int GetBandOffset( const ScheduledUpload* pUpload, int level, int row )
+{
+    if( pUpload->mType == 0 )
+    {
+        return pUpload->mBandRows > 0 ? ( row / pUpload->mBandRows ) * pUpload->mLevels[level].mStride : 0;
+    }
+    return row * pUpload->mLevels[level].mStride;
+}
+
+static unsigned int GetBandSize( const ScheduledUpload* pUpload, int level, int rowCount )
+{
+    const ScheduledLevel* pLevel = &pUpload->mLevels[level];
+
+    if( pUpload->mType == 0 )
+    {
+        return pUpload->mBandRows > 0 ? ( ( rowCount + pUpload->mBandRows - 1 ) / pUpload->mBandRows ) * pLevel->mStride
+                                      : pLevel->mSize;
+    }
+    return rowCount * pLevel->mStride;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads rows [row, row + rowCount) of a level, found at pBand, to the bound texture
+static void UploadBand( const ScheduledUpload* pUpload, int level, int row, int rowCount, const unsigned char* pBand )
+{
+    const ScheduledLevel* pLevel = &pUpload->mLevels[level];
+
+    if( pUpload->mType == 0 )
+    {
+        glCompressedTexSubImage2D( GL_TEXTURE_2D, level, 0, row, pLevel->mWidth, rowCount, pUpload->mFormat,
+                                   GetBandSize( pUpload, level, rowCount ), pBand );
+    }
+    else
+    {
+        // Rows padded beyond the default alignment (e.g. packed from wider RGBA rows) need their length
+        int padded = pLevel->mStride != ( ( pLevel->mWidth * pUpload->mPixelBytes + 3 ) & ~3u );
+
+        if( padded )
+        {
+            CachedPixelStorei( GL_UNPACK_ROW_LENGTH, pLevel->mStride / pUpload->mPixelBytes );
+        }
+        glTexSubImage2D( GL_TEXTURE_2D, level, 0, row, pLevel->mWidth, rowCount, pUpload->mFormat, pUpload->mType, pBand );
+        if( padded )
+        {
+            CachedPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the most rows of a level one band can hold, streamed bands have to fit the buffer
+static int GetMaxBandRows( const ScheduledTexture* pTexture, int level )
+{
+    const ScheduledUpload* pUpload = &pTexture->mUpload;
+    const ScheduledLevel* pLevel = &pUpload->mLevels[level];
+    unsigned int rows;
+
+    if( pUpload->pFile == NULL || pUpload->mBandRows == 0 )
+    {
+        return pLevel->mHeight;
+    }
+    rows = ( pTexture->mBufferSize / pLevel->mStride ) * pUpload->mBandRows;
+    return rows < (unsigned int)pLevel->mHeight ? (int)rows : pLevel->mHeight;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads rows [row, row + rowCount) of a level to the bound texture, reading them from the file
+// first if the upload is streamed. Returns their size, 0 if they couldn't be read.
+static unsigned int UploadRows( ScheduledTexture* pTexture, int level, int row, int rowCount )
+{
+    const ScheduledUpload* pUpload = &pTexture->mUpload;
+    unsigned int offset = pUpload->mLevels[level].mOffset + GetBandOffset( pUpload, level, row );
+    unsigned int size = GetBandSize( pUpload, level, rowCount );
+
+    if( pUpload->pFile == NULL )
+    {
+        UploadBand( pUpload, level, row, rowCount, pTexture->pData + offset );
+        return size;
+    }
+
+    // Files packed in upload order only ever seek forward
+    if( ( pTexture->mFilePosition != offset && !SeekFile( pUpload->pFile, offset ) ) ||
+        !ReadFilePart( pUpload->pFile, pTexture->pData, size ) )
+    {
+        LogError( "Couldn't read level %d of streamed texture %u\n", level, pUpload->mTexture );
+        return 0;
+    }
+    pTexture->mFilePosition = offset + size;
+
+    UploadBand( pUpload, level, row, rowCount, pTexture->pData );
+    return size;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads a whole level to the bound texture, in as many bands as streaming needs. Returns 0 if
+// it couldn't be read.
+static int UploadLevel( ScheduledTexture* pTexture, int level )
+{
+    int height = pTexture->mUpload.mLevels[level].mHeight;
+    int maxRows = GetMaxBandRows( pTexture, level );
+    int row;
+
+    for( row = 0; row < height; row += maxRows )
+    {
+        if( !UploadRows( pTexture, level, row, row + maxRows < height ? maxRows : height - row ) )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Frees the data of a texture and closes its file
+static void ReleaseScheduledData( ScheduledTexture* pTexture )
+{
+    ReleaseStagingBuffer( pTexture->pData );
+    if( pTexture->mUpload.pFile != NULL )
+    {
+        CloseFile( pTexture->mUpload.pFile );
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Takes a texture off the list and frees it. gSchedulerMutex must be held.
+static void RemoveScheduledTexture( ScheduledTexture* pTexture )
+{
+    ScheduledTexture** ppLink = &gpScheduledTextures;
+
+    while( *ppLink != pTexture )
+    {
+        ppLink = &( *ppLink )->pNext;
+    }
+    *ppLink = pTexture->pNext;
+
+    if( pTexture->mFence != 0 )
+    {
+        glDeleteSync( pTexture->mFence );
+    }
+    ReleaseScheduledData( pTexture );
+    free( pTexture );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads the smallest levels and queues the others for RunScheduledUploads
+void ScheduleTextureUpload( const ScheduledUpload* pUpload, void* pData )
+{
+    ScheduledTexture texture;
+    ScheduledTexture* pTexture = NULL;
+    unsigned int immediateBytes = 0;
+    int level = pUpload->mLevelCount - 1;
+    int read = 1;
+
+    memset( &texture, 0, sizeof(texture) );
+    texture.mUpload = *pUpload;
+    texture.pData = (unsigned char*)pData;
+    if( pUpload->pFile != NULL )
+    {
+        // Room for a band of the largest level, or for the whole level if they are uploaded whole
+        const ScheduledLevel* pLargest = &pUpload->mLevels[0];
+
+        texture.mBufferSize = pUpload->mBandRows == 0 ? pLargest->mSize : pLargest->mStride * pUpload->mBandRows;
+        if( pUpload->mBandRows > 0 && texture.mBufferSize < UPLOAD_SCHEDULER_STREAM_BYTES )
+        {
+            texture.mBufferSize = UPLOAD_SCHEDULER_STREAM_BYTES;
+        }
+        texture.mFilePosition = ~0u;
+        texture.pData = (unsigned char*)AcquireStagingBuffer( texture.mBufferSize );
+        if( texture.pData == NULL )
+        {
+            LogError( "No memory to stream texture %u\n", pUpload->mTexture );
+            ReleaseScheduledData( &texture );
+            return;
+        }
+    }
+
+    CachedBindTexture( GL_TEXTURE_2D, pUpload->mTexture );
+
+    // The smallest level always goes up, so the texture has something to show
+    do
+    {
+        immediateBytes += pUpload->mLevels[level].mSize;
+        read = UploadLevel( &texture, level );
+        level--;
+    } while( read && level >= 0 && immediateBytes + pUpload->mLevels[level].mSize <= UPLOAD_SCHEDULER_IMMEDIATE_BYTES );
+
+    if( !read )
+    {
+        // Only the levels below the one that couldn't be read are complete
+        level++;
+    }
+    else if( level >= 0 )
+    {
+        pTexture = (ScheduledTexture*)calloc( 1, sizeof(ScheduledTexture) );
+        if( pTexture == NULL )
+        {
+            // Nowhere to keep track of it, upload the rest now
+            for( ; level >= 0 && UploadLevel( &texture, level ); --level )
+            {
+            }
+        }
+    }
+    CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1 );
+
+    if( pTexture == NULL )
+    {
+        ReleaseScheduledData( &texture );
+        return;
+    }
+
+    *pTexture = texture;
+    pTexture->mLevel = level;
+    pTexture->mRow = 0;
+
+    // The texture may have been made in another context, the render thread waits for this fence
+    // before uploading to it. The flush gets the fence to the GPU.
+    pTexture->mFence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    glFlush();
+
+    pthread_mutex_lock( &gSchedulerMutex );
+    {
+        ScheduledTexture** ppLink = &gpScheduledTextures;
+        while( *ppLink != NULL )
+        {
+            ppLink = &( *ppLink )->pNext;
+        }
+        *ppLink = pTexture;
+    }
+    pthread_mutex_unlock( &gSchedulerMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Uploads bands of the scheduled textures until the budget is spent
+int RunScheduledUploads( unsigned int budgetMicroseconds )
+{
+    unsigned long long start = GetNanoseconds();
+    unsigned long long budget = budgetMicroseconds * 1000ull;
+    ScheduledTexture* pTexture;
+    int bands = 0;
+    int pending = 0;
+
+    pthread_mutex_lock( &gSchedulerMutex );
+    pTexture = gpScheduledTextures;
+    while( pTexture != NULL )
+    {
+        const ScheduledUpload* pUpload = &pTexture->mUpload;
+        const ScheduledLevel* pLevel = &pUpload->mLevels[pTexture->mLevel];
+        unsigned long long elapsed = GetNanoseconds() - start;
+        unsigned long long left = elapsed < budget ? budget - elapsed : 0;
+        int rowCount = pLevel->mHeight - pTexture->mRow;
+        int maxRows = GetMaxBandRows( pTexture, pTexture->mLevel );
+        UploadRate* pRate;
+        double rate;
+        unsigned int size;
+
+        if( bands > 0 && left == 0 )
+        {
+            break;
+        }
+
+        if( pTexture->mFence != 0 )
+        {
+            if( glClientWaitSync( pTexture->mFence, 0, 0 ) == GL_TIMEOUT_EXPIRED )
+            {
+                pTexture = pTexture->pNext;
+                continue;
+            }
+            glDeleteSync( pTexture->mFence );
+            pTexture->mFence = 0;
+        }
+
+        pRate = FindUploadRate( pUpload->mFormat, pUpload->mType );
+        rate = pRate != NULL && pRate->mBytesPerNanosecond > 0.0 ? pRate->mBytesPerNanosecond : UPLOAD_SCHEDULER_INITIAL_RATE;
+        if( pUpload->mBandRows > 0 )
+        {
+            // As many rows as the time left is expected to upload, at least one band
+            unsigned long long units = (unsigned long long)( left * rate ) / pLevel->mStride;
+            unsigned long long rows = ( units > 0 ? units : 1 ) * pUpload->mBandRows;
+
+            if( rows < (unsigned long long)rowCount )
+            {
+                rowCount = (int)rows;
+            }
+            if( rowCount > maxRows )
+            {
+                rowCount = maxRows;
+            }
+        }
+        else if( bands > 0 && pLevel->mSize > left * rate )
+        {
+            // A whole level that won't fit waits for a frame of its own
+            break;
+        }
+        pthread_mutex_unlock( &gSchedulerMutex );
+
+        CachedBindTexture( GL_TEXTURE_2D, pUpload->mTexture );
+        elapsed = GetNanoseconds();
+        size = UploadRows( pTexture, pTexture->mLevel, pTexture->mRow, rowCount );
+        elapsed = GetNanoseconds() - elapsed;
+
+        pTexture->mRow += rowCount;
+        if( size == 0 )
+        {
+            // A streamed band that couldn't be read ends the stream, the texture keeps the levels it has
+            pTexture->mLevel = -1;
+        }
+        else if( pTexture->mRow >= pLevel->mHeight )
+        {
+            CachedTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, pTexture->mLevel );
+            pTexture->mLevel--;
+            pTexture->mRow = 0;
+        }
+        bands++;
+
+        pthread_mutex_lock( &gSchedulerMutex );
+        if( pRate != NULL && elapsed > 0 && size > 0 )
+        {
+            double measured = size / (double)elapsed;
+
+            pRate->mBytesPerNanosecond = pRate->mBytesPerNanosecond > 0.0
+                                       ? pRate->mBytesPerNanosecond + UPLOAD_SCHEDULER_RATE_WEIGHT * ( measured - pRate->mBytesPerNanosecond )
+                                       : measured;
+        }
+
+        if( pTexture->mLevel < 0 )
+        {
+            ScheduledTexture* pNext = pTexture->pNext;
+            RemoveScheduledTexture( pTexture );
+            pTexture = pNext;
+        }
+    }
+
+    for( pTexture = gpScheduledTextures; pTexture != NULL; pTexture = pTexture->pNext )
+    {
+        pending++;
+    }
+    pthread_mutex_unlock( &gSchedulerMutex );
+
+    return pending;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Forgets the levels of a texture that haven't been uploaded
+void CancelScheduledUploads( GLuint texture )
+{
+    ScheduledTexture* pTexture;
+
+    pthread_mutex_lock( &gSchedulerMutex );
+    for( pTexture = gpScheduledTextures; pTexture != NULL; pTexture = pTexture->pNext )
+    {
+        if( pTexture->mUpload.mTexture == texture )
+        {
+            RemoveScheduledTexture( pTexture );
+            break;
+        }
+    }
+    pthread_mutex_unlock( &gSchedulerMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Frees every texture on the list. Their fences went with the context, so they aren't deleted.
+void ResetUploadScheduler()
+{
+    pthread_mutex_lock( &gSchedulerMutex );
+    while( gpScheduledTextures != NULL )
+    {
+        ScheduledTexture* pTexture = gpScheduledTextures;
+
+        gpScheduledTextures = pTexture->pNext;
+        ReleaseScheduledData( pTexture );
+        free( pTexture );
+    }
+    pthread_mutex_unlock( &gSchedulerMutex );
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns whether a texture is on the list
+int IsTextureUploadScheduled( GLuint texture )
+{
+    ScheduledTexture* pTexture;
+    int scheduled = 0;
+
+    pthread_mutex_lock( &gSchedulerMutex );
+    for( pTexture = gpScheduledTextures; pTexture != NULL && !scheduled; pTexture = pTexture->pNext )
+    {
+        scheduled = pTexture->mUpload.mTexture == texture;
+    }
+    pthread_mutex_unlock( &gSchedulerMutex );
+
+    return scheduled;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the running upload rate estimate of a format
+float GetScheduledUploadRate( GLenum format, GLenum type )
+{
+    float rate = 0.0f;
+    int index;
+
+    pthread_mutex_lock( &gSchedulerMutex );
+    for( index = 0; index < gUploadRateCount; ++index )
+    {
+        if( gUploadRates[index].mFormat == format && gUploadRates[index].mType == type )
+        {
+            rate = (float)( gUploadRates[index].mBytesPerNanosecond * 1000.0 );
+        }
+    }
+    pthread_mutex_unlock( &gSchedulerMutex );
+
+    return rate;
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include "file.h"
+#include "mipmap.h"
+
+// Spreads texture uploads over frames. A loader asked to defer its upload (TextureOptions
+// mDeferUpload) decodes as usual but hands the levels to the scheduler: the smallest ones are
+// uploaded right away, so the texture can be drawn at once, and the render thread uploads the rest
+// from RunScheduledUploads, coarse to fine, in bands of rows sized to the time it is given each
+// frame. GL_TEXTURE_BASE_LEVEL follows the finest complete level, so the texture sharpens as its
+// levels arrive instead of showing undefined texels.
+//
+// Streamed uploads (TextureOptions mStreamLevels) don't read the levels up front at all: the
+// scheduler reads each band from the file right before uploading it, so a texture is shown from its
+// smallest levels as soon as its header is read and only one band is ever held in memory. Files
+// store their levels largest first, which takes a seek back for every level; files packed smallest
+// first (see texture.h) are read straight through.
+//
+// The time an upload takes is measured for every band, reading included, and a running estimate of
+// the upload rate of each format decides how many rows fit in what is left of the budget.
+//
+// ScheduleTextureUpload may be called on any thread whose context shares objects with the render
+// context. RunScheduledUploads and CancelScheduledUploads must be called on the render thread;
+// they leave the textures they upload to bound to GL_TEXTURE_2D.
+
+// Levels up to this size are uploaded by ScheduleTextureUpload itself
+#define UPLOAD_SCHEDULER_IMMEDIATE_BYTES    ( 64 * 1024 )
+
+// Size of the buffer streamed bands are read into, or of the largest level if it is uploaded whole
+#define UPLOAD_SCHEDULER_STREAM_BYTES       ( 256 * 1024 )
+
+typedef struct
+{
+    int          mWidth;
+    int          mHeight;
+    unsigned int mOffset;       // Of the level in the data, or in the file of streamed uploads
+    unsigned int mStride;       // Bytes from one row to the next, or one row of blocks to the next
+    unsigned int mSize;         // Bytes
+} ScheduledLevel;
+
+typedef struct
+{
+    GLuint         mTexture;    // GL_TEXTURE_2D with immutable storage for all the levels
+    GLenum         mFormat;     // glTexSubImage2D format, or the compressed internal format
+    GLenum         mType;       // glTexSubImage2D type, 0 for compressed formats
+    unsigned int   mPixelBytes; // Bytes per pixel of uncompressed formats
+    unsigned int   mBandRows;   // Bands are cut at multiples of this many rows (the block height of
+                                // compressed formats), 0 uploads levels whole
+    int            mLevelCount;
+    ScheduledLevel mLevels[MAX_MIP_LEVELS];
+    AAsset*        pFile;       // Streamed uploads read the levels from it, NULL if they are in the data
+} ScheduledUpload;
+
+// Uploads the smallest levels of a texture and schedules the rest. Takes over pData, a staging
+// buffer (see staging.h) that is released once the last level is uploaded, or for streamed
+// uploads the file, which is closed then; pData is NULL for those.
+void ScheduleTextureUpload( const ScheduledUpload* pUpload, void* pData );
+
+// Uploads bands of the scheduled textures, oldest first, until about 'budgetMicroseconds' have
+// been spent. At least one band is uploaded if anything is pending, so streaming always makes
+// progress. Returns the number of textures still pending.
+int RunScheduledUploads( unsigned int budgetMicroseconds );
+
+// Drops the levels of a texture still waiting, e.g. before it is deleted
+void CancelScheduledUploads( GLuint texture );
+
+// Forgets every texture still waiting, without any GL calls, once the context they were in is lost
+// and took them with it. The upload rates are kept.
+void ResetUploadScheduler();
+
+// Returns whether a texture has levels waiting, its GL_TEXTURE_BASE_LEVEL is the scheduler's until
+// it hasn't
+int IsTextureUploadScheduled( GLuint texture );
+
+// Returns the estimated upload rate of a format in bytes per microsecond, 0 until measured
+float GetScheduledUploadRate( GLenum format, GLenum type );
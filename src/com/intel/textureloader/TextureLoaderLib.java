@@ -1,47 +1,98 @@
-/* Copyright (c) <2012>, Intel Corporation
-*
-* Redistribution and use in source and binary forms, with or without 
-* modification, are permitted provided that the following conditions are met:
-*
-* - Redistributions of source code must retain the above copyright notice, 
-*   this list of conditions and the following disclaimer.
-* - Redistributions in binary form must reproduce the above copyright notice, 
-*   this list of conditions and the following disclaimer in the documentation 
-*   and/or other materials provided with the distribution.
-* - Neither the name of Intel Corporation nor the names of its contributors 
-*   may be used to endorse or promote products derived from this software 
-*   without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
-* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
-* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
-* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
-* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
-* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
-* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
-* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
-* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
-* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
-* POSSIBILITY OF SUCH DAMAGE.
-*
-*/
-
-package com.intel.textureloader;
-
-import android.content.res.AssetManager;
-
-public class TextureLoaderLib 
-{
-     
-    // This is static so it will be called at startup (without creating an instance of this class)
-    static 
-    {
-        // Load textureloader.so
-        System.loadLibrary( "textureloader" );
-    }
-
-    // Define native functions that can be called from Java code
-    public static native void initGraphics( int width, int height );
-    public static native void drawFrame();
-    public static native void createAssetManager( AssetManager assetManager );
-}
+/* Copyright (c) <2012>, Intel Corporation
+*
+* Redistribution and use in source and binary forms, with or without 
+* modification, are permitted provided that the following conditions are met:
+*
+* - Redistributions of source code must retain the above copyright notice, 
+*   this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright notice, 
+*   this list of conditions and the following disclaimer in the documentation 
+*   and/or other materials provided with the distribution.
+* - Neither the name of Intel Corporation nor the names of its contributors 
+*   may be used to endorse or promote products derived from this software 
+*   without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+package com.intel.textureloader;
+
+import android.content.res.AssetManager;
+
+public class TextureLoaderLib 
+{
+     
+    // This is static so it will be called at startup (without creating an instance of this class)
+    static 
+    {
+        // Load textureloader.so
+        System.loadLibrary( "textureloader" );
+    }
+
+    // Define native functions that can be called from Java code
+    public static native void initGraphics( int width, int height );
+    public static native void drawFrame();
+    public static native void createAssetManager( AssetManager assetManager );
+
+    // Memory used by the loaded textures, getTextureMemoryTotals returns these entries (bytes
+    // unless noted). GPU sizes are estimated from the format and mip chain.
+    public static final int MEMORY_TEXTURE_COUNT    = 0;    // Textures loaded
+    public static final int MEMORY_GPU_BYTES        = 1;    // Video memory they use
+    public static final int MEMORY_PEAK_GPU_BYTES   = 2;    // High-water mark of MEMORY_GPU_BYTES
+    public static final int MEMORY_CPU_PEAK_BYTES   = 3;    // Largest transient CPU memory of a single load
+    public static final int MEMORY_SOURCE_BYTES     = 4;    // Bytes read from the files they came from
+    public static final int MEMORY_GPU_BUDGET       = 5;    // As set by setTextureMemoryBudget, 0 if none
+    public static native long[] getTextureMemoryTotals();
+
+    // Video memory the textures should fit in, 0 for no limit. Loads past it are logged, and the
+    // textures drop their top levels, least recently drawn first, or are evicted when unused.
+    public static native void setTextureMemoryBudget( long bytes );
+
+    // Loads textures at reduced resolution from now on, for low memory devices: no larger than
+    // maxDimension, and without the top skipMipLevels levels of KTX/PVRTC/S3TC files, which are
+    // not even read. 0 for no limit.
+    public static native void setTextureResolutionCap( int maxDimension, int skipMipLevels );
+
+    // Texture uploads staged through the pixel unpack buffer ring, getUploadStats returns these
+    // entries
+    public static final int UPLOAD_BYTES                  = 0;  // Uploaded through the ring
+    public static final int UPLOAD_ISSUE_BYTES_PER_SECOND = 1;  // Rate the upload calls are issued at; the
+                                                                // transfers finish asynchronously, later
+    public static final int UPLOAD_COUNT                  = 2;  // Regions uploaded
+    public static final int UPLOAD_STALLS                 = 3;  // Waits for the GPU to release a ring buffer
+    public static final int UPLOAD_STALL_NANOS            = 4;  // Time spent in those waits
+    public static final int UPLOAD_FALLBACKS              = 5;  // Uploads that went from client memory instead
+    public static final int UPLOAD_BUFFER_BYTES           = 6;  // GL memory held by the ring
+    public static native long[] getUploadStats();
+
+    // Time each frame may spend uploading the levels of textures loaded in the background, the
+    // rest wait for the next frames. 2000 by default.
+    public static native void setUploadBudget( int microseconds );
+
+    // Textures kept to their footprint on screen and to the video memory budget, getResidencyStats
+    // returns these entries
+    public static final int RESIDENCY_FRAME          = 0;   // Frames residency was updated in
+    public static final int RESIDENCY_MANAGED        = 1;   // Textures managed
+    public static final int RESIDENCY_RESIDENT       = 2;   // Of those, textures in video memory
+    public static final int RESIDENCY_RESIDENT_BYTES = 3;   // Video memory they use
+    public static final int RESIDENCY_EVICTIONS      = 4;   // Unused textures deleted to meet the budget
+    public static final int RESIDENCY_LEVEL_DROPS    = 5;   // Reloads without their top levels, to meet the budget
+    public static final int RESIDENCY_RELOADS        = 6;   // Reloads with more levels, or after an eviction
+    public static native long[] getResidencyStats();
+
+    // Calls to GL the state cache let through and left out, getGlStateStats returns these entries
+    public static final int GL_STATE_ISSUED          = 0;   // Calls that changed state, or queries it didn't know
+    public static final int GL_STATE_SKIPPED         = 1;   // Calls setting state already set, or queries it answered
+    public static native long[] getGlStateStats();
+}